@@ -30,6 +30,7 @@
 
 #include "itkProcessObject.h"
 #include "itkImage.h"
+#include "itkVariableLengthVector.h"
 
 namespace itk
 {
@@ -209,6 +210,11 @@ public:
   using Superclass::MakeOutput;
   virtual DataObjectPointer MakeOutput(DataObjectPointerArraySizeType idx);
 
+  /** Estimate the number of bytes held by the outputs of this source
+   * for their current requested regions. Outputs that are not of
+   * OutputImageType are not counted. */
+  virtual SizeValueType GetEstimatedOutputMemorySize();
+
 protected:
   ImageSource();
   virtual ~ImageSource() {}
@@ -308,6 +314,23 @@ protected:
 private:
   ImageSource(const Self &);    //purposely not implemented
   void operator=(const Self &); //purposely not implemented
+
+  /** Number of bytes used to store one pixel of an output image. The
+   * components of a VariableLengthVector pixel (VectorImage) are stored
+   * contiguously in the pixel container. */
+  template< class TPixel >
+  static SizeValueType GetPixelMemorySize(const ImageBase< OutputImageDimension > *,
+                                          const TPixel *)
+  {
+    return sizeof( TPixel );
+  }
+
+  template< class TValue >
+  static SizeValueType GetPixelMemorySize(const ImageBase< OutputImageDimension > *image,
+                                          const VariableLengthVector< TValue > *)
+  {
+    return sizeof( TValue ) * image->GetNumberOfComponentsPerPixel();
+  }
 };
 } // end namespace itk
 
@@ -222,6 +222,32 @@ ImageSource< TOutputImage >
   return maxThreadIdUsed + 1;
 }
 
+//----------------------------------------------------------------------------
+template< class TOutputImage >
+SizeValueType
+ImageSource< TOutputImage >
+::GetEstimatedOutputMemorySize()
+{
+  typedef ImageBase< OutputImageDimension > ImageBaseType;
+
+  SizeValueType size = 0;
+
+  for ( OutputDataObjectIterator it(this); !it.IsAtEnd(); it++ )
+    {
+    // Only outputs of the templated type have a known pixel size
+    const TOutputImage *outputPtr = dynamic_cast< const TOutputImage * >( it.GetOutput() );
+
+    if ( outputPtr )
+      {
+      const ImageBaseType *imagePtr = outputPtr;
+      size += outputPtr->GetRequestedRegion().GetNumberOfPixels()
+              * Self::GetPixelMemorySize( imagePtr, static_cast< const OutputImagePixelType * >( 0 ) );
+      }
+    }
+
+  return size;
+}
+
 //----------------------------------------------------------------------------
 template< class TOutputImage >
 void
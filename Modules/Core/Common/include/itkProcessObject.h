@@ -306,6 +306,25 @@ public:
    * a process object does not modify the size of the output requested region. */
   virtual void EnlargeOutputRequestedRegion( DataObject *itkNotUsed(output) ){}
 
+  /** Estimate the number of bytes of bulk data the outputs of this
+   * process object will hold to satisfy their current requested
+   * regions. The default implementation does not know the size of its
+   * outputs and returns zero; ImageSource reports the size of its
+   * image outputs. Subclasses that allocate large temporary buffers
+   * may add them to the estimate. */
+  virtual SizeValueType GetEstimatedOutputMemorySize();
+
+  /** Estimate the number of bytes of bulk data needed to update this
+   * process object and every process object upstream of it, for the
+   * requested regions set by the last call to
+   * PropagateRequestedRegion(). Because the requested regions are
+   * propagated through GenerateInputRequestedRegion(), the padding
+   * requested by neighborhood filters is included. Each upstream
+   * process object is counted once. This is used by streaming drivers,
+   * such as StreamingImageFilter, to select a number of stream divisions
+   * for a memory budget. */
+  SizeValueType GetEstimatedPipelineMemorySize();
+
   /** Reset the pipeline. If an exception is thrown during an Update(),
    * the pipeline may be in an inconsistent state.  This method clears
    * the internal state of the pipeline so Update() can be called. */
@@ -36,6 +36,13 @@ namespace itk
  * This filter will produce the entire output as one image, but the upstream
  * filters will do their processing in pieces.
  *
+ * Alternatively, a memory budget in bytes can be set with
+ * SetMemoryBudget(). The number of pieces is then chosen so that the
+ * estimated memory needed by the upstream pipeline to generate one
+ * piece, as reported by ProcessObject::GetEstimatedPipelineMemorySize(),
+ * fits in the budget. The number of pieces actually used and the
+ * estimate for the largest piece can be queried after an update.
+ *
  * \ingroup ITKSystemObjects
  * \ingroup DataProcessing
  * \ingroup ITKCommon
@@ -87,6 +94,24 @@ public:
    * will be executed this many times. */
   itkGetConstReferenceMacro(NumberOfStreamDivisions, unsigned int);
 
+  /** Set/Get the memory budget, in bytes, for the upstream pipeline.
+   * When non-zero, the number of stream divisions is chosen
+   * automatically so that the estimated memory needed to generate one
+   * piece does not exceed the budget, and NumberOfStreamDivisions is
+   * ignored. If the budget cannot be met even with the finest split the
+   * RegionSplitter allows, an exception is thrown. Defaults to zero. */
+  itkSetMacro(MemoryBudget, SizeValueType);
+  itkGetConstMacro(MemoryBudget, SizeValueType);
+
+  /** Get the number of pieces the input was divided into during the
+   * last update. */
+  itkGetConstMacro(ActualNumberOfStreamDivisions, unsigned int);
+
+  /** Get the estimated memory, in bytes, needed by the upstream
+   * pipeline to generate the first piece during the last update. Only
+   * computed when a memory budget is set. */
+  itkGetConstMacro(EstimatedPieceMemorySize, SizeValueType);
+
   /** Set the helper class for dividing the input into chunks. */
   itkSetObjectMacro(RegionSplitter, SplitterType);
 
@@ -119,6 +144,12 @@ protected:
   ~StreamingImageFilter();
   void PrintSelf(std::ostream & os, Indent indent) const;
 
+  /** Determine the number of pieces for which the estimated memory
+   * needed to generate the first piece fits in the MemoryBudget. The
+   * requested regions of the upstream pipeline are modified. */
+  unsigned int ComputeNumberOfStreamDivisions(InputImageType *inputPtr,
+                                              const OutputImageRegionType & outputRegion);
+
 private:
   StreamingImageFilter(const StreamingImageFilter &); //purposely not
                                                       // implemented
@@ -128,6 +159,10 @@ private:
 
   unsigned int          m_NumberOfStreamDivisions;
   RegionSplitterPointer m_RegionSplitter;
+
+  SizeValueType m_MemoryBudget;
+  unsigned int  m_ActualNumberOfStreamDivisions;
+  SizeValueType m_EstimatedPieceMemorySize;
 };
 } // end namespace itk
 
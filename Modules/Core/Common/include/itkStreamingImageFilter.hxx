@@ -21,6 +21,7 @@
 #include "itkCommand.h"
 #include "itkImageRegionIterator.h"
 #include "itkImageAlgorithm.h"
+#include "itkStreamingMemoryBudgetCalculator.h"
 
 namespace itk
 {
@@ -36,6 +37,11 @@ StreamingImageFilter< TInputImage, TOutputImage >
 
   // create default region splitter
   m_RegionSplitter = ImageRegionSplitter< InputImageDimension >::New();
+
+  // no memory budget by default
+  m_MemoryBudget = 0;
+  m_ActualNumberOfStreamDivisions = 0;
+  m_EstimatedPieceMemorySize = 0;
 }
 
 /**
@@ -58,6 +64,11 @@ StreamingImageFilter< TInputImage, TOutputImage >
 
   os << indent << "Number of stream divisions: " << m_NumberOfStreamDivisions
      << std::endl;
+  os << indent << "Memory budget: " << m_MemoryBudget << std::endl;
+  os << indent << "Actual number of stream divisions: "
+     << m_ActualNumberOfStreamDivisions << std::endl;
+  os << indent << "Estimated piece memory size: "
+     << m_EstimatedPieceMemorySize << std::endl;
   if ( m_RegionSplitter )
     {
     os << indent << "Region splitter:" << m_RegionSplitter << std::endl;
@@ -173,14 +184,31 @@ StreamingImageFilter< TInputImage, TOutputImage >
    */
   unsigned int numDivisions, numDivisionsFromSplitter;
 
-  numDivisions = m_NumberOfStreamDivisions;
+  if ( m_MemoryBudget > 0 )
+    {
+    try
+      {
+      numDivisions = this->ComputeNumberOfStreamDivisions(inputPtr, outputRegion);
+      }
+    catch ( ExceptionObject & )
+      {
+      this->m_Updating = false;
+      throw;
+      }
+    }
+  else
+    {
+    numDivisions = m_NumberOfStreamDivisions;
+    }
   numDivisionsFromSplitter =
     m_RegionSplitter
-    ->GetNumberOfSplits(outputRegion, m_NumberOfStreamDivisions);
+    ->GetNumberOfSplits(outputRegion, numDivisions);
   if ( numDivisionsFromSplitter < numDivisions )
     {
     numDivisions = numDivisionsFromSplitter;
     }
+  m_ActualNumberOfStreamDivisions = numDivisions;
+  itkDebugMacro("Streaming with " << numDivisions << " divisions");
 
   /**
    * Loop over the number of pieces, execute the upstream pipeline on each
@@ -240,6 +268,59 @@ StreamingImageFilter< TInputImage, TOutputImage >
   // Mark that we are no longer updating the data in this filter
   this->m_Updating = false;
 }
+/**
+ *
+ */
+template< class TInputImage, class TOutputImage >
+unsigned int
+StreamingImageFilter< TInputImage, TOutputImage >
+::ComputeNumberOfStreamDivisions(InputImageType *inputPtr,
+                                 const OutputImageRegionType & outputRegion)
+{
+  // the pieces are the ones of the splitter, and the memory of a piece is
+  // estimated by propagating its requested region without updating the
+  // pipeline
+  class MemoryBudgetCalculator:public StreamingMemoryBudgetCalculator
+  {
+public:
+    MemoryBudgetCalculator(SplitterType *splitter, InputImageType *input,
+                           const OutputImageRegionType & region):
+      m_Splitter(splitter), m_Input(input), m_Region(region) {}
+protected:
+    virtual unsigned int GetNumberOfSplits(unsigned int requestedNumber)
+    {
+      return m_Splitter->GetNumberOfSplits(m_Region, requestedNumber);
+    }
+
+    virtual SizeValueType EstimatePieceMemorySize(unsigned int numberOfPieces)
+    {
+      m_Input->SetRequestedRegion( m_Splitter->GetSplit(0, numberOfPieces, m_Region) );
+      m_Input->PropagateRequestedRegion();
+      return m_Input->GetSource() ? m_Input->GetSource()->GetEstimatedPipelineMemorySize() : 0;
+    }
+
+private:
+    SplitterType *                m_Splitter;
+    InputImageType *              m_Input;
+    const OutputImageRegionType & m_Region;
+  };
+
+  MemoryBudgetCalculator calculator(m_RegionSplitter, inputPtr, outputRegion);
+  try
+    {
+    const unsigned int numDivisions =
+      calculator.ComputeNumberOfStreamDivisions(outputRegion.GetNumberOfPixels(), m_MemoryBudget);
+    m_EstimatedPieceMemorySize = calculator.GetEstimatedPieceMemorySize();
+    itkDebugMacro("Estimated memory for " << numDivisions << " divisions: "
+                  << m_EstimatedPieceMemorySize << " bytes");
+    return numDivisions;
+    }
+  catch ( ExceptionObject & )
+    {
+    m_EstimatedPieceMemorySize = calculator.GetEstimatedPieceMemorySize();
+    throw;
+    }
+}
 } // end namespace itk
 
 #endif
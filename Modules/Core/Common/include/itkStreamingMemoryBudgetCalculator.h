@@ -0,0 +1,76 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkStreamingMemoryBudgetCalculator_h
+#define __itkStreamingMemoryBudgetCalculator_h
+
+#include "itkMacro.h"
+#include "itkIntTypes.h"
+
+namespace itk
+{
+/** \class StreamingMemoryBudgetCalculator
+ *
+ * \brief Finds the number of pieces for which one piece of a streamed
+ * region fits in a memory budget.
+ *
+ * The number of pieces is increased until the estimated memory needed to
+ * generate the first, and largest, piece does not exceed the budget. The
+ * number of pieces a region is actually split into, and the estimate of
+ * the memory for one piece, are left to the subclasses, so that the search
+ * can be shared by the objects that stream a region in pieces, such as
+ * StreamingImageFilter with its ImageRegionSplitter and ImageFileWriter
+ * with its ImageIOBase.
+ *
+ * \ingroup ITKCommon
+ */
+class ITKCommon_EXPORT StreamingMemoryBudgetCalculator
+{
+public:
+  StreamingMemoryBudgetCalculator();
+  virtual ~StreamingMemoryBudgetCalculator();
+
+  /** Returns the smallest number of pieces, for a region of
+   * \a numberOfPixels pixels, for which the estimated memory of one piece
+   * fits in \a memoryBudget bytes. Throws an ExceptionObject if the budget
+   * cannot be met even with the finest split. */
+  unsigned int ComputeNumberOfStreamDivisions(SizeValueType numberOfPixels,
+                                              SizeValueType memoryBudget);
+
+  /** Returns the estimated memory, in bytes, of one piece for the number
+   * of pieces last tried by ComputeNumberOfStreamDivisions(). */
+  SizeValueType GetEstimatedPieceMemorySize() const
+  { return m_EstimatedPieceMemorySize; }
+
+protected:
+  /** Returns the number of pieces the region is actually split into when
+   * \a requestedNumber pieces are requested. */
+  virtual unsigned int GetNumberOfSplits(unsigned int requestedNumber) = 0;
+
+  /** Returns the estimated memory, in bytes, needed to generate the first
+   * piece of the region split into \a numberOfPieces pieces. */
+  virtual SizeValueType EstimatePieceMemorySize(unsigned int numberOfPieces) = 0;
+
+private:
+  StreamingMemoryBudgetCalculator(const StreamingMemoryBudgetCalculator &); //purposely not implemented
+  void operator=(const StreamingMemoryBudgetCalculator &);                 //purposely not implemented
+
+  SizeValueType m_EstimatedPieceMemorySize;
+};
+} // end namespace itk
+
+#endif
@@ -28,6 +28,7 @@
 #include "itkProcessObject.h"
 
 #include <stdio.h>
+#include <set>
 
 namespace itk
 {
@@ -1243,6 +1244,52 @@ ProcessObject
   m_Updating = false;
 }
 
+/**
+ * By default the size of the outputs is unknown.
+ */
+SizeValueType
+ProcessObject
+::GetEstimatedOutputMemorySize()
+{
+  return 0;
+}
+
+/**
+ * Walk the pipeline upstream, visiting each process object once, and
+ * accumulate the estimated size of their outputs.
+ */
+SizeValueType
+ProcessObject
+::GetEstimatedPipelineMemorySize()
+{
+  SizeValueType                  size = 0;
+  std::set< ProcessObject * >    visited;
+  std::vector< ProcessObject * > pending(1, this);
+
+  while ( !pending.empty() )
+    {
+    ProcessObject *source = pending.back();
+    pending.pop_back();
+
+    if ( !visited.insert(source).second )
+      {
+      continue;
+      }
+
+    size += source->GetEstimatedOutputMemorySize();
+
+    for ( DataObjectPointerMap::iterator it=source->m_Inputs.begin(); it != source->m_Inputs.end(); it++ )
+      {
+      if ( it->second && it->second->GetSource() )
+        {
+        pending.push_back( it->second->GetSource().GetPointer() );
+        }
+      }
+    }
+
+  return size;
+}
+
 /**
  * By default we require all the input to produce the output. This is
  * overridden in the subclasses since we can often produce the output with
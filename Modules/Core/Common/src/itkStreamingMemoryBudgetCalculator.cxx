@@ -0,0 +1,97 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkStreamingMemoryBudgetCalculator.h"
+#include "itkNumericTraits.h"
+#include "vnl/vnl_math.h"
+#include "vcl_cmath.h"
+
+namespace itk
+{
+StreamingMemoryBudgetCalculator
+::StreamingMemoryBudgetCalculator():
+  m_EstimatedPieceMemorySize(0)
+{}
+
+StreamingMemoryBudgetCalculator
+::~StreamingMemoryBudgetCalculator()
+{}
+
+unsigned int
+StreamingMemoryBudgetCalculator
+::ComputeNumberOfStreamDivisions(SizeValueType numberOfPixels,
+                                 SizeValueType memoryBudget)
+{
+  // the finest split that can be produced
+  if ( numberOfPixels > NumericTraits< unsigned int >::max() )
+    {
+    numberOfPixels = NumericTraits< unsigned int >::max();
+    }
+  const unsigned int maxDivisions =
+    this->GetNumberOfSplits( static_cast< unsigned int >( numberOfPixels ) );
+
+  // many requested counts are mapped onto the same number of pieces, so
+  // keep the requested count apart from the pieces it gives
+  unsigned int requestedDivisions = 1;
+  unsigned int numDivisions = this->GetNumberOfSplits(requestedDivisions);
+  while ( true )
+    {
+    m_EstimatedPieceMemorySize = this->EstimatePieceMemorySize(numDivisions);
+    if ( m_EstimatedPieceMemorySize <= memoryBudget )
+      {
+      break;
+      }
+    if ( numDivisions >= maxDivisions )
+      {
+      itkGenericExceptionMacro(<< "The memory budget of " << memoryBudget
+                               << " bytes cannot be met: the finest split into "
+                               << numDivisions << " divisions needs an estimated "
+                               << m_EstimatedPieceMemorySize << " bytes per piece.");
+      }
+
+    // the padding of neighborhood filters does not shrink with the
+    // piece, so ask for at least one more division
+    const double next = vcl_ceil( numDivisions * static_cast< double >( m_EstimatedPieceMemorySize )
+                                  / static_cast< double >( memoryBudget ) );
+    if ( next >= numberOfPixels )
+      {
+      requestedDivisions = static_cast< unsigned int >( numberOfPixels );
+      }
+    else
+      {
+      requestedDivisions = vnl_math_max(static_cast< unsigned int >( next ), requestedDivisions + 1);
+      }
+
+    // step through the requested counts that are mapped onto the current
+    // number of pieces
+    unsigned int nextDivisions = this->GetNumberOfSplits(requestedDivisions);
+    while ( nextDivisions <= numDivisions && requestedDivisions < numberOfPixels )
+      {
+      ++requestedDivisions;
+      nextDivisions = this->GetNumberOfSplits(requestedDivisions);
+      }
+    if ( nextDivisions <= numDivisions )
+      {
+      // the region cannot be split into more pieces
+      nextDivisions = maxDivisions;
+      }
+    numDivisions = nextDivisions;
+    }
+
+  return numDivisions;
+}
+} // end namespace itk
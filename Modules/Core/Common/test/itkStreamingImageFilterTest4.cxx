@@ -0,0 +1,174 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <iostream>
+#include "itkShrinkImageFilter.h"
+#include "itkStreamingImageFilter.h"
+#include "itkPipelineMonitorImageFilter.h"
+
+// Test the selection of the number of stream divisions from a memory
+// budget.
+int itkStreamingImageFilterTest4(int, char* [] )
+{
+  typedef itk::Image<short, 2>   ShortImage;
+
+  ShortImage::Pointer image = ShortImage::New();
+
+  ShortImage::IndexType  index = {{0, 0}};
+  ShortImage::SizeType   size = {{64, 64}};
+  ShortImage::RegionType region;
+  region.SetSize( size );
+  region.SetIndex( index );
+  image->SetRegions( region );
+  image->Allocate();
+
+  itk::ImageRegionIterator<ShortImage> iterator(image, region);
+  short i=0;
+  for (; !iterator.IsAtEnd(); ++iterator, ++i)
+    {
+    iterator.Set( i );
+    }
+
+  itk::ShrinkImageFilter< ShortImage, ShortImage >::Pointer shrink;
+  shrink = itk::ShrinkImageFilter< ShortImage, ShortImage >::New();
+  shrink->SetInput( image );
+  shrink->SetShrinkFactors( 1 );
+
+  itk::PipelineMonitorImageFilter<ShortImage>::Pointer monitor;
+  monitor = itk::PipelineMonitorImageFilter<ShortImage>::New();
+  monitor->SetInput( shrink->GetOutput() );
+
+  // The shrink and monitor filters both hold a short image of the
+  // requested size, so a quarter of the image fits in this budget.
+  const itk::SizeValueType budget = 2 * sizeof(short) * region.GetNumberOfPixels() / 4;
+
+  itk::StreamingImageFilter<ShortImage, ShortImage>::Pointer streamer;
+  streamer = itk::StreamingImageFilter<ShortImage, ShortImage>::New();
+  streamer->SetInput( monitor->GetOutput() );
+  streamer->SetMemoryBudget( budget );
+  streamer->Update();
+
+  std::cout << streamer;
+
+  const unsigned int divisions = streamer->GetActualNumberOfStreamDivisions();
+  if ( divisions != 4 )
+    {
+    std::cout << "Expected 4 divisions but got " << divisions << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if ( streamer->GetEstimatedPieceMemorySize() > budget )
+    {
+    std::cout << "Estimated piece memory " << streamer->GetEstimatedPieceMemorySize()
+              << " exceeds the budget " << budget << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if ( monitor->GetNumberOfUpdates() != divisions )
+    {
+    std::cout << monitor;
+    std::cout << "Pipeline didn't execute as expected." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  itk::ImageRegionConstIterator<ShortImage> inIt(image, region);
+  itk::ImageRegionConstIterator<ShortImage> outIt(streamer->GetOutput(), region);
+  for (; !inIt.IsAtEnd(); ++inIt, ++outIt )
+    {
+    if ( inIt.Get() != outIt.Get() )
+      {
+      std::cout << "Pixel " << inIt.GetIndex() << " expected " << inIt.Get()
+                << " but got " << outIt.Get() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // A budget larger than the whole pipeline does not stream
+  streamer->SetMemoryBudget( 10 * budget );
+  streamer->UpdateLargestPossibleRegion();
+
+  if ( streamer->GetActualNumberOfStreamDivisions() != 1 )
+    {
+    std::cout << "Expected 1 division but got "
+              << streamer->GetActualNumberOfStreamDivisions() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Between 32 and 64 pieces, the splitter of the 64 rows can only give
+  // 32 or 64 pieces, so a budget of one and a half rows needs 64 of them.
+  // A new pipeline is used, since the buffers of the previous updates
+  // hold the whole image.
+  shrink = itk::ShrinkImageFilter< ShortImage, ShortImage >::New();
+  shrink->SetInput( image );
+  shrink->SetShrinkFactors( 1 );
+  monitor = itk::PipelineMonitorImageFilter<ShortImage>::New();
+  monitor->SetInput( shrink->GetOutput() );
+  streamer = itk::StreamingImageFilter<ShortImage, ShortImage>::New();
+  streamer->SetInput( monitor->GetOutput() );
+
+  const itk::SizeValueType rowBudget = 3 * sizeof(short) * size[0];
+  streamer->SetMemoryBudget( rowBudget );
+  streamer->Update();
+
+  if ( streamer->GetActualNumberOfStreamDivisions() != 64 )
+    {
+    std::cout << "Expected 64 divisions but got "
+              << streamer->GetActualNumberOfStreamDivisions() << std::endl;
+    return EXIT_FAILURE;
+    }
+  if ( streamer->GetEstimatedPieceMemorySize() > rowBudget )
+    {
+    std::cout << "Estimated piece memory " << streamer->GetEstimatedPieceMemorySize()
+              << " exceeds the budget " << rowBudget << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A budget smaller than one row cannot be met
+  streamer = itk::StreamingImageFilter<ShortImage, ShortImage>::New();
+  streamer->SetInput( monitor->GetOutput() );
+  streamer->SetMemoryBudget( 3 * sizeof(short) * size[0] / 2 );
+  bool caught = false;
+  try
+    {
+    streamer->UpdateLargestPossibleRegion();
+    }
+  catch ( itk::ExceptionObject & excp )
+    {
+    std::cout << "Caught expected exception: " << excp << std::endl;
+    caught = true;
+    }
+  if ( !caught )
+    {
+    std::cout << "Expected an exception for a budget that cannot be met." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The filter can still update after the failure
+  streamer->SetMemoryBudget( budget );
+  streamer->UpdateLargestPossibleRegion();
+
+  if ( streamer->GetActualNumberOfStreamDivisions() != 4 )
+    {
+    std::cout << "Expected 4 divisions but got "
+              << streamer->GetActualNumberOfStreamDivisions() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
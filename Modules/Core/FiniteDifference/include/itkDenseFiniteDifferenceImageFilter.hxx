@@ -159,6 +159,9 @@ DenseFiniteDifferenceImageFilter< TInputImage, TOutputImage >
   // Multithread the execution
   this->GetMultiThreader()->SingleMethodExecute();
 
+  // Combine the global data of the threads
+  this->GetDifferenceFunction()->ReduceGlobalData();
+
   // Resolve the single value time step to return
   TimeStepType dt = this->ResolveTimeStep( str.TimeStepList,
                                            str.ValidTimeStepList );
@@ -228,7 +231,7 @@ template< class TInputImage, class TOutputImage >
 typename
 DenseFiniteDifferenceImageFilter< TInputImage, TOutputImage >::TimeStepType
 DenseFiniteDifferenceImageFilter< TInputImage, TOutputImage >
-::ThreadedCalculateChange(const ThreadRegionType & regionToProcess, ThreadIdType)
+::ThreadedCalculateChange(const ThreadRegionType & regionToProcess, ThreadIdType threadId)
 {
   typedef typename OutputImageType::RegionType                    RegionType;
   typedef typename OutputImageType::SizeType                      SizeType;
@@ -249,8 +252,8 @@ DenseFiniteDifferenceImageFilter< TInputImage, TOutputImage >
   // will use to manage any global values it needs.  We'll pass this
   // back to the function object at each calculation and then
   // again so that the function object can use it to determine a
-  // time step for this iteration.
-  void * globalData = df->GetGlobalDataPointer();
+  // time step for this iteration.  Each thread has its own structure.
+  void * globalData = df->GetThreadGlobalDataPointer(threadId);
 
   // Break the input into a series of regions.  The first region is free
   // of boundary conditions, the rest with boundary conditions.  We operate
@@ -297,7 +300,7 @@ DenseFiniteDifferenceImageFilter< TInputImage, TOutputImage >
   // this iteration.  We give it the global data pointer to use, then
   // ask it to free the global data memory.
   TimeStepType timeStep = df->ComputeGlobalTimeStep(globalData);
-  df->ReleaseGlobalDataPointer(globalData);
+  df->ReleaseThreadGlobalDataPointer(globalData, threadId);
 
   return timeStep;
 }
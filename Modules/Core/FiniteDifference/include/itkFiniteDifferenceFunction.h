@@ -179,6 +179,38 @@ public:
    * to which the pointer points. */
   virtual void ReleaseGlobalDataPointer(void *GlobalData) const = 0;
 
+  /** Returns a pointer to the global data structure of the thread
+   * \a threadId of the solver. A solver that calls this method instead of
+   * GetGlobalDataPointer() passes the structure back to
+   * ReleaseThreadGlobalDataPointer(), and calls ReduceGlobalData() once
+   * all its threads are done with an iteration. A function can then keep
+   * one structure per thread across the iterations, and combine them once
+   * per iteration without locks. By default, this is
+   * GetGlobalDataPointer(). */
+  virtual void * GetThreadGlobalDataPointer( ThreadIdType itkNotUsed(threadId) ) const
+  { return this->GetGlobalDataPointer(); }
+
+  /** Passes back a structure returned by GetThreadGlobalDataPointer(). By
+   * default, this is ReleaseGlobalDataPointer(). */
+  virtual void ReleaseThreadGlobalDataPointer( void *GlobalData,
+                                               ThreadIdType itkNotUsed(threadId) ) const
+  { this->ReleaseGlobalDataPointer(GlobalData); }
+
+  /** Combines the global data structures of the threads, after all the
+   * threads of the solver are done with an iteration. Does nothing by
+   * default. */
+  virtual void ReduceGlobalData() const {}
+
+  /** Returns true when a solver that needs a single time step for all its
+   * threads can compute the updates of this function on several threads.
+   * ComputeUpdate() must then be safe to call concurrently, each thread
+   * with the structure returned by GetThreadGlobalDataPointer(), and
+   * ReduceGlobalData() must combine the structures that the solver still
+   * holds into the one of thread 0, so that ComputeGlobalTimeStep() of that
+   * structure is the time step of all the threads. Such solvers use one
+   * thread when this is false, which is the default. */
+  virtual bool IsThreadSafe() const { return false; }
+
 protected:
   FiniteDifferenceFunction();
   ~FiniteDifferenceFunction() {}
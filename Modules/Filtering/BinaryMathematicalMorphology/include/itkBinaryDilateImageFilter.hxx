@@ -41,6 +41,12 @@ void
 BinaryDilateImageFilter< TInputImage, TOutputImage, TKernel >
 ::GenerateData()
 {
+  if ( this->GetUseBitPackedRows() )
+    {
+    this->BitPackedGenerateData(false);
+    return;
+    }
+
   this->AllocateOutputs();
 
   unsigned int i, j;
@@ -41,6 +41,12 @@ void
 BinaryErodeImageFilter< TInputImage, TOutputImage, TKernel >
 ::GenerateData()
 {
+  if ( this->GetUseBitPackedRows() )
+    {
+    this->BitPackedGenerateData(true);
+    return;
+    }
+
   this->AllocateOutputs();
 
   unsigned int i, j;
@@ -25,6 +25,7 @@
 #include "itkImageBoundaryCondition.h"
 #include "itkImageRegionIterator.h"
 #include "itkConceptChecking.h"
+#include "itkIntTypes.h"
 
 namespace itk
 {
@@ -189,6 +190,20 @@ public:
   itkGetConstReferenceMacro(BoundaryToForeground, bool);
   itkBooleanMacro(BoundaryToForeground);
 
+  /** Set/Get whether the output is computed on a copy of the image
+   * where the rows are packed 64 pixels to a machine word. The
+   * structuring element is split in runs of consecutive elements along
+   * the first dimension; every run is applied to a whole word with a
+   * few shifts and the result is or-ed into the rows it reaches. When
+   * the structuring element is the Minkowski sum of a smaller one and a
+   * line along a dimension, as a box, the line is applied separately.
+   * The rows are processed on several threads. The output is the same
+   * as the one of the border tracking algorithm described above, which
+   * is used when this option is off. Defaults to true. */
+  itkSetMacro(UseBitPackedRows, bool);
+  itkGetConstReferenceMacro(UseBitPackedRows, bool);
+  itkBooleanMacro(UseBitPackedRows);
+
   /** Set kernel (structuring element). */
   void SetKernel(const KernelType & kernel);
 
@@ -229,6 +244,14 @@ protected:
   ComponentVectorConstIterator KernelCCVectorEnd()
   { return m_KernelCCVector.end(); }
 
+  /**
+   * Compute the output with the bit packed rows. When erode is false,
+   * the foreground is dilated. When erode is true, the background is
+   * dilated and the output is set to the foreground value everywhere
+   * else. In both cases, the input values other than the foreground
+   * value are kept in the background. */
+  void BitPackedGenerateData(bool erode);
+
   bool m_BoundaryToForeground;
 private:
   BinaryMorphologyImageFilter(const Self &); //purposely not implemented
@@ -247,6 +270,65 @@ private:
    * store the position of one element, arbitrary chosen, which belongs
    * to the CC */
   std::vector< OffsetType > m_KernelCCVector;
+
+  bool m_UseBitPackedRows;
+
+  typedef uint64_t                             BitPackedWordType;
+  typedef std::vector< BitPackedWordType >     BitPackedBufferType;
+  typedef typename OffsetType::OffsetValueType OffsetValueType;
+  typedef std::vector< OffsetType >            OffsetListType;
+
+  enum { BitPackedPackPass, BitPackedRunPass, BitPackedOrPass, BitPackedUnpackPass };
+
+  /** Rows of the structuring element shifted by the same offset along
+   * the other dimensions and covering the same run along the first
+   * one. */
+  struct BitPackedRunType {
+    OffsetValueType First;
+    OffsetValueType Last;
+    OffsetListType  RowOffsets;
+  };
+  typedef std::vector< BitPackedRunType > BitPackedRunListType;
+
+  /** State shared by the threads of a bit packed pass. */
+  struct BitPackedStruct {
+    Self                         *Filter;
+    int                          Pass;
+    bool                         Erode;
+    bool                         OutsideValue;
+    OutputImageRegionType        Region;
+    OutputImageRegionType        OutputRegion;
+    SizeValueType                NumberOfWords;
+    SizeValueType                NumberOfRows;
+    BitPackedWordType            LastWordMask;
+    BitPackedBufferType          Source;
+    BitPackedBufferType          Run;
+    BitPackedBufferType          Destination;
+    std::vector< unsigned char > RunRowIsEmpty;
+    const BitPackedRunType       *CurrentRun;
+  };
+
+  /** Split the structuring element in factors whose Minkowski sum is
+   * the structuring element, and the factors in runs. */
+  void BitPackedFactorize(std::vector< BitPackedRunListType > & factors,
+                          InputSizeType & padding) const;
+
+  /** Shift a row by the given number of pixels toward the end of the
+   * row when positive, toward its beginning when negative. */
+  static void BitPackedShiftRow(BitPackedWordType *row, SizeValueType numberOfWords,
+                                OffsetValueType shift);
+
+  /** Or a row with itself shifted by 1, 2, ... length - 1 pixels toward
+   * the end of the row, with about log2(length) shifts. */
+  static void BitPackedSpreadRow(BitPackedWordType *row, SizeValueType numberOfWords,
+                                 OffsetValueType length);
+
+  static ITK_THREAD_RETURN_TYPE BitPackedThreaderCallback(void *arg);
+
+  void BitPackedThreadedPass(BitPackedStruct & str, ThreadIdType threadId,
+                             ThreadIdType numberOfThreads);
+
+  void BitPackedExecutePass(BitPackedStruct & str, int pass);
 };
 } // end namespace itk
 
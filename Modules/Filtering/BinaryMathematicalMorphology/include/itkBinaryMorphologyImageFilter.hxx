@@ -18,6 +18,9 @@
 #ifndef __itkBinaryMorphologyImageFilter_hxx
 #define __itkBinaryMorphologyImageFilter_hxx
 
+#include <map>
+#include <set>
+#include <algorithm>
 #include "itkImageRegionIteratorWithIndex.h"
 #include "itkNeighborhoodInnerProduct.h"
 #include "itkImageRegionConstIterator.h"
@@ -35,6 +38,7 @@ BinaryMorphologyImageFilter< TInputImage, TOutputImage, TKernel >
 {
   m_ForegroundValue = NumericTraits< InputPixelType >::max();
   m_BackgroundValue = NumericTraits< OutputPixelType >::NonpositiveMin();
+  m_UseBitPackedRows = true;
   //this->SetNumberOfThreads(1);
   this->AnalyzeKernel();
 }
@@ -330,6 +334,481 @@ BinaryMorphologyImageFilter< TInputImage, TOutputImage, TKernel >
     }
 }
 
+template< class TInputImage, class TOutputImage, class TKernel >
+void
+BinaryMorphologyImageFilter< TInputImage, TOutputImage, TKernel >
+::BitPackedFactorize(std::vector< BitPackedRunListType > & factors,
+                     InputSizeType & padding) const
+{
+  const unsigned int dimension = InputImageDimension;
+  typedef std::set< OffsetType, typename OffsetType::LexicographicCompare > OffsetSetType;
+
+  OffsetSetType kernelSet;
+  const KernelType & kernel = this->GetKernel();
+  for ( SizeValueType i = 0; i < kernel.Size(); ++i )
+    {
+    if ( kernel[i] )
+      {
+      kernelSet.insert( kernel.GetOffset(i) );
+      }
+    }
+
+  // Split off the lines: if all the slices of the structuring element
+  // orthogonal to a dimension are the same, and the slices are
+  // contiguous, the structuring element is the Minkowski sum of one
+  // slice and of a line along that dimension.
+  std::vector< OffsetSetType > factorSets;
+  for ( unsigned int d = dimension - 1; d > 0; --d )
+    {
+    typedef std::map< OffsetValueType, OffsetSetType > SliceMapType;
+    SliceMapType slices;
+    for ( typename OffsetSetType::const_iterator it = kernelSet.begin(); it != kernelSet.end(); ++it )
+      {
+      OffsetType o = *it;
+      const OffsetValueType c = o[d];
+      o[d] = 0;
+      slices[c].insert(o);
+      }
+    if ( slices.size() < 2
+         || slices.rbegin()->first - slices.begin()->first + 1
+         != static_cast< OffsetValueType >( slices.size() ) )
+      {
+      continue;
+      }
+    bool identical = true;
+    for ( typename SliceMapType::const_iterator it = slices.begin(); it != slices.end(); ++it )
+      {
+      if ( it->second != slices.begin()->second )
+        {
+        identical = false;
+        break;
+        }
+      }
+    if ( !identical )
+      {
+      continue;
+      }
+    OffsetSetType line;
+    for ( typename SliceMapType::const_iterator it = slices.begin(); it != slices.end(); ++it )
+      {
+      OffsetType o;
+      o.Fill(0);
+      o[d] = it->first;
+      line.insert(o);
+      }
+    factorSets.push_back(line);
+    kernelSet = slices.begin()->second;
+    }
+  factorSets.push_back(kernelSet);
+
+  // Now code each factor as runs along the first dimension
+  factors.clear();
+  for ( unsigned int f = 0; f < factorSets.size(); ++f )
+    {
+    typedef std::map< OffsetType, std::vector< OffsetValueType >,
+                      typename OffsetType::LexicographicCompare > RowMapType;
+    RowMapType rows;
+    for ( typename OffsetSetType::const_iterator it = factorSets[f].begin(); it != factorSets[f].end(); ++it )
+      {
+      OffsetType            o = *it;
+      const OffsetValueType x = o[0];
+      o[0] = 0;
+      rows[o].push_back(x);
+      }
+
+    typedef std::map< std::pair< OffsetValueType, OffsetValueType >, OffsetListType > RunMapType;
+    RunMapType runs;
+    for ( typename RowMapType::iterator it = rows.begin(); it != rows.end(); ++it )
+      {
+      std::vector< OffsetValueType > & xs = it->second;
+      std::sort( xs.begin(), xs.end() );
+      SizeValueType first = 0;
+      for ( SizeValueType i = 1; i <= xs.size(); ++i )
+        {
+        if ( i == xs.size() || xs[i] != xs[i - 1] + 1 )
+          {
+          runs[std::make_pair(xs[first], xs[i - 1])].push_back(it->first);
+          first = i;
+          }
+        }
+      }
+
+    BitPackedRunListType runList;
+    for ( typename RunMapType::const_iterator it = runs.begin(); it != runs.end(); ++it )
+      {
+      BitPackedRunType run;
+      run.First = it->first.first;
+      run.Last = it->first.second;
+      run.RowOffsets = it->second;
+      runList.push_back(run);
+      }
+    factors.push_back(runList);
+    }
+
+  // Each factor is applied to the result of the previous one, which
+  // must be known on a region padded by the extent of the next ones
+  padding.Fill(0);
+  for ( unsigned int f = 0; f < factorSets.size(); ++f )
+    {
+    for ( unsigned int d = 0; d < dimension; ++d )
+      {
+      SizeValueType extent = 0;
+      for ( typename OffsetSetType::const_iterator it = factorSets[f].begin(); it != factorSets[f].end(); ++it )
+        {
+        const OffsetValueType v = ( *it )[d];
+        extent = vnl_math_max( extent, static_cast< SizeValueType >( v < 0 ? -v : v ) );
+        }
+      padding[d] += extent;
+      }
+    }
+}
+
+template< class TInputImage, class TOutputImage, class TKernel >
+void
+BinaryMorphologyImageFilter< TInputImage, TOutputImage, TKernel >
+::BitPackedShiftRow(BitPackedWordType *row, SizeValueType numberOfWords,
+                    OffsetValueType shift)
+{
+  if ( shift == 0 )
+    {
+    return;
+    }
+  const SizeValueType n = static_cast< SizeValueType >( shift < 0 ? -shift : shift );
+  const SizeValueType wordShift = n / 64;
+  const unsigned int  bitShift = static_cast< unsigned int >( n % 64 );
+  if ( wordShift >= numberOfWords )
+    {
+    std::fill(row, row + numberOfWords, BitPackedWordType(0));
+    return;
+    }
+  if ( shift > 0 )
+    {
+    // toward the end of the row: the high bits of the high words
+    for ( SizeValueType i = numberOfWords; i-- > wordShift; )
+      {
+      BitPackedWordType w = row[i - wordShift] << bitShift;
+      if ( bitShift != 0 && i > wordShift )
+        {
+        w |= row[i - wordShift - 1] >> ( 64 - bitShift );
+        }
+      row[i] = w;
+      }
+    std::fill(row, row + wordShift, BitPackedWordType(0));
+    }
+  else
+    {
+    const SizeValueType last = numberOfWords - wordShift;
+    for ( SizeValueType i = 0; i < last; ++i )
+      {
+      BitPackedWordType w = row[i + wordShift] >> bitShift;
+      if ( bitShift != 0 && i + wordShift + 1 < numberOfWords )
+        {
+        w |= row[i + wordShift + 1] << ( 64 - bitShift );
+        }
+      row[i] = w;
+      }
+    std::fill(row + last, row + numberOfWords, BitPackedWordType(0));
+    }
+}
+
+template< class TInputImage, class TOutputImage, class TKernel >
+void
+BinaryMorphologyImageFilter< TInputImage, TOutputImage, TKernel >
+::BitPackedSpreadRow(BitPackedWordType *row, SizeValueType numberOfWords,
+                     OffsetValueType length)
+{
+  // After each step, every set pixel covers the "covered" next pixels
+  OffsetValueType covered = 1;
+  while ( covered < length )
+    {
+    const OffsetValueType shift = vnl_math_min(covered, length - covered);
+    const SizeValueType   wordShift = static_cast< SizeValueType >( shift / 64 );
+    const unsigned int    bitShift = static_cast< unsigned int >( shift % 64 );
+    // going down, the words read are not modified yet
+    for ( SizeValueType i = numberOfWords; i-- > wordShift; )
+      {
+      BitPackedWordType w = row[i - wordShift] << bitShift;
+      if ( bitShift != 0 && i > wordShift )
+        {
+        w |= row[i - wordShift - 1] >> ( 64 - bitShift );
+        }
+      row[i] |= w;
+      }
+    covered += shift;
+    }
+}
+
+template< class TInputImage, class TOutputImage, class TKernel >
+ITK_THREAD_RETURN_TYPE
+BinaryMorphologyImageFilter< TInputImage, TOutputImage, TKernel >
+::BitPackedThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info = static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  BitPackedStruct *str = static_cast< BitPackedStruct * >( info->UserData );
+
+  str->Filter->BitPackedThreadedPass(*str, info->ThreadID, info->NumberOfThreads);
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TInputImage, class TOutputImage, class TKernel >
+void
+BinaryMorphologyImageFilter< TInputImage, TOutputImage, TKernel >
+::BitPackedExecutePass(BitPackedStruct & str, int pass)
+{
+  str.Pass = pass;
+  this->GetMultiThreader()->SetNumberOfThreads( this->GetNumberOfThreads() );
+  this->GetMultiThreader()->SetSingleMethod( Self::BitPackedThreaderCallback, &str );
+  this->GetMultiThreader()->SingleMethodExecute();
+}
+
+template< class TInputImage, class TOutputImage, class TKernel >
+void
+BinaryMorphologyImageFilter< TInputImage, TOutputImage, TKernel >
+::BitPackedThreadedPass(BitPackedStruct & str, ThreadIdType threadId,
+                        ThreadIdType numberOfThreads)
+{
+  const unsigned int  dimension = InputImageDimension;
+  const SizeValueType numberOfWords = str.NumberOfWords;
+  const IndexType &   regionIndex = str.Region.GetIndex();
+  const InputSizeType regionSize = str.Region.GetSize();
+
+  // The passes go over rows of the padded region, except the last one
+  // that goes over the rows of the output
+  SizeValueType numberOfRows = str.NumberOfRows;
+  if ( str.Pass == BitPackedUnpackPass )
+    {
+    numberOfRows = str.OutputRegion.GetNumberOfPixels() / str.OutputRegion.GetSize(0);
+    }
+  const SizeValueType firstRow = numberOfRows * threadId / numberOfThreads;
+  const SizeValueType lastRow = numberOfRows * ( threadId + 1 ) / numberOfThreads;
+
+  const InputImageType *input = this->GetInput();
+  OutputImageType *     output = this->GetOutput();
+  const InputPixelType  foregroundValue = m_ForegroundValue;
+
+  for ( SizeValueType row = firstRow; row < lastRow; ++row )
+    {
+    switch ( str.Pass )
+      {
+      case BitPackedPackPass:
+        {
+        IndexType idx = regionIndex;
+        SizeValueType r = row;
+        for ( unsigned int d = 1; d < dimension; ++d )
+          {
+          idx[d] += static_cast< IndexValueType >( r % regionSize[d] );
+          r /= regionSize[d];
+          }
+        BitPackedWordType *words = &str.Source[row * numberOfWords];
+        std::fill( words, words + numberOfWords,
+                   str.OutsideValue ? ~BitPackedWordType(0) : BitPackedWordType(0) );
+
+        const InputImageRegionType & inputRegion = input->GetBufferedRegion();
+        bool inside = true;
+        for ( unsigned int d = 1; d < dimension; ++d )
+          {
+          if ( idx[d] < inputRegion.GetIndex(d)
+               || idx[d] >= inputRegion.GetIndex(d) + static_cast< IndexValueType >( inputRegion.GetSize(d) ) )
+            {
+            inside = false;
+            }
+          }
+        if ( inside )
+          {
+          const IndexValueType begin = vnl_math_max( idx[0], inputRegion.GetIndex(0) );
+          const IndexValueType end = vnl_math_min(
+            idx[0] + static_cast< IndexValueType >( regionSize[0] ),
+            inputRegion.GetIndex(0) + static_cast< IndexValueType >( inputRegion.GetSize(0) ) );
+          if ( begin < end )
+            {
+            idx[0] = begin;
+            const InputPixelType *in = input->GetBufferPointer() + input->ComputeOffset(idx);
+            for ( IndexValueType x = begin; x < end; ++x, ++in )
+              {
+              const SizeValueType     bit = static_cast< SizeValueType >( x - regionIndex[0] );
+              const BitPackedWordType mask = BitPackedWordType(1) << ( bit % 64 );
+              if ( ( *in == foregroundValue ) != str.Erode )
+                {
+                words[bit / 64] |= mask;
+                }
+              else
+                {
+                words[bit / 64] &= ~mask;
+                }
+              }
+            }
+          }
+        words[numberOfWords - 1] &= str.LastWordMask;
+        break;
+        }
+      case BitPackedRunPass:
+        {
+        const BitPackedWordType *source = &str.Source[row * numberOfWords];
+        BitPackedWordType *      words = &str.Run[row * numberOfWords];
+        bool                     empty = true;
+        for ( SizeValueType i = 0; i < numberOfWords; ++i )
+          {
+          words[i] = source[i];
+          empty = empty && source[i] == 0;
+          }
+        if ( !empty )
+          {
+          BitPackedSpreadRow( words, numberOfWords, str.CurrentRun->Last - str.CurrentRun->First + 1 );
+          BitPackedShiftRow( words, numberOfWords, str.CurrentRun->First );
+          words[numberOfWords - 1] &= str.LastWordMask;
+          }
+        str.RunRowIsEmpty[row] = empty;
+        break;
+        }
+      case BitPackedOrPass:
+        {
+        OffsetValueType position[InputImageDimension];
+        SizeValueType   r = row;
+        for ( unsigned int d = 1; d < dimension; ++d )
+          {
+          position[d] = static_cast< OffsetValueType >( r % regionSize[d] );
+          r /= regionSize[d];
+          }
+        BitPackedWordType *   words = &str.Destination[row * numberOfWords];
+        const OffsetListType &rowOffsets = str.CurrentRun->RowOffsets;
+        for ( typename OffsetListType::const_iterator it = rowOffsets.begin(); it != rowOffsets.end(); ++it )
+          {
+          SizeValueType sourceRow = 0;
+          SizeValueType stride = 1;
+          bool          inside = true;
+          for ( unsigned int d = 1; d < dimension && inside; ++d )
+            {
+            const OffsetValueType p = position[d] - ( *it )[d];
+            inside = p >= 0 && p < static_cast< OffsetValueType >( regionSize[d] );
+            sourceRow += static_cast< SizeValueType >( p ) * stride;
+            stride *= regionSize[d];
+            }
+          if ( !inside || str.RunRowIsEmpty[sourceRow] )
+            {
+            continue;
+            }
+          const BitPackedWordType *source = &str.Run[sourceRow * numberOfWords];
+          for ( SizeValueType i = 0; i < numberOfWords; ++i )
+            {
+            words[i] |= source[i];
+            }
+          }
+        break;
+        }
+      case BitPackedUnpackPass:
+        {
+        const OutputImageRegionType & outputRegion = str.OutputRegion;
+        IndexType     idx = outputRegion.GetIndex();
+        SizeValueType r = row;
+        SizeValueType sourceRow = 0;
+        SizeValueType stride = 1;
+        for ( unsigned int d = 1; d < dimension; ++d )
+          {
+          idx[d] += static_cast< IndexValueType >( r % outputRegion.GetSize(d) );
+          r /= outputRegion.GetSize(d);
+          sourceRow += static_cast< SizeValueType >( idx[d] - regionIndex[d] ) * stride;
+          stride *= regionSize[d];
+          }
+        const BitPackedWordType *words = &str.Source[sourceRow * numberOfWords];
+        const InputPixelType *   in = input->GetBufferPointer() + input->ComputeOffset(idx);
+        OutputPixelType *        out = output->GetBufferPointer() + output->ComputeOffset(idx);
+        const SizeValueType      begin = static_cast< SizeValueType >( idx[0] - regionIndex[0] );
+        const SizeValueType      end = begin + outputRegion.GetSize(0);
+        for ( SizeValueType bit = begin; bit < end; ++bit, ++in, ++out )
+          {
+          const bool on = ( words[bit / 64] >> ( bit % 64 ) ) & 1;
+          if ( str.Erode )
+            {
+            // the dilated background is removed from the foreground, and
+            // the input values are restored in the background
+            if ( !on )
+              {
+              *out = static_cast< OutputPixelType >( foregroundValue );
+              }
+            else
+              {
+              *out = ( *in != foregroundValue ) ? static_cast< OutputPixelType >( *in ) : m_BackgroundValue;
+              }
+            }
+          else if ( on )
+            {
+            *out = static_cast< OutputPixelType >( foregroundValue );
+            }
+          else
+            {
+            // foreground pixels not reached by the structuring element
+            // are removed, the other values are kept
+            *out = ( *in == foregroundValue ) ? m_BackgroundValue : static_cast< OutputPixelType >( *in );
+            }
+          }
+        break;
+        }
+      }
+    }
+}
+
+template< class TInputImage, class TOutputImage, class TKernel >
+void
+BinaryMorphologyImageFilter< TInputImage, TOutputImage, TKernel >
+::BitPackedGenerateData(bool erode)
+{
+  this->AllocateOutputs();
+
+  // The erosion is the complement of the dilation of the background,
+  // where the pixels outside the image are also complemented.
+  BitPackedStruct str;
+  str.Filter = this;
+  str.Erode = erode;
+  str.OutsideValue = ( m_BoundaryToForeground != erode );
+  str.OutputRegion = this->GetOutput()->GetBufferedRegion();
+  str.CurrentRun = 0;
+
+  std::vector< BitPackedRunListType > factors;
+  InputSizeType                       padding;
+  this->BitPackedFactorize(factors, padding);
+
+  str.Region = str.OutputRegion;
+  str.Region.PadByRadius(padding);
+  const SizeValueType rowLength = str.Region.GetSize(0);
+  str.NumberOfWords = ( rowLength + 63 ) / 64;
+  str.NumberOfRows = str.Region.GetNumberOfPixels() / rowLength;
+  str.LastWordMask = ( rowLength % 64 == 0 ) ? ~BitPackedWordType(0)
+                     : ( BitPackedWordType(1) << ( rowLength % 64 ) ) - 1;
+
+  const SizeValueType bufferSize = str.NumberOfWords * str.NumberOfRows;
+  str.Source.resize(bufferSize);
+  str.Run.resize(bufferSize);
+  str.Destination.resize(bufferSize);
+  str.RunRowIsEmpty.resize(str.NumberOfRows);
+
+  SizeValueType numberOfPasses = 2;
+  for ( unsigned int f = 0; f < factors.size(); ++f )
+    {
+    numberOfPasses += 2 * factors[f].size();
+    }
+  SizeValueType pass = 0;
+
+  this->BitPackedExecutePass(str, BitPackedPackPass);
+  this->UpdateProgress( static_cast< float >( ++pass ) / numberOfPasses );
+
+  for ( unsigned int f = 0; f < factors.size(); ++f )
+    {
+    std::fill( str.Destination.begin(), str.Destination.end(), BitPackedWordType(0) );
+    for ( unsigned int r = 0; r < factors[f].size(); ++r )
+      {
+      str.CurrentRun = &factors[f][r];
+      this->BitPackedExecutePass(str, BitPackedRunPass);
+      this->BitPackedExecutePass(str, BitPackedOrPass);
+      pass += 2;
+      this->UpdateProgress( static_cast< float >( pass ) / numberOfPasses );
+      }
+    str.Source.swap(str.Destination);
+    }
+
+  this->BitPackedExecutePass(str, BitPackedUnpackPass);
+  this->UpdateProgress(1.0f);
+}
+
 /**
  * Standard "PrintSelf" method
  */
@@ -344,6 +823,7 @@ BinaryMorphologyImageFilter< TInputImage, TOutput, TKernel >
   os << indent << "Background Value: "
      << static_cast< typename NumericTraits< OutputPixelType >::PrintType >( m_BackgroundValue ) << std::endl;
   os << indent << "BoundaryToForeground: " << m_BoundaryToForeground << std::endl;
+  os << indent << "UseBitPackedRows: " << m_UseBitPackedRows << std::endl;
 }
 } // end namespace itk
 
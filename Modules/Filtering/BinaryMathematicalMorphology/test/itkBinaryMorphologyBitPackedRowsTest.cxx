@@ -0,0 +1,200 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkBinaryDilateImageFilter.h"
+#include "itkBinaryErodeImageFilter.h"
+#include "itkBinaryBallStructuringElement.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkStreamingImageFilter.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkTimeProbe.h"
+
+namespace
+{
+typedef unsigned char                                                     PixelType;
+typedef itk::Image< PixelType, 3 >                                        ImageType;
+typedef itk::Neighborhood< bool, 3 >                                      KernelType;
+typedef itk::BinaryDilateImageFilter< ImageType, ImageType, KernelType > DilateType;
+typedef itk::BinaryErodeImageFilter< ImageType, ImageType, KernelType >  ErodeType;
+
+bool SameImages(const ImageType *a, const ImageType *b, const char *name)
+{
+  itk::ImageRegionConstIterator< ImageType > ait( a, a->GetBufferedRegion() );
+  itk::ImageRegionConstIterator< ImageType > bit( b, a->GetBufferedRegion() );
+  for( ; !ait.IsAtEnd(); ++ait, ++bit )
+    {
+    if( ait.Get() != bit.Get() )
+      {
+      std::cerr << name << ": pixel " << ait.GetIndex() << " is "
+                << static_cast< int >( ait.Get() ) << " with bit packed rows, "
+                << static_cast< int >( bit.Get() ) << " without" << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+// Run the filter with and without bit packed rows, with both boundary
+// conditions, and compare the outputs.
+template< class TFilter >
+bool CompareAlgorithms(const ImageType *image, const KernelType & kernel,
+                       const char *name)
+{
+  for( unsigned int boundary = 0; boundary < 2; ++boundary )
+    {
+    typename TFilter::Pointer fast = TFilter::New();
+    fast->SetInput( image );
+    fast->SetKernel( kernel );
+    fast->SetForegroundValue( 2 );
+    fast->SetBackgroundValue( 7 );
+    fast->SetBoundaryToForeground( boundary != 0 );
+    fast->SetNumberOfThreads( 3 );
+
+    typename TFilter::Pointer classic = TFilter::New();
+    classic->SetInput( image );
+    classic->SetKernel( kernel );
+    classic->SetForegroundValue( 2 );
+    classic->SetBackgroundValue( 7 );
+    classic->SetBoundaryToForeground( boundary != 0 );
+    classic->UseBitPackedRowsOff();
+
+    // Also check that the fast path streams
+    typedef itk::StreamingImageFilter< ImageType, ImageType > StreamerType;
+    typename StreamerType::Pointer streamer = StreamerType::New();
+    streamer->SetInput( fast->GetOutput() );
+    streamer->SetNumberOfStreamDivisions( 3 );
+
+    itk::TimeProbe fastTime;
+    itk::TimeProbe classicTime;
+    fastTime.Start();
+    fast->Update();
+    fastTime.Stop();
+    classicTime.Start();
+    classic->Update();
+    classicTime.Stop();
+    streamer->Update();
+
+    std::cout << name << ", BoundaryToForeground " << boundary
+              << ": bit packed rows " << fastTime.GetMean()
+              << " s, classic " << classicTime.GetMean() << " s" << std::endl;
+    if( !SameImages( fast->GetOutput(), classic->GetOutput(), name )
+        || !SameImages( streamer->GetOutput(), classic->GetOutput(), name ) )
+      {
+      return false;
+      }
+    }
+  return true;
+}
+}
+
+int itkBinaryMorphologyBitPackedRowsTest(int, char* [] )
+{
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator GeneratorType;
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize( 1234 );
+
+  // Blobs of foreground among a few other labels, with a width that is
+  // not a multiple of the word size
+  ImageType::SizeType size;
+  size[0] = 141;
+  size[1] = 37;
+  size[2] = 23;
+  ImageType::IndexType start;
+  start[0] = -5;
+  start[1] = 3;
+  start[2] = 0;
+  ImageType::RegionType region( start, size );
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( region );
+  image->Allocate();
+  itk::ImageRegionIterator< ImageType > it( image, region );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType idx = it.GetIndex();
+    const bool blob = ( ( idx[0] / 9 + idx[1] / 7 + idx[2] / 5 ) % 3 ) == 0;
+    const double u = generator->GetVariate();
+    if( blob )
+      {
+      it.Set( u < 0.95 ? 2 : 0 );
+      }
+    else
+      {
+      it.Set( u < 0.05 ? 2 : ( u < 0.5 ? 0 : 5 ) );
+      }
+    }
+
+  // A ball, a box, which is split in lines, and a random kernel that is
+  // neither centered nor symmetric
+  KernelType::SizeType radius;
+  radius[0] = 3;
+  radius[1] = 2;
+  radius[2] = 2;
+  itk::BinaryBallStructuringElement< bool, 3 > ball;
+  ball.SetRadius( radius );
+  ball.CreateStructuringElement();
+
+  KernelType box;
+  box.SetRadius( radius );
+  for( unsigned int i = 0; i < box.Size(); ++i )
+    {
+    box[i] = true;
+    }
+
+  KernelType random;
+  random.SetRadius( radius );
+  for( unsigned int i = 0; i < random.Size(); ++i )
+    {
+    random[i] = generator->GetVariate() < 0.3;
+    }
+  random[random.GetCenterNeighborhoodIndex()] = false;
+
+  // Runs longer than a word, shifted by more than a word
+  radius[0] = 70;
+  radius[1] = 1;
+  radius[2] = 0;
+  KernelType wide;
+  wide.SetRadius( radius );
+  for( unsigned int i = 0; i < wide.Size(); ++i )
+    {
+    const KernelType::OffsetType o = wide.GetOffset( i );
+    wide[i] = ( o[1] == 0 && o[0] > -66 && o[0] < 3 ) || ( o[1] == 1 && o[0] > 68 );
+    }
+
+  const KernelType *kernels[] = { &ball, &box, &random, &wide };
+  const char *      names[] = { "ball", "box", "random", "wide" };
+  for( unsigned int k = 0; k < 4; ++k )
+    {
+    std::string name = std::string( "dilate " ) + names[k];
+    if( !CompareAlgorithms< DilateType >( image, *kernels[k], name.c_str() ) )
+      {
+      return EXIT_FAILURE;
+      }
+    name = std::string( "erode " ) + names[k];
+    if( !CompareAlgorithms< ErodeType >( image, *kernels[k], name.c_str() ) )
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  DilateType::Pointer dilate = DilateType::New();
+  dilate->Print( std::cout );
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -19,8 +19,12 @@
 #define __itkFFTConvolutionImageFilter_h
 
 #include "itkConvolutionImageFilterBase.h"
+#include "itkFFTSpectrumCache.h"
+#include "itkHalfHermitianToRealInverseFFTImageFilter.h"
 
 #include "itkProgressAccumulator.h"
+#include "itkRealToHalfHermitianForwardFFTImageFilter.h"
+#include "itkSimpleFastMutexLock.h"
 #include "itkZeroFluxNeumannBoundaryCondition.h"
 
 namespace itk
@@ -34,6 +38,25 @@ namespace itk
  * convolution theorem to accelerate the convolution computation when
  * the kernel is large.
  *
+ * When the image is large compared to the kernel, the output is
+ * computed block by block with the overlap-save method: each block of
+ * BlockSize pixels is transformed, multiplied by the spectrum of the
+ * kernel, and transformed back, and the part of the result that is not
+ * affected by the wrap around of the circular convolution is copied to
+ * the output. The blocks are transformed with the FFT filters selected
+ * by the object factory, and processed concurrently by the filter's
+ * threads. Only the output requested region, padded by the kernel
+ * radius, is requested from the input, so the filter can be streamed.
+ * The memory used is then a few blocks per thread instead of several
+ * complex copies of the whole image. When a single block would cover
+ * the whole image, the image is transformed at once, with the FFT
+ * filters selected by the object factory.
+ *
+ * When the kernel has no more than
+ * MaximumKernelSizeForSpatialConvolution pixels, computing the
+ * convolution in the spatial domain is faster, and the work is
+ * delegated to ConvolutionImageFilter.
+ *
  * \warning This filter ignores the spacing, origin, and orientation
  * of the kernel image and treats them as identical to those in the
  * input image.
@@ -108,16 +131,52 @@ public:
   /** Typedef to describe the boundary condition. */
   typedef typename Superclass::BoundaryConditionType        BoundaryConditionType;
   typedef typename Superclass::BoundaryConditionPointerType BoundaryConditionPointerType;
+  typedef typename Superclass::DefaultBoundaryConditionType DefaultBoundaryConditionType;
+
+  typedef typename InputIndexType::IndexValueType IndexValueType;
+
+  /** Set/Get the size of the blocks transformed by the overlap-save
+   * method. Each dimension is rounded up to at least twice the kernel
+   * size minus one, and to a size with prime factors 2, 3 and 5. A
+   * size of zero in a dimension, the default, selects a size from the
+   * kernel size and the image dimension, of about 2^18 pixels per
+   * block. */
+  itkSetMacro(BlockSize, InputSizeType);
+  itkGetConstReferenceMacro(BlockSize, InputSizeType);
+
+  /** Set/Get the largest number of pixels of a kernel for which the
+   * convolution is computed in the spatial domain by
+   * ConvolutionImageFilter. This is only done when the boundary
+   * condition is the default one, or when the output region mode is
+   * VALID. Defaults to 27. Set it to zero to always use the Fourier
+   * domain. */
+  itkSetMacro(MaximumKernelSizeForSpatialConvolution, SizeValueType);
+  itkGetConstMacro(MaximumKernelSizeForSpatialConvolution, SizeValueType);
+
+  /** Set/Get whether the spectrum of the kernel is kept in a process
+   * wide FFTSpectrumCache, to be reused by the next updates of this
+   * filter, or of other FFTConvolutionImageFilters, with the same
+   * kernel and the same transform size. Enable it when the same kernel
+   * is applied to many images of the same size. The kernel must not be
+   * changed without calling its Modified() method. Defaults to
+   * false. */
+  itkSetMacro(UseKernelSpectrumCache, bool);
+  itkGetConstMacro(UseKernelSpectrumCache, bool);
+  itkBooleanMacro(UseKernelSpectrumCache);
 
 protected:
   FFTConvolutionImageFilter();
   ~FFTConvolutionImageFilter() {}
 
+  void PrintSelf(std::ostream & os, Indent indent) const;
+
   /** FFTConvolutionImageFilter needs the entire image kernel, which in
    * general is going to be a different size than the output requested
-   * region. As such, this filter needs to provide an implementation
-   * for GenerateInputRequestedRegion() in order to inform the
-   * pipeline execution model.
+   * region. When the image is transformed at once, the entire input
+   * image is needed too; otherwise only the output requested region
+   * padded by the kernel radius is. As such, this filter needs to
+   * provide an implementation for GenerateInputRequestedRegion() in
+   * order to inform the pipeline execution model.
    *
    * \sa ProcessObject::GenerateInputRequestedRegion()  */
   void GenerateInputRequestedRegion();
@@ -139,15 +198,78 @@ protected:
                      ProgressAccumulator * progress,
                      float progressWeight);
 
+  /** The cache of the kernel spectra. */
+  typedef FFTSpectrumCache< InternalComplexImageType > SpectrumCacheType;
+
+  /** The FFT filters, created by the object factory. */
+  typedef RealToHalfHermitianForwardFFTImageFilter< InternalImageType,
+                                                    InternalComplexImageType >
+    FFTFilterType;
+  typedef HalfHermitianToRealInverseFFTImageFilter< InternalComplexImageType,
+                                                    InternalImageType >
+    IFFTFilterType;
+
   /** Get the pad size. */
   InputSizeType GetPadSize() const;
 
   /** Get whether the X dimension has an odd size. */
   bool GetXDimensionIsOdd() const;
 
+  /** Get whether the convolution is delegated to
+   * ConvolutionImageFilter. */
+  bool GetUseSpatialConvolution() const;
+
+  /** Get whether the output requested region is computed block by
+   * block rather than by transforming the whole image. */
+  bool GetUseBlocks() const;
+
+  /** Get the size of the blocks used to compute the output requested
+   * region. */
+  InputSizeType GetBlockFFTSize() const;
+
+  /** Shared state of the threads computing the blocks. */
+  struct BlockThreadStruct
+  {
+    Self                            *Filter;
+    InternalComplexImagePointerType KernelSpectrum;
+    InputSizeType                   BlockSize;
+    InputSizeType                   TileSize;
+    InputSizeType                   NumberOfTiles;
+    SizeValueType                   TotalNumberOfTiles;
+    SizeValueType                   NextTile;
+    SizeValueType                   NumberOfCompletedTiles;
+    SimpleFastMutexLock             Mutex;
+    std::vector< InternalImagePointerType >         Blocks;
+    std::vector< typename FFTFilterType::Pointer >  FFTFilters;
+    std::vector< typename IFFTFilterType::Pointer > IFFTFilters;
+  };
+
+  /** Compute the output requested region with the overlap-save
+   * method. */
+  void GenerateDataInBlocks();
+
+  /** Compute the blocks claimed by one thread, with the block image and
+   * the forward and inverse FFT filters of the thread. */
+  void ThreadedGenerateBlocks(BlockThreadStruct *str, ThreadIdType threadId);
+
+  static ITK_THREAD_RETURN_TYPE BlocksThreaderCallback(void *arg);
+
+  /** Get the output region computed by a block. */
+  OutputRegionType GetTileRegion(const BlockThreadStruct *str, SizeValueType tile) const;
+
+  /** Copy the input pixels a tile depends on to a block. */
+  void FillBlock(InternalImageType *block, const OutputRegionType & tile) const;
+
+  /** Copy the convolved block of a tile to the output. */
+  void CopyBlockToOutput(const InternalImageType *block, const OutputRegionType & tile);
+
 private:
   FFTConvolutionImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);         //purposely not implemented
+
+  InputSizeType m_BlockSize;
+  SizeValueType m_MaximumKernelSizeForSpatialConvolution;
+  bool          m_UseKernelSpectrumCache;
 };
 }
 
@@ -23,13 +23,13 @@
 
 #include "itkChangeInformationImageFilter.h"
 #include "itkConstantPadImageFilter.h"
+#include "itkConvolutionImageFilter.h"
 #include "itkCyclicShiftImageFilter.h"
 #include "itkExtractImageFilter.h"
-#include "itkHalfHermitianToRealInverseFFTImageFilter.h"
 #include "itkImageBase.h"
+#include "itkImageRegionIteratorWithIndex.h"
 #include "itkMultiplyImageFilter.h"
 #include "itkNormalizeToConstantImageFilter.h"
-#include "itkRealToHalfHermitianForwardFFTImageFilter.h"
 #include "itkVnlFFTCommon.h"
 
 namespace itk
@@ -39,6 +39,9 @@ template< class TInputImage, class TKernelImage, class TOutputImage, class TInte
 FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPrecision >
 ::FFTConvolutionImageFilter()
 {
+  m_BlockSize.Fill(0);
+  m_MaximumKernelSizeForSpatialConvolution = 27;
+  m_UseKernelSpectrumCache = false;
 }
 
 template< class TInputImage, class TKernelImage, class TOutputImage, class TInternalPrecision >
@@ -46,22 +49,41 @@ void
 FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPrecision >
 ::GenerateInputRequestedRegion()
 {
-  // Request the largest possible region for both input images.
-  if ( this->GetInput() )
+  if ( !this->GetInput() || !this->GetKernelImage() )
     {
-    typename InputImageType::Pointer imagePtr =
-      const_cast< InputImageType * >( this->GetInput() );
+    return;
+    }
+
+  // Request the largest possible region for the kernel image.
+  // Input kernel is an image, cast away the constness so we can set
+  // the requested region.
+  typename KernelImageType::Pointer kernelPtr =
+    const_cast< KernelImageType * >( this->GetKernelImage() );
+  kernelPtr->SetRequestedRegionToLargestPossibleRegion();
+
+  typename InputImageType::Pointer imagePtr =
+    const_cast< InputImageType * >( this->GetInput() );
+
+  if ( !this->GetUseSpatialConvolution() && !this->GetUseBlocks() )
+    {
+    // The whole image is transformed at once.
     imagePtr->SetRequestedRegionToLargestPossibleRegion();
+    return;
     }
 
-  if ( this->GetKernelImage() )
+  // Pad the output requested region by the kernel radius, and let the
+  // boundary condition tell which part of the input it needs.
+  InputRegionType inputRegion = this->GetOutput()->GetRequestedRegion();
+  KernelSizeType  radius;
+  for ( unsigned int i = 0; i < ImageDimension; ++i )
     {
-    // Input kernel is an image, cast away the constness so we can set
-    // the requested region.
-    typename KernelImageType::Pointer kernelPtr =
-      const_cast< KernelImageType * >( this->GetKernelImage() );
-    kernelPtr->SetRequestedRegionToLargestPossibleRegion();
+    radius[i] = kernelPtr->GetLargestPossibleRegion().GetSize()[i] / 2;
     }
+  inputRegion.PadByRadius( radius );
+  inputRegion = this->GetBoundaryCondition()->GetInputRequestedRegion(
+    imagePtr->GetLargestPossibleRegion(), inputRegion );
+
+  imagePtr->SetRequestedRegion( inputRegion );
 }
 
 template< class TInputImage, class TKernelImage, class TOutputImage, class TInternalPrecision >
@@ -73,6 +95,43 @@ FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPre
   ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
   progress->SetMiniPipelineFilter( this );
 
+  if ( this->GetUseSpatialConvolution() )
+    {
+    typename InputImageType::Pointer localInput = InputImageType::New();
+    localInput->Graft( this->GetInput() );
+
+    typedef ConvolutionImageFilter< InputImageType, KernelImageType, OutputImageType >
+      SpatialConvolutionFilterType;
+    typename SpatialConvolutionFilterType::Pointer convolutionFilter =
+      SpatialConvolutionFilterType::New();
+    convolutionFilter->SetInput( localInput );
+    convolutionFilter->SetKernelImage( this->GetKernelImage() );
+    convolutionFilter->SetNormalize( this->GetNormalize() );
+    convolutionFilter->SetOutputRegionMode(
+      static_cast< typename SpatialConvolutionFilterType::OutputRegionModeType >(
+        this->GetOutputRegionMode() ) );
+    convolutionFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
+    progress->RegisterInternalFilter( convolutionFilter, 1.0f );
+
+    convolutionFilter->GraftOutput( this->GetOutput() );
+    convolutionFilter->GetOutput()->SetRequestedRegion( this->GetOutput()->GetRequestedRegion() );
+    convolutionFilter->Update();
+
+    // The grafted input only spans its buffered region, which the
+    // mini-pipeline takes for the largest possible region. Keep the
+    // largest possible region of this filter's output.
+    const OutputRegionType largestRegion = this->GetOutput()->GetLargestPossibleRegion();
+    this->GraftOutput( convolutionFilter->GetOutput() );
+    this->GetOutput()->SetLargestPossibleRegion( largestRegion );
+    return;
+    }
+
+  if ( this->GetUseBlocks() )
+    {
+    this->GenerateDataInBlocks();
+    return;
+    }
+
   InternalComplexImagePointerType input = NULL;
   InternalComplexImagePointerType kernel = NULL;
 
@@ -114,60 +173,87 @@ FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPre
     kernelUpperBound[i] = padSize[i] - kernelSize[i];
     }
 
-  InternalImagePointerType paddedKernelImage = NULL;
-
-  if ( this->GetNormalize() )
+  // The spectrum of the kernel is computed lazily, with the rest of the
+  // minipipeline, unless it has to be stored in the cache.
+  typename SpectrumCacheType::KeyType spectrumKey( padSize,
+    this->GetNormalize() ? "FFTConvolutionImageFilter normalized"
+                         : "FFTConvolutionImageFilter" );
+  spectrumKey.AddSource( kernelImage );
+  InternalComplexImagePointerType kernelSpectrum = NULL;
+  if ( m_UseKernelSpectrumCache )
     {
-    typedef NormalizeToConstantImageFilter< KernelImageType, InternalImageType >
-      NormalizeFilterType;
-    typename NormalizeFilterType::Pointer normalizeFilter = NormalizeFilterType::New();
-    normalizeFilter->SetConstant( NumericTraits< TInternalPrecision >::One );
-    normalizeFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
-    normalizeFilter->SetInput( this->GetKernelImage() );
-    normalizeFilter->ReleaseDataFlagOn();
-    progress->RegisterInternalFilter( normalizeFilter, 0.05f * progressWeight );
-    progressWeight = 0.95f * progressWeight;
-
-    // Pad the kernel image with zeros.
-    typedef ConstantPadImageFilter< InternalImageType, InternalImageType > KernelPadType;
-    typedef typename KernelPadType::Pointer                                KernelPadPointer;
-    KernelPadPointer kernelPadder = KernelPadType::New();
-    kernelPadder->SetConstant( NumericTraits< TInternalPrecision >::ZeroValue() );
-    kernelPadder->SetPadUpperBound( kernelUpperBound );
-    kernelPadder->SetNumberOfThreads( this->GetNumberOfThreads() );
-    kernelPadder->SetInput( normalizeFilter->GetOutput() );
-    kernelPadder->ReleaseDataFlagOn();
-    progress->RegisterInternalFilter( kernelPadder, 0.1f * progressWeight );
-    paddedKernelImage = kernelPadder->GetOutput();
+    kernelSpectrum = SpectrumCacheType::Find( spectrumKey );
     }
-  else
+  if ( kernelSpectrum.IsNull() )
     {
-    // Pad the kernel image with zeros.
-    typedef ConstantPadImageFilter< KernelImageType, InternalImageType > KernelPadType;
-    typedef typename KernelPadType::Pointer                              KernelPadPointer;
-    KernelPadPointer kernelPadder = KernelPadType::New();
-    kernelPadder->SetConstant( NumericTraits< TInternalPrecision >::ZeroValue() );
-    kernelPadder->SetPadUpperBound( kernelUpperBound );
-    kernelPadder->SetNumberOfThreads( this->GetNumberOfThreads() );
-    kernelPadder->SetInput( kernelImage );
-    kernelPadder->ReleaseDataFlagOn();
-    progress->RegisterInternalFilter( kernelPadder, 0.1f * progressWeight );
-    paddedKernelImage = kernelPadder->GetOutput();
-    }
+    InternalImagePointerType paddedKernelImage = NULL;
 
-  // Shift the padded kernel image.
-  typedef CyclicShiftImageFilter< InternalImageType, InternalImageType > KernelShiftFilterType;
-  typename KernelShiftFilterType::Pointer kernelShifter = KernelShiftFilterType::New();
-  typename KernelShiftFilterType::OffsetType kernelShift;
-  for (unsigned int i = 0; i < ImageDimension; ++i)
-    {
-    kernelShift[i] = -(kernelSize[i] / 2);
+    if ( this->GetNormalize() )
+      {
+      typedef NormalizeToConstantImageFilter< KernelImageType, InternalImageType >
+        NormalizeFilterType;
+      typename NormalizeFilterType::Pointer normalizeFilter = NormalizeFilterType::New();
+      normalizeFilter->SetConstant( NumericTraits< TInternalPrecision >::One );
+      normalizeFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
+      normalizeFilter->SetInput( this->GetKernelImage() );
+      normalizeFilter->ReleaseDataFlagOn();
+      progress->RegisterInternalFilter( normalizeFilter, 0.05f * progressWeight );
+      progressWeight = 0.95f * progressWeight;
+
+      // Pad the kernel image with zeros.
+      typedef ConstantPadImageFilter< InternalImageType, InternalImageType > KernelPadType;
+      typedef typename KernelPadType::Pointer                                KernelPadPointer;
+      KernelPadPointer kernelPadder = KernelPadType::New();
+      kernelPadder->SetConstant( NumericTraits< TInternalPrecision >::ZeroValue() );
+      kernelPadder->SetPadUpperBound( kernelUpperBound );
+      kernelPadder->SetNumberOfThreads( this->GetNumberOfThreads() );
+      kernelPadder->SetInput( normalizeFilter->GetOutput() );
+      kernelPadder->ReleaseDataFlagOn();
+      progress->RegisterInternalFilter( kernelPadder, 0.1f * progressWeight );
+      paddedKernelImage = kernelPadder->GetOutput();
+      }
+    else
+      {
+      // Pad the kernel image with zeros.
+      typedef ConstantPadImageFilter< KernelImageType, InternalImageType > KernelPadType;
+      typedef typename KernelPadType::Pointer                              KernelPadPointer;
+      KernelPadPointer kernelPadder = KernelPadType::New();
+      kernelPadder->SetConstant( NumericTraits< TInternalPrecision >::ZeroValue() );
+      kernelPadder->SetPadUpperBound( kernelUpperBound );
+      kernelPadder->SetNumberOfThreads( this->GetNumberOfThreads() );
+      kernelPadder->SetInput( kernelImage );
+      kernelPadder->ReleaseDataFlagOn();
+      progress->RegisterInternalFilter( kernelPadder, 0.1f * progressWeight );
+      paddedKernelImage = kernelPadder->GetOutput();
+      }
+
+    // Shift the padded kernel image.
+    typedef CyclicShiftImageFilter< InternalImageType, InternalImageType > KernelShiftFilterType;
+    typename KernelShiftFilterType::Pointer kernelShifter = KernelShiftFilterType::New();
+    typename KernelShiftFilterType::OffsetType kernelShift;
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+      {
+      kernelShift[i] = -(kernelSize[i] / 2);
+      }
+    kernelShifter->SetShift( kernelShift );
+    kernelShifter->SetNumberOfThreads( this->GetNumberOfThreads() );
+    kernelShifter->SetInput( paddedKernelImage );
+    kernelShifter->ReleaseDataFlagOn();
+    progress->RegisterInternalFilter( kernelShifter, 0.1f * progressWeight );
+
+    typename FFTFilterType::Pointer kernelFFTFilter = FFTFilterType::New();
+    kernelFFTFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
+    kernelFFTFilter->SetInput( kernelShifter->GetOutput() );
+    progress->RegisterInternalFilter( kernelFFTFilter, 0.3f * progressWeight );
+    kernelSpectrum = kernelFFTFilter->GetOutput();
+
+    if ( m_UseKernelSpectrumCache )
+      {
+      kernelFFTFilter->Update();
+      kernelSpectrum->DisconnectPipeline();
+      SpectrumCacheType::Insert( spectrumKey, kernelSpectrum );
+      }
     }
-  kernelShifter->SetShift( kernelShift );
-  kernelShifter->SetNumberOfThreads( this->GetNumberOfThreads() );
-  kernelShifter->SetInput( paddedKernelImage );
-  kernelShifter->ReleaseDataFlagOn();
-  progress->RegisterInternalFilter( kernelShifter, 0.1f * progressWeight );
 
   // Pad the image
   typename InputImageType::Pointer localInput = InputImageType::New();
@@ -198,9 +284,6 @@ FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPre
   progress->RegisterInternalFilter( inputPadder, 0.099f * progressWeight );
 
   // Set up the forward and inverse FFT minipipeline.
-  typedef RealToHalfHermitianForwardFFTImageFilter< InternalImageType,
-                                                    InternalComplexImageType >
-    FFTFilterType;
   typename FFTFilterType::Pointer imageFFTFilter = FFTFilterType::New();
   imageFFTFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
   imageFFTFilter->SetInput( inputPadder->GetOutput() );
@@ -208,18 +291,13 @@ FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPre
 
   preparedInput = imageFFTFilter->GetOutput();
 
-  typename FFTFilterType::Pointer kernelFFTFilter = FFTFilterType::New();
-  kernelFFTFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
-  kernelFFTFilter->SetInput( kernelShifter->GetOutput() );
-  progress->RegisterInternalFilter( kernelFFTFilter, 0.3f * progressWeight );
-
   typedef ChangeInformationImageFilter< InternalComplexImageType > InfoFilterType;
   typename InfoFilterType::Pointer kernelInfoFilter = InfoFilterType::New();
   kernelInfoFilter->SetReferenceImage( imageFFTFilter->GetOutput() );
   kernelInfoFilter->UseReferenceImageOn();
   kernelInfoFilter->ChangeAll();
   kernelInfoFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
-  kernelInfoFilter->SetInput( kernelFFTFilter->GetOutput() );
+  kernelInfoFilter->SetInput( kernelSpectrum );
   progress->RegisterInternalFilter( kernelInfoFilter, 0.001f * progressWeight );
 
   preparedKernel = kernelInfoFilter->GetOutput();
@@ -232,9 +310,6 @@ FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPre
                 ProgressAccumulator * progress,
                 float progressWeight)
 {
-  typedef HalfHermitianToRealInverseFFTImageFilter< InternalComplexImageType,
-                                                    InternalImageType >
-    IFFTFilterType;
   typename IFFTFilterType::Pointer ifftFilter = IFFTFilterType::New();
   ifftFilter->SetActualXDimensionIsOdd( this->GetXDimensionIsOdd() );
   ifftFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
@@ -308,5 +383,377 @@ FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPre
   InputSizeType padSize = this->GetPadSize();
   return (padSize[0] % 2 != 0);
 }
+
+template< class TInputImage, class TKernelImage, class TOutputImage, class TInternalPrecision >
+bool
+FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPrecision >
+::GetUseSpatialConvolution() const
+{
+  const SizeValueType numberOfKernelPixels =
+    this->GetKernelImage()->GetLargestPossibleRegion().GetNumberOfPixels();
+  if ( numberOfKernelPixels > m_MaximumKernelSizeForSpatialConvolution )
+    {
+    return false;
+    }
+
+  // ConvolutionImageFilter has its own boundary condition, of a
+  // different type. It only matters in SAME mode.
+  if ( this->GetOutputRegionMode() == Self::VALID )
+    {
+    return true;
+    }
+  return dynamic_cast< DefaultBoundaryConditionType * >( this->GetBoundaryCondition() ) != NULL;
+}
+
+template< class TInputImage, class TKernelImage, class TOutputImage, class TInternalPrecision >
+typename FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPrecision >::InputSizeType
+FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPrecision >
+::GetBlockFFTSize() const
+{
+  const OutputSizeType outputSize = this->GetOutput()->GetRequestedRegion().GetSize();
+  const KernelSizeType kernelSize = this->GetKernelImage()->GetLargestPossibleRegion().GetSize();
+
+  // About 2^18 pixels per block: a few megabytes per thread, and
+  // transforms that fit in the cache.
+  const SizeValueType defaultBlockSize = 1 << ( 18 / ImageDimension );
+
+  InputSizeType blockSize;
+  for ( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+    SizeValueType size = m_BlockSize[i];
+    if ( size == 0 )
+      {
+      size = std::max( defaultBlockSize, 4 * kernelSize[i] );
+      }
+    // At least as many output pixels as kernel pixels per block...
+    size = std::max( size, 2 * kernelSize[i] - 1 );
+    // ... but no more than needed for the whole requested region.
+    size = std::min( size, outputSize[i] + kernelSize[i] - 1 );
+    while ( !VnlFFTCommon::IsDimensionSizeLegal( size ) )
+      {
+      size++;
+      }
+    blockSize[i] = size;
+    }
+
+  return blockSize;
+}
+
+template< class TInputImage, class TKernelImage, class TOutputImage, class TInternalPrecision >
+bool
+FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPrecision >
+::GetUseBlocks() const
+{
+  const OutputRegionType outputRegion = this->GetOutput()->GetRequestedRegion();
+
+  // Only the whole image can be transformed at once.
+  if ( outputRegion != this->GetOutput()->GetLargestPossibleRegion() )
+    {
+    return true;
+    }
+
+  const KernelSizeType kernelSize = this->GetKernelImage()->GetLargestPossibleRegion().GetSize();
+  const InputSizeType  blockSize = this->GetBlockFFTSize();
+  for ( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+    if ( blockSize[i] < outputRegion.GetSize()[i] + kernelSize[i] - 1 )
+      {
+      return true;
+      }
+    }
+  return false;
+}
+
+template< class TInputImage, class TKernelImage, class TOutputImage, class TInternalPrecision >
+void
+FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPrecision >
+::GenerateDataInBlocks()
+{
+  this->AllocateOutputs();
+
+  const OutputRegionType outputRegion = this->GetOutput()->GetRequestedRegion();
+  const KernelImageType *kernelImage = this->GetKernelImage();
+  const KernelRegionType kernelRegion = kernelImage->GetLargestPossibleRegion();
+
+  BlockThreadStruct str;
+  str.Filter = this;
+  str.BlockSize = this->GetBlockFFTSize();
+  str.TotalNumberOfTiles = 1;
+  for ( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+    str.TileSize[i] = str.BlockSize[i] - kernelRegion.GetSize()[i] + 1;
+    str.NumberOfTiles[i] = ( outputRegion.GetSize()[i] + str.TileSize[i] - 1 ) / str.TileSize[i];
+    str.TotalNumberOfTiles *= str.NumberOfTiles[i];
+    }
+  str.NextTile = 0;
+  str.NumberOfCompletedTiles = 0;
+
+  // Half spectrum of the kernel, zero padded to the block size. It
+  // includes the normalization of the kernel if requested.
+  typename SpectrumCacheType::KeyType spectrumKey( str.BlockSize,
+    this->GetNormalize() ? "FFTConvolutionImageFilter blocks normalized"
+                         : "FFTConvolutionImageFilter blocks" );
+  spectrumKey.AddSource( kernelImage );
+  if ( m_UseKernelSpectrumCache )
+    {
+    str.KernelSpectrum = SpectrumCacheType::Find( spectrumKey );
+    }
+  InputRegionType blockRegion;
+  blockRegion.SetSize( str.BlockSize );
+  if ( str.KernelSpectrum.IsNull() )
+    {
+    InternalImagePointerType paddedKernel = InternalImageType::New();
+    paddedKernel->SetRegions( blockRegion );
+    paddedKernel->Allocate();
+    paddedKernel->FillBuffer( NumericTraits< TInternalPrecision >::Zero );
+
+    TInternalPrecision scale = NumericTraits< TInternalPrecision >::One;
+    ImageRegionConstIterator< KernelImageType > kIt( kernelImage, kernelRegion );
+    if ( this->GetNormalize() )
+      {
+      TInternalPrecision sum = NumericTraits< TInternalPrecision >::Zero;
+      for ( kIt.GoToBegin(); !kIt.IsAtEnd(); ++kIt )
+        {
+        sum += static_cast< TInternalPrecision >( kIt.Get() );
+        }
+      scale /= sum;
+      }
+
+    InputRegionType kernelInBlock;
+    kernelInBlock.SetSize( kernelRegion.GetSize() );
+    ImageRegionIterator< InternalImageType > pIt( paddedKernel, kernelInBlock );
+    for ( kIt.GoToBegin(), pIt.GoToBegin(); !kIt.IsAtEnd(); ++kIt, ++pIt )
+      {
+      pIt.Set( scale * static_cast< TInternalPrecision >( kIt.Get() ) );
+      }
+
+    typename FFTFilterType::Pointer kernelFFTFilter = FFTFilterType::New();
+    kernelFFTFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
+    kernelFFTFilter->SetInput( paddedKernel );
+    kernelFFTFilter->Update();
+    str.KernelSpectrum = kernelFFTFilter->GetOutput();
+    str.KernelSpectrum->DisconnectPipeline();
+
+    if ( m_UseKernelSpectrumCache )
+      {
+      SpectrumCacheType::Insert( spectrumKey, str.KernelSpectrum );
+      }
+    }
+
+  ThreadIdType numberOfThreads = this->GetNumberOfThreads();
+  if ( str.TotalNumberOfTiles < numberOfThreads )
+    {
+    numberOfThreads = static_cast< ThreadIdType >( str.TotalNumberOfTiles );
+    }
+
+  // The block images and the FFT filters of the threads are created
+  // here, as the object factory is not meant to be used concurrently.
+  str.Blocks.resize( numberOfThreads );
+  str.FFTFilters.resize( numberOfThreads );
+  str.IFFTFilters.resize( numberOfThreads );
+  for ( ThreadIdType t = 0; t < numberOfThreads; ++t )
+    {
+    str.Blocks[t] = InternalImageType::New();
+    str.Blocks[t]->SetRegions( blockRegion );
+    str.Blocks[t]->Allocate();
+    str.FFTFilters[t] = FFTFilterType::New();
+    str.FFTFilters[t]->SetNumberOfThreads( 1 );
+    str.FFTFilters[t]->SetInput( str.Blocks[t] );
+    str.IFFTFilters[t] = IFFTFilterType::New();
+    str.IFFTFilters[t]->SetActualXDimensionIsOdd( str.BlockSize[0] % 2 != 0 );
+    str.IFFTFilters[t]->SetNumberOfThreads( 1 );
+    str.IFFTFilters[t]->SetInput( str.FFTFilters[t]->GetOutput() );
+    }
+
+  this->GetMultiThreader()->SetNumberOfThreads( numberOfThreads );
+  this->GetMultiThreader()->SetSingleMethod( Self::BlocksThreaderCallback, &str );
+  this->GetMultiThreader()->SingleMethodExecute();
+}
+
+template< class TInputImage, class TKernelImage, class TOutputImage, class TInternalPrecision >
+ITK_THREAD_RETURN_TYPE
+FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPrecision >
+::BlocksThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info =
+    static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  BlockThreadStruct *str = static_cast< BlockThreadStruct * >( info->UserData );
+
+  str->Filter->ThreadedGenerateBlocks( str, info->ThreadID );
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TInputImage, class TKernelImage, class TOutputImage, class TInternalPrecision >
+void
+FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPrecision >
+::ThreadedGenerateBlocks(BlockThreadStruct *str, ThreadIdType threadId)
+{
+  InternalImageType *block = str->Blocks[threadId];
+  FFTFilterType     *fftFilter = str->FFTFilters[threadId];
+  IFFTFilterType    *ifftFilter = str->IFFTFilters[threadId];
+
+  const InternalComplexType *spectrum = str->KernelSpectrum->GetBufferPointer();
+  const SizeValueType        numberOfSpectrumPixels =
+    str->KernelSpectrum->GetBufferedRegion().GetNumberOfPixels();
+
+  for (;; )
+    {
+    str->Mutex.Lock();
+    const SizeValueType tile = str->NextTile;
+    if ( tile < str->TotalNumberOfTiles )
+      {
+      ++str->NextTile;
+      }
+    str->Mutex.Unlock();
+
+    if ( tile >= str->TotalNumberOfTiles )
+      {
+      break;
+      }
+
+    const OutputRegionType tileRegion = this->GetTileRegion( str, tile );
+    block->FillBuffer( NumericTraits< TInternalPrecision >::Zero );
+    this->FillBlock( block, tileRegion );
+    block->Modified();
+
+    fftFilter->Update();
+    InternalComplexType *buffer = fftFilter->GetOutput()->GetBufferPointer();
+    for ( SizeValueType i = 0; i < numberOfSpectrumPixels; ++i )
+      {
+      buffer[i] *= spectrum[i];
+      }
+    ifftFilter->Update();
+
+    this->CopyBlockToOutput( ifftFilter->GetOutput(), tileRegion );
+
+    str->Mutex.Lock();
+    ++str->NumberOfCompletedTiles;
+    const float completed = static_cast< float >( str->NumberOfCompletedTiles )
+      / static_cast< float >( str->TotalNumberOfTiles );
+    str->Mutex.Unlock();
+
+    // Only the first thread reports the progress
+    if ( threadId == 0 )
+      {
+      this->UpdateProgress( completed );
+      }
+    }
+}
+
+template< class TInputImage, class TKernelImage, class TOutputImage, class TInternalPrecision >
+typename FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPrecision >::OutputRegionType
+FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPrecision >
+::GetTileRegion(const BlockThreadStruct *str, SizeValueType tile) const
+{
+  const OutputRegionType outputRegion = this->GetOutput()->GetRequestedRegion();
+
+  OutputIndexType index;
+  OutputSizeType  size;
+  for ( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+    const SizeValueType position = tile % str->NumberOfTiles[i];
+    tile /= str->NumberOfTiles[i];
+
+    const SizeValueType offset = position * str->TileSize[i];
+    index[i] = outputRegion.GetIndex()[i] + static_cast< IndexValueType >( offset );
+    size[i] = std::min( str->TileSize[i], outputRegion.GetSize()[i] - offset );
+    }
+
+  return OutputRegionType( index, size );
+}
+
+template< class TInputImage, class TKernelImage, class TOutputImage, class TInternalPrecision >
+void
+FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPrecision >
+::FillBlock(InternalImageType *block, const OutputRegionType & tile) const
+{
+  const InputImageType *input = this->GetInput();
+  const KernelSizeType  kernelSize = this->GetKernelImage()->GetLargestPossibleRegion().GetSize();
+
+  // Output pixel x depends on the input pixels x + r - j, where r is
+  // the kernel radius and j a kernel index. The block starts with the
+  // first of them, so that the wrap around of the circular convolution
+  // only affects the first kernelSize - 1 pixels of the block.
+  InputRegionType neededRegion = tile;
+  InputIndexType  blockIndex = tile.GetIndex();
+  for ( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+    blockIndex[i] -= static_cast< IndexValueType >( kernelSize[i] - 1 - kernelSize[i] / 2 );
+    neededRegion.SetSize( i, tile.GetSize()[i] + kernelSize[i] - 1 );
+    }
+  neededRegion.SetIndex( blockIndex );
+  block->SetRegions( InputRegionType( blockIndex, block->GetBufferedRegion().GetSize() ) );
+
+  InputRegionType insideRegion = neededRegion;
+  if ( insideRegion.Crop( input->GetBufferedRegion() ) )
+    {
+    ImageRegionConstIterator< InputImageType > inIt( input, insideRegion );
+    ImageRegionIterator< InternalImageType >   bIt( block, insideRegion );
+    for ( inIt.GoToBegin(), bIt.GoToBegin(); !inIt.IsAtEnd(); ++inIt, ++bIt )
+      {
+      bIt.Set( static_cast< TInternalPrecision >( inIt.Get() ) );
+      }
+    }
+  else
+    {
+    insideRegion = InputRegionType();
+    }
+
+  if ( insideRegion == neededRegion )
+    {
+    return;
+    }
+
+  // The rest of the needed pixels come from the boundary condition.
+  BoundaryConditionPointerType boundaryCondition = this->GetBoundaryCondition();
+  ImageRegionIteratorWithIndex< InternalImageType > bIt( block, neededRegion );
+  for ( bIt.GoToBegin(); !bIt.IsAtEnd(); ++bIt )
+    {
+    const InputIndexType index = bIt.GetIndex();
+    if ( insideRegion.IsInside( index ) )
+      {
+      continue;
+      }
+    bIt.Set( static_cast< TInternalPrecision >( boundaryCondition->GetPixel( index, input ) ) );
+    }
+}
+
+template< class TInputImage, class TKernelImage, class TOutputImage, class TInternalPrecision >
+void
+FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPrecision >
+::CopyBlockToOutput(const InternalImageType *block, const OutputRegionType & tile)
+{
+  const KernelSizeType kernelSize = this->GetKernelImage()->GetLargestPossibleRegion().GetSize();
+
+  // The block has the index given by FillBlock(), and the output pixels
+  // of the tile start after the kernelSize - 1 pixels affected by the
+  // wrap around.
+  InputRegionType resultRegion = tile;
+  for ( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+    resultRegion.SetIndex( i, tile.GetIndex()[i] + static_cast< IndexValueType >( kernelSize[i] / 2 ) );
+    }
+
+  ImageRegionConstIterator< InternalImageType > bIt( block, resultRegion );
+  ImageRegionIterator< OutputImageType >        oIt( this->GetOutput(), tile );
+  for ( bIt.GoToBegin(), oIt.GoToBegin(); !oIt.IsAtEnd(); ++bIt, ++oIt )
+    {
+    oIt.Set( static_cast< OutputPixelType >( bIt.Get() ) );
+    }
+}
+
+template< class TInputImage, class TKernelImage, class TOutputImage, class TInternalPrecision >
+void
+FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPrecision >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "BlockSize: " << m_BlockSize << std::endl;
+  os << indent << "MaximumKernelSizeForSpatialConvolution: "
+     << m_MaximumKernelSizeForSpatialConvolution << std::endl;
+  os << indent << "UseKernelSpectrumCache: " << m_UseKernelSpectrumCache << std::endl;
+}
 }
 #endif
@@ -198,6 +198,17 @@ public:
   itkSetMacro(RequiredNumberOfOverlappingVoxels,unsigned long);
   itkGetMacro(RequiredNumberOfOverlappingVoxels,unsigned long);
 
+  /** Set and get whether the spectra computed from the moving image
+   * and mask are kept in a process wide FFTSpectrumCache, to be reused
+   * by the next updates with the same moving image and mask and a
+   * fixed image of the same size. This is useful when a template is
+   * searched in many images. The moving image and mask must not be
+   * changed without calling their Modified() method. Defaults to
+   * false. */
+  itkSetMacro(UseMovingImageSpectrumCache, bool);
+  itkGetConstMacro(UseMovingImageSpectrumCache, bool);
+  itkBooleanMacro(UseMovingImageSpectrumCache);
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Begin concept checking */
   itkConceptMacro( OutputPixelTypeIsFloatingPointCheck,
@@ -210,6 +221,7 @@ protected:
   {
     this->SetNumberOfRequiredInputs(2);
     m_RequiredNumberOfOverlappingVoxels = 0;
+    m_UseMovingImageSpectrumCache = false;
   }
   virtual ~MaskedFFTNormalizedCorrelationImageFilter() {}
   void PrintSelf(std::ostream& os, Indent indent) const;
@@ -283,6 +295,8 @@ private:
    * Thus, larger values remove less stable computations but also limit the capture range.
    * The default is set to 0. */
   unsigned long m_RequiredNumberOfOverlappingVoxels;
+
+  bool m_UseMovingImageSpectrumCache;
 };
 } // end namespace itk
 
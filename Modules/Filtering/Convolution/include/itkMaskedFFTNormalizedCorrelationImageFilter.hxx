@@ -22,6 +22,7 @@
 #include "itkFlipImageFilter.h"
 #include "itkForwardFFTImageFilter.h"
 #include "itkInverseFFTImageFilter.h"
+#include "itkFFTSpectrumCache.h"
 #include "itkImageRegionIterator.h"
 #include "itkMultiplyImageFilter.h"
 #include "itkDivideImageFilter.h"
@@ -115,20 +116,6 @@ void MaskedFFTNormalizedCorrelationImageFilter<TInputImage, TOutputImage>
 {
   OutputImagePointer outputImage = this->GetOutput();
 
-  InputImagePointer fixedMask = PreProcessMask<InputImageType>( this->GetFixedImage(), this->GetFixedImageMask() );
-  InputImagePointer movingMask = PreProcessMask<InputImageType>( this->GetMovingImage(), this->GetMovingImageMask() );
-
-  // The fixed and moving images need to be masked for the equations
-  // below to work correctly.  The masks need to be pre-processed
-  // before this step.
-  InputImagePointer fixedImage = this->PreProcessImage<InputImageType>( this->GetFixedImage(),fixedMask );
-  InputImagePointer movingImage = this->PreProcessImage<InputImageType>( this->GetMovingImage(),movingMask );
-
-  InputImagePointer rotatedMovingImage = this->RotateImage( movingImage );
-  movingImage = NULL;
-  InputImagePointer rotatedMovingMask = this->RotateImage( movingMask);
-  movingMask = NULL;
-
   // The combinedImageSize is the size resulting from the correlation of the two images.
   RealSizeType combinedImageSize;
   // The FFTImageSize is the closest valid dimension each dimension.
@@ -136,10 +123,41 @@ void MaskedFFTNormalizedCorrelationImageFilter<TInputImage, TOutputImage>
   InputSizeType FFTImageSize;
   for( unsigned int i = 0; i < ImageDimension; i++ )
   {
-    combinedImageSize[i] = fixedImage->GetLargestPossibleRegion().GetSize()[i] + rotatedMovingImage->GetLargestPossibleRegion().GetSize()[i] - 1;
+    combinedImageSize[i] = this->GetFixedImage()->GetLargestPossibleRegion().GetSize()[i] + this->GetMovingImage()->GetLargestPossibleRegion().GetSize()[i] - 1;
     FFTImageSize[i] = this->FindClosestValidDimension( combinedImageSize[i] );
   }
 
+  // The spectra computed from the moving image and mask only depend on
+  // them and on the transform size, so they can be reused.
+  typedef FFTSpectrumCache< FFTImageType > SpectrumCacheType;
+  typename SpectrumCacheType::KeyType movingKey( FFTImageSize, "MaskedFFTNormalizedCorrelationImageFilter moving" );
+  typename SpectrumCacheType::KeyType movingMaskKey( FFTImageSize, "MaskedFFTNormalizedCorrelationImageFilter moving mask" );
+  typename SpectrumCacheType::KeyType movingSquaredKey( FFTImageSize, "MaskedFFTNormalizedCorrelationImageFilter moving squared" );
+  movingKey.AddSource( this->GetMovingImage() );
+  movingKey.AddSource( this->GetMovingImageMask() );
+  movingMaskKey.AddSource( this->GetMovingImage() );
+  movingMaskKey.AddSource( this->GetMovingImageMask() );
+  movingSquaredKey.AddSource( this->GetMovingImage() );
+  movingSquaredKey.AddSource( this->GetMovingImageMask() );
+
+  FFTImagePointer rotatedMovingFFT;
+  FFTImagePointer rotatedMovingMaskFFT;
+  FFTImagePointer rotatedMovingSquaredFFT;
+  if( m_UseMovingImageSpectrumCache )
+  {
+    rotatedMovingFFT = SpectrumCacheType::Find( movingKey );
+    rotatedMovingMaskFFT = SpectrumCacheType::Find( movingMaskKey );
+    rotatedMovingSquaredFFT = SpectrumCacheType::Find( movingSquaredKey );
+  }
+  const bool computeMovingFFTs = rotatedMovingFFT.IsNull() || rotatedMovingMaskFFT.IsNull() || rotatedMovingSquaredFFT.IsNull();
+
+  InputImagePointer fixedMask = PreProcessMask<InputImageType>( this->GetFixedImage(), this->GetFixedImageMask() );
+
+  // The fixed and moving images need to be masked for the equations
+  // below to work correctly.  The masks need to be pre-processed
+  // before this step.
+  InputImagePointer fixedImage = this->PreProcessImage<InputImageType>( this->GetFixedImage(),fixedMask );
+
   // Only 6 FFTs are needed.
   // Calculate them in stages to reduce memory.
   // For the numerator, only 4 FFTs are required.
@@ -148,9 +166,27 @@ void MaskedFFTNormalizedCorrelationImageFilter<TInputImage, TOutputImage>
   FFTImagePointer fixedFFT = this->CalculateForwardFFT<InputImageType,FFTImageType>( fixedImage, FFTImageSize );
   FFTImagePointer fixedMaskFFT = this->CalculateForwardFFT<InputImageType,FFTImageType>( fixedMask, FFTImageSize );
   fixedMask = NULL;
-  FFTImagePointer rotatedMovingFFT = this->CalculateForwardFFT<InputImageType,FFTImageType>( rotatedMovingImage, FFTImageSize );
-  FFTImagePointer rotatedMovingMaskFFT = this->CalculateForwardFFT<InputImageType,FFTImageType>( rotatedMovingMask, FFTImageSize );
-  rotatedMovingMask = NULL;
+
+  InputImagePointer rotatedMovingImage;
+  if( computeMovingFFTs )
+  {
+    InputImagePointer movingMask = PreProcessMask<InputImageType>( this->GetMovingImage(), this->GetMovingImageMask() );
+    InputImagePointer movingImage = this->PreProcessImage<InputImageType>( this->GetMovingImage(),movingMask );
+
+    rotatedMovingImage = this->RotateImage( movingImage );
+    movingImage = NULL;
+    InputImagePointer rotatedMovingMask = this->RotateImage( movingMask);
+    movingMask = NULL;
+
+    rotatedMovingFFT = this->CalculateForwardFFT<InputImageType,FFTImageType>( rotatedMovingImage, FFTImageSize );
+    rotatedMovingMaskFFT = this->CalculateForwardFFT<InputImageType,FFTImageType>( rotatedMovingMask, FFTImageSize );
+    rotatedMovingMask = NULL;
+    if( m_UseMovingImageSpectrumCache )
+    {
+      SpectrumCacheType::Insert( movingKey, rotatedMovingFFT );
+      SpectrumCacheType::Insert( movingMaskKey, rotatedMovingMaskFFT );
+    }
+  }
 
   // Only 6 IFFTs are needed.
   // Compute and save some of these rather than computing them multiple times.
@@ -183,9 +219,16 @@ void MaskedFFTNormalizedCorrelationImageFilter<TInputImage, TOutputImage>
   fixedDenom = this->ElementPositive<RealImageType>(fixedDenom);
 
   // Calculate the moving part of the masked FFT NCC denominator.
-  FFTImagePointer rotatedMovingSquaredFFT = this->CalculateForwardFFT<RealImageType,FFTImageType>(
-      this->ElementProduct<InputImageType,RealImageType>(rotatedMovingImage,rotatedMovingImage), FFTImageSize );
-  rotatedMovingImage = NULL; // No longer needed
+  if( computeMovingFFTs )
+  {
+    rotatedMovingSquaredFFT = this->CalculateForwardFFT<RealImageType,FFTImageType>(
+        this->ElementProduct<InputImageType,RealImageType>(rotatedMovingImage,rotatedMovingImage), FFTImageSize );
+    rotatedMovingImage = NULL; // No longer needed
+    if( m_UseMovingImageSpectrumCache )
+    {
+      SpectrumCacheType::Insert( movingSquaredKey, rotatedMovingSquaredFFT );
+    }
+  }
   RealImagePointer rotatedMovingDenom = this->ElementSubtraction<RealImageType>(
       this->CalculateInverseFFT<FFTImageType,RealImageType>(this->ElementProduct<FFTImageType,FFTImageType>(fixedMaskFFT,rotatedMovingSquaredFFT),combinedImageSize),
       this->ElementQuotient<RealImageType>(this->ElementProduct<RealImageType,RealImageType>(rotatedMovingCumulativeSumImage,rotatedMovingCumulativeSumImage),numberOfOverlapVoxels));
@@ -616,6 +659,9 @@ MaskedFFTNormalizedCorrelationImageFilter<TInputImage, TOutputImage>
 ::PrintSelf(std::ostream& os, Indent indent) const
 {
   Superclass::PrintSelf(os,indent);
+
+  os << indent << "RequiredNumberOfOverlappingVoxels: " << m_RequiredNumberOfOverlappingVoxels << std::endl;
+  os << indent << "UseMovingImageSpectrumCache: " << m_UseMovingImageSpectrumCache << std::endl;
 }
 
 } // end namespace itk
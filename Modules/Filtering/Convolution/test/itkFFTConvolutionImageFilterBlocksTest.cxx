@@ -0,0 +1,201 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkAbsImageFilter.h"
+#include "itkFFTConvolutionImageFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkPeriodicBoundaryCondition.h"
+#include "itkPipelineMonitorImageFilter.h"
+#include "itkStreamingImageFilter.h"
+
+namespace
+{
+const unsigned int Dimension = 3;
+
+typedef itk::Image< float, Dimension >                    ImageType;
+typedef itk::FFTConvolutionImageFilter< ImageType >       ConvolutionFilterType;
+typedef itk::AbsImageFilter< ImageType, ImageType >       AbsFilterType;
+typedef itk::PipelineMonitorImageFilter< ImageType >      MonitorFilterType;
+typedef itk::StreamingImageFilter< ImageType, ImageType > StreamingFilterType;
+
+ImageType::Pointer
+CreateRandomImage(const ImageType::SizeType & size, unsigned int seed)
+{
+  ImageType::RegionType region;
+  region.SetSize( size );
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( region );
+  image->Allocate();
+  itk::ImageRegionIterator< ImageType > it( image, region );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    seed = seed * 1103515245 + 12345;
+    it.Set( static_cast< float >( ( seed >> 16 ) % 1000 ) / 1000.0f );
+    }
+  return image;
+}
+
+bool
+CompareImages(const ImageType *reference, const ImageType *test, const char *description)
+{
+  if ( reference->GetLargestPossibleRegion() != test->GetLargestPossibleRegion() )
+    {
+    std::cerr << description << ": output region " << test->GetLargestPossibleRegion()
+              << " instead of " << reference->GetLargestPossibleRegion() << std::endl;
+    return false;
+    }
+
+  itk::ImageRegionConstIterator< ImageType > rIt( reference, reference->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator< ImageType > tIt( test, reference->GetLargestPossibleRegion() );
+  for ( rIt.GoToBegin(), tIt.GoToBegin(); !rIt.IsAtEnd(); ++rIt, ++tIt )
+    {
+    if ( vnl_math_abs( rIt.Get() - tIt.Get() ) > 1e-4f * ( vnl_math_abs( rIt.Get() ) + 1.0f ) )
+      {
+      std::cerr << description << ": " << tIt.Get() << " instead of " << rIt.Get()
+                << " at " << rIt.GetIndex() << std::endl;
+      return false;
+      }
+    }
+  std::cout << description << ": OK" << std::endl;
+  return true;
+}
+}
+
+// Compare the overlap-save computation of FFTConvolutionImageFilter,
+// streamed or not, with the transform of the whole image, and the
+// spatial domain computation with the Fourier domain one.
+int itkFFTConvolutionImageFilterBlocksTest(int, char *[])
+{
+  ImageType::SizeType imageSize;
+  imageSize[0] = 70;
+  imageSize[1] = 53;
+  imageSize[2] = 41;
+  ImageType::SizeType kernelSize;
+  kernelSize[0] = 7;
+  kernelSize[1] = 6;
+  kernelSize[2] = 5;
+  ImageType::SizeType smallKernelSize;
+  smallKernelSize.Fill( 3 );
+
+  ImageType::Pointer image = CreateRandomImage( imageSize, 1 );
+  ImageType::Pointer kernel = CreateRandomImage( kernelSize, 2 );
+  ImageType::Pointer smallKernel = CreateRandomImage( smallKernelSize, 3 );
+
+  ImageType::SizeType wholeImageBlockSize;
+  wholeImageBlockSize.Fill( 1000 );
+  ImageType::SizeType smallBlockSize;
+  smallBlockSize.Fill( 20 );
+
+  itk::PeriodicBoundaryCondition< ImageType, ConvolutionFilterType::InternalImageType > periodic;
+
+  bool success = true;
+  for ( unsigned int test = 0; test < 4; ++test )
+    {
+    ConvolutionFilterType::Pointer reference = ConvolutionFilterType::New();
+    ConvolutionFilterType::Pointer blocks = ConvolutionFilterType::New();
+    ConvolutionFilterType *filters[2] = { reference, blocks };
+    for ( unsigned int f = 0; f < 2; ++f )
+      {
+      filters[f]->SetInput( image );
+      filters[f]->SetKernelImage( kernel );
+      filters[f]->SetNumberOfThreads( 4 );
+      }
+    reference->SetBlockSize( wholeImageBlockSize );
+    blocks->SetBlockSize( smallBlockSize );
+
+    const char *description = "";
+    switch ( test )
+      {
+      case 0:
+        description = "SAME";
+        break;
+      case 1:
+        description = "VALID, normalized";
+        for ( unsigned int f = 0; f < 2; ++f )
+          {
+          filters[f]->SetOutputRegionModeToValid();
+          filters[f]->NormalizeOn();
+          }
+        break;
+      case 2:
+        description = "Periodic boundary condition";
+        for ( unsigned int f = 0; f < 2; ++f )
+          {
+          filters[f]->SetBoundaryCondition( &periodic );
+          }
+        break;
+      case 3:
+        description = "Spatial domain";
+        for ( unsigned int f = 0; f < 2; ++f )
+          {
+          filters[f]->SetKernelImage( smallKernel );
+          }
+        reference->SetMaximumKernelSizeForSpatialConvolution( 0 );
+        break;
+      }
+
+    // The filter computing the blocks is streamed. The pixels are
+    // positive, so the absolute value only stands for a streamable
+    // source.
+    AbsFilterType::Pointer source = AbsFilterType::New();
+    source->SetInput( image );
+    source->InPlaceOff();
+    MonitorFilterType::Pointer monitor = MonitorFilterType::New();
+    monitor->SetInput( source->GetOutput() );
+    blocks->SetInput( monitor->GetOutput() );
+    StreamingFilterType::Pointer streamer = StreamingFilterType::New();
+    streamer->SetInput( blocks->GetOutput() );
+    streamer->SetNumberOfStreamDivisions( 3 );
+
+    try
+      {
+      reference->Update();
+      streamer->Update();
+      }
+    catch ( itk::ExceptionObject & excp )
+      {
+      std::cerr << description << ": " << excp << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    // The periodic boundary condition needs the whole input.
+    if ( test != 2 && !monitor->VerifyInputFilterExecutedStreaming( 3 ) )
+      {
+      std::cerr << description << ": the input was not streamed" << std::endl;
+      success = false;
+      }
+    success &= CompareImages( reference->GetOutput(), streamer->GetOutput(), description );
+    }
+
+  ConvolutionFilterType::Pointer filter = ConvolutionFilterType::New();
+  filter->SetBlockSize( smallBlockSize );
+  if ( filter->GetBlockSize() != smallBlockSize )
+    {
+    std::cerr << "Set/GetBlockSize() error" << std::endl;
+    return EXIT_FAILURE;
+    }
+  filter->SetMaximumKernelSizeForSpatialConvolution( 10 );
+  if ( filter->GetMaximumKernelSizeForSpatialConvolution() != 10 )
+    {
+    std::cerr << "Set/GetMaximumKernelSizeForSpatialConvolution() error" << std::endl;
+    return EXIT_FAILURE;
+    }
+  filter->Print( std::cout );
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
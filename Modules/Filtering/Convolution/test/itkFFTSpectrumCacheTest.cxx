@@ -0,0 +1,196 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkFFTConvolutionImageFilter.h"
+#include "itkFFTNormalizedCorrelationImageFilter.h"
+#include "itkImageRegionIterator.h"
+
+namespace
+{
+typedef itk::Image< float, 2 > ImageType;
+
+ImageType::Pointer
+CreateRandomImage(unsigned int size, unsigned int seed)
+{
+  ImageType::SizeType imageSize;
+  imageSize.Fill( size );
+  ImageType::RegionType region;
+  region.SetSize( imageSize );
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( region );
+  image->Allocate();
+  itk::ImageRegionIterator< ImageType > it( image, region );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    seed = seed * 1103515245 + 12345;
+    it.Set( static_cast< float >( ( seed >> 16 ) % 1000 ) / 1000.0f );
+    }
+  return image;
+}
+
+bool
+SameImages(const ImageType *image1, const ImageType *image2)
+{
+  itk::ImageRegionConstIterator< ImageType > it1( image1, image1->GetBufferedRegion() );
+  itk::ImageRegionConstIterator< ImageType > it2( image2, image2->GetBufferedRegion() );
+  for ( it1.GoToBegin(), it2.GoToBegin(); !it1.IsAtEnd(); ++it1, ++it2 )
+    {
+    if ( it2.IsAtEnd() || it1.Get() != it2.Get() )
+      {
+      return false;
+      }
+    }
+  return it2.IsAtEnd();
+}
+}
+
+// Check that the kernel spectra cached by FFTConvolutionImageFilter
+// and MaskedFFTNormalizedCorrelationImageFilter give the same results
+// as recomputed ones, and are not used once the kernel is modified.
+int itkFFTSpectrumCacheTest(int, char *[])
+{
+  typedef itk::FFTConvolutionImageFilter< ImageType >                      ConvolutionFilterType;
+  typedef itk::FFTNormalizedCorrelationImageFilter< ImageType, ImageType > CorrelationFilterType;
+  typedef ConvolutionFilterType::InternalComplexImageType                  ConvolutionSpectrumType;
+  typedef itk::FFTSpectrumCache< ConvolutionSpectrumType >                 ConvolutionCacheType;
+  typedef itk::FFTSpectrumCache< CorrelationFilterType::FFTImageType >     CorrelationCacheType;
+
+  ImageType::Pointer kernel = CreateRandomImage( 9, 1 );
+
+  ImageType::SizeType blockSize;
+  blockSize.Fill( 32 );
+
+  // Two images of the same size, with the whole image transformed at
+  // once or block by block.
+  for ( unsigned int blocks = 0; blocks < 2; ++blocks )
+    {
+    ConvolutionCacheType::Clear();
+    for ( unsigned int i = 0; i < 3; ++i )
+      {
+      if ( i == 2 )
+        {
+        // The kernel changes: the cached spectrum must not be used.
+        kernel->GetPixel( kernel->GetBufferedRegion().GetIndex() ) += 1.0f;
+        kernel->Modified();
+        }
+      ImageType::Pointer image = CreateRandomImage( 100, 10 + i );
+
+      ConvolutionFilterType::Pointer reference = ConvolutionFilterType::New();
+      reference->SetInput( image );
+      reference->SetKernelImage( kernel );
+      reference->NormalizeOn();
+      ConvolutionFilterType::Pointer cached = ConvolutionFilterType::New();
+      cached->SetInput( image );
+      cached->SetKernelImage( kernel );
+      cached->NormalizeOn();
+      cached->UseKernelSpectrumCacheOn();
+      if ( blocks )
+        {
+        reference->SetBlockSize( blockSize );
+        cached->SetBlockSize( blockSize );
+        }
+
+      // Use the cached spectrum twice.
+      cached->Update();
+      cached->Modified();
+      cached->Update();
+      reference->Update();
+
+      if ( !SameImages( reference->GetOutput(), cached->GetOutput() ) )
+        {
+        std::cerr << "Convolution " << i << ( blocks ? " by blocks" : "" )
+                  << ": the cached spectrum gives a different result" << std::endl;
+        return EXIT_FAILURE;
+        }
+      const itk::SizeValueType expectedNumberOfSpectra = ( i < 2 ) ? 1 : 2;
+      if ( ConvolutionCacheType::GetNumberOfSpectra() != expectedNumberOfSpectra )
+        {
+        std::cerr << "Convolution " << i << ( blocks ? " by blocks" : "" ) << ": "
+                  << ConvolutionCacheType::GetNumberOfSpectra() << " spectra in the cache instead of "
+                  << expectedNumberOfSpectra << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  // The least recently used spectrum is dropped when the cache is full.
+  const itk::SizeValueType memorySize = ConvolutionCacheType::GetMemorySize();
+  ConvolutionCacheType::SetMaximumMemorySize( memorySize - 1 );
+  if ( ConvolutionCacheType::GetNumberOfSpectra() != 1
+       || ConvolutionCacheType::GetMemorySize() > memorySize - 1 )
+    {
+    std::cerr << "The cache was not reduced below " << memorySize - 1 << " bytes" << std::endl;
+    return EXIT_FAILURE;
+    }
+  ConvolutionCacheType::SetMaximumMemorySize( 0 );
+  if ( ConvolutionCacheType::GetNumberOfSpectra() != 0 || ConvolutionCacheType::GetMemorySize() != 0 )
+    {
+    std::cerr << "The cache is not empty" << std::endl;
+    return EXIT_FAILURE;
+    }
+  ConvolutionCacheType::SetMaximumMemorySize( 256 * 1024 * 1024 );
+
+  // Search a template in several images.
+  ImageType::Pointer movingImage = CreateRandomImage( 11, 2 );
+  for ( unsigned int i = 0; i < 2; ++i )
+    {
+    ImageType::Pointer fixedImage = CreateRandomImage( 40, 20 + i );
+
+    CorrelationFilterType::Pointer reference = CorrelationFilterType::New();
+    reference->SetFixedImage( fixedImage );
+    reference->SetMovingImage( movingImage );
+    CorrelationFilterType::Pointer cached = CorrelationFilterType::New();
+    cached->SetFixedImage( fixedImage );
+    cached->SetMovingImage( movingImage );
+    cached->UseMovingImageSpectrumCacheOn();
+    try
+      {
+      reference->Update();
+      cached->Update();
+      }
+    catch ( itk::ExceptionObject & excp )
+      {
+      std::cerr << excp << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    if ( !SameImages( reference->GetOutput(), cached->GetOutput() ) )
+      {
+      std::cerr << "Correlation " << i << ": the cached spectra give a different result" << std::endl;
+      return EXIT_FAILURE;
+      }
+    if ( CorrelationCacheType::GetNumberOfSpectra() != 3 )
+      {
+      std::cerr << "Correlation " << i << ": " << CorrelationCacheType::GetNumberOfSpectra()
+                << " spectra in the cache instead of 3" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  CorrelationCacheType::Clear();
+
+  ConvolutionFilterType::Pointer filter = ConvolutionFilterType::New();
+  filter->UseKernelSpectrumCacheOn();
+  if ( !filter->GetUseKernelSpectrumCache() )
+    {
+    std::cerr << "Set/GetUseKernelSpectrumCache() error" << std::endl;
+    return EXIT_FAILURE;
+    }
+  filter->Print( std::cout );
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,153 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkFFTSpectrumCache_h
+#define __itkFFTSpectrumCache_h
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+#include "itkDataObject.h"
+#include "itkSimpleFastMutexLock.h"
+
+namespace itk
+{
+/** \class FFTSpectrumCache
+ * \brief Process wide cache of the Fourier transforms of images.
+ *
+ * Filters that transform the same image again and again, such as the
+ * kernel of a convolution applied to many images of the same size, can
+ * keep the transform in this cache and reuse it on the next update.
+ *
+ * A spectrum is identified by a KeyType: the data objects it was
+ * computed from, along with their modification time, the size of the
+ * transform, and a tag describing the other parameters of the
+ * computation. An entry is thus never found again once one of its
+ * sources is modified. Note that changing the pixels of an image
+ * through its buffer does not modify it: call Modified() on the image
+ * in that case.
+ *
+ * The cache holds at most MaximumMemorySize bytes of spectra. When
+ * this limit is exceeded, the least recently used spectra are
+ * dropped. The spectra returned by Find() are shared between all the
+ * filters using the cache, and must not be modified.
+ *
+ * There is one cache per spectrum image type.
+ *
+ * \ingroup ITKFFT
+ */
+template< class TSpectrumImage >
+class FFTSpectrumCache
+{
+public:
+  /** Standard class typedefs. */
+  typedef FFTSpectrumCache Self;
+
+  typedef TSpectrumImage                       SpectrumImageType;
+  typedef typename SpectrumImageType::Pointer  SpectrumImagePointer;
+  typedef typename SpectrumImageType::SizeType SizeType;
+
+  /** \class KeyType
+   * \brief Identifies a spectrum in the cache.
+   * \ingroup ITKFFT
+   */
+  class KeyType
+  {
+  public:
+    KeyType(const SizeType & size, const std::string & tag);
+
+    /** Add an object the spectrum depends on. A null pointer is
+     * allowed, for an optional input that is not set. */
+    void AddSource(const DataObject *source);
+
+    bool operator<(const KeyType & other) const;
+
+  private:
+    typedef std::pair< const DataObject *, unsigned long > SourceType;
+
+    std::vector< SourceType > m_Sources;
+    SizeType                  m_Size;
+    std::string               m_Tag;
+  };
+
+  /** Return the spectrum stored with the given key, or a null pointer
+   * if there is none. */
+  static SpectrumImagePointer Find(const KeyType & key);
+
+  /** Store a spectrum. The spectrum must not be modified afterwards. It
+   * is not stored if it alone is larger than MaximumMemorySize. */
+  static void Insert(const KeyType & key, SpectrumImageType *spectrum);
+
+  /** Drop all the spectra. */
+  static void Clear();
+
+  /** Set/Get the number of bytes the spectra can use. Defaults to
+   * 256 MB. */
+  static void SetMaximumMemorySize(SizeValueType size);
+  static SizeValueType GetMaximumMemorySize();
+
+  /** Get the number of bytes used by the spectra in the cache. */
+  static SizeValueType GetMemorySize();
+
+  /** Get the number of spectra in the cache. */
+  static SizeValueType GetNumberOfSpectra();
+
+private:
+  FFTSpectrumCache();                  //purposely not implemented
+  FFTSpectrumCache(const Self &);      //purposely not implemented
+  void operator=(const Self &);        //purposely not implemented
+
+  struct EntryType
+  {
+    EntryType(const KeyType & key, SpectrumImageType *spectrum, SizeValueType memorySize):
+      Key(key), Spectrum(spectrum), MemorySize(memorySize) {}
+
+    KeyType              Key;
+    SpectrumImagePointer Spectrum;
+    SizeValueType        MemorySize;
+  };
+
+  /** The entries, most recently used first. */
+  typedef std::list< EntryType > EntryListType;
+  typedef std::map< KeyType, typename EntryListType::iterator > EntryMapType;
+
+  class CacheType
+  {
+  public:
+    CacheType();
+
+    /** Drop the least recently used entries until the memory size is
+     * within the limit. Called with the mutex held. */
+    void Shrink();
+
+    EntryListType       m_Entries;
+    EntryMapType        m_Map;
+    SizeValueType       m_MemorySize;
+    SizeValueType       m_MaximumMemorySize;
+    SimpleFastMutexLock m_Mutex;
+  };
+
+  static CacheType m_Cache;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkFFTSpectrumCache.hxx"
+#endif
+
+#endif
@@ -0,0 +1,185 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkFFTSpectrumCache_hxx
+#define __itkFFTSpectrumCache_hxx
+
+#include "itkFFTSpectrumCache.h"
+#include "itkMutexLockHolder.h"
+
+namespace itk
+{
+template< class TSpectrumImage >
+typename FFTSpectrumCache< TSpectrumImage >::CacheType
+FFTSpectrumCache< TSpectrumImage >::m_Cache;
+
+template< class TSpectrumImage >
+FFTSpectrumCache< TSpectrumImage >::KeyType
+::KeyType(const SizeType & size, const std::string & tag):
+  m_Size(size),
+  m_Tag(tag)
+{}
+
+template< class TSpectrumImage >
+void
+FFTSpectrumCache< TSpectrumImage >::KeyType
+::AddSource(const DataObject *source)
+{
+  m_Sources.push_back( SourceType( source, source ? source->GetMTime() : 0 ) );
+}
+
+template< class TSpectrumImage >
+bool
+FFTSpectrumCache< TSpectrumImage >::KeyType
+::operator<(const KeyType & other) const
+{
+  for ( unsigned int i = 0; i < SizeType::Dimension; ++i )
+    {
+    if ( m_Size[i] != other.m_Size[i] )
+      {
+      return m_Size[i] < other.m_Size[i];
+      }
+    }
+  if ( m_Sources != other.m_Sources )
+    {
+    return m_Sources < other.m_Sources;
+    }
+  return m_Tag < other.m_Tag;
+}
+
+template< class TSpectrumImage >
+FFTSpectrumCache< TSpectrumImage >::CacheType
+::CacheType():
+  m_MemorySize(0),
+  m_MaximumMemorySize(256 * 1024 * 1024)
+{}
+
+template< class TSpectrumImage >
+void
+FFTSpectrumCache< TSpectrumImage >::CacheType
+::Shrink()
+{
+  while ( m_MemorySize > m_MaximumMemorySize )
+    {
+    m_MemorySize -= m_Entries.back().MemorySize;
+    m_Map.erase( m_Entries.back().Key );
+    m_Entries.pop_back();
+    }
+}
+
+template< class TSpectrumImage >
+typename FFTSpectrumCache< TSpectrumImage >::SpectrumImagePointer
+FFTSpectrumCache< TSpectrumImage >
+::Find(const KeyType & key)
+{
+  MutexLockHolder< SimpleFastMutexLock > mutexHolder(m_Cache.m_Mutex);
+
+  typename EntryMapType::iterator it = m_Cache.m_Map.find(key);
+  if ( it == m_Cache.m_Map.end() )
+    {
+    return NULL;
+    }
+  // Move the entry to the front of the list.
+  m_Cache.m_Entries.splice( m_Cache.m_Entries.begin(), m_Cache.m_Entries, it->second );
+  return it->second->Spectrum;
+}
+
+template< class TSpectrumImage >
+void
+FFTSpectrumCache< TSpectrumImage >
+::Insert(const KeyType & key, SpectrumImageType *spectrum)
+{
+  const SizeValueType memorySize = spectrum->GetBufferedRegion().GetNumberOfPixels()
+                                   * sizeof( typename SpectrumImageType::PixelType );
+
+  MutexLockHolder< SimpleFastMutexLock > mutexHolder(m_Cache.m_Mutex);
+
+  if ( memorySize > m_Cache.m_MaximumMemorySize )
+    {
+    return;
+    }
+
+  typename EntryMapType::iterator it = m_Cache.m_Map.find(key);
+  if ( it != m_Cache.m_Map.end() )
+    {
+    // Another filter stored the same spectrum in the meantime.
+    m_Cache.m_MemorySize -= it->second->MemorySize;
+    m_Cache.m_Entries.erase(it->second);
+    m_Cache.m_Map.erase(it);
+    }
+
+  m_Cache.m_Entries.push_front( EntryType(key, spectrum, memorySize) );
+  m_Cache.m_Map.insert( typename EntryMapType::value_type( key, m_Cache.m_Entries.begin() ) );
+  m_Cache.m_MemorySize += memorySize;
+  m_Cache.Shrink();
+}
+
+template< class TSpectrumImage >
+void
+FFTSpectrumCache< TSpectrumImage >
+::Clear()
+{
+  MutexLockHolder< SimpleFastMutexLock > mutexHolder(m_Cache.m_Mutex);
+
+  m_Cache.m_Map.clear();
+  m_Cache.m_Entries.clear();
+  m_Cache.m_MemorySize = 0;
+}
+
+template< class TSpectrumImage >
+void
+FFTSpectrumCache< TSpectrumImage >
+::SetMaximumMemorySize(SizeValueType size)
+{
+  MutexLockHolder< SimpleFastMutexLock > mutexHolder(m_Cache.m_Mutex);
+
+  m_Cache.m_MaximumMemorySize = size;
+  m_Cache.Shrink();
+}
+
+template< class TSpectrumImage >
+SizeValueType
+FFTSpectrumCache< TSpectrumImage >
+::GetMaximumMemorySize()
+{
+  MutexLockHolder< SimpleFastMutexLock > mutexHolder(m_Cache.m_Mutex);
+
+  return m_Cache.m_MaximumMemorySize;
+}
+
+template< class TSpectrumImage >
+SizeValueType
+FFTSpectrumCache< TSpectrumImage >
+::GetMemorySize()
+{
+  MutexLockHolder< SimpleFastMutexLock > mutexHolder(m_Cache.m_Mutex);
+
+  return m_Cache.m_MemorySize;
+}
+
+template< class TSpectrumImage >
+SizeValueType
+FFTSpectrumCache< TSpectrumImage >
+::GetNumberOfSpectra()
+{
+  MutexLockHolder< SimpleFastMutexLock > mutexHolder(m_Cache.m_Mutex);
+
+  return m_Cache.m_Entries.size();
+}
+} // end namespace itk
+
+#endif
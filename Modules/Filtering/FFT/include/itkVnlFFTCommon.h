@@ -18,7 +18,12 @@
 #ifndef __itkVnlFFTCommon_h
 #define __itkVnlFFTCommon_h
 
-#include "vnl/algo/vnl_fft_base.h"
+#include <complex>
+#include <map>
+#include <vector>
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
+#include "vnl/algo/vnl_fft_prime_factors.h"
 
 namespace itk
 {
@@ -31,21 +36,141 @@ namespace itk
 struct VnlFFTCommon
 {
 
-  /** Vnl's FFT supports discrete Fourier transforms for images whose
-  sizes have a prime factorization consisting of 2's, 3's, and 5's. */
+  /** Vnl's FFT directly supports discrete Fourier transforms for
+  sizes whose prime factorization consists of 2's, 3's, and 5's.
+  These are the fast sizes; the other sizes are transformed with
+  Bluestein's algorithm, which is several times slower. */
   template< class TSizeValue >
   static bool IsDimensionSizeLegal(TSizeValue n);
 
-  /** Convenience struct for computing the discrete Fourier
-  Transform. */
+  /** \class VnlFFT1DPlan
+   * \brief Precomputed data for the one-dimensional transforms of a
+   * given size.
+   *
+   * Sizes that factor into 2's, 3's, and 5's are transformed directly
+   * with Vnl's prime factor FFT. Any other size N is transformed with
+   * Bluestein's algorithm: the transform is rewritten as a circular
+   * convolution with a chirp, computed with a prime factor FFT of a
+   * fast size of at least 2N-1. The chirp and the spectrum of the
+   * convolution kernel are computed once, when the plan is created.
+   *
+   * Plans are immutable once created, so a plan can be used by
+   * several threads at the same time. GetPlan() returns plans from a
+   * process wide cache, indexed by size.
+   *
+   * \ingroup ITKFFT
+   */
+  template< class TPrecision >
+  class VnlFFT1DPlan
+  {
+  public:
+    typedef std::complex< TPrecision > ComplexType;
+
+    VnlFFT1DPlan(unsigned int n);
+
+    /** Size of the transformed signals. */
+    unsigned int GetSize() const
+    {
+      return m_Size;
+    }
+
+    /** True if the plan uses Bluestein's algorithm. */
+    bool GetUseBluestein() const
+    {
+      return m_PaddedSize != 0;
+    }
+
+    /** Number of elements of the scratch buffer passed to Transform(). */
+    unsigned int GetScratchSize() const
+    {
+      return m_PaddedSize;
+    }
+
+    /** Transform in place a contiguous signal of GetSize() elements.
+     * dir is -1 for the forward transform and +1 for the inverse one;
+     * like Vnl's transforms, neither is normalized. */
+    void Transform(ComplexType *signal, int dir, ComplexType *scratch) const;
+
+    /** Return the cached plan for size n, creating it on first use.
+     * Thread safe. */
+    static const VnlFFT1DPlan * GetPlan(unsigned int n);
+
+  private:
+    VnlFFT1DPlan(const VnlFFT1DPlan &); //purposely not implemented
+    void operator=(const VnlFFT1DPlan &); //purposely not implemented
+
+    /** Owns the cached plans. */
+    class PlanCacheType
+    {
+    public:
+      ~PlanCacheType();
+
+      typedef std::map< unsigned int, VnlFFT1DPlan * > MapType;
+      MapType             m_Plans;
+      SimpleFastMutexLock m_Mutex;
+    };
+
+    unsigned int                        m_Size;
+    unsigned int                        m_PaddedSize;
+    vnl_fft_prime_factors< TPrecision > m_Factors;
+    std::vector< ComplexType >          m_Chirp;
+    std::vector< ComplexType >          m_KernelSpectrum;
+
+    static PlanCacheType m_PlanCache;
+  };
+
+  /** Convenience class for computing the discrete Fourier transform
+  of an image buffer of any size. The one-dimensional transforms
+  along each axis are distributed over several threads. */
   template< class TImage >
-  struct VnlFFTTransform:
-    public vnl_fft_base< TImage::ImageDimension, typename TImage::PixelType >
+  class VnlFFTTransform
   {
-    typedef vnl_fft_base< TImage::ImageDimension, typename TImage::PixelType > Base;
+  public:
+    typedef VnlFFTTransform              Self;
+    typedef typename TImage::PixelType   PixelType;
+    typedef typename TImage::SizeType    SizeType;
+    typedef std::complex< PixelType >    ComplexType;
+    typedef VnlFFT1DPlan< PixelType >    PlanType;
+
+    itkStaticConstMacro(ImageDimension, unsigned int, TImage::ImageDimension);
 
     //: constructor takes size of signal.
-    VnlFFTTransform(const typename TImage::SizeType & s);
+    VnlFFTTransform(const SizeType & s);
+
+    /** Set/Get the maximum number of threads used by transform().
+     * Defaults to the global default number of threads. Small signals
+     * are transformed on a single thread. */
+    void SetNumberOfThreads(ThreadIdType n)
+    {
+      m_NumberOfThreads = n;
+    }
+    ThreadIdType GetNumberOfThreads() const
+    {
+      return m_NumberOfThreads;
+    }
+
+    //: dir = +1/-1 according to direction of transform.
+    void transform(ComplexType *signal, int dir);
+
+  private:
+    VnlFFTTransform(const VnlFFTTransform &); //purposely not implemented
+    void operator=(const VnlFFTTransform &); //purposely not implemented
+
+    /** Transform the lines [firstLine, endLine) along the current axis. */
+    void TransformLines(SizeValueType firstLine, SizeValueType endLine);
+
+    static ITK_THREAD_RETURN_TYPE TransformThreaderCallback(void *arg);
+
+    SizeType               m_Size;
+    const PlanType        *m_Plans[TImage::ImageDimension];
+    ThreadIdType           m_NumberOfThreads;
+    MultiThreader::Pointer m_Threader;
+
+    // State of the transform in progress
+    ComplexType  *m_Signal;
+    int           m_Direction;
+    unsigned int  m_Axis;
+    SizeValueType m_NumberOfLines;
   };
 
 };
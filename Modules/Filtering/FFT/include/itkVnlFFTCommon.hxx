@@ -19,6 +19,10 @@
 #define __itkVnlFFTCommon_hxx
 
 #include "itkVnlFFTCommon.h"
+#include "itkMutexLockHolder.h"
+#include "vnl/algo/vnl_fft.h"
+#include "vnl/vnl_math.h"
+#include "vcl_cmath.h"
 
 namespace itk
 {
@@ -41,13 +45,288 @@ VnlFFTCommon
   return ( n == 1 ); // return false if decomposition failed
 }
 
+template< class TPrecision >
+typename VnlFFTCommon::VnlFFT1DPlan< TPrecision >::PlanCacheType
+VnlFFTCommon::VnlFFT1DPlan< TPrecision >::m_PlanCache;
+
+template< class TPrecision >
+VnlFFTCommon::VnlFFT1DPlan< TPrecision >::PlanCacheType
+::~PlanCacheType()
+{
+  for ( typename MapType::iterator it = m_Plans.begin(); it != m_Plans.end(); ++it )
+    {
+    delete it->second;
+    }
+}
+
+template< class TPrecision >
+VnlFFTCommon::VnlFFT1DPlan< TPrecision >
+::VnlFFT1DPlan(unsigned int n):
+  m_Size(n),
+  m_PaddedSize(0)
+{
+  if ( n <= 1 || VnlFFTCommon::IsDimensionSizeLegal(n) )
+    {
+    if ( n > 1 )
+      {
+      m_Factors.resize(n);
+      }
+    return;
+    }
+
+  // Bluestein's algorithm: the linear convolution of two signals of
+  // size n must fit in the padded signal without wrapping around.
+  m_PaddedSize = 2 * n - 1;
+  while ( !VnlFFTCommon::IsDimensionSizeLegal(m_PaddedSize) )
+    {
+    ++m_PaddedSize;
+    }
+  m_Factors.resize(m_PaddedSize);
+
+  // Chirp exp(-i pi k^2 / n). k^2 is computed modulo 2n to keep the
+  // phase accurate for large k.
+  m_Chirp.resize(n);
+  const unsigned int twoN = 2 * n;
+  unsigned int       kSquare = 0;
+  for ( unsigned int k = 0; k < n; ++k )
+    {
+    if ( k > 0 )
+      {
+      kSquare = ( kSquare + 2 * k - 1 ) % twoN;
+      }
+    const double phase = -vnl_math::pi * static_cast< double >( kSquare ) / n;
+    m_Chirp[k] = ComplexType( static_cast< TPrecision >( vcl_cos(phase) ),
+                              static_cast< TPrecision >( vcl_sin(phase) ) );
+    }
+
+  // The convolution kernel is the conjugate chirp, wrapped around.
+  // Its spectrum includes the normalization of the inverse transform
+  // of the padded signal.
+  m_KernelSpectrum.assign( m_PaddedSize, ComplexType(0) );
+  m_KernelSpectrum[0] = std::conj(m_Chirp[0]);
+  for ( unsigned int k = 1; k < n; ++k )
+    {
+    m_KernelSpectrum[k] = std::conj(m_Chirp[k]);
+    m_KernelSpectrum[m_PaddedSize - k] = m_KernelSpectrum[k];
+    }
+
+  TPrecision *data = reinterpret_cast< TPrecision * >( &m_KernelSpectrum[0] );
+  long        info = 0;
+  vnl_fft_gpfa(data, data + 1, m_Factors.trigs(), 2, 0, m_PaddedSize, 1, -1,
+               m_Factors.pqr(), &info);
+
+  const TPrecision scale = static_cast< TPrecision >( 1.0 / m_PaddedSize );
+  for ( unsigned int k = 0; k < m_PaddedSize; ++k )
+    {
+    m_KernelSpectrum[k] *= scale;
+    }
+}
+
+template< class TPrecision >
+void
+VnlFFTCommon::VnlFFT1DPlan< TPrecision >
+::Transform(ComplexType *signal, int dir, ComplexType *scratch) const
+{
+  long info = 0;
+
+  if ( m_Size <= 1 )
+    {
+    return;
+    }
+
+  // This relies on the assumption that std::complex<T> is layout
+  // compatible with "struct { T real; T imag; }", as Vnl does.
+  if ( m_PaddedSize == 0 )
+    {
+    TPrecision *data = reinterpret_cast< TPrecision * >( signal );
+    vnl_fft_gpfa(data, data + 1, m_Factors.trigs(), 2, 0, m_Size, 1, dir,
+                 m_Factors.pqr(), &info);
+    return;
+    }
+
+  // The chirp is that of the forward transform. The inverse transform
+  // is computed as the conjugate of the forward transform of the
+  // conjugate signal.
+  const bool inverse = ( dir > 0 );
+  for ( unsigned int k = 0; k < m_Size; ++k )
+    {
+    const ComplexType value = inverse ? std::conj(signal[k]) : signal[k];
+    scratch[k] = value * m_Chirp[k];
+    }
+  for ( unsigned int k = m_Size; k < m_PaddedSize; ++k )
+    {
+    scratch[k] = ComplexType(0);
+    }
+
+  TPrecision *data = reinterpret_cast< TPrecision * >( scratch );
+  vnl_fft_gpfa(data, data + 1, m_Factors.trigs(), 2, 0, m_PaddedSize, 1, -1,
+               m_Factors.pqr(), &info);
+  for ( unsigned int k = 0; k < m_PaddedSize; ++k )
+    {
+    scratch[k] *= m_KernelSpectrum[k];
+    }
+  vnl_fft_gpfa(data, data + 1, m_Factors.trigs(), 2, 0, m_PaddedSize, 1, 1,
+               m_Factors.pqr(), &info);
+
+  for ( unsigned int k = 0; k < m_Size; ++k )
+    {
+    const ComplexType value = scratch[k] * m_Chirp[k];
+    signal[k] = inverse ? std::conj(value) : value;
+    }
+}
+
+template< class TPrecision >
+const VnlFFTCommon::VnlFFT1DPlan< TPrecision > *
+VnlFFTCommon::VnlFFT1DPlan< TPrecision >
+::GetPlan(unsigned int n)
+{
+  MutexLockHolder< SimpleFastMutexLock > mutexHolder(m_PlanCache.m_Mutex);
+
+  typename PlanCacheType::MapType::iterator it = m_PlanCache.m_Plans.find(n);
+  if ( it != m_PlanCache.m_Plans.end() )
+    {
+    return it->second;
+    }
+  VnlFFT1DPlan *plan = new VnlFFT1DPlan(n);
+  m_PlanCache.m_Plans.insert( typename PlanCacheType::MapType::value_type(n, plan) );
+  return plan;
+}
+
 template< class TImage >
 VnlFFTCommon::VnlFFTTransform< TImage >
-::VnlFFTTransform(const typename TImage::SizeType & s)
+::VnlFFTTransform(const SizeType & s):
+  m_Size(s),
+  m_NumberOfThreads( MultiThreader::GetGlobalDefaultNumberOfThreads() ),
+  m_Signal(0),
+  m_Direction(-1),
+  m_Axis(0),
+  m_NumberOfLines(0)
 {
-  for( int i=0; i < TImage::ImageDimension; i++ )
+  for ( unsigned int i = 0; i < ImageDimension; i++ )
     {
-    Base::factors_[TImage::ImageDimension - i - 1].resize(s[i]);
+    m_Plans[i] = PlanType::GetPlan( static_cast< unsigned int >( s[i] ) );
+    }
+}
+
+template< class TImage >
+void
+VnlFFTCommon::VnlFFTTransform< TImage >
+::transform(ComplexType *signal, int dir)
+{
+  // Below this number of elements, starting the threads costs more
+  // than the transforms themselves.
+  const SizeValueType minimumSizeForThreading = 4096;
+
+  SizeValueType numberOfElements = 1;
+  for ( unsigned int i = 0; i < ImageDimension; i++ )
+    {
+    numberOfElements *= m_Size[i];
+    }
+
+  m_Signal = signal;
+  m_Direction = dir;
+
+  // transform along each dimension, i, in turn.
+  for ( unsigned int i = 0; i < ImageDimension; i++ )
+    {
+    if ( m_Size[i] <= 1 )
+      {
+      continue;
+      }
+    m_Axis = i;
+    m_NumberOfLines = numberOfElements / m_Size[i];
+
+    ThreadIdType numberOfThreads = m_NumberOfThreads;
+    if ( numberOfElements < minimumSizeForThreading )
+      {
+      numberOfThreads = 1;
+      }
+    if ( m_NumberOfLines < numberOfThreads )
+      {
+      numberOfThreads = static_cast< ThreadIdType >( m_NumberOfLines );
+      }
+
+    if ( numberOfThreads <= 1 )
+      {
+      this->TransformLines(0, m_NumberOfLines);
+      }
+    else
+      {
+      if ( m_Threader.IsNull() )
+        {
+        m_Threader = MultiThreader::New();
+        }
+      m_Threader->SetNumberOfThreads(numberOfThreads);
+      m_Threader->SetSingleMethod(Self::TransformThreaderCallback, this);
+      m_Threader->SingleMethodExecute();
+      }
+    }
+
+  m_Signal = 0;
+}
+
+template< class TImage >
+ITK_THREAD_RETURN_TYPE
+VnlFFTCommon::VnlFFTTransform< TImage >
+::TransformThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info =
+    static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  Self *self = static_cast< Self * >( info->UserData );
+
+  const SizeValueType threadId = info->ThreadID;
+  const SizeValueType numberOfThreads = info->NumberOfThreads;
+  const SizeValueType firstLine = self->m_NumberOfLines * threadId / numberOfThreads;
+  const SizeValueType endLine = self->m_NumberOfLines * ( threadId + 1 ) / numberOfThreads;
+
+  self->TransformLines(firstLine, endLine);
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TImage >
+void
+VnlFFTCommon::VnlFFTTransform< TImage >
+::TransformLines(SizeValueType firstLine, SizeValueType endLine)
+{
+  const PlanType     *plan = m_Plans[m_Axis];
+  const SizeValueType n = m_Size[m_Axis];
+
+  // Distance between two consecutive elements of a line
+  SizeValueType stride = 1;
+  for ( unsigned int i = 0; i < m_Axis; i++ )
+    {
+    stride *= m_Size[i];
+    }
+
+  std::vector< ComplexType > scratch( plan->GetScratchSize() );
+  ComplexType *scratchPtr = scratch.empty() ? 0 : &scratch[0];
+
+  if ( stride == 1 )
+    {
+    for ( SizeValueType line = firstLine; line < endLine; ++line )
+      {
+      plan->Transform(m_Signal + line * n, m_Direction, scratchPtr);
+      }
+    return;
+    }
+
+  // Lines along the other axes are copied to a contiguous buffer.
+  // Consecutive lines share their cache lines, so the strided
+  // accesses stay mostly in cache.
+  std::vector< ComplexType > buffer(n);
+  for ( SizeValueType line = firstLine; line < endLine; ++line )
+    {
+    ComplexType *start = m_Signal + ( line / stride ) * stride * n + line % stride;
+    for ( SizeValueType k = 0; k < n; ++k )
+      {
+      buffer[k] = start[k * stride];
+      }
+    plan->Transform(&buffer[0], m_Direction, scratchPtr);
+    for ( SizeValueType k = 0; k < n; ++k )
+      {
+      start[k * stride] = buffer[k];
+      }
     }
 }
 
@@ -30,8 +30,10 @@ namespace itk
  *
  * \brief VNL-based reverse Fast Fourier Transform.
  *
- * The input image size must be a multiple of combinations of 2s, 3s,
- * and/or 5s in all dimensions.
+ * The image may have any size. Sizes whose prime factorization
+ * consists of 2s, 3s, and 5s are the fastest; the other sizes are
+ * transformed with Bluestein's algorithm. The one-dimensional
+ * transforms are distributed over the filter's threads.
  *
  * \ingroup FourierTransform
  *
@@ -56,13 +56,6 @@ VnlHalfHermitianToRealInverseFFTImageFilter< TInputImage, TOutputImage >
   unsigned int vectorSize = 1;
   for ( unsigned int i = 0; i < ImageDimension; i++ )
     {
-    if ( !VnlFFTCommon::IsDimensionSizeLegal( outputSize[i] ) )
-      {
-      itkExceptionMacro(<< "Cannot compute FFT of image with size "
-                        << outputSize << ". VnlHalfHermitianToRealInverseFFTImageFilter operates "
-                        << "only on images whose size in each dimension is a multiple of "
-                        << "2, 3, or 5." );
-      }
     vectorSize *= outputSize[i];
     }
 
@@ -101,6 +94,7 @@ VnlHalfHermitianToRealInverseFFTImageFilter< TInputImage, TOutputImage >
 
   // call the proper transform, based on compile type template parameter
   VnlFFTCommon::VnlFFTTransform< OutputImageType > vnlfft( outputSize );
+  vnlfft.SetNumberOfThreads( this->GetNumberOfThreads() );
   vnlfft.transform( signal.data_block(), 1 );
 
   // Copy the VNL output back to the ITK image. Extract the real part
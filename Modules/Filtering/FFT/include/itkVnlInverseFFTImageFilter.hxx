@@ -55,13 +55,6 @@ VnlInverseFFTImageFilter< TInputImage, TOutputImage >
   unsigned int vectorSize = 1;
   for ( unsigned int i = 0; i < ImageDimension; i++ )
     {
-    if ( !VnlFFTCommon::IsDimensionSizeLegal( outputSize[i] ) )
-      {
-      itkExceptionMacro(<< "Cannot compute FFT of image with size "
-                        << outputSize << ". VnlInverseFFTImageFilter operates "
-                        << "only on images whose size in each dimension is a multiple of "
-                        << "2, 3, or 5." );
-      }
     vectorSize *= outputSize[i];
     }
 
@@ -75,6 +68,7 @@ VnlInverseFFTImageFilter< TInputImage, TOutputImage >
 
   // call the proper transform, based on compile type template parameter
   VnlFFTCommon::VnlFFTTransform< OutputImageType > vnlfft( outputSize );
+  vnlfft.SetNumberOfThreads( this->GetNumberOfThreads() );
   vnlfft.transform( signal.data_block(), 1 );
 
   // Copy the VNL output back to the ITK image.
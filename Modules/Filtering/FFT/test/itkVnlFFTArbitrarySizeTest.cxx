@@ -0,0 +1,139 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkVnlForwardFFTImageFilter.h"
+#include "itkVnlInverseFFTImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "vnl/vnl_math.h"
+
+// Compare the forward transform of an image whose sizes have large
+// prime factors with a direct evaluation of the discrete Fourier
+// transform, and check that the result does not depend on the number
+// of threads.
+template< unsigned int VDimension >
+int
+test_vnl_fft_arbitrary_size(const unsigned int *sizes)
+{
+  typedef itk::Image< double, VDimension >                  RealImageType;
+  typedef itk::Image< std::complex< double >, VDimension >  ComplexImageType;
+  typedef itk::VnlForwardFFTImageFilter< RealImageType >    ForwardType;
+  typedef itk::VnlInverseFFTImageFilter< ComplexImageType > InverseType;
+
+  typename RealImageType::SizeType size;
+  for ( unsigned int i = 0; i < VDimension; i++ )
+    {
+    size[i] = sizes[i];
+    }
+  typename RealImageType::RegionType region;
+  region.SetSize(size);
+
+  typename RealImageType::Pointer image = RealImageType::New();
+  image->SetRegions(region);
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< RealImageType > it(image, region);
+  unsigned int seed = 1;
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    seed = seed * 1103515245 + 12345;
+    it.Set( static_cast< double >( ( seed >> 16 ) % 1000 ) / 100.0 );
+    }
+
+  typename ForwardType::Pointer fft1 = ForwardType::New();
+  fft1->SetInput(image);
+  fft1->SetNumberOfThreads(1);
+  fft1->Update();
+
+  typename ForwardType::Pointer fftN = ForwardType::New();
+  fftN->SetInput(image);
+  fftN->SetNumberOfThreads(4);
+  fftN->Update();
+
+  // Direct evaluation at a few frequencies
+  const unsigned int numberOfFrequencies = 20;
+  double maxError = 0.0;
+  for ( unsigned int f = 0; f < numberOfFrequencies; f++ )
+    {
+    typename ComplexImageType::IndexType frequency;
+    for ( unsigned int i = 0; i < VDimension; i++ )
+      {
+      frequency[i] = ( f * ( 2 * i + 3 ) + i ) % size[i];
+      }
+    std::complex< double > expected(0.0, 0.0);
+    for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+      {
+      double phase = 0.0;
+      for ( unsigned int i = 0; i < VDimension; i++ )
+        {
+        phase -= 2.0 * vnl_math::pi * it.GetIndex()[i] * frequency[i] / size[i];
+        }
+      expected += it.Get() * std::complex< double >( vcl_cos(phase), vcl_sin(phase) );
+      }
+    const std::complex< double > value = fft1->GetOutput()->GetPixel(frequency);
+    maxError = std::max( maxError, std::abs(value - expected) / ( std::abs(expected) + 1.0 ) );
+    }
+  if ( maxError > 1e-9 )
+    {
+    std::cerr << "Forward transform differs from the DFT by " << maxError << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  itk::ImageRegionIteratorWithIndex< ComplexImageType > it1( fft1->GetOutput(), region );
+  itk::ImageRegionIteratorWithIndex< ComplexImageType > itN( fftN->GetOutput(), region );
+  for ( it1.GoToBegin(), itN.GoToBegin(); !it1.IsAtEnd(); ++it1, ++itN )
+    {
+    if ( std::abs( it1.Get() - itN.Get() ) > 1e-9 * ( std::abs( it1.Get() ) + 1.0 ) )
+      {
+      std::cerr << "Threaded transform differs at " << it1.GetIndex() << ": "
+                << itN.Get() << " instead of " << it1.Get() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  typename InverseType::Pointer ifft = InverseType::New();
+  ifft->SetInput( fftN->GetOutput() );
+  ifft->SetNumberOfThreads(4);
+  ifft->Update();
+  itk::ImageRegionIteratorWithIndex< RealImageType > out( ifft->GetOutput(), region );
+  for ( it.GoToBegin(), out.GoToBegin(); !it.IsAtEnd(); ++it, ++out )
+    {
+    if ( vnl_math_abs( it.Get() - out.Get() ) > 1e-9 )
+      {
+      std::cerr << "Inverse transform differs at " << it.GetIndex() << ": "
+                << out.Get() << " instead of " << it.Get() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  std::cout << "Size " << size << ": maximum relative error " << maxError << std::endl;
+  return EXIT_SUCCESS;
+}
+
+int itkVnlFFTArbitrarySizeTest(int, char *[])
+{
+  const unsigned int sizes1[] = { 127 };
+  const unsigned int sizes2[] = { 7, 13 };
+  const unsigned int sizes3[] = { 17, 12, 23 };
+
+  if ( test_vnl_fft_arbitrary_size< 1 >(sizes1) != EXIT_SUCCESS
+       || test_vnl_fft_arbitrary_size< 2 >(sizes2) != EXIT_SUCCESS
+       || test_vnl_fft_arbitrary_size< 3 >(sizes3) != EXIT_SUCCESS )
+    {
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
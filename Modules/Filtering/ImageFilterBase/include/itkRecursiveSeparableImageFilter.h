@@ -20,6 +20,7 @@
 
 #include "itkInPlaceImageFilter.h"
 #include "itkNumericTraits.h"
+#include "itkProgressReporter.h"
 
 namespace itk
 {
@@ -93,6 +94,31 @@ public:
   /** Get Input Image. */
   const TInputImage * GetInputImage(void);
 
+  /** Number of lines filtered together by ThreadedGenerateData(), for
+   * lines of ln pixels. */
+  unsigned int GetNumberOfLinesPerBlock(unsigned int ln) const;
+
+  /** Set up the coefficients of the filter for the given spacing along
+   * Direction. BeforeThreadedGenerateData() does it for the spacing of the
+   * input image. */
+  void InitializeCoefficients(ScalarRealType spacing)
+  {
+    this->SetUp(spacing);
+  }
+
+  /** Filter along Direction the lines of "region", reading them from
+   * "input" and writing them to "output", which may share their buffer.
+   * The lines must run across the whole region along Direction. The tiles
+   * must hold GetNumberOfLinesPerBlock(ln) * ln values, ln being the
+   * number of pixels of the lines. This is the work done by each thread of
+   * the filter; it lets composite filters chain several directions on one
+   * buffer, one tile of the image at a time. InitializeCoefficients() must
+   * have been called. */
+  void FilterLinesInRegion(const TInputImage *input, TOutputImage *output,
+                           const OutputImageRegionType & region,
+                           RealType *inps, RealType *outs, RealType *scratch,
+                           ProgressReporter *progress = 0);
+
 protected:
   RecursiveSeparableImageFilter();
   virtual ~RecursiveSeparableImageFilter() {}
@@ -130,6 +156,16 @@ protected:
   void FilterDataArray(RealType *outs, const RealType *data, RealType *scratch,
                        unsigned int ln);
 
+  /** Apply the Recursive Filter to a block of numberOfLines lines at
+   * once. The samples of the lines are interleaved: sample i of line l is
+   * at position i * numberOfLines + l of "outs", "data" and "scratch",
+   * which are ln * numberOfLines long. The innermost loops run across the
+   * lines, so that they are vectorized when RealType is a scalar. Each line
+   * gets exactly the same result as with FilterDataArray(). */
+  void FilterDataBlock(RealType *outs, const RealType *data, RealType *scratch,
+                       unsigned int ln, unsigned int numberOfLines);
+
+
 protected:
   /** Causal coefficients that multiply the input data. */
   ScalarRealType m_N0;
@@ -20,7 +20,7 @@
 
 #include "itkRecursiveSeparableImageFilter.h"
 #include "itkObjectFactory.h"
-#include "itkImageLinearIteratorWithIndex.h"
+#include "itkImageRegionIterator.h"
 #include "itkProgressReporter.h"
 #include <new>
 
@@ -152,6 +152,159 @@ RecursiveSeparableImageFilter< TInputImage, TOutputImage >
     }
 }
 
+/**
+ * Apply Recursive Filter to a block of interleaved lines
+ */
+template< typename TInputImage, typename TOutputImage >
+void
+RecursiveSeparableImageFilter< TInputImage, TOutputImage >
+::FilterDataBlock(RealType *outs, const RealType *data,
+                  RealType *scratch, unsigned int ln, unsigned int numberOfLines)
+{
+  const unsigned int nl = numberOfLines;
+
+  // Local copies of the coefficients: the compiler cannot otherwise assume
+  // that they are not modified by the stores in the inner loops
+  const ScalarRealType n0 = m_N0;
+  const ScalarRealType n1 = m_N1;
+  const ScalarRealType n2 = m_N2;
+  const ScalarRealType n3 = m_N3;
+  const ScalarRealType d1 = m_D1;
+  const ScalarRealType d2 = m_D2;
+  const ScalarRealType d3 = m_D3;
+  const ScalarRealType d4 = m_D4;
+  const ScalarRealType m1 = m_M1;
+  const ScalarRealType m2 = m_M2;
+  const ScalarRealType m3 = m_M3;
+  const ScalarRealType m4 = m_M4;
+  const ScalarRealType bn1 = m_BN1;
+  const ScalarRealType bn2 = m_BN2;
+  const ScalarRealType bn3 = m_BN3;
+  const ScalarRealType bn4 = m_BN4;
+  const ScalarRealType bm1 = m_BM1;
+  const ScalarRealType bm2 = m_BM2;
+  const ScalarRealType bm3 = m_BM3;
+  const ScalarRealType bm4 = m_BM4;
+
+  /**
+   * Causal direction pass
+   */
+  for ( unsigned int l = 0; l < nl; l++ )
+    {
+    const RealType *dt = data + l;
+    RealType       *sc = scratch + l;
+
+    // this value is assumed to exist from the border to infinity.
+    const RealType outV1 = dt[0];
+
+    sc[0]      = RealType(outV1      * n0 +      outV1 * n1 + outV1      * n2 + outV1 * n3);
+    sc[nl]     = RealType(dt[nl]     * n0 +      outV1 * n1 + outV1      * n2 + outV1 * n3);
+    sc[2 * nl] = RealType(dt[2 * nl] * n0 + dt[nl]     * n1 + outV1      * n2 + outV1 * n3);
+    sc[3 * nl] = RealType(dt[3 * nl] * n0 + dt[2 * nl] * n1 + dt[nl]     * n2 + outV1 * n3);
+
+    sc[0]      -= RealType(outV1      * bn1 + outV1      * bn2 + outV1  * bn3 + outV1 * bn4);
+    sc[nl]     -= RealType(sc[0]      * d1  + outV1      * bn2 + outV1  * bn3 + outV1 * bn4);
+    sc[2 * nl] -= RealType(sc[nl]     * d1  + sc[0]      * d2  + outV1  * bn3 + outV1 * bn4);
+    sc[3 * nl] -= RealType(sc[2 * nl] * d1  + sc[nl]     * d2  + sc[0]  * d3  + outV1 * bn4);
+    }
+
+  for ( unsigned int i = 4; i < ln; i++ )
+    {
+    const RealType *dt0 = data + i * nl;
+    const RealType *dt1 = dt0 - nl;
+    const RealType *dt2 = dt1 - nl;
+    const RealType *dt3 = dt2 - nl;
+    RealType       *sc0 = scratch + i * nl;
+    const RealType *sc1 = sc0 - nl;
+    const RealType *sc2 = sc1 - nl;
+    const RealType *sc3 = sc2 - nl;
+    const RealType *sc4 = sc3 - nl;
+    for ( unsigned int l = 0; l < nl; l++ )
+      {
+      sc0[l]  = RealType(dt0[l] * n0 + dt1[l] * n1 + dt2[l] * n2 + dt3[l] * n3);
+      sc0[l] -= RealType(sc1[l] * d1 + sc2[l] * d2 + sc3[l] * d3 + sc4[l] * d4);
+      }
+    }
+
+  const unsigned int size = ln * nl;
+  for ( unsigned int k = 0; k < size; k++ )
+    {
+    outs[k] = scratch[k];
+    }
+
+  /**
+   * AntiCausal direction pass
+   */
+  for ( unsigned int l = 0; l < nl; l++ )
+    {
+    const RealType *dt = data + ( ln - 1 ) * nl + l;
+    RealType       *sc = scratch + ( ln - 1 ) * nl + l;
+
+    // this value is assumed to exist from the border to infinity.
+    const RealType outV2 = dt[0];
+
+    *( sc )          = RealType(outV2          * m1 + outV2          * m2 + outV2          * m3 + outV2 * m4);
+    *( sc - nl )     = RealType(*( dt )        * m1 + outV2          * m2 + outV2          * m3 + outV2 * m4);
+    *( sc - 2 * nl ) = RealType(*( dt - nl )   * m1 + *( dt )        * m2 + outV2          * m3 + outV2 * m4);
+    *( sc - 3 * nl ) = RealType(*( dt - 2 * nl ) * m1 + *( dt - nl ) * m2 + *( dt )        * m3 + outV2 * m4);
+
+    *( sc )          -= RealType(outV2           * bm1 + outV2          * bm2 + outV2  * bm3 + outV2 * bm4);
+    *( sc - nl )     -= RealType(*( sc )         * d1  + outV2          * bm2 + outV2  * bm3 + outV2 * bm4);
+    *( sc - 2 * nl ) -= RealType(*( sc - nl )    * d1  + *( sc )        * d2  + outV2  * bm3 + outV2 * bm4);
+    *( sc - 3 * nl ) -= RealType(*( sc - 2 * nl ) * d1 + *( sc - nl )   * d2  + *( sc ) * d3 + outV2 * bm4);
+    }
+
+  for ( unsigned int i = ln - 4; i > 0; i-- )
+    {
+    RealType       *sc0 = scratch + ( i - 1 ) * nl;
+    const RealType *sc1 = sc0 + nl;
+    const RealType *sc2 = sc1 + nl;
+    const RealType *sc3 = sc2 + nl;
+    const RealType *sc4 = sc3 + nl;
+    const RealType *dt1 = data + i * nl;
+    const RealType *dt2 = dt1 + nl;
+    const RealType *dt3 = dt2 + nl;
+    const RealType *dt4 = dt3 + nl;
+    for ( unsigned int l = 0; l < nl; l++ )
+      {
+      sc0[l]  = RealType(dt1[l] * m1 + dt2[l] * m2 + dt3[l] * m3 + dt4[l] * m4);
+      sc0[l] -= RealType(sc1[l] * d1 + sc2[l] * d2 + sc3[l] * d3 + sc4[l] * d4);
+      }
+    }
+
+  /**
+   * Roll the antiCausal part into the output
+   */
+  for ( unsigned int k = 0; k < size; k++ )
+    {
+    outs[k] += scratch[k];
+    }
+}
+
+template< typename TInputImage, typename TOutputImage >
+unsigned int
+RecursiveSeparableImageFilter< TInputImage, TOutputImage >
+::GetNumberOfLinesPerBlock(unsigned int ln) const
+{
+  // The input, output and scratch tiles of a block should stay in a
+  // typical L2 cache.
+  const unsigned int maximumNumberOfLines = 16;
+  const SizeValueType tileBudget = 256 * 1024;
+
+  const SizeValueType lineSize = 3 * static_cast< SizeValueType >( ln ) * sizeof( RealType );
+  SizeValueType numberOfLines = tileBudget / lineSize;
+
+  if ( numberOfLines > maximumNumberOfLines )
+    {
+    numberOfLines = maximumNumberOfLines;
+    }
+  if ( numberOfLines < 1 )
+    {
+    numberOfLines = 1;
+    }
+  return static_cast< unsigned int >( numberOfLines );
+}
+
 //
 // we need all of the image in just the "Direction" we are separated into
 //
@@ -278,32 +431,21 @@ RecursiveSeparableImageFilter< TInputImage, TOutputImage >
 
 /**
  * Compute Recursive filter
- * line by line in one of the dimensions
+ * in blocks of adjacent lines in one of the dimensions
  */
 template< typename TInputImage, typename TOutputImage >
 void
 RecursiveSeparableImageFilter< TInputImage, TOutputImage >
 ::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId)
 {
-  typedef typename TOutputImage::PixelType OutputPixelType;
-
-  typedef ImageLinearConstIteratorWithIndex< TInputImage > InputConstIteratorType;
-  typedef ImageLinearIteratorWithIndex< TOutputImage >     OutputIteratorType;
-
-  typedef ImageRegion< TInputImage::ImageDimension > RegionType;
-
   typename TInputImage::ConstPointer inputImage( this->GetInputImage () );
   typename TOutputImage::Pointer     outputImage( this->GetOutput() );
 
-  RegionType region = outputRegionForThread;
-
-  InputConstIteratorType inputIterator(inputImage,  region);
-  OutputIteratorType     outputIterator(outputImage, region);
-
-  inputIterator.SetDirection(this->m_Direction);
-  outputIterator.SetDirection(this->m_Direction);
+  const unsigned int ln = outputRegionForThread.GetSize()[this->m_Direction];
 
-  const unsigned int ln = region.GetSize()[this->m_Direction];
+  // The samples of the lines of a block are interleaved in these tiles
+  const SizeValueType tileSize =
+    static_cast< SizeValueType >( ln ) * this->GetNumberOfLinesPerBlock(ln);
 
   RealType *inps = 0;
   RealType *outs = 0;
@@ -311,7 +453,7 @@ RecursiveSeparableImageFilter< TInputImage, TOutputImage >
 
   try
     {
-    inps = new RealType[ln];
+    inps = new RealType[tileSize];
     }
   catch ( std::bad_alloc & )
     {
@@ -320,7 +462,7 @@ RecursiveSeparableImageFilter< TInputImage, TOutputImage >
 
   try
     {
-    outs = new RealType[ln];
+    outs = new RealType[tileSize];
     }
   catch ( std::bad_alloc & )
     {
@@ -330,7 +472,7 @@ RecursiveSeparableImageFilter< TInputImage, TOutputImage >
 
   try
     {
-    scratch = new RealType[ln];
+    scratch = new RealType[tileSize];
     }
   catch ( std::bad_alloc & )
     {
@@ -339,41 +481,13 @@ RecursiveSeparableImageFilter< TInputImage, TOutputImage >
     itkExceptionMacro("Problem allocating memory for internal computations");
     }
 
-  inputIterator.GoToBegin();
-  outputIterator.GoToBegin();
-
-  const typename TInputImage::OffsetValueType * offsetTable = inputImage->GetOffsetTable();
-
-  const unsigned int numberOfLinesToProcess = offsetTable[TInputImage::ImageDimension] / ln;
-  ProgressReporter   progress(this, threadId, numberOfLinesToProcess, 10);
+  const SizeValueType numberOfLinesToProcess = outputRegionForThread.GetNumberOfPixels() / ln;
+  ProgressReporter    progress(this, threadId, numberOfLinesToProcess, 10);
 
   try  // this try is intended to catch an eventual AbortException.
     {
-    while ( !inputIterator.IsAtEnd() && !outputIterator.IsAtEnd() )
-      {
-      unsigned int i = 0;
-      while ( !inputIterator.IsAtEndOfLine() )
-        {
-        inps[i++]      = inputIterator.Get();
-        ++inputIterator;
-        }
-
-      this->FilterDataArray(outs, inps, scratch, ln);
-
-      unsigned int j = 0;
-      while ( !outputIterator.IsAtEndOfLine() )
-        {
-        outputIterator.Set( static_cast< OutputPixelType >( outs[j++] ) );
-        ++outputIterator;
-        }
-
-      inputIterator.NextLine();
-      outputIterator.NextLine();
-
-      // Although the method name is CompletedPixel(),
-      // this is being called after each line is processed
-      progress.CompletedPixel();
-      }
+    this->FilterLinesInRegion(inputImage, outputImage, outputRegionForThread,
+                              inps, outs, scratch, &progress);
     }
   catch ( ProcessAborted  & )
     {
@@ -397,6 +511,149 @@ RecursiveSeparableImageFilter< TInputImage, TOutputImage >
   delete[] scratch;
 }
 
+template< typename TInputImage, typename TOutputImage >
+void
+RecursiveSeparableImageFilter< TInputImage, TOutputImage >
+::FilterLinesInRegion(const TInputImage *input, TOutputImage *output,
+                      const OutputImageRegionType & region,
+                      RealType *inps, RealType *outs, RealType *scratch,
+                      ProgressReporter *progress)
+{
+  typedef typename TOutputImage::PixelType OutputPixelType;
+
+  typedef ImageRegionConstIterator< TInputImage > InputConstIteratorType;
+  typedef ImageRegionIterator< TOutputImage >     OutputIteratorType;
+
+  typedef ImageRegion< TInputImage::ImageDimension > RegionType;
+  typedef typename RegionType::IndexType             IndexType;
+  typedef typename RegionType::SizeType              SizeType;
+
+  const unsigned int imageDimension = TInputImage::ImageDimension;
+
+  const unsigned int ln = region.GetSize()[this->m_Direction];
+
+  // The lines of a block are adjacent along the blocking axis: the fastest
+  // axis unless the lines themselves run along it. A block is then read
+  // and written as a small region, which visits the pixels in memory order.
+  unsigned int blockAxis = 0;
+  if ( this->m_Direction == 0 )
+    {
+    blockAxis = 1;
+    }
+
+  unsigned int numberOfLinesPerBlock = 1;
+  SizeType     numberOfBlocks = region.GetSize();
+  numberOfBlocks[this->m_Direction] = 1;
+  if ( blockAxis < imageDimension )
+    {
+    numberOfLinesPerBlock = this->GetNumberOfLinesPerBlock(ln);
+    numberOfBlocks[blockAxis] =
+      ( region.GetSize()[blockAxis] + numberOfLinesPerBlock - 1 ) / numberOfLinesPerBlock;
+    }
+
+  SizeValueType totalNumberOfBlocks = 1;
+  for ( unsigned int d = 0; d < imageDimension; d++ )
+    {
+    totalNumberOfBlocks *= numberOfBlocks[d];
+    }
+
+  // When the lines are along an axis slower than the blocking axis, the
+  // region iterators visit a block sample by sample; otherwise line by line.
+  const bool samplesAreOuter = ( this->m_Direction > blockAxis );
+
+  for ( SizeValueType b = 0; b < totalNumberOfBlocks; b++ )
+    {
+    // Index of the first pixel of the block
+    IndexType     blockIndex = region.GetIndex();
+    SizeValueType remainder = b;
+    for ( unsigned int d = 0; d < imageDimension; d++ )
+      {
+      const SizeValueType coordinate = remainder % numberOfBlocks[d];
+      remainder /= numberOfBlocks[d];
+      if ( d == blockAxis )
+        {
+        blockIndex[d] += static_cast< IndexValueType >( coordinate * numberOfLinesPerBlock );
+        }
+      else
+        {
+        blockIndex[d] += static_cast< IndexValueType >( coordinate );
+        }
+      }
+
+    SizeType blockSize;
+    blockSize.Fill(1);
+    blockSize[this->m_Direction] = ln;
+    unsigned int nl = 1;
+    if ( blockAxis < imageDimension )
+      {
+      const IndexValueType regionEnd = region.GetIndex()[blockAxis]
+                                       + static_cast< IndexValueType >( region.GetSize()[blockAxis] );
+      nl = static_cast< unsigned int >( regionEnd - blockIndex[blockAxis] );
+      if ( nl > numberOfLinesPerBlock )
+        {
+        nl = numberOfLinesPerBlock;
+        }
+      blockSize[blockAxis] = nl;
+      }
+
+    RegionType blockRegion(blockIndex, blockSize);
+
+    InputConstIteratorType inputIterator(input,  blockRegion);
+    if ( samplesAreOuter )
+      {
+      for ( unsigned int k = 0; k < ln * nl; k++ )
+        {
+        inps[k] = inputIterator.Get();
+        ++inputIterator;
+        }
+      }
+    else
+      {
+      for ( unsigned int l = 0; l < nl; l++ )
+        {
+        for ( unsigned int i = 0; i < ln; i++ )
+          {
+          inps[i * nl + l] = inputIterator.Get();
+          ++inputIterator;
+          }
+        }
+      }
+
+    this->FilterDataBlock(outs, inps, scratch, ln, nl);
+
+    OutputIteratorType outputIterator(output, blockRegion);
+    if ( samplesAreOuter )
+      {
+      for ( unsigned int k = 0; k < ln * nl; k++ )
+        {
+        outputIterator.Set( static_cast< OutputPixelType >( outs[k] ) );
+        ++outputIterator;
+        }
+      }
+    else
+      {
+      for ( unsigned int l = 0; l < nl; l++ )
+        {
+        for ( unsigned int i = 0; i < ln; i++ )
+          {
+          outputIterator.Set( static_cast< OutputPixelType >( outs[i * nl + l] ) );
+          ++outputIterator;
+          }
+        }
+      }
+
+    if ( progress )
+      {
+      // Although the method name is CompletedPixel(),
+      // this is being called after each line is processed
+      for ( unsigned int l = 0; l < nl; l++ )
+        {
+        progress->CompletedPixel();
+        }
+      }
+    }
+}
+
 template< typename TInputImage, typename TOutputImage >
 void
 RecursiveSeparableImageFilter< TInputImage, TOutputImage >
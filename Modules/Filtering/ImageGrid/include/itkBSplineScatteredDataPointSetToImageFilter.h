@@ -83,6 +83,14 @@ namespace itk
  * and SetSize() functions.  For a 2-D deformation on 2-D points, the output is a 2-D image
  * where each voxel contains the approximated (dx, dy) vector.
  *
+ * The fitting, the evaluation of the residuals of the points between the
+ * fitting levels, the refinement of the control point lattice and the
+ * reconstruction of the output are multi-threaded.  The output supports
+ * streaming: only the requested region of the output is allocated and
+ * reconstructed, and the control point lattice is fitted again only when
+ * the filter, the input or the point weights have been modified, so the
+ * pieces of a streamed output share one fitting.
+ *
  * The parameterization must be specified using SetPoint, where the actual
  * coordinates of the point are set via SetPointData. For example, to compute a
  * spline through the (ordered) 2D points (5,6) and (7,8), you should use:
@@ -323,6 +331,8 @@ protected:
 
   void PrintSelf(std::ostream & os, Indent indent) const;
 
+  void GenerateOutputInformation();
+
   void ThreadedGenerateData( const RegionType &, ThreadIdType );
 
   void BeforeThreadedGenerateData();
@@ -339,17 +349,37 @@ private:
   BSplineScatteredDataPointSetToImageFilter( const Self & );
   void operator=( const Self & );
 
+  /**
+   * Fit the control point lattice to the points at all the fitting levels.
+   */
+  void GenerateControlPointLattice();
+
   /**
    * Function used to propagate the fitting solution at one fitting level
    * to the next level with the mesh resolution doubled.
    */
   void RefineControlPointLattice();
 
+  /**
+   * Refine the control points of the given region of the refined lattice.
+   * Each control point with even indices sets the control points of its
+   * 2^ImageDimension neighborhood.
+   */
+  void ThreadedRefineControlPointLattice( const RegionType &,
+    PointDataImageType *, const ArrayType & );
+
   /**
    * Determine the residuals after fitting to one level.
    */
   void UpdatePointSet();
 
+  /**
+   * Evaluate the control point lattice at the points [start, end) of the
+   * point set.
+   */
+  void ThreadedUpdatePointSet( const SizeValueType, const SizeValueType,
+    std::vector<PointDataType> & );
+
   /**
    * This function is not used as it requires an evaluation of all
    * (SplineOrder+1)^ImageDimensions B-spline weights for each evaluation.
@@ -385,6 +415,31 @@ private:
    */
   IndexType NumberToIndex( const unsigned int, const SizeType );
 
+  /**
+   * Structure passed to the threads that refine the control point lattice.
+   */
+  struct RefineControlPointLatticeThreadStruct
+  {
+    Self *               Filter;
+    PointDataImageType * RefinedLattice;
+    ArrayType            NumberOfNewControlPoints;
+    unsigned int         SplitAxis;
+  };
+
+  /**
+   * Structure passed to the threads that evaluate the control point lattice
+   * at the points.
+   */
+  struct UpdatePointSetThreadStruct
+  {
+    Self *                     Filter;
+    std::vector<PointDataType> OutputPointData;
+  };
+
+  static ITK_THREAD_RETURN_TYPE RefineControlPointLatticeThreaderCallback( void * );
+
+  static ITK_THREAD_RETURN_TYPE UpdatePointSetThreaderCallback( void * );
+
   bool                                         m_DoMultilevel;
   bool                                         m_GenerateOutputImage;
   bool                                         m_UsePointWeights;
@@ -418,6 +473,7 @@ private:
 
   RealType                                     m_BSplineEpsilon;
   bool                                         m_IsFittingComplete;
+  TimeStamp                                    m_FittingTime;
 };
 } // end namespace itk
 
@@ -206,6 +206,26 @@ BSplineScatteredDataPointSetToImageFilter<TInputPointSet, TOutputImage>
   this->Modified();
 }
 
+template<class TInputPointSet, class TOutputImage>
+void
+BSplineScatteredDataPointSetToImageFilter<TInputPointSet, TOutputImage>
+::GenerateOutputInformation()
+{
+  ImageType *output = this->GetOutput();
+
+  typename RegionType::IndexType index;
+  index.Fill( 0 );
+
+  RegionType region;
+  region.SetSize( this->m_Size );
+  region.SetIndex( index );
+
+  output->SetOrigin( this->m_Origin );
+  output->SetSpacing( this->m_Spacing );
+  output->SetDirection( this->m_Direction );
+  output->SetLargestPossibleRegion( region );
+}
+
 template<class TInputPointSet, class TOutputImage>
 void
 BSplineScatteredDataPointSetToImageFilter<TInputPointSet, TOutputImage>
@@ -227,11 +247,49 @@ BSplineScatteredDataPointSetToImageFilter<TInputPointSet, TOutputImage>
       }
     }
 
-  this->GetOutput()->SetOrigin( this->m_Origin );
-  this->GetOutput()->SetSpacing( this->m_Spacing );
-  this->GetOutput()->SetDirection( this->m_Direction );
-  this->GetOutput()->SetRegions( this->m_Size );
-  this->GetOutput()->Allocate();
+  /**
+   * Only the requested region of the output is allocated, so that the
+   * output can be streamed.
+   */
+  ImageType *output = this->GetOutput();
+  output->SetBufferedRegion( output->GetRequestedRegion() );
+  output->Allocate();
+
+  /**
+   * The pieces of a streamed output share the control point lattice, which
+   * is fitted again only if the filter, the input or the point weights have
+   * been modified since.
+   */
+  if( !this->m_IsFittingComplete ||
+    this->GetMTime() > this->m_FittingTime.GetMTime() ||
+    this->GetInput()->GetMTime() > this->m_FittingTime.GetMTime() ||
+    this->m_PointWeights->GetMTime() > this->m_FittingTime.GetMTime() )
+    {
+    this->GenerateControlPointLattice();
+    }
+
+  if( this->m_GenerateOutputImage )
+    {
+    typename ImageSource<ImageType>::ThreadStruct str3;
+    str3.Filter = this;
+
+    this->GetMultiThreader()->SetNumberOfThreads( this->GetNumberOfThreads() );
+    this->GetMultiThreader()->SetSingleMethod( this->ThreaderCallback, &str3 );
+
+//    this->BeforeThreadedGenerateData();
+    this->GetMultiThreader()->SingleMethodExecute();
+//    this->AfterThreadedGenerateData();
+    }
+
+  this->SetPhiLatticeParametricDomainParameters();
+}
+
+template<class TInputPointSet, class TOutputImage>
+void
+BSplineScatteredDataPointSetToImageFilter<TInputPointSet, TOutputImage>
+::GenerateControlPointLattice()
+{
+  this->m_IsFittingComplete = false;
 
   /**
    * Perform some error checking on the input
@@ -420,21 +478,7 @@ BSplineScatteredDataPointSetToImageFilter<TInputPointSet, TOutputImage>
     }
 
   this->m_IsFittingComplete = true;
-
-  if( this->m_GenerateOutputImage )
-    {
-    typename ImageSource<ImageType>::ThreadStruct str3;
-    str3.Filter = this;
-
-    this->GetMultiThreader()->SetNumberOfThreads( this->GetNumberOfThreads() );
-    this->GetMultiThreader()->SetSingleMethod( this->ThreaderCallback, &str3 );
-
-//    this->BeforeThreadedGenerateData();
-    this->GetMultiThreader()->SingleMethodExecute();
-//    this->AfterThreadedGenerateData();
-    }
-
-  this->SetPhiLatticeParametricDomainParameters();
+  this->m_FittingTime.Modified();
 }
 
 template<class TInputPointSet, class TOutputImage>
@@ -710,12 +754,7 @@ BSplineScatteredDataPointSetToImageFilter<TInputPointSet, TOutputImage>
     collapsedPhiLattices[i]->SetRegions( size );
     collapsedPhiLattices[i]->Allocate();
     }
-  typedef ImageDuplicator<PointDataImageType> ImageDuplicatorType;
-  typename ImageDuplicatorType::Pointer duplicator = ImageDuplicatorType::New();
-  duplicator->SetInputImage( this->m_PhiLattice );
-  duplicator->Update();
-
-  collapsedPhiLattices[ImageDimension] = duplicator->GetOutput();
+  collapsedPhiLattices[ImageDimension] = this->m_PhiLattice;
 
   ArrayType totalNumberOfSpans;
   for( unsigned int i = 0; i < ImageDimension; i++ )
@@ -736,8 +775,10 @@ BSplineScatteredDataPointSetToImageFilter<TInputPointSet, TOutputImage>
   FixedArray<RealType, ImageDimension> currentU;
   currentU.Fill( -1 );
 
+  // The parametric coordinates are relative to the whole output, of which
+  // the region may be a streamed piece.
   typename ImageType::IndexType startIndex =
-    this->GetOutput()->GetRequestedRegion().GetIndex();
+    this->GetOutput()->GetLargestPossibleRegion().GetIndex();
   typename PointDataImageType::IndexType startPhiIndex =
     this->m_PhiLattice->GetLargestPossibleRegion().GetIndex();
 
@@ -903,6 +944,90 @@ BSplineScatteredDataPointSetToImageFilter<TInputPointSet, TOutputImage>
   data.Fill( 0.0 );
   refinedLattice->FillBuffer( data );
 
+  /**
+   * Each control point with even indices sets the control points of its
+   * 2^ImageDimension neighborhood, so the threads split the lattice at even
+   * indices along the last dimension that is not closed.  A closed dimension
+   * of odd size wraps around onto its first control points, in which case
+   * the lattice is refined on one thread.
+   */
+  RefineControlPointLatticeThreadStruct str;
+  str.Filter = this;
+  str.RefinedLattice = refinedLattice;
+  str.NumberOfNewControlPoints = NumberOfNewControlPoints;
+  str.SplitAxis = ImageDimension - 1;
+  for( int i = ImageDimension - 1; i >= 0; i-- )
+    {
+    if( !this->m_CloseDimension[i] )
+      {
+      str.SplitAxis = i;
+      break;
+      }
+    }
+
+  ThreadIdType numberOfThreads = this->GetNumberOfThreads();
+  const SizeValueType numberOfEvenIndices = ( size[str.SplitAxis] + 1 ) / 2;
+  if( numberOfThreads > numberOfEvenIndices )
+    {
+    numberOfThreads = numberOfEvenIndices;
+    }
+  if( this->m_CloseDimension[str.SplitAxis] && size[str.SplitAxis] % 2 )
+    {
+    numberOfThreads = 1;
+    }
+
+  this->GetMultiThreader()->SetNumberOfThreads( numberOfThreads );
+  this->GetMultiThreader()->SetSingleMethod(
+    this->RefineControlPointLatticeThreaderCallback, &str );
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  this->m_PsiLattice = refinedLattice;
+}
+
+template<class TInputPointSet, class TOutputImage>
+ITK_THREAD_RETURN_TYPE
+BSplineScatteredDataPointSetToImageFilter<TInputPointSet, TOutputImage>
+::RefineControlPointLatticeThreaderCallback( void *arg )
+{
+  MultiThreader::ThreadInfoStruct *info =
+    static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  RefineControlPointLatticeThreadStruct *str =
+    static_cast<RefineControlPointLatticeThreadStruct *>( info->UserData );
+
+  const ThreadIdType threadId = info->ThreadID;
+  const ThreadIdType numberOfThreads = info->NumberOfThreads;
+  const unsigned int splitAxis = str->SplitAxis;
+
+  /**
+   * Split the even indices of the split axis among the threads.
+   */
+  RegionType region = str->RefinedLattice->GetLargestPossibleRegion();
+  const SizeValueType splitSize = region.GetSize()[splitAxis];
+  const SizeValueType numberOfEvenIndices = ( splitSize + 1 ) / 2;
+  const SizeValueType start = 2 * ( numberOfEvenIndices * threadId / numberOfThreads );
+  const SizeValueType end = vnl_math_min( splitSize,
+    2 * ( numberOfEvenIndices * ( threadId + 1 ) / numberOfThreads ) );
+  if( start < end )
+    {
+    typename RegionType::IndexType index = region.GetIndex();
+    typename RegionType::SizeType size = region.GetSize();
+    index[splitAxis] += start;
+    size[splitAxis] = end - start;
+    region.SetIndex( index );
+    region.SetSize( size );
+    str->Filter->ThreadedRefineControlPointLattice( region,
+      str->RefinedLattice, str->NumberOfNewControlPoints );
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template<class TInputPointSet, class TOutputImage>
+void
+BSplineScatteredDataPointSetToImageFilter<TInputPointSet, TOutputImage>
+::ThreadedRefineControlPointLattice( const RegionType & region,
+  PointDataImageType *refinedLattice, const ArrayType & NumberOfNewControlPoints )
+{
   typename PointDataImageType::IndexType idx;
   typename PointDataImageType::IndexType idxPsi;
   typename PointDataImageType::IndexType tmp;
@@ -910,6 +1035,7 @@ BSplineScatteredDataPointSetToImageFilter<TInputPointSet, TOutputImage>
   typename PointDataImageType::IndexType off;
   typename PointDataImageType::IndexType offPsi;
   typename PointDataImageType::RegionType::SizeType sizePsi;
+  typename PointDataImageType::RegionType::SizeType size;
 
   size.Fill(2);
   unsigned int N = 1;
@@ -919,8 +1045,7 @@ BSplineScatteredDataPointSetToImageFilter<TInputPointSet, TOutputImage>
     sizePsi[i] = this->m_SplineOrder[i] + 1;
     }
 
-  ImageRegionIteratorWithIndex< PointDataImageType >
-  It( refinedLattice, refinedLattice->GetLargestPossibleRegion() );
+  ImageRegionIteratorWithIndex< PointDataImageType > It( refinedLattice, region );
 
   It.GoToBegin();
   while( !It.IsAtEnd() )
@@ -1016,18 +1141,73 @@ BSplineScatteredDataPointSetToImageFilter<TInputPointSet, TOutputImage>
         }
       }
     }
-
-  typedef ImageDuplicator<PointDataImageType> ImageDuplicatorType;
-  typename ImageDuplicatorType::Pointer duplicator = ImageDuplicatorType::New();
-  duplicator->SetInputImage( refinedLattice );
-  duplicator->Update();
-  this->m_PsiLattice = duplicator->GetOutput();
 }
 
 template<class TInputPointSet, class TOutputImage>
 void
 BSplineScatteredDataPointSetToImageFilter<TInputPointSet, TOutputImage>
 ::UpdatePointSet()
+{
+  const SizeValueType numberOfPoints = this->m_InputPointData->Size();
+  if( numberOfPoints == 0 )
+    {
+    return;
+    }
+
+  /**
+   * Each thread evaluates the current lattice at a contiguous block of the
+   * points with its own collapsed lattices.
+   */
+  UpdatePointSetThreadStruct str;
+  str.Filter = this;
+  str.OutputPointData.resize( numberOfPoints );
+
+  ThreadIdType numberOfThreads = this->GetNumberOfThreads();
+  if( numberOfThreads > numberOfPoints )
+    {
+    numberOfThreads = numberOfPoints;
+    }
+
+  this->GetMultiThreader()->SetNumberOfThreads( numberOfThreads );
+  this->GetMultiThreader()->SetSingleMethod(
+    this->UpdatePointSetThreaderCallback, &str );
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  for( SizeValueType n = 0; n < numberOfPoints; n++ )
+    {
+    this->m_OutputPointData->InsertElement( n, str.OutputPointData[n] );
+    }
+}
+
+template<class TInputPointSet, class TOutputImage>
+ITK_THREAD_RETURN_TYPE
+BSplineScatteredDataPointSetToImageFilter<TInputPointSet, TOutputImage>
+::UpdatePointSetThreaderCallback( void *arg )
+{
+  MultiThreader::ThreadInfoStruct *info =
+    static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  UpdatePointSetThreadStruct *str =
+    static_cast<UpdatePointSetThreadStruct *>( info->UserData );
+
+  const ThreadIdType threadId = info->ThreadID;
+  const ThreadIdType numberOfThreads = info->NumberOfThreads;
+  const SizeValueType numberOfPoints = str->OutputPointData.size();
+
+  const SizeValueType startPoint = numberOfPoints * threadId / numberOfThreads;
+  const SizeValueType endPoint =
+    numberOfPoints * ( threadId + 1 ) / numberOfThreads;
+
+  str->Filter->ThreadedUpdatePointSet( startPoint, endPoint,
+    str->OutputPointData );
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template<class TInputPointSet, class TOutputImage>
+void
+BSplineScatteredDataPointSetToImageFilter<TInputPointSet, TOutputImage>
+::ThreadedUpdatePointSet( const SizeValueType startPoint,
+  const SizeValueType endPoint, std::vector<PointDataType> & outputPointData )
 {
   PointDataImagePointer collapsedPhiLattices[ImageDimension + 1];
   for( unsigned int i = 0; i < ImageDimension; i++ )
@@ -1069,14 +1249,12 @@ BSplineScatteredDataPointSetToImageFilter<TInputPointSet, TOutputImage>
   typename PointDataImageType::IndexType startPhiIndex =
     this->m_PhiLattice->GetLargestPossibleRegion().GetIndex();
 
-  typename PointDataContainerType::ConstIterator ItIn =
-    this->m_InputPointData->Begin();
-  while( ItIn != this->m_InputPointData->End() )
+  for( SizeValueType n = startPoint; n < endPoint; n++ )
     {
     PointType point;
     point.Fill( 0.0 );
 
-    this->GetInput()->GetPoint( ItIn.Index(), &point );
+    this->GetInput()->GetPoint( n, &point );
 
     for( unsigned int i = 0; i < ImageDimension; i++ )
       {
@@ -1109,9 +1287,7 @@ BSplineScatteredDataPointSetToImageFilter<TInputPointSet, TOutputImage>
         break;
         }
       }
-    this->m_OutputPointData->InsertElement( ItIn.Index(),
-      collapsedPhiLattices[0]->GetPixel( startPhiIndex ) );
-    ++ItIn;
+    outputPointData[n] = collapsedPhiLattices[0]->GetPixel( startPhiIndex );
     }
 }
 
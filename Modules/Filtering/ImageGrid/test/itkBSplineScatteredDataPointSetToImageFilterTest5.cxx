@@ -0,0 +1,188 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkPointSet.h"
+#include "itkBSplineScatteredDataPointSetToImageFilter.h"
+#include "itkStreamingImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkTimeProbe.h"
+
+/**
+ * In this test, we approximate a 2-D scalar field sampled at random
+ * locations on one and on several threads, with an open and a closed
+ * parametric dimension.  The control point lattices and the outputs must
+ * agree up to the order in which the threads sum the fitted lattices, and
+ * the output must be identical when it is streamed in pieces.
+ */
+const unsigned int ParametricDimension = 2;
+const unsigned int DataDimension = 1;
+
+typedef double                                         RealType;
+typedef itk::Vector<RealType, DataDimension>           VectorType;
+typedef itk::Image<VectorType, ParametricDimension>    ImageType;
+typedef itk::PointSet<VectorType, ParametricDimension> PointSetType;
+
+typedef itk::BSplineScatteredDataPointSetToImageFilter
+  <PointSetType, ImageType> FilterType;
+
+static FilterType::Pointer
+CreateFilter( PointSetType *pointSet, bool closeDimension,
+  itk::ThreadIdType numberOfThreads )
+{
+  ImageType::SizeType size;
+  size.Fill( 150 );
+  ImageType::PointType origin;
+  origin.Fill( 0.0 );
+  ImageType::SpacingType spacing;
+  spacing.Fill( 1.0 );
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetSize( size );
+  filter->SetOrigin( origin );
+  filter->SetSpacing( spacing );
+  filter->SetInput( pointSet );
+  filter->SetNumberOfThreads( numberOfThreads );
+
+  filter->SetSplineOrder( 3 );
+  FilterType::ArrayType ncps;
+  ncps.Fill( 4 );
+  filter->SetNumberOfControlPoints( ncps );
+  filter->SetNumberOfLevels( 4 );
+
+  FilterType::ArrayType close;
+  close.Fill( 0 );
+  if( closeDimension )
+    {
+    close[0] = 1;
+    }
+  filter->SetCloseDimension( close );
+
+  return filter;
+}
+
+static bool
+CompareImages( const ImageType *image1, const ImageType *image2,
+  RealType tolerance )
+{
+  if( image1->GetLargestPossibleRegion() != image2->GetLargestPossibleRegion() )
+    {
+    return false;
+    }
+
+  itk::ImageRegionConstIterator<ImageType> It1( image1,
+    image1->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator<ImageType> It2( image2,
+    image2->GetLargestPossibleRegion() );
+  for( It1.GoToBegin(), It2.GoToBegin(); !It1.IsAtEnd(); ++It1, ++It2 )
+    {
+    if( vnl_math_abs( It1.Get()[0] - It2.Get()[0] ) > tolerance )
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+int itkBSplineScatteredDataPointSetToImageFilterTest5( int, char * [] )
+{
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator GeneratorType;
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize( 2012 );
+
+  PointSetType::Pointer pointSet = PointSetType::New();
+  for( unsigned int i = 0; i < 5000; i++ )
+    {
+    PointSetType::PointType point;
+    point[0] = generator->GetUniformVariate( 0.0, 149.0 );
+    point[1] = generator->GetUniformVariate( 0.0, 149.0 );
+    pointSet->SetPoint( i, point );
+
+    VectorType V;
+    V[0] = vcl_sin( 0.05 * point[0] ) * vcl_cos( 0.03 * point[1] );
+    pointSet->SetPointData( i, V );
+    }
+
+  for( unsigned int c = 0; c < 2; c++ )
+    {
+    const bool closeDimension = ( c == 1 );
+    std::cout << "Close dimension: " << closeDimension << std::endl;
+
+    FilterType::Pointer filter1 = CreateFilter( pointSet, closeDimension, 1 );
+    FilterType::Pointer filter4 = CreateFilter( pointSet, closeDimension, 4 );
+
+    itk::TimeProbe probe1;
+    itk::TimeProbe probe4;
+    try
+      {
+      probe1.Start();
+      filter1->Update();
+      probe1.Stop();
+
+      probe4.Start();
+      filter4->Update();
+      probe4.Stop();
+      }
+    catch( itk::ExceptionObject & excp )
+      {
+      std::cerr << excp << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    std::cout << "  1 thread:  " << probe1.GetMean() << " s" << std::endl;
+    std::cout << "  4 threads: " << probe4.GetMean() << " s" << std::endl;
+
+    if( !CompareImages( filter1->GetPhiLattice(), filter4->GetPhiLattice(), 1e-5 ) )
+      {
+      std::cerr << "The control point lattices differ." << std::endl;
+      return EXIT_FAILURE;
+      }
+    if( !CompareImages( filter1->GetOutput(), filter4->GetOutput(), 1e-5 ) )
+      {
+      std::cerr << "The outputs differ." << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    // Stream the output in pieces
+    FilterType::Pointer filterStreamed =
+      CreateFilter( pointSet, closeDimension, 4 );
+
+    typedef itk::StreamingImageFilter<ImageType, ImageType> StreamerType;
+    StreamerType::Pointer streamer = StreamerType::New();
+    streamer->SetInput( filterStreamed->GetOutput() );
+    streamer->SetNumberOfStreamDivisions( 5 );
+    try
+      {
+      streamer->Update();
+      }
+    catch( itk::ExceptionObject & excp )
+      {
+      std::cerr << excp << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    if( !CompareImages( filter4->GetOutput(), streamer->GetOutput(), 0.0 ) )
+      {
+      std::cerr << "The streamed output differs." << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -23,6 +23,7 @@
 #include "itkImageRegionIterator.h"
 #include "itkProgressReporter.h"
 #include <queue>
+#include <vector>
 
 //#define BASIC
 #define COPY
@@ -43,6 +44,9 @@ namespace itk
  * applications and efficient algorithms" -- IEEE Transactions on
  * Image processing, Vol 2, No 2, pp 176-201, April 1993
  *
+ * By default, the propagation runs on several threads: see
+ * SetParallelPropagation().
+ *
  * \author Richard Beare. Department of Medicine, Monash University,
  * Melbourne, Australia.
  *
@@ -135,6 +139,20 @@ public:
   itkSetMacro(UseInternalCopy, bool);
   itkGetConstReferenceMacro(UseInternalCopy, bool);
   itkBooleanMacro(UseInternalCopy);
+
+  /**
+   * Run the propagation on several threads. The image is split in
+   * slabs along its last dimension, one per thread, and the raster,
+   * anti-raster and queue based propagation is run on each slab
+   * independently. The values are then propagated across the slab
+   * boundaries and the queues of the slabs run again, until nothing
+   * changes. The result does not depend on the number of threads.
+   * The parallel propagation works on padded copies of the images, so
+   * it is only used when UseInternalCopy is on. Default is on.
+   */
+  itkSetMacro(ParallelPropagation, bool);
+  itkGetConstReferenceMacro(ParallelPropagation, bool);
+  itkBooleanMacro(ParallelPropagation);
 protected:
   ReconstructionImageFilter();
   ~ReconstructionImageFilter() {}
@@ -150,6 +168,9 @@ protected:
 
   void GenerateData();
 
+  /** The implementation used when ParallelPropagation is on. */
+  void ParallelGenerateData();
+
   /**
    * the value of the border - used in boundary condition.
    */
@@ -160,6 +181,7 @@ private:
 
   bool m_FullyConnected;
   bool m_UseInternalCopy;
+  bool m_ParallelPropagation;
 
   typedef typename itk::NeighborhoodAlgorithm::ImageBoundaryFacesCalculator< OutputImageType > FaceCalculatorType;
 
@@ -173,6 +195,107 @@ private:
   typedef typename InputImageType::IndexType                InIndexType;
   typedef ConstShapedNeighborhoodIterator< InputImageType > CNInputIterator;
   typedef ShapedNeighborhoodIterator< OutputImageType >     NOutputIterator;
+
+  typedef typename InputImageType::OffsetValueType OffsetValueType;
+  typedef std::vector< InputImagePixelType >       BufferType;
+  typedef std::vector< OffsetValueType >           OffsetListType;
+
+  /** A queue of buffer offsets, stored in a ring that only grows when
+   * it is full. */
+  class OffsetFifo
+  {
+public:
+    OffsetFifo():m_Head(0), m_Size(0) {}
+
+    void Reserve(SizeValueType capacity)
+    {
+      if ( capacity > m_Ring.size() )
+        {
+        OffsetListType ring(capacity);
+        for ( SizeValueType i = 0; i < m_Size; ++i )
+          {
+          ring[i] = m_Ring[( m_Head + i ) % m_Ring.size()];
+          }
+        m_Ring.swap(ring);
+        m_Head = 0;
+        }
+    }
+
+    void Push(OffsetValueType offset)
+    {
+      if ( m_Size == m_Ring.size() )
+        {
+        this->Reserve( 2 * m_Ring.size() + 64 );
+        }
+      SizeValueType tail = m_Head + m_Size;
+      if ( tail >= m_Ring.size() )
+        {
+        tail -= m_Ring.size();
+        }
+      m_Ring[tail] = offset;
+      ++m_Size;
+    }
+
+    OffsetValueType Pop()
+    {
+      const OffsetValueType offset = m_Ring[m_Head];
+      if ( ++m_Head == m_Ring.size() )
+        {
+        m_Head = 0;
+        }
+      --m_Size;
+      return offset;
+    }
+
+    bool Empty() const
+    {
+      return m_Size == 0;
+    }
+
+private:
+    OffsetListType m_Ring;
+    SizeValueType  m_Head;
+    SizeValueType  m_Size;
+  };
+
+  /** A slab of planes along the last dimension, processed by one
+   * thread. */
+  struct SlabType {
+    OffsetValueType Begin;
+    OffsetValueType End;
+    OffsetFifo      Fifo;
+  };
+
+  /** The padded images and the neighbor offsets, shared by the
+   * threads. */
+  struct ParallelStruct {
+    Self                                *Filter;
+    bool                                FirstPass;
+    bool                                Invalid;
+    BufferType                          Marker;
+    BufferType                          Mask;
+    OffsetValueType                     Size[OutputImageDimension];
+    OffsetValueType                     Stride[OutputImageDimension];
+    OffsetListType                      Neighbors;
+    std::vector< int >                  NeighborPlaneShift;
+    std::vector< SlabType >             Slabs;
+  };
+
+  static ITK_THREAD_RETURN_TYPE ParallelThreaderCallback(void *arg);
+
+  /** Append the buffer offsets of the first pixel of the rows of a
+   * plane. */
+  static void ComputeRowOffsets(const ParallelStruct & str, OffsetValueType plane,
+                                OffsetListType & rows);
+
+  /** Run the hybrid algorithm on a slab. On the first pass, the marker
+   * and the mask are copied in the buffers and the raster and
+   * anti-raster scans are run before the queue is processed. */
+  void PropagateSlab(ParallelStruct & str, SlabType & slab);
+
+  /** Propagate the values across the boundary between a slab and the
+   * next one. Return true if a pixel was changed. */
+  bool PropagateAcrossSlabs(ParallelStruct & str, SizeValueType slab);
 }; // end of class
 } // end namespace itk
 
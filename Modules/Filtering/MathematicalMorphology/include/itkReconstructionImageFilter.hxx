@@ -33,6 +33,7 @@ ReconstructionImageFilter< TInputImage, TOutputImage, TCompare >
 {
   m_FullyConnected = false;
   m_UseInternalCopy = true;
+  m_ParallelPropagation = true;
 }
 
 template< class TInputImage, class TOutputImage, class TCompare >
@@ -104,6 +105,12 @@ void
 ReconstructionImageFilter< TInputImage, TOutputImage, TCompare >
 ::GenerateData()
 {
+  if ( m_ParallelPropagation && m_UseInternalCopy )
+    {
+    this->ParallelGenerateData();
+    return;
+    }
+
   // Allocate the output
   this->AllocateOutputs();
   // there are 2 passes that use all pixels and a 3rd that uses some
@@ -387,6 +394,433 @@ ReconstructionImageFilter< TInputImage, TOutputImage, TCompare >
     }
 }
 
+template< class TInputImage, class TOutputImage, class TCompare >
+void
+ReconstructionImageFilter< TInputImage, TOutputImage, TCompare >
+::ParallelGenerateData()
+{
+  this->AllocateOutputs();
+
+  MarkerImageConstPointer markerImage = this->GetMarkerImage();
+  MaskImageConstPointer   maskImage = this->GetMaskImage();
+  OutputImagePointer      output = this->GetOutput();
+
+  // mask and marker must have the same size
+  if ( markerImage->GetRequestedRegion().GetSize() != maskImage->GetRequestedRegion().GetSize() )
+    {
+    itkExceptionMacro(<< "Marker and mask must have the same size.");
+    }
+
+  const unsigned int dimension = OutputImageDimension;
+  const ISizeType    size = output->GetRequestedRegion().GetSize();
+
+  // The buffers are padded by one pixel with the marker value, so the
+  // neighbors of the image pixels are always in the buffers
+  ParallelStruct str;
+  str.Filter = this;
+  str.FirstPass = true;
+  str.Invalid = false;
+  OffsetValueType bufferSize = 1;
+  for ( unsigned int d = 0; d < dimension; ++d )
+    {
+    str.Size[d] = static_cast< OffsetValueType >( size[d] ) + 2;
+    str.Stride[d] = bufferSize;
+    bufferSize *= str.Size[d];
+    }
+  str.Marker.assign(bufferSize, m_MarkerValue);
+  str.Mask.assign(bufferSize, m_MarkerValue);
+
+  // The neighbors, in raster order
+  OffsetValueType numberOfNeighborhoodPixels = 1;
+  for ( unsigned int d = 0; d < dimension; ++d )
+    {
+    numberOfNeighborhoodPixels *= 3;
+    }
+  for ( OffsetValueType n = 0; n < numberOfNeighborhoodPixels; ++n )
+    {
+    OffsetValueType offset = 0;
+    unsigned int    nonZero = 0;
+    int             shift = 0;
+    OffsetValueType r = n;
+    for ( unsigned int d = 0; d < dimension; ++d )
+      {
+      shift = static_cast< int >( r % 3 ) - 1;
+      r /= 3;
+      offset += shift * str.Stride[d];
+      nonZero += ( shift != 0 );
+      }
+    if ( nonZero == 0 || ( !m_FullyConnected && nonZero > 1 ) )
+      {
+      continue;
+      }
+    str.Neighbors.push_back(offset);
+    // the last shift computed is the one along the last dimension
+    str.NeighborPlaneShift.push_back(shift);
+    }
+
+  // One slab per thread
+  const OffsetValueType numberOfPlanes = str.Size[dimension - 1] - 2;
+  const OffsetValueType numberOfSlabs = vnl_math_max( static_cast< OffsetValueType >( 1 ),
+    vnl_math_min( static_cast< OffsetValueType >( this->GetNumberOfThreads() ), numberOfPlanes ) );
+  str.Slabs.resize(numberOfSlabs);
+  for ( OffsetValueType i = 0; i < numberOfSlabs; ++i )
+    {
+    str.Slabs[i].Begin = 1 + numberOfPlanes * i / numberOfSlabs;
+    str.Slabs[i].End = 1 + numberOfPlanes * ( i + 1 ) / numberOfSlabs;
+    }
+
+  MultiThreader *threader = this->GetMultiThreader();
+  threader->SetNumberOfThreads( static_cast< ThreadIdType >( numberOfSlabs ) );
+  threader->SetSingleMethod(Self::ParallelThreaderCallback, &str);
+  threader->SingleMethodExecute();
+  this->UpdateProgress(0.5f);
+
+  if ( str.Invalid )
+    {
+    if ( TCompare()(0, 1) )
+      {
+      itkExceptionMacro(<< "Marker pixels must be <= mask pixels.");
+      }
+    else
+      {
+      itkExceptionMacro(<< "Marker pixels must be >= mask pixels.");
+      }
+    }
+
+  // Exchange the values across the slab boundaries until nothing
+  // changes anymore
+  str.FirstPass = false;
+  bool changed = true;
+  while ( changed )
+    {
+    changed = false;
+    for ( OffsetValueType i = 0; i + 1 < numberOfSlabs; ++i )
+      {
+      changed = this->PropagateAcrossSlabs(str, i) || changed;
+      }
+    if ( changed )
+      {
+      threader->SingleMethodExecute();
+      }
+    }
+
+  // Copy the buffer, without the padding, to the output
+  const OffsetValueType rowLength = ( dimension > 1 ) ? str.Size[0] - 2 : 1;
+  OffsetListType        rows;
+  for ( OffsetValueType z = 1; z <= numberOfPlanes; ++z )
+    {
+    rows.clear();
+    Self::ComputeRowOffsets(str, z, rows);
+    for ( typename OffsetListType::const_iterator rIt = rows.begin(); rIt != rows.end(); ++rIt )
+      {
+      OutputImageIndexType idx = output->GetRequestedRegion().GetIndex();
+      OffsetValueType      r = *rIt;
+      for ( unsigned int d = dimension; d-- > 0; )
+        {
+        idx[d] += r / str.Stride[d] - 1;
+        r %= str.Stride[d];
+        }
+      OutputImagePixelType *out = output->GetBufferPointer() + output->ComputeOffset(idx);
+      const InputImagePixelType *in = &str.Marker[*rIt];
+      for ( OffsetValueType x = 0; x < rowLength; ++x )
+        {
+        out[x] = static_cast< OutputImagePixelType >( in[x] );
+        }
+      }
+    }
+  this->UpdateProgress(1.0f);
+}
+
+template< class TInputImage, class TOutputImage, class TCompare >
+ITK_THREAD_RETURN_TYPE
+ReconstructionImageFilter< TInputImage, TOutputImage, TCompare >
+::ParallelThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info = static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  ParallelStruct *str = static_cast< ParallelStruct * >( info->UserData );
+
+  str->Filter->PropagateSlab( *str, str->Slabs[info->ThreadID] );
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TInputImage, class TOutputImage, class TCompare >
+void
+ReconstructionImageFilter< TInputImage, TOutputImage, TCompare >
+::ComputeRowOffsets(const ParallelStruct & str, OffsetValueType plane, OffsetListType & rows)
+{
+  const unsigned int dimension = OutputImageDimension;
+  if ( dimension == 1 )
+    {
+    rows.push_back(plane);
+    return;
+    }
+  // iterate over the dimensions between the first and the last one
+  OffsetValueType position[OutputImageDimension];
+  for ( unsigned int d = 1; d + 1 < dimension; ++d )
+    {
+    position[d] = 1;
+    }
+  while ( true )
+    {
+    OffsetValueType offset = 1 + plane * str.Stride[dimension - 1];
+    for ( unsigned int d = 1; d + 1 < dimension; ++d )
+      {
+      offset += position[d] * str.Stride[d];
+      }
+    rows.push_back(offset);
+    unsigned int d = 1;
+    for (; d + 1 < dimension; ++d )
+      {
+      if ( ++position[d] < str.Size[d] - 1 )
+        {
+        break;
+        }
+      position[d] = 1;
+      }
+    if ( d + 1 >= dimension )
+      {
+      return;
+      }
+    }
+}
+
+template< class TInputImage, class TOutputImage, class TCompare >
+void
+ReconstructionImageFilter< TInputImage, TOutputImage, TCompare >
+::PropagateSlab(ParallelStruct & str, SlabType & slab)
+{
+  const unsigned int    dimension = OutputImageDimension;
+  const OffsetValueType rowLength = ( dimension > 1 ) ? str.Size[0] - 2 : 1;
+  const OffsetValueType planeStride = str.Stride[dimension - 1];
+  const SizeValueType   numberOfNeighbors = str.Neighbors.size();
+  InputImagePixelType * marker = &str.Marker[0];
+  InputImagePixelType * mask = &str.Mask[0];
+  TCompare              compare;
+
+  // The neighbors that stay in the slab, for the first, the last and
+  // the other planes of the slab
+  OffsetListType previous[3];
+  OffsetListType later[3];
+  OffsetListType all[3];
+  for ( unsigned int c = 0; c < 3; ++c )
+    {
+    for ( SizeValueType k = 0; k < numberOfNeighbors; ++k )
+      {
+      const int shift = str.NeighborPlaneShift[k];
+      if ( ( c == 1 && shift < 0 ) || ( c == 2 && shift > 0 ) )
+        {
+        continue;
+        }
+      const OffsetValueType o = str.Neighbors[k];
+      all[c].push_back(o);
+      if ( o < 0 )
+        {
+        previous[c].push_back(o);
+        }
+      else
+        {
+        later[c].push_back(o);
+        }
+      }
+    }
+  // a slab with a single plane has both restrictions
+  const bool singlePlane = ( slab.End - slab.Begin == 1 );
+  if ( singlePlane )
+    {
+    OffsetListType inPlane;
+    for ( SizeValueType k = 0; k < numberOfNeighbors; ++k )
+      {
+      if ( str.NeighborPlaneShift[k] == 0 )
+        {
+        inPlane.push_back(str.Neighbors[k]);
+        }
+      }
+    all[1] = inPlane;
+    previous[1].clear();
+    later[1].clear();
+    for ( SizeValueType k = 0; k < inPlane.size(); ++k )
+      {
+      ( inPlane[k] < 0 ? previous[1] : later[1] ).push_back(inPlane[k]);
+      }
+    }
+  // 0: inside, 1: first plane, 2: last plane
+#define itkReconstructionPlaneCase(z) \
+  ( ( (z) == slab.Begin || singlePlane ) ? 1 : ( ( (z) == slab.End - 1 ) ? 2 : 0 ) )
+
+  if ( str.FirstPass )
+    {
+    slab.Fifo.Reserve( static_cast< SizeValueType >( ( slab.End - slab.Begin ) * planeStride / 16 ) );
+
+    const MarkerImageType *markerImage = this->GetMarkerImage();
+    const MaskImageType *  maskImage = this->GetMaskImage();
+    OffsetListType         rows;
+
+    // copy the slab from the images, and scan it in raster order
+    for ( OffsetValueType z = slab.Begin; z < slab.End; ++z )
+      {
+      rows.clear();
+      Self::ComputeRowOffsets(str, z, rows);
+      const OffsetListType & neighbors = previous[itkReconstructionPlaneCase(z)];
+      for ( typename OffsetListType::const_iterator rIt = rows.begin(); rIt != rows.end(); ++rIt )
+        {
+        InputImageIndexType markerIndex = markerImage->GetRequestedRegion().GetIndex();
+        InputImageIndexType maskIndex = maskImage->GetRequestedRegion().GetIndex();
+        OffsetValueType     r = *rIt;
+        for ( unsigned int d = dimension; d-- > 0; )
+          {
+          markerIndex[d] += r / str.Stride[d] - 1;
+          maskIndex[d] += r / str.Stride[d] - 1;
+          r %= str.Stride[d];
+          }
+        const MarkerImagePixelType *markerRow =
+          markerImage->GetBufferPointer() + markerImage->ComputeOffset(markerIndex);
+        const MaskImagePixelType *maskRow =
+          maskImage->GetBufferPointer() + maskImage->ComputeOffset(maskIndex);
+        for ( OffsetValueType x = 0; x < rowLength; ++x )
+          {
+          const OffsetValueType p = *rIt + x;
+          InputImagePixelType   V = markerRow[x];
+          const InputImagePixelType iV = maskRow[x];
+          mask[p] = iV;
+
+          // be sure that the pixels in the images follow the preconditions
+          if ( compare(V, iV) )
+            {
+            str.Invalid = true;
+            }
+          for ( typename OffsetListType::const_iterator nIt = neighbors.begin(); nIt != neighbors.end(); ++nIt )
+            {
+            const InputImagePixelType VN = marker[p + *nIt];
+            if ( compare(VN, V) )
+              {
+              V = VN;
+              }
+            }
+          // this step clamps to the mask
+          if ( compare(V, iV) )
+            {
+            V = iV;
+            }
+          marker[p] = V;
+          }
+        }
+      }
+
+    // the reverse raster order pass, which fills the queue
+    for ( OffsetValueType z = slab.End; z-- > slab.Begin; )
+      {
+      rows.clear();
+      Self::ComputeRowOffsets(str, z, rows);
+      const OffsetListType & neighbors = later[itkReconstructionPlaneCase(z)];
+      for ( typename OffsetListType::const_reverse_iterator rIt = rows.rbegin(); rIt != rows.rend(); ++rIt )
+        {
+        for ( OffsetValueType x = rowLength; x-- > 0; )
+          {
+          const OffsetValueType p = *rIt + x;
+          InputImagePixelType   V = marker[p];
+          typename OffsetListType::const_iterator nIt;
+          for ( nIt = neighbors.begin(); nIt != neighbors.end(); ++nIt )
+            {
+            const InputImagePixelType VN = marker[p + *nIt];
+            if ( compare(VN, V) )
+              {
+              V = VN;
+              }
+            }
+          const InputImagePixelType iV = mask[p];
+          if ( compare(V, iV) )
+            {
+            V = iV;
+            }
+          marker[p] = V;
+
+          for ( nIt = neighbors.begin(); nIt != neighbors.end(); ++nIt )
+            {
+            const InputImagePixelType VN = marker[p + *nIt];
+            const InputImagePixelType iN = mask[p + *nIt];
+            if ( compare(V, VN) && compare(iN, VN) )
+              {
+              slab.Fifo.Push(p);
+              break;
+              }
+            }
+          }
+        }
+      }
+    }
+
+  // now process the fifo - this fill the parts that weren't dealt
+  // with by the raster and anti-raster passes
+  while ( !slab.Fifo.Empty() )
+    {
+    const OffsetValueType     p = slab.Fifo.Pop();
+    const InputImagePixelType V = marker[p];
+    const OffsetListType &    neighbors = all[itkReconstructionPlaneCase(p / planeStride)];
+    for ( typename OffsetListType::const_iterator nIt = neighbors.begin(); nIt != neighbors.end(); ++nIt )
+      {
+      const OffsetValueType     q = p + *nIt;
+      const InputImagePixelType VN = marker[q];
+      const InputImagePixelType iN = mask[q];
+      // candidate for dilation via flooding
+      if ( compare(V, VN) && ( iN != VN ) )
+        {
+        // propagate the center value, clamped by the mask
+        marker[q] = compare(iN, V) ? V : iN;
+        slab.Fifo.Push(q);
+        }
+      }
+    }
+#undef itkReconstructionPlaneCase
+}
+
+template< class TInputImage, class TOutputImage, class TCompare >
+bool
+ReconstructionImageFilter< TInputImage, TOutputImage, TCompare >
+::PropagateAcrossSlabs(ParallelStruct & str, SizeValueType slab)
+{
+  const unsigned int    dimension = OutputImageDimension;
+  const OffsetValueType rowLength = ( dimension > 1 ) ? str.Size[0] - 2 : 1;
+  InputImagePixelType * marker = &str.Marker[0];
+  InputImagePixelType * mask = &str.Mask[0];
+  TCompare              compare;
+  bool                  changed = false;
+
+  // from the last plane of the slab to the first plane of the next
+  // one, then the other way
+  for ( int direction = 1; direction >= -1; direction -= 2 )
+    {
+    const OffsetValueType plane = ( direction > 0 ) ? str.Slabs[slab].End - 1 : str.Slabs[slab + 1].Begin;
+    SlabType &            target = ( direction > 0 ) ? str.Slabs[slab + 1] : str.Slabs[slab];
+    OffsetListType        rows;
+    Self::ComputeRowOffsets(str, plane, rows);
+    for ( typename OffsetListType::const_iterator rIt = rows.begin(); rIt != rows.end(); ++rIt )
+      {
+      for ( OffsetValueType x = 0; x < rowLength; ++x )
+        {
+        const OffsetValueType     p = *rIt + x;
+        const InputImagePixelType V = marker[p];
+        for ( SizeValueType k = 0; k < str.Neighbors.size(); ++k )
+          {
+          if ( str.NeighborPlaneShift[k] != direction )
+            {
+            continue;
+            }
+          const OffsetValueType     q = p + str.Neighbors[k];
+          const InputImagePixelType VN = marker[q];
+          const InputImagePixelType iN = mask[q];
+          if ( compare(V, VN) && ( iN != VN ) )
+            {
+            marker[q] = compare(iN, V) ? V : iN;
+            target.Fifo.Push(q);
+            changed = true;
+            }
+          }
+        }
+      }
+    }
+  return changed;
+}
+
 template< class TInputImage, class TOutputImage, class TCompare >
 void
 ReconstructionImageFilter< TInputImage, TOutputImage, TCompare >
@@ -397,6 +831,7 @@ ReconstructionImageFilter< TInputImage, TOutputImage, TCompare >
   os << indent << "FullyConnected: "  << m_FullyConnected << std::endl;
   os << indent << "MarkerValue: " << m_MarkerValue << std::endl;
   os << indent << "UseInternalCopy: " << m_UseInternalCopy << std::endl;
+  os << indent << "ParallelPropagation: " << m_ParallelPropagation << std::endl;
 }
 }
 #endif
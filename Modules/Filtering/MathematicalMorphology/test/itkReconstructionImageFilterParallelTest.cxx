@@ -0,0 +1,162 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkReconstructionByDilationImageFilter.h"
+#include "itkReconstructionByErosionImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkTimeProbe.h"
+
+namespace
+{
+typedef short                      PixelType;
+typedef itk::Image< PixelType, 3 > ImageType;
+
+// Compare the parallel propagation, with several numbers of threads,
+// to the serial implementation.
+template< class TFilter >
+bool CompareToSerial(const ImageType *marker, const ImageType *mask, const char *name)
+{
+  for( unsigned int fullyConnected = 0; fullyConnected < 2; ++fullyConnected )
+    {
+    typename TFilter::Pointer serial = TFilter::New();
+    serial->SetMarkerImage( marker );
+    serial->SetMaskImage( mask );
+    serial->SetFullyConnected( fullyConnected != 0 );
+    serial->ParallelPropagationOff();
+    itk::TimeProbe serialTime;
+    serialTime.Start();
+    serial->Update();
+    serialTime.Stop();
+    std::cout << name << ", FullyConnected " << fullyConnected
+              << ": serial " << serialTime.GetMean() << " s" << std::endl;
+
+    const itk::ThreadIdType numbersOfThreads[] = { 1, 3, 7 };
+    for( unsigned int t = 0; t < 3; ++t )
+      {
+      typename TFilter::Pointer parallel = TFilter::New();
+      parallel->SetMarkerImage( marker );
+      parallel->SetMaskImage( mask );
+      parallel->SetFullyConnected( fullyConnected != 0 );
+      parallel->SetNumberOfThreads( numbersOfThreads[t] );
+      itk::TimeProbe parallelTime;
+      parallelTime.Start();
+      parallel->Update();
+      parallelTime.Stop();
+      std::cout << name << ", FullyConnected " << fullyConnected
+                << ": parallel with " << numbersOfThreads[t] << " threads "
+                << parallelTime.GetMean() << " s" << std::endl;
+
+      itk::ImageRegionConstIterator< ImageType > sit( serial->GetOutput(),
+                                                      serial->GetOutput()->GetBufferedRegion() );
+      itk::ImageRegionConstIterator< ImageType > pit( parallel->GetOutput(),
+                                                      serial->GetOutput()->GetBufferedRegion() );
+      for( ; !sit.IsAtEnd(); ++sit, ++pit )
+        {
+        if( sit.Get() != pit.Get() )
+          {
+          std::cerr << name << ": pixel " << sit.GetIndex() << " is " << pit.Get()
+                    << " with " << numbersOfThreads[t] << " threads, "
+                    << sit.Get() << " with the serial implementation" << std::endl;
+          return false;
+          }
+        }
+      }
+    }
+  return true;
+}
+}
+
+int itkReconstructionImageFilterParallelTest(int, char* [] )
+{
+  typedef itk::ReconstructionByDilationImageFilter< ImageType, ImageType > DilationType;
+  typedef itk::ReconstructionByErosionImageFilter< ImageType, ImageType >  ErosionType;
+
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator GeneratorType;
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize( 5678 );
+
+  // A mask made of hills with some noise, with long paths between the
+  // slabs, and the markers of an h-maxima and an h-minima transform
+  ImageType::SizeType size;
+  size[0] = 67;
+  size[1] = 45;
+  size[2] = 38;
+  ImageType::IndexType start;
+  start[0] = 3;
+  start[1] = -2;
+  start[2] = 7;
+  ImageType::RegionType region( start, size );
+
+  ImageType::Pointer mask = ImageType::New();
+  mask->SetRegions( region );
+  mask->Allocate();
+  ImageType::Pointer maximaMarker = ImageType::New();
+  maximaMarker->SetRegions( region );
+  maximaMarker->Allocate();
+  ImageType::Pointer minimaMarker = ImageType::New();
+  minimaMarker->SetRegions( region );
+  minimaMarker->Allocate();
+
+  const PixelType h = 20;
+  itk::ImageRegionIterator< ImageType > it( mask, region );
+  itk::ImageRegionIterator< ImageType > maxIt( maximaMarker, region );
+  itk::ImageRegionIterator< ImageType > minIt( minimaMarker, region );
+  for( ; !it.IsAtEnd(); ++it, ++maxIt, ++minIt )
+    {
+    const ImageType::IndexType idx = it.GetIndex();
+    const double value = 100.0 * vcl_sin( idx[0] / 7.0 ) * vcl_cos( idx[1] / 5.0 + idx[2] / 11.0 )
+      + 30.0 * generator->GetVariate();
+    it.Set( static_cast< PixelType >( value ) );
+    maxIt.Set( it.Get() - h );
+    minIt.Set( it.Get() + h );
+    }
+
+  if( !CompareToSerial< DilationType >( maximaMarker, mask, "dilation" )
+      || !CompareToSerial< ErosionType >( minimaMarker, mask, "erosion" ) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  // The marker must be below the mask for the dilation
+  DilationType::Pointer invalid = DilationType::New();
+  invalid->SetMarkerImage( minimaMarker );
+  invalid->SetMaskImage( mask );
+  invalid->SetNumberOfThreads( 3 );
+  bool caught = false;
+  try
+    {
+    invalid->Update();
+    }
+  catch( itk::ExceptionObject & err )
+    {
+    std::cout << "Expected exception: " << err.GetDescription() << std::endl;
+    caught = true;
+    }
+  if( !caught )
+    {
+    std::cerr << "A marker above the mask did not throw" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  invalid->Print( std::cout );
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -23,6 +23,7 @@
 #include "itkImage.h"
 #include "itkPixelTraits.h"
 #include "itkCommand.h"
+#include <vector>
 
 namespace itk
 {
@@ -38,6 +39,16 @@ namespace itk
  * image types need to be the same and/or the same type as the
  * RealImageType.
  *
+ * By default the passes along each direction run as a mini-pipeline of
+ * RecursiveGaussianImageFilter instances. With UseSingleBuffer enabled,
+ * the filter instead runs all the passes itself on one RealImageType
+ * buffer: the pass along the last direction first, then the passes along
+ * the other directions and the conversion to the output pixel type slice
+ * by slice, while each slice is in the cache. The buffer is the output
+ * image when the output is a RealImageType, so that the memory needed is
+ * that of the input and of the output. The results are the same in both
+ * modes.
+ *
  * \ingroup IntensityImageFilters
  * \ingroup SingelThreaded
  * \ingroup ITKSmoothing
@@ -143,6 +154,12 @@ public:
   //
   virtual bool CanRunInPlace( void ) const;
 
+  /** Set/Get whether the passes run on a single buffer, one slice at a
+   * time, instead of as a mini-pipeline. Defaults to false. */
+  itkSetMacro(UseSingleBuffer, bool);
+  itkGetConstMacro(UseSingleBuffer, bool);
+  itkBooleanMacro(UseSingleBuffer);
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Begin concept checking */
   itkConceptMacro( InputHasNumericTraitsCheck,
@@ -168,6 +185,13 @@ protected:
   // Override since the filter produces the entire dataset
   void EnlargeOutputRequestedRegion(DataObject *output);
 
+  /** Run all the passes on a single buffer, see SetUseSingleBuffer() */
+  void GenerateDataInSingleBuffer();
+
+  /** Runs one of the passes of GenerateDataInSingleBuffer() on the part of
+   * the image assigned to a thread. */
+  static ITK_THREAD_RETURN_TYPE SingleBufferThreaderCallback(void *arg);
+
 private:
   SmoothingRecursiveGaussianImageFilter(const Self &); //purposely not
                                                        // implemented
@@ -184,6 +208,21 @@ private:
 
   /** Standard deviation of the gaussian used for smoothing */
   SigmaArrayType m_Sigma;
+
+  bool m_UseSingleBuffer;
+
+  typedef typename FirstGaussianFilterType::RealType    FirstFilterRealType;
+  typedef typename InternalGaussianFilterType::RealType InternalFilterRealType;
+
+  /** Tiles of each thread, three per thread, kept between updates */
+  std::vector< std::vector< FirstFilterRealType > >    m_FirstFilterTiles;
+  std::vector< std::vector< InternalFilterRealType > > m_InternalFilterTiles;
+
+  struct SingleBufferThreadStruct {
+    Self *Filter;
+    RealImageType *Buffer;
+    bool IsThroughPlanePass;
+  };
 };
 } // end namespace itk
 
@@ -20,6 +20,7 @@
 
 #include "itkSmoothingRecursiveGaussianImageFilter.h"
 #include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionIterator.h"
 #include "itkProgressAccumulator.h"
 
 namespace itk
@@ -32,6 +33,7 @@ SmoothingRecursiveGaussianImageFilter< TInputImage, TOutputImage >
 ::SmoothingRecursiveGaussianImageFilter()
 {
   m_NormalizeAcrossScale = false;
+  m_UseSingleBuffer = false;
 
   // NB: The first filter is the last dimension because it does not
   // always run in-place. As this dimension provides the least amount
@@ -239,6 +241,12 @@ SmoothingRecursiveGaussianImageFilter< TInputImage, TOutputImage >
       }
     }
 
+  if ( m_UseSingleBuffer )
+    {
+    this->GenerateDataInSingleBuffer();
+    return;
+    }
+
   // If this filter is running in-place, then set the first smoothing
   // filter to steal the bulk data, by running in-place.
   if ( this->CanRunInPlace() && this->GetInPlace() )
@@ -284,6 +292,164 @@ SmoothingRecursiveGaussianImageFilter< TInputImage, TOutputImage >
   this->GraftOutput( m_CastingFilter->GetOutput() );
 }
 
+template< typename TInputImage, typename TOutputImage >
+void
+SmoothingRecursiveGaussianImageFilter< TInputImage, TOutputImage >
+::GenerateDataInSingleBuffer()
+{
+  const InputImageType *inputImage = this->GetInput();
+
+  // Shares the input bulk data when running in-place
+  this->AllocateOutputs();
+
+  // The buffer is the output itself when it holds real values
+  RealImageType *                  buffer = dynamic_cast< RealImageType * >( this->GetOutput() );
+  typename RealImageType::Pointer  localBuffer;
+  if ( !buffer )
+    {
+    localBuffer = RealImageType::New();
+    localBuffer->CopyInformation( this->GetOutput() );
+    localBuffer->SetRegions( this->GetOutput()->GetRequestedRegion() );
+    localBuffer->Allocate();
+    buffer = localBuffer;
+    }
+
+  const typename InputImageType::SpacingType & spacing = inputImage->GetSpacing();
+  m_FirstSmoothingFilter->InitializeCoefficients( spacing[ImageDimension - 1] );
+  for ( unsigned int i = 0; i < ImageDimension - 1; i++ )
+    {
+    m_SmoothingFilters[i]->InitializeCoefficients( spacing[i] );
+    }
+
+  MultiThreader *threader = this->GetMultiThreader();
+  threader->SetNumberOfThreads( this->GetNumberOfThreads() );
+
+  const ThreadIdType numberOfThreads = threader->GetNumberOfThreads();
+  if ( m_FirstFilterTiles.size() < 3 * numberOfThreads )
+    {
+    m_FirstFilterTiles.resize( 3 * numberOfThreads );
+    m_InternalFilterTiles.resize( 3 * numberOfThreads );
+    }
+
+  SingleBufferThreadStruct str;
+  str.Filter = this;
+  str.Buffer = buffer;
+  threader->SetSingleMethod( this->SingleBufferThreaderCallback, &str );
+
+  // Along the last direction, from the input to the buffer
+  str.IsThroughPlanePass = true;
+  threader->SingleMethodExecute();
+  this->UpdateProgress( 1.0f / ImageDimension );
+
+  // Along the other directions, in the buffer, slice by slice
+  str.IsThroughPlanePass = false;
+  threader->SingleMethodExecute();
+  this->UpdateProgress( 1.0f );
+}
+
+template< typename TInputImage, typename TOutputImage >
+ITK_THREAD_RETURN_TYPE
+SmoothingRecursiveGaussianImageFilter< TInputImage, TOutputImage >
+::SingleBufferThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info = static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  SingleBufferThreadStruct *       str = static_cast< SingleBufferThreadStruct * >( info->UserData );
+
+  Self *         filter = str->Filter;
+  RealImageType *buffer = str->Buffer;
+
+  const ThreadIdType threadId = info->ThreadID;
+  const ThreadIdType numberOfThreads = info->NumberOfThreads;
+
+  typedef typename RealImageType::RegionType RegionType;
+  const RegionType region = buffer->GetBufferedRegion();
+
+  // The through-plane pass is split along the next to last direction, the
+  // in-plane passes along the last one.
+  const unsigned int splitAxis = str->IsThroughPlanePass ? ImageDimension - 2 : ImageDimension - 1;
+
+  const SizeValueType range = region.GetSize()[splitAxis];
+  const SizeValueType begin = ( range * threadId ) / numberOfThreads;
+  const SizeValueType end = ( range * ( threadId + 1 ) ) / numberOfThreads;
+  if ( begin == end )
+    {
+    return ITK_THREAD_RETURN_VALUE;
+    }
+
+  RegionType threadRegion = region;
+  threadRegion.SetIndex( splitAxis, region.GetIndex()[splitAxis] + static_cast< IndexValueType >( begin ) );
+  threadRegion.SetSize( splitAxis, end - begin );
+
+  if ( str->IsThroughPlanePass )
+    {
+    FirstGaussianFilterType *gaussian = filter->m_FirstSmoothingFilter;
+
+    const unsigned int  ln = region.GetSize()[ImageDimension - 1];
+    const SizeValueType tileSize = static_cast< SizeValueType >( ln ) * gaussian->GetNumberOfLinesPerBlock(ln);
+
+    std::vector< FirstFilterRealType > *tiles = &filter->m_FirstFilterTiles[3 * threadId];
+    for ( unsigned int k = 0; k < 3; k++ )
+      {
+      if ( tiles[k].size() < tileSize )
+        {
+        tiles[k].resize( tileSize );
+        }
+      }
+
+    gaussian->FilterLinesInRegion( filter->GetInput(), buffer, threadRegion,
+                                   &tiles[0][0], &tiles[1][0], &tiles[2][0] );
+    return ITK_THREAD_RETURN_VALUE;
+    }
+
+  std::vector< InternalFilterRealType > *tiles = &filter->m_InternalFilterTiles[3 * threadId];
+  for ( unsigned int i = 0; i < ImageDimension - 1; i++ )
+    {
+    const unsigned int  ln = region.GetSize()[i];
+    const SizeValueType tileSize =
+      static_cast< SizeValueType >( ln ) * filter->m_SmoothingFilters[i]->GetNumberOfLinesPerBlock(ln);
+    for ( unsigned int k = 0; k < 3; k++ )
+      {
+      if ( tiles[k].size() < tileSize )
+        {
+        tiles[k].resize( tileSize );
+        }
+      }
+    }
+
+  OutputImageType *output = filter->GetOutput();
+  const bool       castToOutput = ( dynamic_cast< RealImageType * >( output ) != buffer );
+
+  typedef Functor::Cast< InternalRealType, typename OutputImageType::PixelType > CastFunctorType;
+  CastFunctorType cast;
+
+  RegionType slice = threadRegion;
+  slice.SetSize( ImageDimension - 1, 1 );
+  for ( SizeValueType z = begin; z < end; z++ )
+    {
+    slice.SetIndex( ImageDimension - 1, region.GetIndex()[ImageDimension - 1] + static_cast< IndexValueType >( z ) );
+
+    for ( unsigned int i = 0; i < ImageDimension - 1; i++ )
+      {
+      filter->m_SmoothingFilters[i]->FilterLinesInRegion( buffer, buffer, slice,
+                                                          &tiles[0][0], &tiles[1][0], &tiles[2][0] );
+      }
+
+    if ( castToOutput )
+      {
+      ImageRegionConstIterator< RealImageType > bufferIt( buffer, slice );
+      ImageRegionIterator< OutputImageType >    outputIt( output, slice );
+      while ( !bufferIt.IsAtEnd() )
+        {
+        outputIt.Set( cast( bufferIt.Get() ) );
+        ++bufferIt;
+        ++outputIt;
+        }
+      }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
 template< typename TInputImage, typename TOutputImage >
 void
 SmoothingRecursiveGaussianImageFilter< TInputImage, TOutputImage >
@@ -293,6 +459,7 @@ SmoothingRecursiveGaussianImageFilter< TInputImage, TOutputImage >
 
   os << "NormalizeAcrossScale: " << m_NormalizeAcrossScale << std::endl;
   os << "Sigma: " << m_Sigma << std::endl;
+  os << "UseSingleBuffer: " << m_UseSingleBuffer << std::endl;
 }
 
 } // end namespace itk
@@ -0,0 +1,171 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkRecursiveGaussianImageFilter.h"
+#include "itkImageLinearConstIteratorWithIndex.h"
+#include "itkImageRegionIterator.h"
+#include "itkTimeProbe.h"
+
+namespace
+{
+// Gives access to the single line kernel of the filter, which is used as
+// the reference for the results of the block kernel.
+template< class TInputImage, class TOutputImage >
+class RecursiveGaussianLineFilter:
+  public itk::RecursiveGaussianImageFilter< TInputImage, TOutputImage >
+{
+public:
+  typedef RecursiveGaussianLineFilter                                    Self;
+  typedef itk::RecursiveGaussianImageFilter< TInputImage, TOutputImage > Superclass;
+  typedef itk::SmartPointer< Self >                                      Pointer;
+
+  itkNewMacro(Self);
+
+  typedef typename Superclass::RealType       RealType;
+  typedef typename Superclass::ScalarRealType ScalarRealType;
+
+  void FilterLine(RealType *outs, const RealType *data, RealType *scratch,
+                  unsigned int ln, ScalarRealType spacing)
+  {
+    this->SetUp(spacing);
+    this->FilterDataArray(outs, data, scratch, ln);
+  }
+};
+}
+
+int itkRecursiveGaussianImageFilterLineBlockTest(int, char* [] )
+{
+  const unsigned int Dimension = 3;
+
+  typedef itk::Image< float, Dimension >                            ImageType;
+  typedef RecursiveGaussianLineFilter< ImageType, ImageType >       FilterType;
+  typedef FilterType::RealType                                      RealType;
+  typedef itk::ImageLinearConstIteratorWithIndex< ImageType >       LineIteratorType;
+
+  // Odd sizes, so that the last block of lines along each axis is partial
+  ImageType::SizeType size;
+  size[0] = 37;
+  size[1] = 23;
+  size[2] = 19;
+  ImageType::IndexType start;
+  start[0] = 3;
+  start[1] = -5;
+  start[2] = 0;
+  ImageType::RegionType region( start, size );
+
+  ImageType::SpacingType spacing;
+  spacing[0] = 1.0;
+  spacing[1] = 0.5;
+  spacing[2] = 2.0;
+
+  ImageType::Pointer input = ImageType::New();
+  input->SetRegions( region );
+  input->SetSpacing( spacing );
+  input->Allocate();
+
+  itk::ImageRegionIterator< ImageType > it( input, region );
+  unsigned int seed = 12345;
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    seed = seed * 1103515245u + 12345u;
+    it.Set( static_cast< float >( ( seed >> 16 ) % 1000 ) );
+    }
+
+  std::vector< RealType > inps;
+  std::vector< RealType > outs;
+  std::vector< RealType > scratch;
+
+  const FilterType::OrderEnumType orders[3] =
+    { FilterType::ZeroOrder, FilterType::FirstOrder, FilterType::SecondOrder };
+
+  for( unsigned int direction = 0; direction < Dimension; ++direction )
+    {
+    for( unsigned int o = 0; o < 3; ++o )
+      {
+      FilterType::Pointer filter = FilterType::New();
+      filter->SetInput( input );
+      filter->SetDirection( direction );
+      filter->SetOrder( orders[o] );
+      filter->SetSigma( 2.5 );
+      filter->SetNumberOfThreads( 3 );
+      filter->Update();
+
+      ImageType::Pointer output = filter->GetOutput();
+
+      const unsigned int ln = size[direction];
+      inps.resize( ln );
+      outs.resize( ln );
+      scratch.resize( ln );
+
+      LineIteratorType inIt( input, region );
+      LineIteratorType outIt( output, region );
+      inIt.SetDirection( direction );
+      outIt.SetDirection( direction );
+
+      for( ; !inIt.IsAtEnd(); inIt.NextLine(), outIt.NextLine() )
+        {
+        const ImageType::IndexType lineStart = inIt.GetIndex();
+        for( unsigned int i = 0; !inIt.IsAtEndOfLine(); ++inIt, ++i )
+          {
+          inps[i] = inIt.Get();
+          }
+        filter->FilterLine( &outs[0], &inps[0], &scratch[0], ln, spacing[direction] );
+
+        for( unsigned int i = 0; !outIt.IsAtEndOfLine(); ++outIt, ++i )
+          {
+          const float expected = static_cast< float >( outs[i] );
+          const float tolerance = 1e-5f * ( 1.0f + vnl_math_abs( expected ) );
+          if( vnl_math_abs( outIt.Get() - expected ) > tolerance )
+            {
+            std::cerr << "Direction " << direction << ", order " << o
+                      << ": line starting at " << lineStart << " has " << outIt.Get()
+                      << " at sample " << i << ", expected " << expected << std::endl;
+            return EXIT_FAILURE;
+            }
+          }
+        }
+      }
+    }
+
+  // Timing of each direction on a larger volume
+  ImageType::SizeType bigSize;
+  bigSize.Fill( 128 );
+  ImageType::RegionType bigRegion;
+  bigRegion.SetSize( bigSize );
+  ImageType::Pointer bigInput = ImageType::New();
+  bigInput->SetRegions( bigRegion );
+  bigInput->Allocate();
+  bigInput->FillBuffer( 1.0f );
+
+  for( unsigned int direction = 0; direction < Dimension; ++direction )
+    {
+    FilterType::Pointer filter = FilterType::New();
+    filter->SetInput( bigInput );
+    filter->SetDirection( direction );
+    filter->SetSigma( 2.0 );
+
+    itk::TimeProbe probe;
+    probe.Start();
+    filter->Update();
+    probe.Stop();
+    std::cout << "Direction " << direction << ": " << probe.GetMean() << " s" << std::endl;
+    }
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,149 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkSmoothingRecursiveGaussianImageFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkTimeProbe.h"
+
+namespace
+{
+// Smooth the same image with the mini-pipeline and with the single buffer,
+// and check that the outputs are identical.
+template< class TInputImage, class TOutputImage >
+bool
+itkSmoothingRecursiveGaussianImageFilterSingleBufferTestCompare(const char *name,
+                                                               typename TInputImage::SizeType size,
+                                                               bool inPlace)
+{
+  typedef itk::SmoothingRecursiveGaussianImageFilter< TInputImage, TOutputImage > FilterType;
+
+  typename TInputImage::RegionType region;
+  region.SetSize( size );
+
+  typename TInputImage::SpacingType spacing;
+  for( unsigned int d = 0; d < TInputImage::ImageDimension; ++d )
+    {
+    spacing[d] = 0.5 + 0.25 * d;
+    }
+
+  typename TOutputImage::Pointer outputs[2];
+  double times[2];
+  for( unsigned int mode = 0; mode < 2; ++mode )
+    {
+    // Same content for both modes, and a new image since the in-place
+    // filter steals its bulk data
+    typename TInputImage::Pointer input = TInputImage::New();
+    input->SetRegions( region );
+    input->SetSpacing( spacing );
+    input->Allocate();
+    unsigned int seed = 4321;
+    itk::ImageRegionIterator< TInputImage > it( input, region );
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+      {
+      seed = seed * 1103515245u + 12345u;
+      it.Set( static_cast< typename TInputImage::PixelType >( ( seed >> 16 ) % 200 ) );
+      }
+
+    typename FilterType::Pointer filter = FilterType::New();
+    filter->SetInput( input );
+    filter->SetSigma( 1.5 );
+    filter->SetInPlace( inPlace );
+    filter->SetUseSingleBuffer( mode == 1 );
+    if( filter->GetUseSingleBuffer() != ( mode == 1 ) )
+      {
+      std::cerr << name << ": GetUseSingleBuffer() is " << filter->GetUseSingleBuffer() << std::endl;
+      return false;
+      }
+
+    itk::TimeProbe probe;
+    try
+      {
+      probe.Start();
+      filter->Update();
+      probe.Stop();
+      }
+    catch( itk::ExceptionObject & err )
+      {
+      std::cerr << name << ": " << err << std::endl;
+      return false;
+      }
+    times[mode] = probe.GetMean();
+
+    outputs[mode] = filter->GetOutput();
+    outputs[mode]->DisconnectPipeline();
+    if( outputs[mode]->GetBufferedRegion() != region )
+      {
+      std::cerr << name << ": output region is " << outputs[mode]->GetBufferedRegion() << std::endl;
+      return false;
+      }
+    }
+
+  itk::ImageRegionConstIterator< TOutputImage > pipelineIt( outputs[0], region );
+  itk::ImageRegionConstIterator< TOutputImage > singleIt( outputs[1], region );
+  for( ; !pipelineIt.IsAtEnd(); ++pipelineIt, ++singleIt )
+    {
+    if( pipelineIt.Get() != singleIt.Get() )
+      {
+      std::cerr << name << ": output is " << static_cast< double >( singleIt.Get() )
+                << " at " << singleIt.GetIndex() << " with a single buffer, and "
+                << static_cast< double >( pipelineIt.Get() ) << " with the mini-pipeline" << std::endl;
+      return false;
+      }
+    }
+
+  std::cout << name << ": mini-pipeline " << times[0] << " s, single buffer " << times[1] << " s" << std::endl;
+  return true;
+}
+}
+
+int itkSmoothingRecursiveGaussianImageFilterSingleBufferTest(int, char* [] )
+{
+  typedef itk::Image< float, 2 >         Float2DImageType;
+  typedef itk::Image< float, 3 >         Float3DImageType;
+  typedef itk::Image< unsigned char, 3 > UChar3DImageType;
+  typedef itk::Image< short, 3 >         Short3DImageType;
+
+  Float2DImageType::SizeType size2D;
+  size2D[0] = 61;
+  size2D[1] = 47;
+
+  Float3DImageType::SizeType size3D;
+  size3D[0] = 64;
+  size3D[1] = 53;
+  size3D[2] = 37;
+
+  bool pass = true;
+  pass &= itkSmoothingRecursiveGaussianImageFilterSingleBufferTestCompare< Float2DImageType, Float2DImageType >
+    ( "float 2D", size2D, false );
+  pass &= itkSmoothingRecursiveGaussianImageFilterSingleBufferTestCompare< Float3DImageType, Float3DImageType >
+    ( "float 3D", size3D, false );
+  pass &= itkSmoothingRecursiveGaussianImageFilterSingleBufferTestCompare< Float3DImageType, Float3DImageType >
+    ( "float 3D in-place", size3D, true );
+  pass &= itkSmoothingRecursiveGaussianImageFilterSingleBufferTestCompare< UChar3DImageType, UChar3DImageType >
+    ( "unsigned char 3D", size3D, false );
+  pass &= itkSmoothingRecursiveGaussianImageFilterSingleBufferTestCompare< Short3DImageType, Float3DImageType >
+    ( "short to float 3D", size3D, false );
+
+  if( !pass )
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -106,9 +106,20 @@ public:
   /** Set the spacing and dimesion information for the current filename. */
   virtual void ReadImageInformation();
 
-  /** Reads the data from disk into the memory buffer provided. */
+  /** Reads the data from disk into the memory buffer provided. Only the
+   * frames of the IORegion are decoded. */
   virtual void Read(void *buffer);
 
+  /** Multi-frame objects, such as enhanced CT and MR or breast
+   * tomosynthesis, can be streamed frame by frame. This is known once
+   * ReadImageInformation() was called. */
+  virtual bool CanStreamRead();
+
+  /** When streaming, the region read spans whole frames: the requested
+   * frames of a multi-frame object, or the whole image otherwise. */
+  virtual ImageIORegion
+  GenerateStreamableReadRegionFromRequestedRegion(const ImageIORegion & requested) const;
+
   /** Get the original component type of the image. This differs from
    * ComponentType which may change as a function of rescale slope and
    * intercept. */
@@ -320,6 +331,8 @@ private:
 
   ImageIOBase::IOComponentType m_InternalComponentType;
   InternalHeader *             m_DICOMHeader;
+
+  bool m_CanStreamFrames;
 };
 } // end namespace itk
 
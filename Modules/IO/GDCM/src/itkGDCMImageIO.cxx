@@ -30,6 +30,8 @@
 #include "itkGDCMImageIO.h"
 #include "itkIOCommon.h"
 #include "itkArray.h"
+#include "itkByteSwapper.h"
+#include "itkMultiThreader.h"
 #include "vnl/vnl_cross.h"
 
 #include "itkMetaDataObject.h"
@@ -47,6 +49,9 @@
 #include "gdcmRescaler.h"
 #include "gdcmImageReader.h"
 #include "gdcmImageWriter.h"
+#include "gdcmJPEGCodec.h"
+#include "gdcmJPEG2000Codec.h"
+#include "gdcmSequenceOfFragments.h"
 #include "gdcmUIDGenerator.h"
 #include "gdcmAttribute.h"
 #include "gdcmGlobal.h"
@@ -91,6 +96,8 @@ GDCMImageIO::GDCMImageIO()
   // By default use JPEG2000. For legacy system, one should prefer JPEG since
   // JPEG2000 was only recently added to the DICOM standard
   m_CompressionType = JPEG2000;
+
+  m_CanStreamFrames = false;
 }
 
 GDCMImageIO::~GDCMImageIO()
@@ -194,6 +201,214 @@ bool GDCMImageIO::CanReadFile(const char *filename)
   return false;
 }
 
+namespace
+{
+// Applies the planar configuration and palette conversions ITK expects
+// and decodes the pixels of image into buffer.
+bool GetITKImageBuffer(gdcm::Image & image, char *buffer)
+{
+  // I think ITK only allow RGB image by pixel (and not by plane)
+  if ( image.GetPlanarConfiguration() == 1 )
+    {
+    gdcm::ImageChangePlanarConfiguration icpc;
+    icpc.SetInput(image);
+    icpc.SetPlanarConfiguration(0);
+    icpc.Change();
+    image = icpc.GetOutput();
+    }
+
+  if ( image.GetPhotometricInterpretation() == gdcm::PhotometricInterpretation::PALETTE_COLOR )
+    {
+    gdcm::ImageApplyLookupTable ialut;
+    ialut.SetInput(image);
+    ialut.Apply();
+    image = ialut.GetOutput();
+    }
+
+  return image.GetBuffer(buffer);
+}
+
+// The fragments of an encapsulated Pixel Data element holding each frame
+typedef std::vector< std::vector< gdcm::Fragment > > FrameFragmentsType;
+
+// Assign the fragments to frames, either one fragment per frame or
+// through the Basic Offset Table. Returns false when the frames cannot
+// be told apart.
+bool GetFrameFragments(const gdcm::SequenceOfFragments & sqf,
+                       unsigned int numberOfFrames,
+                       FrameFragmentsType & frameFragments)
+{
+  const unsigned int numberOfFragments =
+    static_cast< unsigned int >( sqf.GetNumberOfFragments() );
+
+  frameFragments.clear();
+  frameFragments.resize(numberOfFrames);
+  if ( numberOfFragments == numberOfFrames )
+    {
+    for ( unsigned int i = 0; i < numberOfFragments; ++i )
+      {
+      frameFragments[i].push_back( sqf.GetFragment(i) );
+      }
+    return true;
+    }
+
+  const gdcm::ByteValue *table = sqf.GetTable().GetByteValue();
+  if ( table == NULL || table->GetLength() < 4 * numberOfFrames )
+    {
+    return false;
+    }
+
+  // Offsets of the first fragment item of each frame, relative to the
+  // first fragment item.
+  std::vector< uint32_t > offsets(numberOfFrames);
+  memcpy( &offsets[0], table->GetPointer(), 4 * numberOfFrames );
+  ByteSwapper< uint32_t >::SwapRangeFromSystemToLittleEndian(&offsets[0], numberOfFrames);
+  if ( offsets[0] != 0 )
+    {
+    return false;
+    }
+
+  uint32_t     position = 0;
+  unsigned int frame = 0;
+  for ( unsigned int i = 0; i < numberOfFragments; ++i )
+    {
+    const gdcm::Fragment & fragment = sqf.GetFragment(i);
+    while ( frame + 1 < numberOfFrames && offsets[frame + 1] <= position )
+      {
+      ++frame;
+      }
+    frameFragments[frame].push_back(fragment);
+    // Item tag and length, then the fragment itself
+    position += 8 + static_cast< uint32_t >( fragment.GetVL() );
+    }
+
+  for ( unsigned int f = 0; f < numberOfFrames; ++f )
+    {
+    if ( frameFragments[f].empty() )
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+// Build a single frame image holding its own copy of the fragments of
+// one frame, so that frames can be decoded on different threads without
+// sharing the reference counted gdcm objects. The lookup table cannot be
+// copied; palette images share it and must be decoded on one thread.
+bool CreateFrameImage(const gdcm::Image & image,
+                      const std::vector< gdcm::Fragment > & fragments,
+                      gdcm::Image & frame)
+{
+  gdcm::SmartPointer< gdcm::SequenceOfFragments > sqf = new gdcm::SequenceOfFragments;
+  for ( size_t k = 0; k < fragments.size(); ++k )
+    {
+    const gdcm::ByteValue *bv = fragments[k].GetByteValue();
+    if ( !bv )
+      {
+      return false;
+      }
+    gdcm::Fragment fragment;
+    fragment.SetByteValue( bv->GetPointer(), bv->GetLength() );
+    sqf->AddFragment(fragment);
+    }
+  gdcm::DataElement pixeldata( gdcm::Tag(0x7fe0, 0x0010) );
+  pixeldata.SetVR(gdcm::VR::OB);
+  pixeldata.SetValue(*sqf);
+  pixeldata.SetVLToUndefined();
+
+  frame.SetNumberOfDimensions(2);
+  frame.SetDimension( 0, image.GetDimension(0) );
+  frame.SetDimension( 1, image.GetDimension(1) );
+  frame.SetPixelFormat( image.GetPixelFormat() );
+  frame.SetPlanarConfiguration( image.GetPlanarConfiguration() );
+  frame.SetPhotometricInterpretation( image.GetPhotometricInterpretation() );
+  frame.SetTransferSyntax( image.GetTransferSyntax() );
+  frame.SetNeedByteSwap( image.GetNeedByteSwap() );
+  if ( image.GetPhotometricInterpretation() == gdcm::PhotometricInterpretation::PALETTE_COLOR )
+    {
+    frame.SetLUT( image.GetLUT() );
+    }
+  frame.SetDataElement(pixeldata);
+  return true;
+}
+
+// Build the single frame images of the frames to decode, one by one.
+bool CreateFrameImages(const gdcm::Image & image,
+                       const FrameFragmentsType & frameFragments,
+                       unsigned int firstFrame,
+                       unsigned int numberOfFrames,
+                       std::vector< gdcm::SmartPointer< gdcm::Image > > & frames)
+{
+  frames.resize(numberOfFrames);
+  for ( unsigned int i = 0; i < numberOfFrames; ++i )
+    {
+    frames[i] = new gdcm::Image;
+    if ( !CreateFrameImage(image, frameFragments[firstFrame + i], *frames[i]) )
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+struct FrameDecoderStruct {
+  std::vector< gdcm::SmartPointer< gdcm::Image > > Frames;
+  SizeValueType                                    FrameLength;
+  char *                                           Buffer;
+  std::vector< char >                              Failed;
+};
+
+// Decode a contiguous range of frames. Each thread only touches the
+// frame images of its range.
+ITK_THREAD_RETURN_TYPE DecodeFramesThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info =
+    static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  const ThreadIdType  threadId = info->ThreadID;
+  const ThreadIdType  numberOfThreads = info->NumberOfThreads;
+  FrameDecoderStruct *str = static_cast< FrameDecoderStruct * >( info->UserData );
+
+  const SizeValueType numberOfFrames = str->Frames.size();
+  const unsigned int  begin = static_cast< unsigned int >(
+    ( numberOfFrames * threadId ) / numberOfThreads );
+  const unsigned int  end = static_cast< unsigned int >(
+    ( numberOfFrames * ( threadId + 1 ) ) / numberOfThreads );
+
+  for ( unsigned int i = begin; i < end; ++i )
+    {
+    if ( !GetITKImageBuffer( *str->Frames[i], str->Buffer + i * str->FrameLength ) )
+      {
+      str->Failed[threadId] = 1;
+      }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+} // end anonymous namespace
+
+bool GDCMImageIO::CanStreamRead()
+{
+  return m_CanStreamFrames;
+}
+
+ImageIORegion
+GDCMImageIO::GenerateStreamableReadRegionFromRequestedRegion(const ImageIORegion & requested) const
+{
+  ImageIORegion streamableRegion =
+    Superclass::GenerateStreamableReadRegionFromRequestedRegion(requested);
+
+  // Frames are the only unit that can be read on their own
+  if ( m_UseStreamedReading && m_CanStreamFrames
+       && requested.GetImageDimension() > 2
+       && streamableRegion.GetImageDimension() > 2 )
+    {
+    streamableRegion.SetIndex( 2, requested.GetIndex(2) );
+    streamableRegion.SetSize( 2, requested.GetSize(2) );
+    }
+  return streamableRegion;
+}
+
 void GDCMImageIO::Read(void *pointer)
 {
   const char *filename = m_FileName.c_str();
@@ -212,35 +427,122 @@ void GDCMImageIO::Read(void *pointer)
   gdcm::PixelFormat pixeltype_debug = image.GetPixelFormat();
   itkAssertInDebugAndIgnoreInReleaseMacro(image.GetNumberOfDimensions() == 2 || image.GetNumberOfDimensions() == 3);
 #endif
-  SizeValueType len = image.GetBufferLength();
-
-  // I think ITK only allow RGB image by pixel (and not by plane)
-  if ( image.GetPlanarConfiguration() == 1 )
+  const gdcm::PixelFormat pixeltype = image.GetPixelFormat();
+  SizeValueType           len = image.GetBufferLength();
+  if ( image.GetPhotometricInterpretation() == gdcm::PhotometricInterpretation::PALETTE_COLOR )
     {
-    gdcm::ImageChangePlanarConfiguration icpc;
-    icpc.SetInput(image);
-    icpc.SetPlanarConfiguration(0);
-    icpc.Change();
-    image = icpc.GetOutput();
+    len *= 3;
     }
 
-  if ( image.GetPhotometricInterpretation() == gdcm::PhotometricInterpretation::PALETTE_COLOR )
+  // Range of frames to read
+  const unsigned int numberOfFrames =
+    ( image.GetNumberOfDimensions() == 3 ) ? image.GetDimension(2) : 1;
+  unsigned int firstFrame = 0;
+  unsigned int numberOfFramesToRead = numberOfFrames;
+  if ( m_CanStreamFrames && m_IORegion.GetImageDimension() > 2 )
     {
-    gdcm::ImageApplyLookupTable ialut;
-    ialut.SetInput(image);
-    ialut.Apply();
-    image = ialut.GetOutput();
-    len *= 3;
+    firstFrame = static_cast< unsigned int >( m_IORegion.GetIndex(2) );
+    numberOfFramesToRead = static_cast< unsigned int >( m_IORegion.GetSize(2) );
+    }
+  if ( firstFrame + numberOfFramesToRead > numberOfFrames )
+    {
+    itkExceptionMacro(<< "Requested frames " << firstFrame << " to "
+                      << firstFrame + numberOfFramesToRead - 1 << " of a file with "
+                      << numberOfFrames << " frames");
     }
 
-  if ( !image.GetBuffer( (char*)pointer ) )
+  if ( numberOfFramesToRead == numberOfFrames )
     {
-    itkExceptionMacro(<< "Failed to get the buffer!");
-    return;
+    if ( !GetITKImageBuffer( image, (char *)pointer ) )
+      {
+      itkExceptionMacro(<< "Failed to get the buffer!");
+      return;
+      }
     }
+  else
+    {
+    const SizeValueType frameLength = len / numberOfFrames;
+    len = frameLength * numberOfFramesToRead;
 
-  const gdcm::PixelFormat & pixeltype = image.GetPixelFormat();
-  itkAssertInDebugAndIgnoreInReleaseMacro( pixeltype_debug == pixeltype );
+    const gdcm::DataElement &         pixeldata = image.GetDataElement();
+    const gdcm::ByteValue *           bv = pixeldata.GetByteValue();
+    const gdcm::SequenceOfFragments * sqf = pixeldata.GetSequenceOfFragments();
+    FrameFragmentsType                frameFragments;
+    FrameDecoderStruct                str;
+
+    if ( bv )
+      {
+      // Native pixel data: only convert the bytes of the requested frames
+      const SizeValueType storedFrameLength =
+        static_cast< SizeValueType >( image.GetDimension(0) ) * image.GetDimension(1)
+        * pixeltype.GetPixelSize();
+      gdcm::DataElement subset( gdcm::Tag(0x7fe0, 0x0010) );
+      subset.SetVR( pixeldata.GetVR() );
+      subset.SetByteValue( bv->GetPointer() + firstFrame * storedFrameLength,
+                           static_cast< uint32_t >( numberOfFramesToRead * storedFrameLength ) );
+
+      gdcm::Image frames = image;
+      frames.SetDimension(2, numberOfFramesToRead);
+      frames.SetDataElement(subset);
+      if ( !GetITKImageBuffer( frames, (char *)pointer ) )
+        {
+        itkExceptionMacro(<< "Failed to get the buffer!");
+        }
+      }
+    else if ( sqf && GetFrameFragments(*sqf, numberOfFrames, frameFragments)
+              && CreateFrameImages(image, frameFragments, firstFrame,
+                                   numberOfFramesToRead, str.Frames) )
+      {
+      // Encapsulated pixel data: only decompress the fragments of the
+      // requested frames. JPEG and JPEG 2000 frames are independent and
+      // are decoded in parallel, each from its own frame image.
+      str.FrameLength = frameLength;
+      str.Buffer = (char *)pointer;
+
+      ThreadIdType numberOfThreads = 1;
+      gdcm::JPEGCodec     jpeg;
+      gdcm::JPEG2000Codec jpeg2000;
+      if ( ( jpeg.CanDecode( image.GetTransferSyntax() )
+             || jpeg2000.CanDecode( image.GetTransferSyntax() ) )
+           && image.GetPhotometricInterpretation() != gdcm::PhotometricInterpretation::PALETTE_COLOR )
+        {
+        numberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
+        if ( numberOfThreads > numberOfFramesToRead )
+          {
+          numberOfThreads = numberOfFramesToRead;
+          }
+        }
+      str.Failed.resize(numberOfThreads, 0);
+
+      MultiThreader::Pointer threader = MultiThreader::New();
+      threader->SetNumberOfThreads(numberOfThreads);
+      threader->SetSingleMethod(DecodeFramesThreaderCallback, &str);
+      threader->SingleMethodExecute();
+
+      for ( ThreadIdType t = 0; t < str.Failed.size(); ++t )
+        {
+        if ( str.Failed[t] )
+          {
+          itkExceptionMacro(<< "Failed to get the buffer!");
+          }
+        }
+      }
+    else
+      {
+      // The frames cannot be told apart, decode everything
+      const SizeValueType fullLength = frameLength * numberOfFrames;
+      char *              full = new char[fullLength];
+      if ( !GetITKImageBuffer(image, full) )
+        {
+        delete[] full;
+        itkExceptionMacro(<< "Failed to get the buffer!");
+        }
+      memcpy( pointer, full + firstFrame * frameLength, len );
+      delete[] full;
+      }
+    }
+
+  itkAssertInDebugAndIgnoreInReleaseMacro( pixeltype_debug == image.GetPixelFormat() );
 
   if ( m_RescaleSlope != 1.0 || m_RescaleIntercept != 0.0 )
     {
@@ -262,7 +564,8 @@ void GDCMImageIO::Read(void *pointer)
   // Now that len was updated (after unpacker 12bits -> 16bits, rescale...) ,
   // can now check compat:
   const SizeValueType numberOfBytesToBeRead =
-    static_cast< SizeValueType >( this->GetImageSizeInBytes() );
+    static_cast< SizeValueType >( this->GetImageSizeInBytes() )
+    / numberOfFrames * numberOfFramesToRead;
   itkAssertInDebugAndIgnoreInReleaseMacro(numberOfBytesToBeRead == len);   // programmer error
 #endif
 }
@@ -394,6 +697,10 @@ void GDCMImageIO::InternalReadImageInformation(std::ifstream & file)
     m_Dimensions[2] = 1;
     }
 
+  // Frames of multi-frame objects can be read on their own, except when
+  // the stored pixels are packed across byte boundaries.
+  m_CanStreamFrames = ( m_Dimensions[2] > 1 && pixeltype.GetBitsAllocated() % 8 == 0 );
+
   const double *       dircos = image.GetDirectionCosines();
   vnl_vector< double > rowDirection(3), columnDirection(3);
   rowDirection[0] = dircos[0];
@@ -1141,6 +1448,7 @@ void GDCMImageIO::PrintSelf(std::ostream & os, Indent indent) const
   os << indent << "SeriesInstanceUID: " << m_SeriesInstanceUID << std::endl;
   os << indent << "FrameOfReferenceInstanceUID: " << m_FrameOfReferenceInstanceUID << std::endl;
   os << indent << "CompressionType:" << m_CompressionType << std::endl;
+  os << indent << "CanStreamFrames: " << ( m_CanStreamFrames ? "On" : "Off" ) << std::endl;
 
 #if defined( ITKIO_DEPRECATED_GDCM1_API )
   os << indent << "Patient Name:" << m_PatientName << std::endl;
@@ -0,0 +1,136 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkGDCMImageIO.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkPipelineMonitorImageFilter.h"
+#include "itkStreamingImageFilter.h"
+
+// Write a multi-frame DICOM object, uncompressed and with each of the
+// lossless compressions, and read it back frame range by frame range.
+int itkGDCMImageIOMultiFrameStreamingTest(int argc, char *argv[])
+{
+  if( argc < 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " OutputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::Image< unsigned short, 3 >                    ImageType;
+  typedef itk::ImageFileReader< ImageType >                  ReaderType;
+  typedef itk::ImageFileWriter< ImageType >                  WriterType;
+  typedef itk::GDCMImageIO                                   ImageIOType;
+  typedef itk::PipelineMonitorImageFilter< ImageType >       MonitorType;
+  typedef itk::StreamingImageFilter< ImageType, ImageType >  StreamerType;
+
+  const unsigned int numberOfFrames = 12;
+  const unsigned int numberOfPieces = 4;
+
+  ImageType::SizeType size;
+  size[0] = 64;
+  size[1] = 48;
+  size[2] = numberOfFrames;
+  ImageType::RegionType region;
+  region.SetSize(size);
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(region);
+  image->Allocate();
+  itk::ImageRegionIterator< ImageType > it( image, region );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType idx = it.GetIndex();
+    it.Set( static_cast< unsigned short >( 1000 * idx[2] + 10 * idx[1] + idx[0] ) );
+    }
+
+  const char *names[] = { "Raw", "JPEG", "JPEG2000" };
+  for( unsigned int c = 0; c < 3; ++c )
+    {
+    const std::string fileName = std::string( argv[1] )
+      + "/itkGDCMImageIOMultiFrameStreamingTest" + names[c] + ".dcm";
+
+    ImageIOType::Pointer writeIO = ImageIOType::New();
+    if( c == 1 )
+      {
+      writeIO->SetCompressionType( ImageIOType::JPEG );
+      }
+    else if( c == 2 )
+      {
+      writeIO->SetCompressionType( ImageIOType::JPEG2000 );
+      }
+
+    WriterType::Pointer writer = WriterType::New();
+    writer->SetInput( image );
+    writer->SetFileName( fileName );
+    writer->SetImageIO( writeIO );
+    writer->SetUseCompression( c != 0 );
+
+    ImageIOType::Pointer readIO = ImageIOType::New();
+    ReaderType::Pointer reader = ReaderType::New();
+    reader->SetFileName( fileName );
+    reader->SetImageIO( readIO );
+
+    MonitorType::Pointer monitor = MonitorType::New();
+    monitor->SetInput( reader->GetOutput() );
+
+    StreamerType::Pointer streamer = StreamerType::New();
+    streamer->SetInput( monitor->GetOutput() );
+    streamer->SetNumberOfStreamDivisions( numberOfPieces );
+
+    try
+      {
+      writer->Update();
+      streamer->Update();
+      }
+    catch( itk::ExceptionObject & err )
+      {
+      std::cerr << names[c] << ": " << err << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    if( !readIO->CanStreamRead() )
+      {
+      std::cerr << names[c] << ": multi-frame object cannot be streamed" << std::endl;
+      return EXIT_FAILURE;
+      }
+    if( !monitor->VerifyAllInputCanStream( numberOfPieces ) )
+      {
+      std::cerr << monitor;
+      std::cerr << names[c] << ": pipeline did not stream as expected" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    itk::ImageRegionConstIterator< ImageType > ref( image, region );
+    itk::ImageRegionConstIterator< ImageType > out( streamer->GetOutput(), region );
+    for( ref.GoToBegin(), out.GoToBegin(); !ref.IsAtEnd(); ++ref, ++out )
+      {
+      if( ref.Get() != out.Get() )
+        {
+        std::cerr << names[c] << ": pixel " << ref.GetIndex() << " is " << out.Get()
+                  << ", expected " << ref.Get() << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    std::cout << names[c] << ": streamed read matches" << std::endl;
+    }
+
+  return EXIT_SUCCESS;
+}
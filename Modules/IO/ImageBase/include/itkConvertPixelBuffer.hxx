@@ -181,6 +181,28 @@ ConvertPixelBuffer< InputPixelType, OutputPixelType, OutputConvertTraits >
 
   InputPixelType *endInput = inputData + size * 3;
 
+  // For integral output components of at most 16 bits, the weighted sum
+  // of the components is exact in an int, and so is its quotient once
+  // truncated: its fractional part is at least 1/10000 unless it is zero,
+  // far more than the rounding error of the division by 10000.0. The
+  // integer division gives the same values without the floating point
+  // conversions and divisions.
+  if ( NumericTraits< OutputComponentType >::is_integer
+       && sizeof( OutputComponentType ) <= 2 )
+    {
+    while ( inputData != endInput )
+      {
+      const int sum =
+        2125 * static_cast< int >( static_cast< OutputComponentType >( *inputData ) )
+        + 7154 * static_cast< int >( static_cast< OutputComponentType >( *( inputData + 1 ) ) )
+        + 721 * static_cast< int >( static_cast< OutputComponentType >( *( inputData + 2 ) ) );
+      inputData += 3;
+      OutputConvertTraits::SetNthComponent( 0, *outputData++,
+                                            static_cast< OutputComponentType >( sum / 10000 ) );
+      }
+    return;
+    }
+
   while ( inputData != endInput )
     {
     OutputComponentType val = static_cast< OutputComponentType >(
@@ -292,17 +314,15 @@ ConvertPixelBuffer< InputPixelType, OutputPixelType, OutputConvertTraits >
 {
   InputPixelType *endInput = inputData + size;
 
+  // Convert the input value once, before the output components are set:
+  // the compiler cannot assume that setting them leaves the input
+  // unchanged, and would otherwise read and convert it again each time.
   while ( inputData != endInput )
     {
-    OutputConvertTraits::SetNthComponent( 0, *outputData,
-                                          static_cast< OutputComponentType >
-                                          ( *inputData ) );
-    OutputConvertTraits::SetNthComponent( 1, *outputData,
-                                          static_cast< OutputComponentType >
-                                          ( *inputData ) );
-    OutputConvertTraits::SetNthComponent( 2, *outputData,
-                                          static_cast< OutputComponentType >
-                                          ( *inputData ) );
+    const OutputComponentType val = static_cast< OutputComponentType >( *inputData );
+    OutputConvertTraits::SetNthComponent(0, *outputData, val);
+    OutputConvertTraits::SetNthComponent(1, *outputData, val);
+    OutputConvertTraits::SetNthComponent(2, *outputData, val);
     inputData++;
     outputData++;
     }
@@ -319,17 +339,15 @@ ConvertPixelBuffer< InputPixelType, OutputPixelType, OutputConvertTraits >
 {
   InputPixelType *endInput = inputData + size * 3;
 
+  // read all the input components before setting the output ones
   while ( inputData != endInput )
     {
-    OutputConvertTraits::SetNthComponent( 0, *outputData,
-                                          static_cast< OutputComponentType >
-                                          ( *inputData ) );
-    OutputConvertTraits::SetNthComponent( 1, *outputData,
-                                          static_cast< OutputComponentType >
-                                          ( *( inputData + 1 ) ) );
-    OutputConvertTraits::SetNthComponent( 2, *outputData,
-                                          static_cast< OutputComponentType >
-                                          ( *( inputData + 2 ) ) );
+    const OutputComponentType red = static_cast< OutputComponentType >( *inputData );
+    const OutputComponentType green = static_cast< OutputComponentType >( *( inputData + 1 ) );
+    const OutputComponentType blue = static_cast< OutputComponentType >( *( inputData + 2 ) );
+    OutputConvertTraits::SetNthComponent(0, *outputData, red);
+    OutputConvertTraits::SetNthComponent(1, *outputData, green);
+    OutputConvertTraits::SetNthComponent(2, *outputData, blue);
     inputData += 3;
     outputData++;
     }
@@ -346,17 +364,15 @@ ConvertPixelBuffer< InputPixelType, OutputPixelType, OutputConvertTraits >
 {
   InputPixelType *endInput = inputData + size * 4;
 
+  // read all the input components before setting the output ones
   while ( inputData != endInput )
     {
-    OutputConvertTraits::SetNthComponent( 0, *outputData,
-                                          static_cast< OutputComponentType >
-                                          ( *inputData ) );
-    OutputConvertTraits::SetNthComponent( 1, *outputData,
-                                          static_cast< OutputComponentType >
-                                          ( *( inputData + 1 ) ) );
-    OutputConvertTraits::SetNthComponent( 2, *outputData,
-                                          static_cast< OutputComponentType >
-                                          ( *( inputData + 2 ) ) );
+    const OutputComponentType red = static_cast< OutputComponentType >( *inputData );
+    const OutputComponentType green = static_cast< OutputComponentType >( *( inputData + 1 ) );
+    const OutputComponentType blue = static_cast< OutputComponentType >( *( inputData + 2 ) );
+    OutputConvertTraits::SetNthComponent(0, *outputData, red);
+    OutputConvertTraits::SetNthComponent(1, *outputData, green);
+    OutputConvertTraits::SetNthComponent(2, *outputData, blue);
     inputData += 3;
     inputData++; // skip alpha
     outputData++;
@@ -397,15 +413,12 @@ ConvertPixelBuffer< InputPixelType, OutputPixelType, OutputConvertTraits >
     InputPixelType *endInput = inputData + size * (size_t)inputNumberOfComponents;
     while ( inputData != endInput )
       {
-      OutputConvertTraits::SetNthComponent( 0, *outputData,
-                                            static_cast< OutputComponentType >
-                                            ( *inputData ) );
-      OutputConvertTraits::SetNthComponent( 1, *outputData,
-                                            static_cast< OutputComponentType >
-                                            ( *( inputData + 1 ) ) );
-      OutputConvertTraits::SetNthComponent( 2, *outputData,
-                                            static_cast< OutputComponentType >
-                                            ( *( inputData + 2 ) ) );
+      const OutputComponentType red = static_cast< OutputComponentType >( *inputData );
+      const OutputComponentType green = static_cast< OutputComponentType >( *( inputData + 1 ) );
+      const OutputComponentType blue = static_cast< OutputComponentType >( *( inputData + 2 ) );
+      OutputConvertTraits::SetNthComponent(0, *outputData, red);
+      OutputConvertTraits::SetNthComponent(1, *outputData, green);
+      OutputConvertTraits::SetNthComponent(2, *outputData, blue);
       inputData += 3;
       inputData += diff;
       outputData++;
@@ -423,22 +436,17 @@ ConvertPixelBuffer< InputPixelType, OutputPixelType, OutputConvertTraits >
                     OutputPixelType *outputData, size_t size)
 
 {
-  InputPixelType *endInput = inputData + size;
+  InputPixelType *          endInput = inputData + size;
+  const OutputComponentType alpha = static_cast< OutputComponentType >( 1 );
 
+  // convert the input value once, before the output components are set
   while ( inputData != endInput )
     {
-    OutputConvertTraits::SetNthComponent( 0, *outputData,
-                                          static_cast< OutputComponentType >
-                                          ( *inputData ) );
-    OutputConvertTraits::SetNthComponent( 1, *outputData,
-                                          static_cast< OutputComponentType >
-                                          ( *inputData ) );
-    OutputConvertTraits::SetNthComponent( 2, *outputData,
-                                          static_cast< OutputComponentType >
-                                          ( *inputData ) );
-    OutputConvertTraits::SetNthComponent( 3, *outputData,
-                                          static_cast< OutputComponentType >
-                                          ( 1 ) );
+    const OutputComponentType val = static_cast< OutputComponentType >( *inputData );
+    OutputConvertTraits::SetNthComponent(0, *outputData, val);
+    OutputConvertTraits::SetNthComponent(1, *outputData, val);
+    OutputConvertTraits::SetNthComponent(2, *outputData, val);
+    OutputConvertTraits::SetNthComponent(3, *outputData, alpha);
     inputData++;
     outputData++;
     }
@@ -453,22 +461,19 @@ ConvertPixelBuffer< InputPixelType, OutputPixelType, OutputConvertTraits >
 ::ConvertRGBToRGBA(InputPixelType *inputData,
                    OutputPixelType *outputData, size_t size)
 {
-  InputPixelType *endInput = inputData + size * 3;
+  InputPixelType *          endInput = inputData + size * 3;
+  const OutputComponentType alpha = static_cast< OutputComponentType >( 1 );
 
+  // read all the input components before setting the output ones
   while ( inputData != endInput )
     {
-    OutputConvertTraits::SetNthComponent( 0, *outputData,
-                                          static_cast< OutputComponentType >
-                                          ( *inputData ) );
-    OutputConvertTraits::SetNthComponent( 1, *outputData,
-                                          static_cast< OutputComponentType >
-                                          ( *( inputData + 1 ) ) );
-    OutputConvertTraits::SetNthComponent( 2, *outputData,
-                                          static_cast< OutputComponentType >
-                                          ( *( inputData + 2 ) ) );
-    OutputConvertTraits::SetNthComponent( 3, *outputData,
-                                          static_cast< OutputComponentType >
-                                          ( 1 ) );
+    const OutputComponentType red = static_cast< OutputComponentType >( *inputData );
+    const OutputComponentType green = static_cast< OutputComponentType >( *( inputData + 1 ) );
+    const OutputComponentType blue = static_cast< OutputComponentType >( *( inputData + 2 ) );
+    OutputConvertTraits::SetNthComponent(0, *outputData, red);
+    OutputConvertTraits::SetNthComponent(1, *outputData, green);
+    OutputConvertTraits::SetNthComponent(2, *outputData, blue);
+    OutputConvertTraits::SetNthComponent(3, *outputData, alpha);
     inputData += 3;
     outputData++;
     }
@@ -485,20 +490,17 @@ ConvertPixelBuffer< InputPixelType, OutputPixelType, OutputConvertTraits >
 {
   InputPixelType *endInput = inputData + size * 4;
 
+  // read all the input components before setting the output ones
   while ( inputData != endInput )
     {
-    OutputConvertTraits::SetNthComponent( 0, *outputData,
-                                          static_cast< OutputComponentType >
-                                          ( *inputData ) );
-    OutputConvertTraits::SetNthComponent( 1, *outputData,
-                                          static_cast< OutputComponentType >
-                                          ( *( inputData + 1 ) ) );
-    OutputConvertTraits::SetNthComponent( 2, *outputData,
-                                          static_cast< OutputComponentType >
-                                          ( *( inputData + 2 ) ) );
-    OutputConvertTraits::SetNthComponent( 3, *outputData,
-                                          static_cast< OutputComponentType >
-                                          ( *( inputData + 3 ) ) );
+    const OutputComponentType red = static_cast< OutputComponentType >( *inputData );
+    const OutputComponentType green = static_cast< OutputComponentType >( *( inputData + 1 ) );
+    const OutputComponentType blue = static_cast< OutputComponentType >( *( inputData + 2 ) );
+    const OutputComponentType alpha = static_cast< OutputComponentType >( *( inputData + 3 ) );
+    OutputConvertTraits::SetNthComponent(0, *outputData, red);
+    OutputConvertTraits::SetNthComponent(1, *outputData, green);
+    OutputConvertTraits::SetNthComponent(2, *outputData, blue);
+    OutputConvertTraits::SetNthComponent(3, *outputData, alpha);
     inputData += 4;
     outputData++;
     }
@@ -528,6 +530,7 @@ ConvertPixelBuffer< InputPixelType, OutputPixelType, OutputConvertTraits >
       OutputConvertTraits::SetNthComponent(1, *outputData, val);
       OutputConvertTraits::SetNthComponent(2, *outputData, val);
       OutputConvertTraits::SetNthComponent(3, *outputData, alpha);
+      outputData++;
       }
     }
   else
@@ -536,18 +539,14 @@ ConvertPixelBuffer< InputPixelType, OutputPixelType, OutputConvertTraits >
     InputPixelType *endInput = inputData + size * (size_t)inputNumberOfComponents;
     while ( inputData != endInput )
       {
-      OutputConvertTraits::SetNthComponent( 0, *outputData,
-                                            static_cast< OutputComponentType >
-                                            ( *inputData ) );
-      OutputConvertTraits::SetNthComponent( 1, *outputData,
-                                            static_cast< OutputComponentType >
-                                            ( *( inputData + 1 ) ) );
-      OutputConvertTraits::SetNthComponent( 2, *outputData,
-                                            static_cast< OutputComponentType >
-                                            ( *( inputData + 2 ) ) );
-      OutputConvertTraits::SetNthComponent( 3, *outputData,
-                                            static_cast< OutputComponentType >
-                                            ( *( inputData + 3 ) ) );
+      const OutputComponentType red = static_cast< OutputComponentType >( *inputData );
+      const OutputComponentType green = static_cast< OutputComponentType >( *( inputData + 1 ) );
+      const OutputComponentType blue = static_cast< OutputComponentType >( *( inputData + 2 ) );
+      const OutputComponentType alpha = static_cast< OutputComponentType >( *( inputData + 3 ) );
+      OutputConvertTraits::SetNthComponent(0, *outputData, red);
+      OutputConvertTraits::SetNthComponent(1, *outputData, green);
+      OutputConvertTraits::SetNthComponent(2, *outputData, blue);
+      OutputConvertTraits::SetNthComponent(3, *outputData, alpha);
       inputData += 4;
       inputData += diff;
       outputData++;
@@ -595,14 +594,12 @@ ConvertPixelBuffer< InputPixelType, OutputPixelType, OutputConvertTraits >
 {
   InputPixelType *endInput = inputData + size;
 
+  // convert the input value once, before the output components are set
   while ( inputData != endInput )
     {
-    OutputConvertTraits::SetNthComponent( 0, *outputData,
-                                          static_cast< OutputComponentType >
-                                          ( *inputData ) );
-    OutputConvertTraits::SetNthComponent( 1, *outputData,
-                                          static_cast< OutputComponentType >
-                                          ( *inputData ) );
+    const OutputComponentType val = static_cast< OutputComponentType >( *inputData );
+    OutputConvertTraits::SetNthComponent(0, *outputData, val);
+    OutputConvertTraits::SetNthComponent(1, *outputData, val);
     inputData++;
     outputData++;
     }
@@ -0,0 +1,210 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkImageFileReaderPrefetcher_h
+#define __itkImageFileReaderPrefetcher_h
+
+#include <vector>
+#include <string>
+#include "itkImageFileReader.h"
+#include "itkMultiThreader.h"
+#include "itkConditionVariable.h"
+
+namespace itk
+{
+/** \class ImageFileReaderPrefetcher
+ * \brief Reads a list of image files ahead of their use on background threads.
+ *
+ * Batch pipelines frequently process a long list of independent files
+ * one after the other, and spend a significant fraction of their time
+ * waiting for the disk and for the decoder. ImageFileReaderPrefetcher
+ * reads and decodes the next files of the list on background threads
+ * while the caller is busy with the current one.
+ *
+ * Each file is read with an ordinary ImageFileReader, so the
+ * ImageIOFactory lookup, the pixel conversion and the error reporting
+ * are exactly those of the synchronous path. Factory lookups are
+ * serialized between the worker threads of a prefetcher.
+ *
+ * At most NumberOfFilesToPrefetch files are read ahead of the image
+ * that will be returned next. When MemoryBudget is not zero, a file is
+ * only read if the images already decoded and not yet handed to the
+ * caller, plus the new one, fit within the budget. The image the caller
+ * is waiting for is always read, even if it alone exceeds the budget.
+ *
+ * GetNextImage() returns the images in the order of the file list. The
+ * image is disconnected from the reader that produced it and is handed
+ * over without a copy. If reading a file failed, GetNextImage() throws
+ * the exception that the reader raised; the following files can still
+ * be retrieved afterwards.
+ *
+ * \sa ImageFileReader
+ * \sa ImageSeriesReader
+ *
+ * \ingroup IOFilters
+ * \ingroup ITKIOImageBase
+ */
+template< class TOutputImage >
+class ITK_EXPORT ImageFileReaderPrefetcher:public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef ImageFileReaderPrefetcher  Self;
+  typedef Object                     Superclass;
+  typedef SmartPointer< Self >       Pointer;
+  typedef SmartPointer< const Self > ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ImageFileReaderPrefetcher, Object);
+
+  /** Image types. */
+  typedef TOutputImage                      OutputImageType;
+  typedef typename OutputImageType::Pointer OutputImagePointer;
+
+  /** The reader used for each file of the list. */
+  typedef ImageFileReader< OutputImageType > ReaderType;
+
+  typedef std::vector< std::string > FileNamesContainer;
+
+  /** Set the list of files to read. This stops any prefetching in
+   * progress. */
+  void SetFileNames(const FileNamesContainer & name);
+
+  /** Append a file to the list. This stops any prefetching in
+   * progress. */
+  void AddFileName(const std::string & name);
+
+  /** Get the list of files to read. */
+  const FileNamesContainer & GetFileNames() const
+  {
+    return m_FileNames;
+  }
+
+  /** Set/Get the number of files read ahead of the image that
+   * GetNextImage() will return next. Defaults to 2. */
+  itkSetClampMacro(NumberOfFilesToPrefetch, unsigned int,
+                   1, NumericTraits< unsigned int >::max());
+  itkGetConstMacro(NumberOfFilesToPrefetch, unsigned int);
+
+  /** Set/Get the number of background threads. Defaults to 1. No more
+   * threads than NumberOfFilesToPrefetch are started. */
+  itkSetClampMacro(NumberOfThreads, ThreadIdType, 1, ITK_MAX_THREADS);
+  itkGetConstMacro(NumberOfThreads, ThreadIdType);
+
+  /** Set/Get the maximum number of bytes held by images that were read
+   * ahead and not yet returned. A value of zero, the default, disables
+   * the limit. */
+  itkSetMacro(MemoryBudget, SizeValueType);
+  itkGetConstMacro(MemoryBudget, SizeValueType);
+
+  /** Start reading from the beginning of the file list. Any prefetching
+   * in progress is stopped first. */
+  void Start();
+
+  /** Stop the background threads and discard the images that were read
+   * ahead. A file being read when Stop() is called is read to the end
+   * before the thread exits. A later call to GetNextImage() restarts
+   * the threads from the file that was to be returned next. */
+  void Stop();
+
+  /** Return the image read from the next file of the list, waiting for
+   * it if necessary. The background threads are started on the first
+   * call if Start() was not called. Returns a null pointer once all the
+   * files have been returned. */
+  OutputImagePointer GetNextImage();
+
+  /** Return true once all the files of the list have been returned by
+   * GetNextImage(). */
+  bool IsAtEnd() const
+  {
+    return m_NextFileToDeliver >= m_FileNames.size();
+  }
+
+  /** Index in the file list of the image GetNextImage() will return
+   * next. */
+  SizeValueType GetNextFileIndex() const
+  {
+    return m_NextFileToDeliver;
+  }
+
+protected:
+  ImageFileReaderPrefetcher();
+  ~ImageFileReaderPrefetcher();
+  void PrintSelf(std::ostream & os, Indent indent) const;
+
+  /** Spawn the background threads, starting with the given file. */
+  void StartAt(SizeValueType firstFile);
+
+  /** Reads the files claimed by one background thread. */
+  static ITK_THREAD_RETURN_TYPE ThreadFunction(void *arg);
+
+  /** Read a single file. Called by the background threads without the
+   * lock held. */
+  void ReadFile(SizeValueType fileIndex);
+
+private:
+  ImageFileReaderPrefetcher(const Self &); //purposely not implemented
+  void operator=(const Self &);            //purposely not implemented
+
+  typedef enum {
+    Pending,
+    Reading,
+    Ready,
+    Failed
+  } FileStateType;
+
+  /** Book-keeping of a file of the list. */
+  struct FileSlot {
+    FileStateType      State;
+    OutputImagePointer Image;
+    SizeValueType      MemorySize;
+    ExceptionObject    Exception;
+  };
+
+  typedef std::vector< FileSlot >     FileSlotContainer;
+  typedef std::vector< ThreadIdType > ThreadIdContainer;
+
+  FileNamesContainer m_FileNames;
+
+  unsigned int  m_NumberOfFilesToPrefetch;
+  ThreadIdType  m_NumberOfThreads;
+  SizeValueType m_MemoryBudget;
+
+  MultiThreader::Pointer m_Threader;
+  ThreadIdContainer      m_ThreadIds;
+
+  // Everything below is protected by m_Mutex while threads are running
+  SimpleMutexLock            m_Mutex;
+  SimpleMutexLock            m_FactoryMutex;
+  ConditionVariable::Pointer m_FileReadCondition;
+  ConditionVariable::Pointer m_FileDeliveredCondition;
+  FileSlotContainer          m_Slots;
+  SizeValueType              m_NextFileToRead;
+  SizeValueType              m_NextFileToDeliver;
+  SizeValueType              m_MemoryInUse;
+  bool                       m_Stopping;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkImageFileReaderPrefetcher.hxx"
+#endif
+
+#endif // __itkImageFileReaderPrefetcher_h
@@ -0,0 +1,329 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkImageFileReaderPrefetcher_hxx
+#define __itkImageFileReaderPrefetcher_hxx
+
+#include "itkImageFileReaderPrefetcher.h"
+
+namespace itk
+{
+template< class TOutputImage >
+ImageFileReaderPrefetcher< TOutputImage >
+::ImageFileReaderPrefetcher():
+  m_NumberOfFilesToPrefetch(2),
+  m_NumberOfThreads(1),
+  m_MemoryBudget(0),
+  m_NextFileToRead(0),
+  m_NextFileToDeliver(0),
+  m_MemoryInUse(0),
+  m_Stopping(false)
+{
+  m_Threader = MultiThreader::New();
+  m_FileReadCondition = ConditionVariable::New();
+  m_FileDeliveredCondition = ConditionVariable::New();
+}
+
+template< class TOutputImage >
+ImageFileReaderPrefetcher< TOutputImage >
+::~ImageFileReaderPrefetcher()
+{
+  this->Stop();
+}
+
+template< class TOutputImage >
+void
+ImageFileReaderPrefetcher< TOutputImage >
+::SetFileNames(const FileNamesContainer & name)
+{
+  this->Stop();
+  m_FileNames = name;
+  m_NextFileToDeliver = 0;
+  this->Modified();
+}
+
+template< class TOutputImage >
+void
+ImageFileReaderPrefetcher< TOutputImage >
+::AddFileName(const std::string & name)
+{
+  this->Stop();
+  m_FileNames.push_back(name);
+  m_NextFileToDeliver = 0;
+  this->Modified();
+}
+
+template< class TOutputImage >
+void
+ImageFileReaderPrefetcher< TOutputImage >
+::Start()
+{
+  this->Stop();
+  this->StartAt(0);
+}
+
+template< class TOutputImage >
+void
+ImageFileReaderPrefetcher< TOutputImage >
+::StartAt(SizeValueType firstFile)
+{
+  m_Slots.resize( m_FileNames.size() );
+  for ( SizeValueType i = 0; i < m_Slots.size(); i++ )
+    {
+    m_Slots[i].State = Pending;
+    m_Slots[i].MemorySize = 0;
+    }
+  m_NextFileToRead = firstFile;
+  m_NextFileToDeliver = firstFile;
+  m_MemoryInUse = 0;
+  m_Stopping = false;
+
+  // More threads than files that may be read ahead would only wait
+  ThreadIdType numberOfThreads = m_NumberOfThreads;
+  if ( numberOfThreads > m_NumberOfFilesToPrefetch )
+    {
+    numberOfThreads = m_NumberOfFilesToPrefetch;
+    }
+  if ( numberOfThreads > m_FileNames.size() - firstFile )
+    {
+    numberOfThreads = static_cast< ThreadIdType >( m_FileNames.size() - firstFile );
+    }
+
+  for ( ThreadIdType t = 0; t < numberOfThreads; t++ )
+    {
+    m_ThreadIds.push_back( m_Threader->SpawnThread(Self::ThreadFunction, this) );
+    }
+}
+
+template< class TOutputImage >
+void
+ImageFileReaderPrefetcher< TOutputImage >
+::Stop()
+{
+  if ( m_ThreadIds.empty() )
+    {
+    return;
+    }
+
+  m_Mutex.Lock();
+  m_Stopping = true;
+  m_FileDeliveredCondition->Broadcast();
+  m_Mutex.Unlock();
+
+  for ( size_t t = 0; t < m_ThreadIds.size(); t++ )
+    {
+    m_Threader->TerminateThread(m_ThreadIds[t]);
+    }
+  m_ThreadIds.clear();
+
+  // Release the images that were read ahead
+  m_Slots.clear();
+  m_MemoryInUse = 0;
+}
+
+template< class TOutputImage >
+typename ImageFileReaderPrefetcher< TOutputImage >::OutputImagePointer
+ImageFileReaderPrefetcher< TOutputImage >
+::GetNextImage()
+{
+  if ( this->IsAtEnd() )
+    {
+    return OutputImagePointer();
+    }
+
+  if ( m_ThreadIds.empty() )
+    {
+    // Resume where the caller left off
+    this->StartAt(m_NextFileToDeliver);
+    }
+
+  m_Mutex.Lock();
+  FileSlot & slot = m_Slots[m_NextFileToDeliver];
+  while ( slot.State != Ready && slot.State != Failed )
+    {
+    m_FileReadCondition->Wait(&m_Mutex);
+    }
+
+  OutputImagePointer image = slot.Image;
+  const bool         failed = ( slot.State == Failed );
+  ExceptionObject    exception = slot.Exception;
+
+  slot.Image = NULL;
+  m_MemoryInUse -= slot.MemorySize;
+  ++m_NextFileToDeliver;
+  m_FileDeliveredCondition->Broadcast();
+  m_Mutex.Unlock();
+
+  if ( failed )
+    {
+    throw exception;
+    }
+  return image;
+}
+
+template< class TOutputImage >
+ITK_THREAD_RETURN_TYPE
+ImageFileReaderPrefetcher< TOutputImage >
+::ThreadFunction(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *threadInfo =
+    static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  Self *self = static_cast< Self * >( threadInfo->UserData );
+
+  self->m_Mutex.Lock();
+  while ( true )
+    {
+    // Wait until the next file is within the prefetch window
+    while ( !self->m_Stopping
+            && self->m_NextFileToRead < self->m_FileNames.size()
+            && self->m_NextFileToRead >= self->m_NextFileToDeliver + self->m_NumberOfFilesToPrefetch )
+      {
+      self->m_FileDeliveredCondition->Wait(&self->m_Mutex);
+      }
+    if ( self->m_Stopping || self->m_NextFileToRead >= self->m_FileNames.size() )
+      {
+      break;
+      }
+
+    const SizeValueType fileIndex = self->m_NextFileToRead++;
+    self->m_Slots[fileIndex].State = Reading;
+    self->m_Mutex.Unlock();
+
+    self->ReadFile(fileIndex);
+
+    self->m_Mutex.Lock();
+    }
+  self->m_Mutex.Unlock();
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TOutputImage >
+void
+ImageFileReaderPrefetcher< TOutputImage >
+::ReadFile(SizeValueType fileIndex)
+{
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(m_FileNames[fileIndex]);
+
+  OutputImagePointer image;
+  ExceptionObject    exception;
+  bool               failed = false;
+  bool               skipped = false;
+
+  try
+    {
+    // Reading the header creates the ImageIO through the factory, which
+    // is not safe to query from several threads at once.
+    m_FactoryMutex.Lock();
+    try
+      {
+      reader->UpdateOutputInformation();
+      }
+    catch ( ... )
+      {
+      m_FactoryMutex.Unlock();
+      throw;
+      }
+    m_FactoryMutex.Unlock();
+
+    reader->GetOutput()->SetRequestedRegionToLargestPossibleRegion();
+    const SizeValueType memorySize = reader->GetEstimatedOutputMemorySize();
+
+    // Wait for enough memory to be released by the caller. The file the
+    // caller waits for never waits, so that a single image larger than
+    // the budget still gets through.
+    m_Mutex.Lock();
+    while ( !m_Stopping
+            && m_MemoryBudget > 0
+            && fileIndex != m_NextFileToDeliver
+            && m_MemoryInUse + memorySize > m_MemoryBudget )
+      {
+      m_FileDeliveredCondition->Wait(&m_Mutex);
+      }
+    skipped = m_Stopping;
+    if ( !skipped )
+      {
+      m_MemoryInUse += memorySize;
+      m_Slots[fileIndex].MemorySize = memorySize;
+      }
+    m_Mutex.Unlock();
+
+    if ( !skipped )
+      {
+      reader->Update();
+      image = reader->GetOutput();
+      image->DisconnectPipeline();
+      }
+    }
+  catch ( ExceptionObject & err )
+    {
+    exception = err;
+    failed = true;
+    }
+  catch ( std::exception & err )
+    {
+    // An exception escaping the worker would terminate the program, and the
+    // caller waiting for this file would never be woken up.
+    exception = ExceptionObject(__FILE__, __LINE__, err.what(), ITK_LOCATION);
+    failed = true;
+    }
+  catch ( ... )
+    {
+    exception = ExceptionObject(__FILE__, __LINE__,
+                                "Unknown exception while reading " + m_FileNames[fileIndex],
+                                ITK_LOCATION);
+    failed = true;
+    }
+
+  if ( skipped )
+    {
+    return;
+    }
+
+  m_Mutex.Lock();
+  FileSlot & slot = m_Slots[fileIndex];
+  if ( failed )
+    {
+    slot.Exception = exception;
+    slot.State = Failed;
+    }
+  else
+    {
+    slot.Image = image;
+    slot.State = Ready;
+    }
+  m_FileReadCondition->Broadcast();
+  m_Mutex.Unlock();
+}
+
+template< class TOutputImage >
+void
+ImageFileReaderPrefetcher< TOutputImage >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "NumberOfFiles: " << m_FileNames.size() << std::endl;
+  os << indent << "NumberOfFilesToPrefetch: " << m_NumberOfFilesToPrefetch << std::endl;
+  os << indent << "NumberOfThreads: " << m_NumberOfThreads << std::endl;
+  os << indent << "MemoryBudget: " << m_MemoryBudget << std::endl;
+  os << indent << "NextFileIndex: " << m_NextFileToDeliver << std::endl;
+}
+} // end namespace itk
+
+#endif
@@ -155,6 +155,27 @@ public:
   itkSetMacro(NumberOfStreamDivisions, unsigned int);
   itkGetConstReferenceMacro(NumberOfStreamDivisions, unsigned int);
 
+  /** Set/Get the memory budget, in bytes, for the upstream pipeline.
+   * When non-zero, the number of stream divisions is chosen
+   * automatically so that the estimated memory needed to generate one
+   * piece, as reported by ProcessObject::GetEstimatedPipelineMemorySize(),
+   * does not exceed the budget, and NumberOfStreamDivisions is
+   * ignored. The pieces are those the ImageIO can write. If the budget
+   * cannot be met even with the finest split the ImageIO allows, or if
+   * the ImageIO cannot stream and the whole image exceeds the budget, an
+   * exception is thrown. Defaults to zero. */
+  itkSetMacro(MemoryBudget, SizeValueType);
+  itkGetConstMacro(MemoryBudget, SizeValueType);
+
+  /** Get the number of pieces the image was written in by the last
+   * call to Write(). */
+  itkGetConstMacro(ActualNumberOfStreamDivisions, unsigned int);
+
+  /** Get the estimated memory, in bytes, needed by the upstream
+   * pipeline to generate the first piece during the last call to
+   * Write(). Only computed when a memory budget is set. */
+  itkGetConstMacro(EstimatedPieceMemorySize, SizeValueType);
+
   /** Aliased to the Write() method to be consistent with the rest of the
    * pipeline. */
   virtual void Update()
@@ -196,6 +217,12 @@ protected:
   /** Does the real work. */
   void GenerateData(void);
 
+  /** Determine the number of pieces for which the estimated memory
+   * needed to generate the first piece fits in the MemoryBudget. The
+   * requested regions of the upstream pipeline are modified. */
+  unsigned int ComputeNumberOfStreamDivisions(const ImageIORegion & pasteIORegion,
+                                              const ImageIORegion & largestIORegion);
+
 private:
   ImageFileWriter(const Self &); //purposely not implemented
   void operator=(const Self &);  //purposely not implemented
@@ -208,6 +235,9 @@ private:
 
   ImageIORegion m_PasteIORegion;
   unsigned int  m_NumberOfStreamDivisions;
+  SizeValueType m_MemoryBudget;
+  unsigned int  m_ActualNumberOfStreamDivisions;
+  SizeValueType m_EstimatedPieceMemorySize;
   bool          m_UserSpecifiedIORegion;    // track whether the region
                                             // is user specified
   bool m_FactorySpecifiedImageIO;           //track whether the factory
@@ -32,6 +32,7 @@
 #include "itkDiffusionTensor3D.h"
 #include "itkMatrix.h"
 #include "itkImageAlgorithm.h"
+#include "itkStreamingMemoryBudgetCalculator.h"
 #include <complex>
 
 namespace itk
@@ -48,6 +49,9 @@ ImageFileWriter< TInputImage >
   m_UserSpecifiedIORegion = false;
   m_UserSpecifiedImageIO = false;
   m_NumberOfStreamDivisions = 1;
+  m_MemoryBudget = 0;
+  m_ActualNumberOfStreamDivisions = 0;
+  m_EstimatedPieceMemorySize = 0;
 }
 
 //---------------------------------------------------------
@@ -255,11 +259,6 @@ ImageFileWriter< TInputImage >
   // Notify start event observers
   this->InvokeEvent( StartEvent() );
 
-  if ( m_NumberOfStreamDivisions > 1 || m_UserSpecifiedIORegion )
-    {
-    m_ImageIO->SetUseStreamedWriting(true);
-    }
-
   ImageIORegion largestIORegion(TInputImage::ImageDimension);
   ImageIORegionAdaptor< TInputImage::ImageDimension >::
   Convert( largestRegion, largestIORegion, largestRegion.GetIndex() );
@@ -285,14 +284,43 @@ ImageFileWriter< TInputImage >
       << "Largest possible region: " << largestRegion);
     }
 
+  // Determine the requested number of divisions, either set by the
+  // user or derived from the memory budget
+  unsigned int requestedDivisions = m_NumberOfStreamDivisions;
+  if ( m_MemoryBudget > 0 )
+    {
+    // the ImageIO only reports the pieces it can stream when streamed
+    // writing is enabled
+    const bool useStreamedWriting = m_ImageIO->GetUseStreamedWriting();
+    m_ImageIO->SetUseStreamedWriting(true);
+    try
+      {
+      requestedDivisions = this->ComputeNumberOfStreamDivisions(pasteIORegion,
+                                                                largestIORegion);
+      }
+    catch ( ExceptionObject & )
+      {
+      m_ImageIO->SetUseStreamedWriting(useStreamedWriting);
+      throw;
+      }
+    m_ImageIO->SetUseStreamedWriting(useStreamedWriting);
+    }
+
+  if ( requestedDivisions > 1 || m_UserSpecifiedIORegion )
+    {
+    m_ImageIO->SetUseStreamedWriting(true);
+    }
+
   // Determin the actual number of divisions of the input. This is determined
   // by what the ImageIO can do
   unsigned int numDivisions;
 
   // this may fail and throw an exception if the configuration is not supported
-  numDivisions = m_ImageIO->GetActualNumberOfSplitsForWriting(m_NumberOfStreamDivisions,
+  numDivisions = m_ImageIO->GetActualNumberOfSplitsForWriting(requestedDivisions,
                                                               pasteIORegion,
                                                               largestIORegion);
+  m_ActualNumberOfStreamDivisions = numDivisions;
+  itkDebugMacro("Writing with " << numDivisions << " divisions");
 
   /**
    * Loop over the number of pieces, execute the upstream pipeline on each
@@ -338,6 +366,7 @@ ImageFileWriter< TInputImage >
         itkDebugMacro("Requested stream region  matches largest region input filter may not support streaming well.");
         itkDebugMacro("Writer is not streaming now!");
         numDivisions = 1;
+        m_ActualNumberOfStreamDivisions = numDivisions;
         streamRegion = largestRegion;
         ImageIORegionAdaptor< TInputImage::ImageDimension >::
         Convert( streamRegion, streamIORegion, largestRegion.GetIndex() );
@@ -384,7 +413,7 @@ ImageFileWriter< TInputImage >
   // before this test, bad stuff would happend when they don't match
   if ( bufferedRegion != ioRegion )
     {
-    if ( m_NumberOfStreamDivisions > 1 || m_UserSpecifiedIORegion )
+    if ( m_ActualNumberOfStreamDivisions > 1 || m_UserSpecifiedIORegion )
       {
       itkDebugMacro("Requested stream region does not match generated output");
       itkDebugMacro("input filter may not support streaming well");
@@ -416,6 +445,72 @@ ImageFileWriter< TInputImage >
   m_ImageIO->Write(dataPtr);
 }
 
+//---------------------------------------------------------
+template< class TInputImage >
+unsigned int
+ImageFileWriter< TInputImage >
+::ComputeNumberOfStreamDivisions(const ImageIORegion & pasteIORegion,
+                                 const ImageIORegion & largestIORegion)
+{
+  // the pieces are the ones the ImageIO can write, and the memory of a
+  // piece is estimated by propagating its requested region without
+  // updating the pipeline
+  class MemoryBudgetCalculator:public StreamingMemoryBudgetCalculator
+  {
+public:
+    MemoryBudgetCalculator(ImageIOBase *imageIO, InputImageType *input,
+                           const ImageIORegion & pasteIORegion,
+                           const ImageIORegion & largestIORegion):
+      m_ImageIO(imageIO), m_Input(input),
+      m_PasteIORegion(pasteIORegion), m_LargestIORegion(largestIORegion) {}
+protected:
+    virtual unsigned int GetNumberOfSplits(unsigned int requestedNumber)
+    {
+      return m_ImageIO->GetActualNumberOfSplitsForWriting(requestedNumber,
+                                                          m_PasteIORegion,
+                                                          m_LargestIORegion);
+    }
+
+    virtual SizeValueType EstimatePieceMemorySize(unsigned int numberOfPieces)
+    {
+      ImageIORegion streamIORegion =
+        m_ImageIO->GetSplitRegionForWriting(0, numberOfPieces, m_PasteIORegion, m_LargestIORegion);
+      InputImageRegionType streamRegion;
+      ImageIORegionAdaptor< TInputImage::ImageDimension >::
+      Convert( streamIORegion, streamRegion, m_Input->GetLargestPossibleRegion().GetIndex() );
+      m_Input->SetRequestedRegion(streamRegion);
+      m_Input->PropagateRequestedRegion();
+      return m_Input->GetSource() ? m_Input->GetSource()->GetEstimatedPipelineMemorySize() : 0;
+    }
+
+private:
+    ImageIOBase *         m_ImageIO;
+    InputImageType *      m_Input;
+    const ImageIORegion & m_PasteIORegion;
+    const ImageIORegion & m_LargestIORegion;
+  };
+
+  // NOTE: this const_cast<> is due to the lack of const-correctness
+  // of the ProcessObject.
+  InputImageType *nonConstInput = const_cast< InputImageType * >( this->GetInput() );
+
+  MemoryBudgetCalculator calculator(m_ImageIO, nonConstInput, pasteIORegion, largestIORegion);
+  try
+    {
+    const unsigned int numDivisions =
+      calculator.ComputeNumberOfStreamDivisions(pasteIORegion.GetNumberOfPixels(), m_MemoryBudget);
+    m_EstimatedPieceMemorySize = calculator.GetEstimatedPieceMemorySize();
+    itkDebugMacro("Estimated memory for " << numDivisions << " divisions: "
+                  << m_EstimatedPieceMemorySize << " bytes");
+    return numDivisions;
+    }
+  catch ( ExceptionObject & )
+    {
+    m_EstimatedPieceMemorySize = calculator.GetEstimatedPieceMemorySize();
+    throw;
+    }
+}
+
 //---------------------------------------------------------
 template< class TInputImage >
 void
@@ -439,6 +534,9 @@ ImageFileWriter< TInputImage >
 
   os << indent << "IO Region: " << m_PasteIORegion << "\n";
   os << indent << "Number of Stream Divisions: " << m_NumberOfStreamDivisions << "\n";
+  os << indent << "Memory Budget: " << m_MemoryBudget << "\n";
+  os << indent << "Actual Number of Stream Divisions: " << m_ActualNumberOfStreamDivisions << "\n";
+  os << indent << "Estimated Piece Memory Size: " << m_EstimatedPieceMemorySize << "\n";
 
   if ( m_UseCompression )
     {
@@ -25,6 +25,13 @@ namespace itk
 {
 /** \class ImageIOFactory
  * \brief Create instances of ImageIO objects using an object factory.
+ *
+ * When looking for an ImageIO able to read a file, the ImageIOs are asked
+ * in the order of their registration. The classes of the ImageIOs that
+ * rejected and accepted a file are remembered, keyed on the file name,
+ * length and modification time, so that reading the same file again does
+ * not probe the same ImageIOs a second time.
+ *
  * \ingroup ITKIOImageBase
  */
 class ITK_EXPORT ImageIOFactory:public Object
@@ -51,6 +58,15 @@ public:
     */
   static ImageIOBasePointer CreateImageIO(const char *path, FileModeType mode);
 
+  /** Forget the ImageIO classes that were found for the files already
+   * probed. */
+  static void ClearCache();
+
+  /** Enable/disable remembering which ImageIO class can read a file.
+   * Enabled by default. */
+  static void SetGlobalUseCache(bool flag);
+  static bool GetGlobalUseCache();
+
 protected:
   ImageIOFactory();
   ~ImageIOFactory();
@@ -17,7 +17,30 @@
  *=========================================================================*/
 
 #include "itkImageIOFactory.h"
+#include "itkSimpleFastMutexLock.h"
+#include "itksys/SystemTools.hxx"
+#include <map>
+#include <set>
 
+namespace
+{
+// What is known about a file that was probed by the ImageIOs
+struct ImageIOCacheEntry {
+  std::string             ClassName;
+  std::set< std::string > RejectingClassNames;
+  unsigned long           FileLength;
+  long int                ModifiedTime;
+};
+
+typedef std::map< std::string, ImageIOCacheEntry > ImageIOFileCacheType;
+
+// The file cache is simply emptied when it grows beyond this size
+const size_t ImageIOFileCacheMaximumSize = 65536;
+
+itk::SimpleFastMutexLock ImageIOCacheLock;
+ImageIOFileCacheType     ImageIOFileCache;
+bool                     ImageIOUseCache = true;
+} // end anonymous namespace
 
 namespace itk
 {
@@ -42,15 +65,69 @@ ImageIOFactory::CreateImageIO(const char *path, FileModeType mode)
                 << std::endl;
       }
     }
+
+  // Only existing files can be remembered, an ImageIO may accept names
+  // that are not files at all.
+  const bool useCache = ( mode == ReadMode && path
+                          && GetGlobalUseCache()
+                          && itksys::SystemTools::FileExists(path, true) );
+  ImageIOCacheEntry fileEntry;
+  if ( useCache )
+    {
+    const unsigned long fileLength = itksys::SystemTools::FileLength(path);
+    const long int      modifiedTime = itksys::SystemTools::ModifiedTime(path);
+
+    ImageIOCacheLock.Lock();
+    ImageIOFileCacheType::const_iterator found = ImageIOFileCache.find(path);
+    if ( found != ImageIOFileCache.end()
+         && found->second.FileLength == fileLength
+         && found->second.ModifiedTime == modifiedTime )
+      {
+      fileEntry = found->second;
+      }
+    ImageIOCacheLock.Unlock();
+
+    fileEntry.FileLength = fileLength;
+    fileEntry.ModifiedTime = modifiedTime;
+    }
+
+  // The ImageIOs are asked in the registration order. Those already known
+  // to reject the unchanged file are skipped, and the one known to accept
+  // it is returned without asking it again. An ImageIO registered since the
+  // file was probed is asked as usual.
   for ( std::list< ImageIOBase::Pointer >::iterator k = possibleImageIO.begin();
         k != possibleImageIO.end(); ++k )
     {
     if ( mode == ReadMode )
       {
+      const std::string className = ( *k )->GetNameOfClass();
+      if ( useCache && className == fileEntry.ClassName )
+        {
+        return *k;
+        }
+      if ( useCache && fileEntry.RejectingClassNames.count(className) )
+        {
+        continue;
+        }
       if ( ( *k )->CanReadFile(path) )
         {
+        if ( useCache )
+          {
+          fileEntry.ClassName = className;
+          ImageIOCacheLock.Lock();
+          if ( ImageIOFileCache.size() >= ImageIOFileCacheMaximumSize )
+            {
+            ImageIOFileCache.clear();
+            }
+          ImageIOFileCache[path] = fileEntry;
+          ImageIOCacheLock.Unlock();
+          }
         return *k;
         }
+      if ( useCache )
+        {
+        fileEntry.RejectingClassNames.insert(className);
+        }
       }
     else if ( mode == WriteMode )
       {
@@ -62,4 +139,33 @@ ImageIOFactory::CreateImageIO(const char *path, FileModeType mode)
     }
   return 0;
 }
+
+void
+ImageIOFactory::ClearCache()
+{
+  ImageIOCacheLock.Lock();
+  ImageIOFileCache.clear();
+  ImageIOCacheLock.Unlock();
+}
+
+void
+ImageIOFactory::SetGlobalUseCache(bool flag)
+{
+  ImageIOCacheLock.Lock();
+  ImageIOUseCache = flag;
+  if ( !flag )
+    {
+    ImageIOFileCache.clear();
+    }
+  ImageIOCacheLock.Unlock();
+}
+
+bool
+ImageIOFactory::GetGlobalUseCache()
+{
+  ImageIOCacheLock.Lock();
+  const bool flag = ImageIOUseCache;
+  ImageIOCacheLock.Unlock();
+  return flag;
+}
 } // end namespace itk
@@ -0,0 +1,278 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImageFileReader.h"
+#include "itkTimeProbe.h"
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+// Check and time the conversions of ConvertPixelBuffer between every
+// pair of ImageIOBase component types.
+
+namespace
+{
+const size_t NumberOfPixels = 1 << 16;
+const unsigned int NumberOfRepetitions = 10;
+
+template< class TInput, class TOutputPixel >
+double TimeConversion(std::vector< TInput > & input,
+                      int inputNumberOfComponents,
+                      std::vector< TOutputPixel > & output)
+{
+  typedef itk::ConvertPixelBuffer< TInput, TOutputPixel,
+                                   itk::DefaultConvertPixelTraits< TOutputPixel > > ConverterType;
+
+  itk::TimeProbe probe;
+  for ( unsigned int r = 0; r < NumberOfRepetitions; r++ )
+    {
+    probe.Start();
+    ConverterType::Convert(&input[0], inputNumberOfComponents, &output[0], output.size());
+    probe.Stop();
+    }
+  return probe.GetMean();
+}
+
+template< class TInput, class TOutput >
+bool ConvertPair(const char *inputName, const char *outputName)
+{
+  bool passed = true;
+
+  std::vector< TInput > input(4 * NumberOfPixels);
+  for ( size_t i = 0; i < input.size(); i++ )
+    {
+    input[i] = static_cast< TInput >( i % 100 );
+    }
+
+  std::vector< TOutput >                      gray(NumberOfPixels);
+  std::vector< itk::RGBPixel< TOutput > >     rgb(NumberOfPixels);
+  std::vector< itk::RGBAPixel< TOutput > >    rgba(NumberOfPixels);
+  std::vector< std::complex< TOutput > >      complex(NumberOfPixels);
+
+  const double grayToGray = TimeConversion(input, 1, gray);
+  for ( size_t i = 0; i < NumberOfPixels; i++ )
+    {
+    if ( gray[i] != static_cast< TOutput >( input[i] ) )
+      {
+      std::cout << "Gray to gray " << inputName << " to " << outputName
+                << " failed at " << i << std::endl;
+      passed = false;
+      break;
+      }
+    }
+
+  const double rgbToGray = TimeConversion(input, 3, gray);
+  for ( size_t i = 0; i < NumberOfPixels; i++ )
+    {
+    const TOutput val = static_cast< TOutput >(
+      ( 2125.0 * static_cast< TOutput >( input[3 * i] )
+        + 7154.0 * static_cast< TOutput >( input[3 * i + 1] )
+        + 0721.0 * static_cast< TOutput >( input[3 * i + 2] ) ) / 10000.0 );
+    if ( gray[i] != val )
+      {
+      std::cout << "RGB to gray " << inputName << " to " << outputName
+                << " failed at " << i << ": expected " << val
+                << " but got " << gray[i] << std::endl;
+      passed = false;
+      break;
+      }
+    }
+
+  const double grayToRGB = TimeConversion(input, 1, rgb);
+  const double grayToRGBA = TimeConversion(input, 1, rgba);
+  for ( size_t i = 0; i < NumberOfPixels; i++ )
+    {
+    const TOutput val = static_cast< TOutput >( input[i] );
+    if ( rgb[i][0] != val || rgb[i][1] != val || rgb[i][2] != val
+         || rgba[i][0] != val || rgba[i][1] != val || rgba[i][2] != val
+         || rgba[i][3] != static_cast< TOutput >( 1 ) )
+      {
+      std::cout << "Gray to RGB(A) " << inputName << " to " << outputName
+                << " failed at " << i << std::endl;
+      passed = false;
+      break;
+      }
+    }
+
+  const double rgbaToRGB = TimeConversion(input, 4, rgb);
+  for ( size_t i = 0; i < NumberOfPixels; i++ )
+    {
+    if ( rgb[i][0] != static_cast< TOutput >( input[4 * i] )
+         || rgb[i][1] != static_cast< TOutput >( input[4 * i + 1] )
+         || rgb[i][2] != static_cast< TOutput >( input[4 * i + 2] ) )
+      {
+      std::cout << "RGBA to RGB " << inputName << " to " << outputName
+                << " failed at " << i << std::endl;
+      passed = false;
+      break;
+      }
+    }
+
+  // every pixel must be written, not only the first one
+  itk::RGBAPixel< TOutput > zero;
+  zero.Fill( 0 );
+  std::fill(rgba.begin(), rgba.end(), zero);
+  const double twoToRGBA = TimeConversion(input, 2, rgba);
+  for ( size_t i = 0; i < NumberOfPixels; i++ )
+    {
+    const TOutput val = static_cast< TOutput >( input[2 * i] );
+    const TOutput alpha = static_cast< TOutput >( input[2 * i + 1] );
+    if ( rgba[i][0] != val || rgba[i][1] != val || rgba[i][2] != val
+         || rgba[i][3] != alpha )
+      {
+      std::cout << "Two components to RGBA " << inputName << " to " << outputName
+                << " failed at " << i << std::endl;
+      passed = false;
+      break;
+      }
+    }
+
+  const double grayToComplex = TimeConversion(input, 1, complex);
+  for ( size_t i = 0; i < NumberOfPixels; i++ )
+    {
+    const TOutput val = static_cast< TOutput >( input[i] );
+    if ( complex[i].real() != val || complex[i].imag() != val )
+      {
+      std::cout << "Gray to complex " << inputName << " to " << outputName
+                << " failed at " << i << std::endl;
+      passed = false;
+      break;
+      }
+    }
+
+  std::cout << inputName << "\t" << outputName
+            << "\t" << grayToGray
+            << "\t" << rgbToGray
+            << "\t" << grayToRGB
+            << "\t" << grayToRGBA
+            << "\t" << rgbaToRGB
+            << "\t" << twoToRGBA
+            << "\t" << grayToComplex
+            << std::endl;
+
+  return passed;
+}
+
+// Compare the luminance of RGB pixels spread over the whole range of
+// the integral output components with the floating point formula,
+// negative values and values wrapped by the conversion included.
+template< class TInput, class TOutput >
+bool CheckRGBToGrayRange(const char *inputName, const char *outputName)
+{
+  const double lowest = itk::NumericTraits< TInput >::NonpositiveMin();
+  const double highest = itk::NumericTraits< TInput >::max();
+
+  std::vector< TInput > values;
+  for ( unsigned int k = 0; k < 64; k++ )
+    {
+    values.push_back( static_cast< TInput >( lowest + ( highest - lowest ) * k / 63.0 ) );
+    values.push_back( static_cast< TInput >( k ) );
+    }
+
+  std::vector< TInput > input;
+  for ( size_t r = 0; r < values.size(); r++ )
+    {
+    for ( size_t g = 0; g < values.size(); g++ )
+      {
+      for ( size_t b = 0; b < values.size(); b++ )
+        {
+        input.push_back(values[r]);
+        input.push_back(values[g]);
+        input.push_back(values[b]);
+        }
+      }
+    }
+
+  typedef itk::ConvertPixelBuffer< TInput, TOutput,
+                                   itk::DefaultConvertPixelTraits< TOutput > > ConverterType;
+  std::vector< TOutput > gray(input.size() / 3);
+  ConverterType::Convert(&input[0], 3, &gray[0], gray.size());
+
+  for ( size_t i = 0; i < gray.size(); i++ )
+    {
+    const TOutput val = static_cast< TOutput >(
+      ( 2125.0 * static_cast< TOutput >( input[3 * i] )
+        + 7154.0 * static_cast< TOutput >( input[3 * i + 1] )
+        + 0721.0 * static_cast< TOutput >( input[3 * i + 2] ) ) / 10000.0 );
+    if ( gray[i] != val )
+      {
+      std::cout << "RGB to gray over the range of " << inputName << " to " << outputName
+                << " failed at " << i << ": expected "
+                << static_cast< double >( val ) << " but got "
+                << static_cast< double >( gray[i] ) << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+template< class TInput >
+bool ConvertFrom(const char *inputName)
+{
+  bool passed = true;
+
+  passed &= ConvertPair< TInput, unsigned char >(inputName, "unsigned char");
+  passed &= ConvertPair< TInput, char >(inputName, "char");
+  passed &= ConvertPair< TInput, unsigned short >(inputName, "unsigned short");
+  passed &= ConvertPair< TInput, short >(inputName, "short");
+  passed &= ConvertPair< TInput, unsigned int >(inputName, "unsigned int");
+  passed &= ConvertPair< TInput, int >(inputName, "int");
+  passed &= ConvertPair< TInput, unsigned long >(inputName, "unsigned long");
+  passed &= ConvertPair< TInput, long >(inputName, "long");
+  passed &= ConvertPair< TInput, float >(inputName, "float");
+  passed &= ConvertPair< TInput, double >(inputName, "double");
+
+  return passed;
+}
+}
+
+int itkConvertBufferTest3(int, char* [])
+{
+  std::cout << "Mean time in seconds to convert " << NumberOfPixels << " pixels" << std::endl;
+  std::cout << "Input\tOutput\tGrayToGray\tRGBToGray\tGrayToRGB\tGrayToRGBA\tRGBAToRGB\tTwoToRGBA\tGrayToComplex" << std::endl;
+
+  bool passed = true;
+
+  passed &= ConvertFrom< unsigned char >("unsigned char");
+  passed &= ConvertFrom< char >("char");
+  passed &= ConvertFrom< unsigned short >("unsigned short");
+  passed &= ConvertFrom< short >("short");
+  passed &= ConvertFrom< unsigned int >("unsigned int");
+  passed &= ConvertFrom< int >("int");
+  passed &= ConvertFrom< unsigned long >("unsigned long");
+  passed &= ConvertFrom< long >("long");
+  passed &= ConvertFrom< float >("float");
+  passed &= ConvertFrom< double >("double");
+
+  passed &= CheckRGBToGrayRange< unsigned char, unsigned char >("unsigned char", "unsigned char");
+  passed &= CheckRGBToGrayRange< char, char >("char", "char");
+  passed &= CheckRGBToGrayRange< unsigned short, unsigned short >("unsigned short", "unsigned short");
+  passed &= CheckRGBToGrayRange< short, short >("short", "short");
+  passed &= CheckRGBToGrayRange< unsigned short, char >("unsigned short", "char");
+  passed &= CheckRGBToGrayRange< int, unsigned char >("int", "unsigned char");
+  passed &= CheckRGBToGrayRange< int, short >("int", "short");
+  passed &= CheckRGBToGrayRange< short, float >("short", "float");
+
+  if ( !passed )
+    {
+    std::cout << "Test failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,169 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImageFileReaderPrefetcher.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIterator.h"
+
+int itkImageFileReaderPrefetcherTest(int argc, char* argv[])
+{
+  if( argc < 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " outputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef unsigned short                              PixelType;
+  typedef itk::Image< PixelType, 2 >                  ImageType;
+  typedef itk::ImageFileWriter< ImageType >           WriterType;
+  typedef itk::ImageFileReaderPrefetcher< ImageType > PrefetcherType;
+
+  const unsigned int numberOfFiles = 6;
+  const unsigned int missingFile = 3;
+
+  ImageType::SizeType size;
+  size.Fill(32);
+  ImageType::RegionType region;
+  region.SetSize(size);
+
+  // Write a few images with a distinct value each
+  PrefetcherType::FileNamesContainer fileNames;
+  for( unsigned int i = 0; i < numberOfFiles; ++i )
+    {
+    std::ostringstream fileName;
+    fileName << argv[1] << "/itkImageFileReaderPrefetcherTest" << i << ".mha";
+    fileNames.push_back( fileName.str() );
+
+    if( i == missingFile )
+      {
+      // This one is never written, to check error reporting
+      fileNames.back() = std::string( argv[1] ) + "/itkImageFileReaderPrefetcherTestMissing.mha";
+      continue;
+      }
+
+    ImageType::Pointer image = ImageType::New();
+    image->SetRegions( region );
+    image->Allocate();
+    image->FillBuffer( static_cast< PixelType >( 100 * ( i + 1 ) ) );
+
+    WriterType::Pointer writer = WriterType::New();
+    writer->SetInput( image );
+    writer->SetFileName( fileNames.back() );
+    try
+      {
+      writer->Update();
+      }
+    catch( itk::ExceptionObject & err )
+      {
+      std::cerr << err << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  PrefetcherType::Pointer prefetcher = PrefetcherType::New();
+  prefetcher->SetFileNames( fileNames );
+  prefetcher->SetNumberOfFilesToPrefetch( 3 );
+  prefetcher->SetNumberOfThreads( 2 );
+  // Room for one image and a half
+  prefetcher->SetMemoryBudget( 3 * region.GetNumberOfPixels() * sizeof( PixelType ) / 2 );
+  prefetcher->Print( std::cout );
+
+  // Run the list twice: the second pass restarts from the beginning
+  for( unsigned int pass = 0; pass < 2; ++pass )
+    {
+    prefetcher->Start();
+
+    unsigned int numberOfImages = 0;
+    while( !prefetcher->IsAtEnd() )
+      {
+      const unsigned int fileIndex = prefetcher->GetNextFileIndex();
+      ImageType::Pointer image;
+      try
+        {
+        image = prefetcher->GetNextImage();
+        }
+      catch( itk::ExceptionObject & err )
+        {
+        if( fileIndex != missingFile )
+          {
+          std::cerr << "Unexpected exception for file " << fileIndex << std::endl;
+          std::cerr << err << std::endl;
+          return EXIT_FAILURE;
+          }
+        std::cout << "Expected exception for file " << fileIndex << std::endl;
+        continue;
+        }
+
+      if( fileIndex == missingFile )
+        {
+        std::cerr << "Missing file " << fileIndex << " did not throw" << std::endl;
+        return EXIT_FAILURE;
+        }
+      if( image.IsNull() || image->GetSource() )
+        {
+        std::cerr << "Image " << fileIndex << " is not a disconnected image" << std::endl;
+        return EXIT_FAILURE;
+        }
+      if( image->GetBufferedRegion() != region )
+        {
+        std::cerr << "Image " << fileIndex << " has region "
+                  << image->GetBufferedRegion() << std::endl;
+        return EXIT_FAILURE;
+        }
+
+      const PixelType expected = static_cast< PixelType >( 100 * ( fileIndex + 1 ) );
+      itk::ImageRegionConstIterator< ImageType > it( image, region );
+      for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+        {
+        if( it.Get() != expected )
+          {
+          std::cerr << "Image " << fileIndex << " has value " << it.Get()
+                    << " at " << it.GetIndex() << ", expected " << expected << std::endl;
+          return EXIT_FAILURE;
+          }
+        }
+      ++numberOfImages;
+      }
+
+    if( numberOfImages != numberOfFiles - 1 )
+      {
+      std::cerr << "Read " << numberOfImages << " images, expected "
+                << numberOfFiles - 1 << std::endl;
+      return EXIT_FAILURE;
+      }
+    if( prefetcher->GetNextImage().IsNotNull() )
+      {
+      std::cerr << "GetNextImage() did not return a null image at the end" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Stopping in the middle of the list must not lose the next image
+  prefetcher->Start();
+  prefetcher->GetNextImage();
+  prefetcher->Stop();
+  ImageType::Pointer image = prefetcher->GetNextImage();
+  if( image.IsNull() || image->GetPixel( region.GetIndex() ) != 200 )
+    {
+    std::cerr << "GetNextImage() after Stop() did not resume with the second file" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
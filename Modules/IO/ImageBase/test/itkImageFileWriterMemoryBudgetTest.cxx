@@ -0,0 +1,154 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <fstream>
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkAbsImageFilter.h"
+#include "itkPipelineMonitorImageFilter.h"
+
+
+typedef short                    PixelType;
+typedef itk::Image<PixelType,2>  ImageType;
+
+typedef itk::ImageFileReader<ImageType>         ReaderType;
+typedef itk::ImageFileWriter< ImageType >       WriterType;
+
+// Test the selection of the number of stream divisions from a memory
+// budget.
+int itkImageFileWriterMemoryBudgetTest(int argc, char* argv[])
+{
+  if( argc < 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " output " << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ImageType::Pointer image = ImageType::New();
+
+  ImageType::IndexType  index = {{0, 0}};
+  ImageType::SizeType   size = {{64, 64}};
+  ImageType::RegionType region;
+  region.SetSize( size );
+  region.SetIndex( index );
+  image->SetRegions( region );
+  image->Allocate();
+
+  itk::ImageRegionIterator<ImageType> iterator(image, region);
+  PixelType i=0;
+  for (; !iterator.IsAtEnd(); ++iterator, ++i)
+    {
+    iterator.Set( i );
+    }
+
+  typedef itk::AbsImageFilter<ImageType, ImageType> AbsFilter;
+  AbsFilter::Pointer abs = AbsFilter::New();
+  abs->SetInput( image );
+  abs->InPlaceOff();
+
+  typedef itk::PipelineMonitorImageFilter<ImageType> MonitorFilter;
+  MonitorFilter::Pointer monitor = MonitorFilter::New();
+  monitor->SetInput( abs->GetOutput() );
+
+  // The abs and monitor filters both hold a short image of the requested
+  // size. Between 32 and 64 pieces, the 64 rows can only be written in 32
+  // or 64 pieces, so a budget of one and a half rows needs 64 of them.
+  const itk::SizeValueType rowBudget = 3 * sizeof(PixelType) * size[0];
+
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput( monitor->GetOutput() );
+  writer->SetFileName( argv[1] );
+  writer->SetMemoryBudget( rowBudget );
+  try
+    {
+    writer->Update();
+    }
+  catch( itk::ExceptionObject & err )
+    {
+    std::cerr << "ExceptionObject caught !" << std::endl;
+    std::cerr << err << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << writer;
+
+  if ( writer->GetActualNumberOfStreamDivisions() != 64 )
+    {
+    std::cout << "Expected 64 divisions but got "
+              << writer->GetActualNumberOfStreamDivisions() << std::endl;
+    return EXIT_FAILURE;
+    }
+  if ( writer->GetEstimatedPieceMemorySize() > rowBudget )
+    {
+    std::cout << "Estimated piece memory " << writer->GetEstimatedPieceMemorySize()
+              << " exceeds the budget " << rowBudget << std::endl;
+    return EXIT_FAILURE;
+    }
+  if ( monitor->GetNumberOfUpdates() != 64 )
+    {
+    std::cout << monitor;
+    std::cout << "Pipeline didn't execute as expected." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( argv[1] );
+  reader->Update();
+
+  itk::ImageRegionConstIterator<ImageType> inIt(image, region);
+  itk::ImageRegionConstIterator<ImageType> outIt(reader->GetOutput(), region);
+  for (; !inIt.IsAtEnd(); ++inIt, ++outIt )
+    {
+    if ( inIt.Get() != outIt.Get() )
+      {
+      std::cout << "Pixel " << inIt.GetIndex() << " expected " << inIt.Get()
+                << " but got " << outIt.Get() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // A budget smaller than one row cannot be met
+  abs = AbsFilter::New();
+  abs->SetInput( image );
+  abs->InPlaceOff();
+  monitor = MonitorFilter::New();
+  monitor->SetInput( abs->GetOutput() );
+  writer = WriterType::New();
+  writer->SetInput( monitor->GetOutput() );
+  writer->SetFileName( argv[1] );
+  writer->SetMemoryBudget( 3 * sizeof(PixelType) * size[0] / 2 );
+
+  bool caught = false;
+  try
+    {
+    writer->Update();
+    }
+  catch( itk::ExceptionObject & err )
+    {
+    std::cout << "Caught expected exception: " << err << std::endl;
+    caught = true;
+    }
+  if ( !caught )
+    {
+    std::cout << "Expected an exception for a budget that cannot be met." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
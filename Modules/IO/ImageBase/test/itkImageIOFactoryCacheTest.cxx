@@ -0,0 +1,130 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <fstream>
+#include "itkImageFileWriter.h"
+#include "itkImageIOFactory.h"
+#include "itkTimeProbe.h"
+
+int itkImageIOFactoryCacheTest(int argc, char* argv[])
+{
+  if( argc < 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " outputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::Image< unsigned char, 2 >    ImageType;
+  typedef itk::ImageFileWriter< ImageType > WriterType;
+
+  const std::string fileName =
+    std::string( argv[1] ) + "/itkImageIOFactoryCacheTest.mha";
+
+  ImageType::RegionType region;
+  ImageType::SizeType   size;
+  size.Fill(8);
+  region.SetSize(size);
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(region);
+  image->Allocate();
+  image->FillBuffer(7);
+
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(image);
+  writer->SetFileName(fileName);
+  try
+    {
+    writer->Update();
+    }
+  catch( itk::ExceptionObject & err )
+    {
+    std::cerr << err << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int numberOfLookups = 1000;
+
+  // Reference lookup, without the cache
+  itk::ImageIOFactory::SetGlobalUseCache(false);
+  if( itk::ImageIOFactory::GetGlobalUseCache() )
+    {
+    std::cerr << "GetGlobalUseCache() did not return false" << std::endl;
+    return EXIT_FAILURE;
+    }
+  itk::ImageIOBase::Pointer reference =
+    itk::ImageIOFactory::CreateImageIO( fileName.c_str(), itk::ImageIOFactory::ReadMode );
+  if( reference.IsNull() )
+    {
+    std::cerr << "No ImageIO can read " << fileName << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "ImageIO: " << reference->GetNameOfClass() << std::endl;
+
+  itk::TimeProbe uncached;
+  uncached.Start();
+  for( unsigned int i = 0; i < numberOfLookups; ++i )
+    {
+    itk::ImageIOFactory::CreateImageIO( fileName.c_str(), itk::ImageIOFactory::ReadMode );
+    }
+  uncached.Stop();
+
+  // The cached lookups must find the same ImageIO class
+  itk::ImageIOFactory::SetGlobalUseCache(true);
+  itk::TimeProbe cached;
+  cached.Start();
+  for( unsigned int i = 0; i < numberOfLookups; ++i )
+    {
+    itk::ImageIOBase::Pointer io =
+      itk::ImageIOFactory::CreateImageIO( fileName.c_str(), itk::ImageIOFactory::ReadMode );
+    if( io.IsNull() || std::string( io->GetNameOfClass() ) != reference->GetNameOfClass() )
+      {
+      std::cerr << "Cached lookup " << i << " returned "
+                << ( io.IsNull() ? "(null)" : io->GetNameOfClass() ) << std::endl;
+      return EXIT_FAILURE;
+      }
+    if( io == reference )
+      {
+      std::cerr << "Cached lookup returned a shared ImageIO instance" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  cached.Stop();
+
+  std::cout << "Uncached lookup: " << uncached.GetMean() / numberOfLookups << " s" << std::endl;
+  std::cout << "Cached lookup:   " << cached.GetMean() / numberOfLookups << " s" << std::endl;
+
+  // Overwrite the file with something no ImageIO can read. Its length
+  // changes, so the remembered ImageIO must not be used.
+  {
+  std::ofstream garbage( fileName.c_str() );
+  garbage << "This is not an image file";
+  }
+  itk::ImageIOBase::Pointer io =
+    itk::ImageIOFactory::CreateImageIO( fileName.c_str(), itk::ImageIOFactory::ReadMode );
+  if( io.IsNotNull() && io->CanReadFile( fileName.c_str() ) == false )
+    {
+    std::cerr << "A stale cache entry returned " << io->GetNameOfClass()
+              << " for a file it cannot read" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  itk::ImageIOFactory::ClearCache();
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -161,6 +161,20 @@ public:
   /** Release memory for global data structure. */
   virtual void ReleaseGlobalDataPointer(void *GlobalData) const;
 
+  /** Return the global data structure of a thread of the solver. The
+   * structures of the threads are kept across the iterations. */
+  virtual void * GetThreadGlobalDataPointer(ThreadIdType threadId) const
+  { return &m_ThreadGlobalData[threadId].m_GlobalData; }
+
+  /** Nothing to release: the sums of the threads are added by
+   * ReduceGlobalData(). */
+  virtual void ReleaseThreadGlobalDataPointer( void *itkNotUsed(GlobalData),
+                                               ThreadIdType itkNotUsed(threadId) ) const
+  {}
+
+  /** Add the sums of the threads to compute the metric and the rms change. */
+  virtual void ReduceGlobalData() const;
+
   /** Set the object's state before each iteration. */
   virtual void InitializeIteration();
 
@@ -276,6 +290,14 @@ private:
 
   /** Mutex lock to protect modification to metric. */
   mutable SimpleFastMutexLock m_MetricCalculationLock;
+
+  /** Global data of the threads of the solver. Each structure is followed
+   * by a cache line so that the threads do not write to the same lines. */
+  struct ThreadGlobalDataStruct {
+    GlobalDataStruct m_GlobalData;
+    char m_Padding[64];
+  };
+  mutable std::vector< ThreadGlobalDataStruct > m_ThreadGlobalData;
 };
 } // end namespace itk
 
@@ -75,6 +75,8 @@ ESMDemonsRegistrationFunction< TFixedImage, TMovingImage, TDisplacementField >
   m_NumberOfPixelsProcessed = 0L;
   m_RMSChange = NumericTraits< double >::max();
   m_SumOfSquaredChange = 0.0;
+
+  m_ThreadGlobalData.resize(ITK_MAX_THREADS);
 }
 
 /*
@@ -195,6 +197,13 @@ ESMDemonsRegistrationFunction< TFixedImage, TMovingImage, TDisplacementField >
   m_SumOfSquaredDifference  = 0.0;
   m_NumberOfPixelsProcessed = 0L;
   m_SumOfSquaredChange      = 0.0;
+
+  for ( unsigned int i = 0; i < m_ThreadGlobalData.size(); i++ )
+    {
+    m_ThreadGlobalData[i].m_GlobalData.m_SumOfSquaredDifference  = 0.0;
+    m_ThreadGlobalData[i].m_GlobalData.m_NumberOfPixelsProcessed = 0L;
+    m_ThreadGlobalData[i].m_GlobalData.m_SumOfSquaredChange      = 0.0;
+    }
 }
 
 /**
@@ -476,6 +485,35 @@ ESMDemonsRegistrationFunction< TFixedImage, TMovingImage, TDisplacementField >
 
   delete globalData;
 }
+
+/**
+ * Update the metric from the global data of the threads.
+ */
+template< class TFixedImage, class TMovingImage, class TDisplacementField >
+void
+ESMDemonsRegistrationFunction< TFixedImage, TMovingImage, TDisplacementField >
+::ReduceGlobalData() const
+{
+  // The sums are added in the order of the threads, whatever the order
+  // in which the threads finished.
+  for ( unsigned int i = 0; i < m_ThreadGlobalData.size(); i++ )
+    {
+    GlobalDataStruct & globalData = m_ThreadGlobalData[i].m_GlobalData;
+    m_SumOfSquaredDifference += globalData.m_SumOfSquaredDifference;
+    m_NumberOfPixelsProcessed += globalData.m_NumberOfPixelsProcessed;
+    m_SumOfSquaredChange += globalData.m_SumOfSquaredChange;
+    globalData.m_SumOfSquaredDifference  = 0.0;
+    globalData.m_NumberOfPixelsProcessed = 0L;
+    globalData.m_SumOfSquaredChange      = 0.0;
+    }
+  if ( m_NumberOfPixelsProcessed )
+    {
+    m_Metric = m_SumOfSquaredDifference
+               / static_cast< double >( m_NumberOfPixelsProcessed );
+    m_RMSChange = vcl_sqrt( m_SumOfSquaredChange
+                            / static_cast< double >( m_NumberOfPixelsProcessed ) );
+    }
+}
 } // end namespace itk
 
 #endif
@@ -0,0 +1,350 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkFEMLinearSystemWrapperCSR_h
+#define __itkFEMLinearSystemWrapperCSR_h
+#include "itkFEMLinearSystemWrapper.h"
+#include "itkMultiThreader.h"
+#include "itkBarrier.h"
+#include "vnl/vnl_vector.h"
+#include <vector>
+
+namespace itk
+{
+namespace fem
+{
+/**
+ * \class LinearSystemWrapperCSR
+ * \brief LinearSystemWrapper class that stores the matrices in compressed
+ *        sparse row (CSR) format and solves the system with a
+ *        preconditioned conjugate gradient.
+ *
+ * The entries of a matrix that are not in its structure yet are kept
+ * aside, sorted by row and column, and merged into the compressed rows
+ * before the matrix is used in a product or solved. When a matrix is
+ * initialized again for a system of the same order, which is what the
+ * solvers do when they assemble a new system on the same mesh, the
+ * structure is kept and only the values are cleared, so the entries are
+ * added in place. Entries that are set to zero stay in the structure.
+ *
+ * Solve() runs the conjugate gradient on NumberOfThreads threads, with a
+ * Jacobi (diagonal) or an incomplete Cholesky (IC(0)) preconditioner. The
+ * products and the sums are split among the threads by rows; the
+ * triangular solves of the incomplete Cholesky preconditioner run on a
+ * single thread. The matrix must be symmetric positive definite, so the
+ * multi freedom constraints (LoadBCMFC), which add Lagrange multipliers to
+ * the system, are not supported. The current solution is used as the
+ * initial guess.
+ *
+ * \sa LinearSystemWrapper
+ * \ingroup ITKFEM
+ */
+class LinearSystemWrapperCSR : public LinearSystemWrapper
+{
+public:
+
+  /* values stored in matrices & vectors */
+  typedef LinearSystemWrapper::Float Float;
+
+  /* superclass */
+  typedef LinearSystemWrapper SuperClass;
+
+  /** Preconditioners of the conjugate gradient */
+  typedef enum { JacobiPreconditioner = 0, IncompleteCholeskyPreconditioner = 1 } PreconditionerType;
+
+  /* constructor & destructor */
+  LinearSystemWrapperCSR();
+  virtual ~LinearSystemWrapperCSR();
+
+  /**
+   * Set the preconditioner of the conjugate gradient. The default is
+   * JacobiPreconditioner.
+   */
+  void SetPreconditioner(PreconditionerType preconditioner)
+  {
+    m_Preconditioner = preconditioner;
+  }
+
+  PreconditionerType GetPreconditioner() const
+  {
+    return m_Preconditioner;
+  }
+
+  /**
+   * Set the tolerance on the norm of the residual, relative to the norm
+   * of the right hand side. The default is 1e-10.
+   */
+  void SetTolerance(Float tolerance)
+  {
+    m_Tolerance = tolerance;
+  }
+
+  Float GetTolerance() const
+  {
+    return m_Tolerance;
+  }
+
+  /**
+   * Set the maximum number of iterations of the conjugate gradient. Zero,
+   * the default, stands for the order of the system.
+   */
+  void SetMaximumNumberOfIterations(unsigned int i)
+  {
+    m_MaximumNumberOfIterations = i;
+  }
+
+  unsigned int GetMaximumNumberOfIterations() const
+  {
+    return m_MaximumNumberOfIterations;
+  }
+
+  /** Set the number of threads Solve() runs on. The default is the
+   * global default number of threads of MultiThreader. */
+  void SetNumberOfThreads(ThreadIdType numberOfThreads);
+
+  ThreadIdType GetNumberOfThreads() const
+  {
+    return m_NumberOfThreads;
+  }
+
+  /** Keep the structure of the matrices when they are initialized again
+   * for a system of the same order. On by default. */
+  void SetReuseMatrixStructure(bool reuse)
+  {
+    m_ReuseMatrixStructure = reuse;
+  }
+
+  bool GetReuseMatrixStructure() const
+  {
+    return m_ReuseMatrixStructure;
+  }
+
+  /** Number of iterations of the last call to Solve() */
+  unsigned int GetNumberOfIterations() const
+  {
+    return m_NumberOfIterations;
+  }
+
+  /** Norm of the residual of the last call to Solve(), relative to the
+   * norm of the right hand side. */
+  Float GetResidual() const
+  {
+    return m_Residual;
+  }
+
+  /** Number of entries in the structure of a matrix, including the ones
+   * that are not merged into the compressed rows yet. */
+  unsigned int GetNumberOfMatrixEntries(unsigned int matrixIndex = 0) const;
+
+  /* memory management routines */
+  virtual void  InitializeMatrix(unsigned int matrixIndex);
+
+  virtual bool  IsMatrixInitialized(unsigned int matrixIndex);
+
+  virtual void  DestroyMatrix(unsigned int matrixIndex);
+
+  virtual void  InitializeVector(unsigned int vectorIndex);
+
+  virtual bool  IsVectorInitialized(unsigned int vectorIndex);
+
+  virtual void  DestroyVector(unsigned int vectorIndex);
+
+  virtual void  InitializeSolution(unsigned int solutionIndex);
+
+  virtual bool  IsSolutionInitialized(unsigned int solutionIndex);
+
+  virtual void  DestroySolution(unsigned int solutionIndex);
+
+  virtual void  SetMaximumNonZeroValuesInMatrix(unsigned int, unsigned int)
+  {
+  }
+
+  /* assembly & solving routines */
+  virtual Float GetMatrixValue(unsigned int i, unsigned int j, unsigned int matrixIndex) const;
+
+  virtual void  SetMatrixValue(unsigned int i, unsigned int j, Float value, unsigned int matrixIndex);
+
+  virtual void  AddMatrixValue(unsigned int i, unsigned int j, Float value, unsigned int matrixIndex);
+
+  virtual void  GetColumnsOfNonZeroMatrixElementsInRow(unsigned int row, ColumnArray & cols,
+                                                       unsigned int matrixIndex);
+
+  virtual Float GetVectorValue(unsigned int i,
+                               unsigned int vectorIndex) const
+  {
+    return ( *( ( *m_Vectors )[vectorIndex] ) )[i];
+  }
+  virtual void  SetVectorValue(unsigned int i, Float value,
+                               unsigned int vectorIndex)
+  {
+    ( *( ( *m_Vectors )[vectorIndex] ) )(i) =  value;
+  }
+  virtual void  AddVectorValue(unsigned int i, Float value,
+                               unsigned int vectorIndex)
+  {
+    ( *( ( *m_Vectors )[vectorIndex] ) )(i) += value;
+  }
+  virtual Float GetSolutionValue(unsigned int i, unsigned int solutionIndex) const;
+
+  virtual void  SetSolutionValue(unsigned int i, Float value,
+                                 unsigned int solutionIndex)
+  {
+    ( *( ( *m_Solutions )[solutionIndex] ) )(i) =  value;
+  }
+  virtual void  AddSolutionValue(unsigned int i, Float value,
+                                 unsigned int solutionIndex)
+  {
+    ( *( ( *m_Solutions )[solutionIndex] ) )(i) += value;
+  }
+  virtual void  Solve(void);
+
+  /* matrix & vector manipulation routines */
+  virtual void  ScaleMatrix(Float scale, unsigned int matrixIndex);
+
+  virtual void  SwapMatrices(unsigned int matrixIndex1, unsigned int matrixIndex2);
+
+  virtual void  CopyMatrix(unsigned int matrixIndex1, unsigned int matrixIndex2);
+
+  virtual void  SwapVectors(unsigned int vectorIndex1, unsigned int vectorIndex2);
+
+  virtual void  SwapSolutions(unsigned int solutionIndex1, unsigned int solutionIndex2);
+
+  virtual void  CopySolution2Vector(unsigned solutionIndex, unsigned int vectorIndex);
+
+  virtual void  CopyVector2Solution(unsigned int vectorIndex, unsigned int solutionIndex);
+
+  virtual void  MultiplyMatrixMatrix(unsigned int resultMatrixIndex, unsigned int leftMatrixIndex,
+                                     unsigned int rightMatrixIndex);
+
+  virtual void  MultiplyMatrixVector(unsigned int resultVectorIndex, unsigned int matrixIndex, unsigned int vectorIndex);
+
+  virtual void  MultiplyMatrixSolution(unsigned int resultVectorIndex, unsigned int matrixIndex,
+                                       unsigned int solutionIndex);
+
+private:
+
+  /** An entry that is not in the compressed rows yet */
+  typedef std::pair<unsigned int, Float> EntryType;
+  typedef std::vector<EntryType>         EntryRowType;
+
+  /**
+   * A matrix in compressed sparse row format: the columns and the values
+   * of row i are at positions RowStart[i] to RowStart[i+1]-1, sorted by
+   * column. The entries that are not in this structure yet are in
+   * NewEntries, also sorted by column in each row.
+   */
+  struct MatrixRepresentation
+  {
+    std::vector<unsigned int> RowStart;
+    std::vector<unsigned int> Columns;
+    std::vector<Float>        Values;
+    std::vector<EntryRowType> NewEntries;
+    unsigned int              NumberOfNewEntries;
+    bool                      Modified;
+  };
+
+  /** vector of pointers to matrices */
+  typedef std::vector<MatrixRepresentation *> MatrixHolder;
+
+  /** Return a pointer to the value of entry (i, j), or 0 if the entry is
+   * not in the compressed rows. */
+  static Float * FindCompressedValue(MatrixRepresentation *m, unsigned int i, unsigned int j);
+
+  /** Return a pointer to the value of entry (i, j), inserting the entry
+   * with a zero value if it is not in the matrix. */
+  Float * GetValuePointer(unsigned int i, unsigned int j, unsigned int matrixIndex);
+
+  /** Merge the new entries of a matrix into its compressed rows */
+  void CompressMatrix(unsigned int matrixIndex);
+
+  /** Multiply a compressed matrix by a vector */
+  void MultiplyCompressedMatrix(const MatrixRepresentation *m, const vnl_vector<Float> & x,
+                                vnl_vector<Float> & result) const;
+
+  /** Compute the incomplete Cholesky factor of the lower part of the
+   * matrix. Return false if a pivot is not positive. */
+  bool FactorizeIncompleteCholesky(const MatrixRepresentation *m);
+
+  /** Solve L L' z = r with the incomplete Cholesky factor */
+  void SolveIncompleteCholesky(const Float *r, Float *z) const;
+
+  /** The system solved by the threads, and the partial sums of each
+   * thread, which are added in the order of the threads. */
+  struct SolveThreadStruct
+  {
+    const MatrixRepresentation *Matrix;
+    const LinearSystemWrapperCSR *Wrapper;
+    const Float *               B;
+    Float *                     X;
+    Float *                     R;
+    Float *                     Z;
+    Float *                     P;
+    Float *                     Q;
+    const Float *               InverseDiagonal;
+    bool                        UseIncompleteCholesky;
+    std::vector<unsigned int>   FirstRows;
+    std::vector<Float>          PQ;
+    std::vector<Float>          RR;
+    std::vector<Float>          RZ;
+    std::vector<Float>          BB;
+    Barrier::Pointer            SolveBarrier;
+    unsigned int                MaximumNumberOfIterations;
+    Float                       Tolerance;
+    unsigned int                NumberOfIterations;
+    Float                       Residual;
+    bool                        Breakdown;
+  };
+
+  /** Run the conjugate gradient on the rows of a thread */
+  static ITK_THREAD_RETURN_TYPE SolveThreaderCallback(void *arg);
+
+  /** Multiply the rows of a thread, from first to last - 1 */
+  static void MultiplyRows(const MatrixRepresentation *m, const Float *x, Float *result,
+                           unsigned int first, unsigned int last);
+
+  /** vector of pointers to the matrices */
+  MatrixHolder *m_Matrices;
+
+  /** vector of pointers to VNL vectors  */
+  std::vector<vnl_vector<Float> *> *m_Vectors;
+
+  /** vector of pointers to VNL vectors */
+  std::vector<vnl_vector<Float> *> *m_Solutions;
+
+  PreconditionerType     m_Preconditioner;
+  Float                  m_Tolerance;
+  unsigned int           m_MaximumNumberOfIterations;
+  ThreadIdType           m_NumberOfThreads;
+  bool                   m_ReuseMatrixStructure;
+  unsigned int           m_NumberOfIterations;
+  Float                  m_Residual;
+  MultiThreader::Pointer m_Threader;
+
+  /** The preconditioner of the last solved matrix, kept until the matrix
+   * is modified. */
+  const MatrixRepresentation *m_PreconditionedMatrix;
+  PreconditionerType          m_PreconditionedType;
+  vnl_vector<Float>           m_InverseDiagonal;
+  std::vector<unsigned int>   m_FactorRowStart;
+  std::vector<unsigned int>   m_FactorColumns;
+  std::vector<Float>          m_FactorValues;
+};
+}
+}  // end namespace itk::fem
+
+#endif
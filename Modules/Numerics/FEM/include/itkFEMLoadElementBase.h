@@ -100,6 +100,14 @@ public:
   /** Apply the load to the specified element */
   virtual void ApplyLoad(Element::ConstPointer , Element::VectorType & ) { /* HACK:  This should probably through an execption if it is not intended to be used. */ }
 
+  /**
+   * Apply the load to each of the specified elements, and store the force
+   * vector of the i-th element in Fe[i]. The default implementation calls
+   * ApplyLoad() for each element. Loads that are cheaper to evaluate on
+   * many elements at once (e.g. on several threads) override it.
+   */
+  virtual void ApplyLoads(const ElementPointersVectorType & elements, std::vector<Element::VectorType> & Fe);
+
 protected:
   virtual void PrintSelf(std::ostream& os, Indent indent) const;
   void AddNextElementInternal(const Element *e);
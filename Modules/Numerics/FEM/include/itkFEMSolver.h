@@ -63,6 +63,14 @@ namespace fem
  * The solution generated by the SOlver can also be acquired using the
  * GetSolution() method. The FEM can be saved in a file using the
  * spatial objects and the Meta I/O library.
+ *
+ * When UseMultiThreadedAssembly is on, the element matrices are computed on
+ * the threads of the process object (see SetNumberOfThreads()), each thread
+ * buffering the entries of a contiguous range of elements. The entries are then added to the linear
+ * system in the order of the elements, so the master matrices are the
+ * same whatever the number of threads. The element loads compute the
+ * nodal loads of blocks of elements at once (see LoadElement::ApplyLoads()),
+ * which are also added in the order of the elements.
  * \ingroup ITKFEM
  */
 template <unsigned int VDimension = 3>
@@ -134,6 +142,17 @@ public:
   itkSetMacro(Direction, InterpolationGridDirectionType);
   itkGetMacro(Direction, InterpolationGridDirectionType);
 
+  /**
+   * Get/Set whether the element matrices are computed on the threads of
+   * the process object. The entries then come from
+   * ComputeElementMatrixEntries(), and AssembleElementMatrix() is not
+   * called. Off by default, so that derived solvers that override
+   * AssembleElementMatrix() keep assembling their matrices.
+   */
+  itkSetMacro(UseMultiThreadedAssembly, bool);
+  itkGetConstMacro(UseMultiThreadedAssembly, bool);
+  itkBooleanMacro(UseMultiThreadedAssembly);
+
   /** Returns the time step used for dynamic problems. */
   virtual Float GetTimeStep(void) const;
 
@@ -325,9 +344,44 @@ protected:
    * master stiffess matrix. Since more complex Solver classes may need to
    * assemble many matrices and may also do some funky stuff to them, this
    * function is virtual and can be overriden in a derived solver class.
+   *
+   * \note AssembleK() does not call this function when
+   *       UseMultiThreadedAssembly is on and the solver runs on several
+   *       threads. Derived classes that assemble other matrices should
+   *       rather override ComputeElementMatrixEntries(), which is used on
+   *       any number of threads.
    */
   virtual void AssembleElementMatrix(Element::Pointer e);
 
+  /** An entry that an element adds to one of the master matrices. */
+  struct ElementMatrixEntry
+  {
+    Element::DegreeOfFreedomIDType m_Row;
+    Element::DegreeOfFreedomIDType m_Column;
+    unsigned int                   m_MatrixIndex;
+    Float                          m_Value;
+  };
+  typedef std::vector<ElementMatrixEntry> ElementMatrixEntryArray;
+
+  /**
+   * Append to \a entries the entries that the element \a e adds to the
+   * master matrices. By default, these are the nonzero entries of the
+   * element stiffness matrix, added to matrix 0. This function is called
+   * concurrently for different elements, so it must not modify the solver
+   * or the linear system.
+   */
+  virtual void ComputeElementMatrixEntries(const Element *e, ElementMatrixEntryArray & entries) const;
+
+  /**
+   * Add the entries of the matrices of all the elements to the linear
+   * system. Unless UseMultiThreadedAssembly is on, AssembleElementMatrix()
+   * is called for each element. Otherwise the entries are computed by
+   * ComputeElementMatrixEntries() on several threads, and added in the
+   * order of the elements. If an element throws an exception, the
+   * exception of the first of them is rethrown.
+   */
+  void AssembleElementMatrices();
+
   /**
    * Add the contribution of the landmark-containing elements to the
    * correct position in the master stiffess matrix. Since more
@@ -399,6 +453,9 @@ protected:
    */
   unsigned int m_NMFC;
 
+  /** Whether the element matrices are computed on several threads. */
+  bool m_UseMultiThreadedAssembly;
+
   /** Pointer to LinearSystemWrapper object. */
   LinearSystemWrapper::Pointer m_ls;
 
@@ -427,6 +484,38 @@ private:
   InterpolationGridSpacingType      m_Spacing;
   InterpolationGridDirectionType    m_Direction;
 
+  /** A copy of the exception thrown by an element on a thread, to be
+   * rethrown with its type on the calling thread. */
+  class ElementExceptionBase
+  {
+public:
+    virtual ~ElementExceptionBase() {}
+    virtual void Rethrow() const = 0;
+  };
+  template <class TException>
+  class ElementException : public ElementExceptionBase
+  {
+public:
+    ElementException(const TException & e) : m_Exception(e) {}
+    virtual void Rethrow() const { throw m_Exception; }
+private:
+    TException m_Exception;
+  };
+
+  /** The elements of a pass of AssembleElementMatrices(), and the entries
+   * that each chunk of them adds to the master matrices. */
+  struct AssembleElementMatricesThreadStruct
+  {
+    const Self *                         Solver;
+    unsigned int                         FirstElement;
+    unsigned int                         EndElement;
+    std::vector<ElementMatrixEntryArray> Entries;
+    std::vector<ElementExceptionBase *>  Exceptions;
+  };
+
+  /** Compute the entries of the chunks of elements of a thread. Chunk c
+   * holds the c-th contiguous range of the elements of the pass. */
+  static ITK_THREAD_RETURN_TYPE AssembleElementMatricesThreaderCallback(void *arg);
 };
 }  // end namespace fem
 }  // end namespace itk
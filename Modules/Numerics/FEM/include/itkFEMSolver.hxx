@@ -43,6 +43,7 @@ Solver<VDimension>
   this->SetLinearSystemWrapper(&m_lsVNL);
   m_NGFN = 0;
   m_NMFC = 0;
+  m_UseMultiThreadedAssembly = false;
   m_FEMObject = 0;
   this->ProcessObject::SetNumberOfRequiredInputs(1);
   this->ProcessObject::SetNumberOfRequiredOutputs(1);
@@ -185,6 +186,7 @@ Solver<VDimension>
   Superclass::PrintSelf( os, indent );
   os << indent << "Global degrees of freedom: " << m_NGFN << std::endl;
   os << indent << "Multi freedom constraints: " << m_NMFC << std::endl;
+  os << indent << "Use multi-threaded assembly: " << m_UseMultiThreadedAssembly << std::endl;
   os << indent << "FEM Object: " << m_FEMObject << std::endl;
 }
 
@@ -257,14 +259,7 @@ Solver<VDimension>
   /**
   * Step over all elements
   */
-  unsigned int numberOfElements = m_FEMObject->GetNumberOfElements();
-  for( unsigned int i = 0; i < numberOfElements; i++ )
-    {
-    // Call the function that actually moves the element matrix
-    // to the master matrix.
-    Element::Pointer e = m_FEMObject->GetElement( i );
-    this->AssembleElementMatrix(e);
-    }
+  this->AssembleElementMatrices();
 
   /**
   * Step over all the loads again to add the landmark contributions
@@ -339,6 +334,20 @@ template <unsigned int VDimension>
 void
 Solver<VDimension>
 ::AssembleElementMatrix(Element::Pointer e)
+{
+  ElementMatrixEntryArray entries;
+
+  this->ComputeElementMatrixEntries(e, entries);
+  for( typename ElementMatrixEntryArray::const_iterator i = entries.begin(); i != entries.end(); ++i )
+    {
+    this->m_ls->AddMatrixValue(i->m_Row, i->m_Column, i->m_Value, i->m_MatrixIndex);
+    }
+}
+
+template <unsigned int VDimension>
+void
+Solver<VDimension>
+::ComputeElementMatrixEntries(const Element *e, ElementMatrixEntryArray & entries) const
 {
   // Copy the element stiffness matrix for faster access.
   Element::MatrixType Ke;
@@ -361,14 +370,19 @@ Solver<VDimension>
         }
 
       /**
-       * Here we finaly update the corresponding element
+       * Here we finaly store the entry of the corresponding element
        * in the master stiffness matrix. We first check if
        * element in Ke is zero, to prevent zeros from being
        * allocated in sparse matrix.
        */
       if( Ke[j][k] != Float(0.0) )
         {
-        this->m_ls->AddMatrixValue(e->GetDegreeOfFreedom(j), e->GetDegreeOfFreedom(k), Ke[j][k]);
+        ElementMatrixEntry entry;
+        entry.m_Row = e->GetDegreeOfFreedom(j);
+        entry.m_Column = e->GetDegreeOfFreedom(k);
+        entry.m_MatrixIndex = 0;
+        entry.m_Value = Ke[j][k];
+        entries.push_back(entry);
         }
       }
     }
@@ -377,11 +391,142 @@ Solver<VDimension>
 template <unsigned int VDimension>
 void
 Solver<VDimension>
-::AssembleF(int dim)
+::AssembleElementMatrices()
+{
+  const unsigned int numberOfElements = m_FEMObject->GetNumberOfElements();
+  ThreadIdType       numberOfThreads = this->GetNumberOfThreads();
+
+  if( numberOfThreads > numberOfElements )
+    {
+    numberOfThreads = numberOfElements;
+    }
+  if( numberOfThreads <= 1 || !m_UseMultiThreadedAssembly )
+    {
+    for( unsigned int i = 0; i < numberOfElements; i++ )
+      {
+      // Call the function that actually moves the element matrix
+      // to the master matrix.
+      Element::Pointer e = m_FEMObject->GetElement( i );
+      this->AssembleElementMatrix(e);
+      }
+    return;
+    }
+
+  AssembleElementMatricesThreadStruct str;
+  str.Solver = this;
+  str.Entries.resize(numberOfThreads);
+  str.Exceptions.resize(numberOfThreads, 0);
+
+  // The entries are buffered for a limited number of elements per chunk,
+  // so that the buffers stay small on large meshes.
+  const unsigned int elementsPerPass = 256 * numberOfThreads;
+  for( unsigned int first = 0; first < numberOfElements; first += elementsPerPass )
+    {
+    str.FirstElement = first;
+    str.EndElement = std::min(first + elementsPerPass, numberOfElements);
+    this->GetMultiThreader()->SetNumberOfThreads(numberOfThreads);
+    this->GetMultiThreader()->SetSingleMethod(AssembleElementMatricesThreaderCallback, &str);
+    this->GetMultiThreader()->SingleMethodExecute();
+
+    // The chunks are added in the order of the elements, up to the first
+    // element that failed, whose exception is rethrown
+    for( ThreadIdType chunk = 0; chunk < numberOfThreads; chunk++ )
+      {
+      const ElementMatrixEntryArray & entries = str.Entries[chunk];
+      for( typename ElementMatrixEntryArray::const_iterator i = entries.begin(); i != entries.end(); ++i )
+        {
+        this->m_ls->AddMatrixValue(i->m_Row, i->m_Column, i->m_Value, i->m_MatrixIndex);
+        }
+      if( str.Exceptions[chunk] )
+        {
+        const ElementExceptionBase *exception = str.Exceptions[chunk];
+        str.Exceptions[chunk] = 0;
+        for( ThreadIdType c = 0; c < numberOfThreads; c++ )
+          {
+          delete str.Exceptions[c];
+          }
+        try
+          {
+          exception->Rethrow();
+          }
+        catch( ... )
+          {
+          delete exception;
+          throw;
+          }
+        }
+      }
+    }
+}
+
+template <unsigned int VDimension>
+ITK_THREAD_RETURN_TYPE
+Solver<VDimension>
+::AssembleElementMatricesThreaderCallback(void *arg)
 {
-  // Vector that stores element nodal loads
-  Element::VectorType Fe;
+  MultiThreader::ThreadInfoStruct *info =
+    static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  AssembleElementMatricesThreadStruct *str =
+    static_cast<AssembleElementMatricesThreadStruct *>( info->UserData );
+
+  const typename FEMObjectType::ElementContainerType *elements =
+    str->Solver->m_FEMObject->GetElementContainer();
+  const unsigned int numberOfChunks = static_cast<unsigned int>( str->Entries.size() );
+  const unsigned int numberOfElements = str->EndElement - str->FirstElement;
+
+  // the threader may run fewer threads than chunks
+  for( unsigned int chunk = info->ThreadID; chunk < numberOfChunks;
+       chunk += info->NumberOfThreads )
+    {
+    const unsigned int first = str->FirstElement + numberOfElements * chunk / numberOfChunks;
+    const unsigned int end = str->FirstElement + numberOfElements * ( chunk + 1 ) / numberOfChunks;
+    str->Entries[chunk].clear();
+    for( unsigned int i = first; i < end; i++ )
+      {
+      const typename ElementMatrixEntryArray::size_type numberOfEntries = str->Entries[chunk].size();
+      try
+        {
+        str->Solver->ComputeElementMatrixEntries(elements->ElementAt(i).GetPointer(), str->Entries[chunk]);
+        }
+      catch( FEMExceptionSolution & e )
+        {
+        str->Exceptions[chunk] = new ElementException<FEMExceptionSolution>(e);
+        }
+      catch( FEMException & e )
+        {
+        str->Exceptions[chunk] = new ElementException<FEMException>(e);
+        }
+      catch( ExceptionObject & e )
+        {
+        str->Exceptions[chunk] = new ElementException<ExceptionObject>(e);
+        }
+      catch( std::exception & e )
+        {
+        str->Exceptions[chunk] = new ElementException<ExceptionObject>(
+            ExceptionObject(__FILE__, __LINE__, e.what(), ITK_LOCATION) );
+        }
+      catch( ... )
+        {
+        str->Exceptions[chunk] = new ElementException<ExceptionObject>(
+            ExceptionObject(__FILE__, __LINE__, "Unknown exception", ITK_LOCATION) );
+        }
+      if( str->Exceptions[chunk] )
+        {
+        // the exception is rethrown on the calling thread
+        str->Entries[chunk].resize(numberOfEntries);
+        break;
+        }
+      }
+    }
 
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template <unsigned int VDimension>
+void
+Solver<VDimension>
+::AssembleF(int dim)
+{
   // Type that stores IDs of fixed DOF together with the values to
   // which they were fixed.
   typedef std::map<Element::DegreeOfFreedomIDType, Float> BCTermType;
@@ -455,61 +600,49 @@ Solver<VDimension>
      */
     if( LoadElement::Pointer l1 = dynamic_cast<LoadElement *>( l0.GetPointer() ) )
       {
-      if( !( l1->GetElementArray().empty() ) )
+      /**
+       * If array of element pointers is not empty, we apply the load to all
+       * elements in that array. Otherwise we apply the load to all elements
+       * in a system. The load computes the nodal loads of a block of
+       * elements at once, which are then added in the order of the elements.
+       */
+      const bool         allElements = l1->GetElementArray().empty();
+      const unsigned int numberOfElements = allElements ? m_FEMObject->GetNumberOfElements()
+                                                        : static_cast<unsigned int>( l1->GetElementArray().size() );
+      const unsigned int elementsPerBlock = 4096;
+
+      LoadElement::ElementPointersVectorType elements;
+      std::vector<Element::VectorType>       elementLoads;
+      for( unsigned int first = 0; first < numberOfElements; first += elementsPerBlock )
         {
-        /**
-         * If array of element pointers is not empty,
-         * we apply the load to all elements in that array
-         */
-        for( LoadElement::ElementPointersVectorType::const_iterator i = l1->GetElementArray().begin();
-             i != l1->GetElementArray().end(); i++ )
+        const unsigned int end = std::min(first + elementsPerBlock, numberOfElements);
+        elements.clear();
+        for( unsigned int e = first; e < end; e++ )
           {
-          const Element *el0 = ( *i );
-          // Call the Fe() function of the element that we are applying the load
-          // to.
-          // We pass a pointer to the load object as a paramater and a reference
-          // to the nodal loads vector.
-          l1->ApplyLoad(el0, Fe);
-
-          unsigned int Ne = el0->GetNumberOfDegreesOfFreedom(); // ... element's
-                                                                // number of DOF
-          for( unsigned int j = 0; j < Ne; j++ )                // step over all
-                                                                // DOF
+          if( allElements )
             {
-            // error checking
-            if( el0->GetDegreeOfFreedom(j) >= m_NGFN )
-              {
-              throw FEMExceptionSolution(__FILE__, __LINE__, "Solver::AssembleF()", "Illegal GFN!");
-              }
-
-            // update the master force vector (take care of the correct
-            // isotropic dimensions)
-            m_ls->AddVectorValue( el0->GetDegreeOfFreedom(j), Fe(j + dim * Ne) );
+            elements.push_back( m_FEMObject->GetElement(e).GetPointer() );
+            }
+          else
+            {
+            elements.push_back( l1->GetElementArray()[e] );
             }
           }
-        }
-      else
-        {
-        /**
-         * If the list of element pointers in load object is empty,
-         * we apply the load to all elements in a system.
-         */
-        unsigned int numberOfElements = m_FEMObject->GetNumberOfElements();
-        for( unsigned int e = 0; e < numberOfElements; e++ )
+
+        // Call the Fe() function of the elements that we are applying the
+        // load to. We pass a pointer to the load object as a paramater and a
+        // reference to the nodal loads vectors.
+        l1->ApplyLoads(elements, elementLoads);
+        for( unsigned int i = 0; i < elements.size(); i++ )
           {
-          // Element::Pointer el = m_FEMObject->GetElement(e);
-          const Element *el = m_FEMObject->GetElement(e);
-          l1->ApplyLoad(el, Fe);                                   // ...
-                                                                   // element's
-                                                                   // force
-                                                                   // vector
-
-          unsigned int Ne = el->GetNumberOfDegreesOfFreedom(); // ...
-                                                               // element's
-                                                               // number of
-                                                               // DOF
+          const Element *             el = elements[i];
+          const Element::VectorType & Fe = elementLoads[i];
+
+          unsigned int Ne = el->GetNumberOfDegreesOfFreedom(); // ... element's
+                                                               // number of DOF
           for( unsigned int j = 0; j < Ne; j++ )               // step over all DOF
             {
+            // error checking
             if( el->GetDegreeOfFreedom(j) >= m_NGFN )
               {
               throw FEMExceptionSolution(__FILE__, __LINE__, "Solver::AssembleF()", "Illegal GFN!");
@@ -222,6 +222,15 @@ protected:
    */
   void AssembleKandM();
 
+  typedef typename Superclass::ElementMatrixEntry      ElementMatrixEntry;
+  typedef typename Superclass::ElementMatrixEntryArray ElementMatrixEntryArray;
+
+  /**
+   * When the mass matrix is used, the entries of an element go to the left
+   * and right hand side matrices of the implicit scheme equation.
+   */
+  virtual void ComputeElementMatrixEntries(const Element *e, ElementMatrixEntryArray & entries) const;
+
   /**
    * Assemble the master force vector at a given time.
    *
@@ -129,54 +129,8 @@ SolverCrankNicolson<VDimension>
   /**
    * Step over all elements
    */
-  int numElements = this->m_FEMObject->GetElementContainer()->Size();
-  for( int e = 0; e < numElements;  e++ )
-    {
-    vnl_matrix<Float> Ke;
-    this->m_FEMObject->GetElement(e)->GetStiffnessMatrix(Ke);  /*Copy the element stiffness matrix for
-                                       faster access. */
-    vnl_matrix<Float> Me;
-    this->m_FEMObject->GetElement(e)->GetMassMatrix(Me);                      /*Copy the element mass
-                                                      matrix for faster access.
-                                                      */
-    int Ne = this->m_FEMObject->GetElement(e)->GetNumberOfDegreesOfFreedom(); /*... same for element DOF
-                                                      */
-
-    Me = Me * m_Rho;
-    /* step over all rows in in element matrix */
-    for( int j = 0; j < Ne; j++ )
-      {
-      /* step over all columns in in element matrix */
-      for( int k = 0; k < Ne; k++ )
-        {
-        /* error checking. all GFN should be =>0 and <NGFN */
-        if( this->m_FEMObject->GetElement(e)->GetDegreeOfFreedom(j) >= this->m_NGFN
-            || this->m_FEMObject->GetElement(e)->GetDegreeOfFreedom(k) >= this->m_NGFN )
-          {
-          throw FEMExceptionSolution(__FILE__, __LINE__, "SolverCrankNicolson::AssembleKandM()", "Illegal GFN!");
-          }
+  this->AssembleElementMatrices();
 
-        /* Here we finaly update the corresponding element
-         * in the master stiffness matrix. We first check if
-         * element in Ke is zero, to prevent zeros from being
-         * allocated in sparse matrix.
-         */
-        if( Ke(j, k) != Float(0.0) || Me(j, k) != Float(0.0) )
-          {
-          // left hand side matrix
-          lhsval = ( Me(j, k) + m_Alpha * m_TimeStep * Ke(j, k) );
-          this->m_ls->AddMatrixValue( this->m_FEMObject->GetElement(e)->GetDegreeOfFreedom(j),
-                                      this->m_FEMObject->GetElement(e)->GetDegreeOfFreedom(k),
-                                      lhsval, m_SumMatrixIndex );
-          // right hand side matrix
-          rhsval = ( Me(j, k) - ( 1. - m_Alpha ) * m_TimeStep * Ke(j, k) );
-          this->m_ls->AddMatrixValue( this->m_FEMObject->GetElement(e)->GetDegreeOfFreedom(j),
-                                      this->m_FEMObject->GetElement(e)->GetDegreeOfFreedom(k),
-                                      rhsval, m_DifferenceMatrixIndex );
-          }
-        }
-      }
-    }
   /**
    * Step over all the loads to add the landmark contributions to the
    * appropriate place in the stiffness matrix
@@ -227,6 +181,62 @@ SolverCrankNicolson<VDimension>
   this->ApplyBC();  // BUG  -- are BCs applied appropriately to the problem?
 }
 
+template <unsigned int VDimension>
+void
+SolverCrankNicolson<VDimension>
+::ComputeElementMatrixEntries(const Element *e, ElementMatrixEntryArray & entries) const
+{
+  if( !m_UseMassMatrix )
+    {
+    Superclass::ComputeElementMatrixEntries(e, entries);
+    return;
+    }
+
+  vnl_matrix<Float> Ke;
+  e->GetStiffnessMatrix(Ke);  /*Copy the element stiffness matrix for
+                                faster access. */
+  vnl_matrix<Float> Me;
+  e->GetMassMatrix(Me);       /*Copy the element mass
+                                matrix for faster access. */
+  int Ne = e->GetNumberOfDegreesOfFreedom(); /*... same for element DOF */
+
+  Me = Me * m_Rho;
+  /* step over all rows in in element matrix */
+  for( int j = 0; j < Ne; j++ )
+    {
+    /* step over all columns in in element matrix */
+    for( int k = 0; k < Ne; k++ )
+      {
+      /* error checking. all GFN should be =>0 and <NGFN */
+      if( e->GetDegreeOfFreedom(j) >= this->m_NGFN
+          || e->GetDegreeOfFreedom(k) >= this->m_NGFN )
+        {
+        throw FEMExceptionSolution(__FILE__, __LINE__, "SolverCrankNicolson::AssembleKandM()", "Illegal GFN!");
+        }
+
+      /* Here we finaly store the corresponding element
+       * in the master stiffness matrix. We first check if
+       * element in Ke is zero, to prevent zeros from being
+       * allocated in sparse matrix.
+       */
+      if( Ke(j, k) != Float(0.0) || Me(j, k) != Float(0.0) )
+        {
+        ElementMatrixEntry entry;
+        entry.m_Row = e->GetDegreeOfFreedom(j);
+        entry.m_Column = e->GetDegreeOfFreedom(k);
+        // left hand side matrix
+        entry.m_MatrixIndex = m_SumMatrixIndex;
+        entry.m_Value = ( Me(j, k) + m_Alpha * m_TimeStep * Ke(j, k) );
+        entries.push_back(entry);
+        // right hand side matrix
+        entry.m_MatrixIndex = m_DifferenceMatrixIndex;
+        entry.m_Value = ( Me(j, k) - ( 1. - m_Alpha ) * m_TimeStep * Ke(j, k) );
+        entries.push_back(entry);
+        }
+      }
+    }
+}
+
 /**
  * Assemble the master force vector
  */
@@ -86,11 +86,14 @@ protected:
    */
   virtual void InitializeLinearSystemWrapper(void);
 
+  typedef typename Superclass::ElementMatrixEntry      ElementMatrixEntry;
+  typedef typename Superclass::ElementMatrixEntryArray ElementMatrixEntryArray;
+
   /**
    * When assembling the element matrix into master matrix, we
    * need to assemble the mass matrix too.
    */
-  virtual void AssembleElementMatrix(Element::Pointer e);
+  virtual void ComputeElementMatrixEntries(const Element *e, ElementMatrixEntryArray & entries) const;
 
   /**
    * Initializes the storasge for all master matrices.
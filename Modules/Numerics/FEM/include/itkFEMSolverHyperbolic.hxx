@@ -50,7 +50,7 @@ SolverHyperbolic<VDimension>
 template <unsigned int VDimension>
 void
 SolverHyperbolic<VDimension>
-::AssembleElementMatrix(Element::Pointer e)
+::ComputeElementMatrixEntries(const Element *e, ElementMatrixEntryArray & entries) const
 {
   // Copy the element stiffness matrix for faster access.
   Element::MatrixType Ke;
@@ -68,25 +68,32 @@ SolverHyperbolic<VDimension>
     for(int k=0; k<Ne; k++)
       {
       // error checking. all GFN should be =>0 and <NGFN
-      if ( e->GetDegreeOfFreedom(j) >= this->GetInput()->GetNumberOfDegreesOfFreedom() ||
-           e->GetDegreeOfFreedom(k) >= this->GetInput()->GetNumberOfDegreesOfFreedom()  )
+      if ( e->GetDegreeOfFreedom(j) >= this->m_NGFN ||
+           e->GetDegreeOfFreedom(k) >= this->m_NGFN  )
         {
         throw FEMExceptionSolution(__FILE__,__LINE__,"Solver::AssembleElementMatrix()","Illegal GFN!");
         }
 
       /**
-       * Here we finaly update the corresponding element
+       * Here we finaly store the corresponding element
        * in the master stiffness matrix. We first check if
        * element in Ke is zero, to prevent zeros from being
        * allocated in sparse matrix.
        */
+      ElementMatrixEntry entry;
+      entry.m_Row = e->GetDegreeOfFreedom(j);
+      entry.m_Column = e->GetDegreeOfFreedom(k);
       if ( Ke[j][k]!=Float(0.0) )
         {
-        this->m_ls->AddMatrixValue( e->GetDegreeOfFreedom(j), e->GetDegreeOfFreedom(k), Ke[j][k], matrix_K );
+        entry.m_MatrixIndex = matrix_K;
+        entry.m_Value = Ke[j][k];
+        entries.push_back(entry);
         }
       if ( Me[j][k]!=Float(0.0) )
         {
-        this->m_ls->AddMatrixValue( e->GetDegreeOfFreedom(j), e->GetDegreeOfFreedom(k), Me[j][k], matrix_M );
+        entry.m_MatrixIndex = matrix_M;
+        entry.m_Value = Me[j][k];
+        entries.push_back(entry);
         }
       }
     }
@@ -0,0 +1,926 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkFEMLinearSystemWrapperCSR.h"
+#include <algorithm>
+
+namespace itk
+{
+namespace fem
+{
+namespace
+{
+/** Order the entries of a row by column */
+struct EntryColumnLess
+{
+  bool operator()(const std::pair<unsigned int, LinearSystemWrapper::Float> & entry, unsigned int column) const
+  {
+    return entry.first < column;
+  }
+};
+}
+
+LinearSystemWrapperCSR::LinearSystemWrapperCSR() :
+  LinearSystemWrapper(), m_Matrices(0), m_Vectors(0), m_Solutions(0)
+{
+  m_Preconditioner = JacobiPreconditioner;
+  m_Tolerance = 1.0e-10;
+  m_MaximumNumberOfIterations = 0;
+  m_NumberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
+  m_ReuseMatrixStructure = true;
+  m_NumberOfIterations = 0;
+  m_Residual = 0.0;
+  m_Threader = MultiThreader::New();
+  m_PreconditionedMatrix = 0;
+  m_PreconditionedType = JacobiPreconditioner;
+}
+
+void LinearSystemWrapperCSR::SetNumberOfThreads(ThreadIdType numberOfThreads)
+{
+  m_NumberOfThreads = std::min( std::max( numberOfThreads, ThreadIdType(1) ), ThreadIdType(ITK_MAX_THREADS) );
+}
+
+void LinearSystemWrapperCSR::InitializeMatrix(unsigned int matrixIndex)
+{
+  // allocate if necessary
+  if( m_Matrices == 0 )
+    {
+    m_Matrices = new MatrixHolder(m_NumberOfMatrices);
+    if( m_Matrices == NULL )
+      {
+      itkGenericExceptionMacro(<< "LinearSystemWrapperCSR::InitializeMatrix(): m_Matrices allocation failed.");
+      }
+    }
+
+  // keep the structure of a matrix of the same order, and only clear the
+  // values
+  MatrixRepresentation *m = ( *m_Matrices )[matrixIndex];
+  if( m != 0 && m_ReuseMatrixStructure && m->RowStart.size() == this->GetSystemOrder() + 1 )
+    {
+    this->CompressMatrix(matrixIndex);
+    std::fill(m->Values.begin(), m->Values.end(), 0.0);
+    m->Modified = true;
+    return;
+    }
+
+  // out with old, in with new
+  delete m;
+  m = new MatrixRepresentation;
+  m->RowStart.assign(this->GetSystemOrder() + 1, 0);
+  m->NewEntries.resize( this->GetSystemOrder() );
+  m->NumberOfNewEntries = 0;
+  m->Modified = true;
+  ( *m_Matrices )[matrixIndex] = m;
+}
+
+bool LinearSystemWrapperCSR::IsMatrixInitialized(unsigned int matrixIndex)
+{
+  if( !m_Matrices )
+    {
+    return false;
+    }
+  if( !( ( *m_Matrices )[matrixIndex] ) )
+    {
+    return false;
+    }
+
+  return true;
+}
+
+void LinearSystemWrapperCSR::DestroyMatrix(unsigned int matrixIndex)
+{
+  if( m_Matrices == 0 )
+    {
+    return;
+    }
+  if( ( *m_Matrices )[matrixIndex] == 0 )
+    {
+    return;
+    }
+  if( ( *m_Matrices )[matrixIndex] == m_PreconditionedMatrix )
+    {
+    m_PreconditionedMatrix = 0;
+    }
+  delete ( *m_Matrices )[matrixIndex];
+  ( *m_Matrices )[matrixIndex] = 0;
+}
+
+void LinearSystemWrapperCSR::InitializeVector(unsigned int vectorIndex)
+{
+  // allocate if necessary
+  if( m_Vectors == 0 )
+    {
+    m_Vectors = new std::vector<vnl_vector<Float> *>(m_NumberOfVectors);
+    if( m_Vectors == NULL )
+      {
+      itkGenericExceptionMacro(<< "InitializeVector(): m_Vectors memory allocation failed.");
+      }
+    }
+
+  // out with old, in with new
+  if( ( *m_Vectors )[vectorIndex] != 0 )
+    {
+    delete ( *m_Vectors )[vectorIndex];
+    }
+
+  ( *m_Vectors )[vectorIndex] = new vnl_vector<Float>( this->GetSystemOrder() );
+  ( *m_Vectors )[vectorIndex]->fill(0.0);
+}
+
+bool LinearSystemWrapperCSR::IsVectorInitialized(unsigned int vectorIndex)
+{
+  if( !m_Vectors )
+    {
+    return false;
+    }
+  if( !( *m_Vectors )[vectorIndex] )
+    {
+    return false;
+    }
+
+  return true;
+}
+
+void LinearSystemWrapperCSR::DestroyVector(unsigned int vectorIndex)
+{
+  if( m_Vectors == 0 )
+    {
+    return;
+    }
+  if( ( *m_Vectors )[vectorIndex] == 0 )
+    {
+    return;
+    }
+  delete ( *m_Vectors )[vectorIndex];
+  ( *m_Vectors )[vectorIndex] = 0;
+}
+
+void LinearSystemWrapperCSR::InitializeSolution(unsigned int solutionIndex)
+{
+  // allocate if necessary
+  if( m_Solutions == 0 )
+    {
+    m_Solutions = new std::vector<vnl_vector<Float> *>(m_NumberOfSolutions);
+    if( m_Solutions == NULL )
+      {
+      itkGenericExceptionMacro(<< "InitializeSolution(): m_Solutions memory allocation failed.");
+      }
+    }
+
+  // out with old, in with new
+  if( ( *m_Solutions )[solutionIndex] != 0 )
+    {
+    delete ( *m_Solutions )[solutionIndex];
+    }
+
+  ( *m_Solutions )[solutionIndex] = new vnl_vector<Float>( this->GetSystemOrder() );
+  ( *m_Solutions )[solutionIndex]->fill(0.0);
+}
+
+bool LinearSystemWrapperCSR::IsSolutionInitialized(unsigned int solutionIndex)
+{
+  if( !m_Solutions )
+    {
+    return false;
+    }
+  if( !( *m_Solutions )[solutionIndex] )
+    {
+    return false;
+    }
+
+  return true;
+}
+
+void LinearSystemWrapperCSR::DestroySolution(unsigned int solutionIndex)
+{
+  if( m_Solutions == 0 )
+    {
+    return;
+    }
+  if( ( *m_Solutions )[solutionIndex] == 0 )
+    {
+    return;
+    }
+  delete ( *m_Solutions )[solutionIndex];
+  ( *m_Solutions )[solutionIndex] = 0;
+}
+
+LinearSystemWrapperCSR::Float * LinearSystemWrapperCSR::FindCompressedValue(MatrixRepresentation *m,
+                                                                           unsigned int i, unsigned int j)
+{
+  const std::vector<unsigned int>::iterator begin = m->Columns.begin() + m->RowStart[i];
+  const std::vector<unsigned int>::iterator end = m->Columns.begin() + m->RowStart[i + 1];
+  const std::vector<unsigned int>::iterator c = std::lower_bound(begin, end, j);
+  if( c == end || *c != j )
+    {
+    return 0;
+    }
+  return &m->Values[c - m->Columns.begin()];
+}
+
+LinearSystemWrapperCSR::Float * LinearSystemWrapperCSR::GetValuePointer(unsigned int i, unsigned int j,
+                                                                       unsigned int matrixIndex)
+{
+  MatrixRepresentation *m = ( *m_Matrices )[matrixIndex];
+  m->Modified = true;
+  if( Float *value = FindCompressedValue(m, i, j) )
+    {
+    return value;
+    }
+
+  EntryRowType &               row = m->NewEntries[i];
+  const EntryRowType::iterator e = std::lower_bound( row.begin(), row.end(), j, EntryColumnLess() );
+  if( e != row.end() && e->first == j )
+    {
+    return &e->second;
+    }
+  m->NumberOfNewEntries++;
+  return &row.insert( e, EntryType(j, 0.0) )->second;
+}
+
+LinearSystemWrapperCSR::Float LinearSystemWrapperCSR::GetMatrixValue(unsigned int i, unsigned int j,
+                                                                     unsigned int matrixIndex) const
+{
+  MatrixRepresentation *m = ( *m_Matrices )[matrixIndex];
+  if( const Float *value = FindCompressedValue(m, i, j) )
+    {
+    return *value;
+    }
+
+  const EntryRowType &               row = m->NewEntries[i];
+  const EntryRowType::const_iterator e = std::lower_bound( row.begin(), row.end(), j, EntryColumnLess() );
+  if( e != row.end() && e->first == j )
+    {
+    return e->second;
+    }
+  return 0.0;
+}
+
+void LinearSystemWrapperCSR::SetMatrixValue(unsigned int i, unsigned int j, Float value, unsigned int matrixIndex)
+{
+  // zeros are not added to the structure
+  if( value == 0.0 && this->GetMatrixValue(i, j, matrixIndex) == 0.0 )
+    {
+    return;
+    }
+  *this->GetValuePointer(i, j, matrixIndex) = value;
+}
+
+void LinearSystemWrapperCSR::AddMatrixValue(unsigned int i, unsigned int j, Float value, unsigned int matrixIndex)
+{
+  *this->GetValuePointer(i, j, matrixIndex) += value;
+}
+
+void LinearSystemWrapperCSR::GetColumnsOfNonZeroMatrixElementsInRow(unsigned int row, ColumnArray & cols,
+                                                                    unsigned int matrixIndex)
+{
+  const MatrixRepresentation *m = ( *m_Matrices )[matrixIndex];
+
+  // merge the compressed row and the new entries of the row
+  cols.clear();
+  unsigned int                       c = m->RowStart[row];
+  const EntryRowType &               newRow = m->NewEntries[row];
+  EntryRowType::const_iterator       e = newRow.begin();
+  while( c < m->RowStart[row + 1] || e != newRow.end() )
+    {
+    if( e == newRow.end() || ( c < m->RowStart[row + 1] && m->Columns[c] < e->first ) )
+      {
+      if( m->Values[c] != 0.0 )
+        {
+        cols.push_back(m->Columns[c]);
+        }
+      c++;
+      }
+    else
+      {
+      if( e->second != 0.0 )
+        {
+        cols.push_back(e->first);
+        }
+      e++;
+      }
+    }
+}
+
+unsigned int LinearSystemWrapperCSR::GetNumberOfMatrixEntries(unsigned int matrixIndex) const
+{
+  const MatrixRepresentation *m = ( *m_Matrices )[matrixIndex];
+
+  return static_cast<unsigned int>( m->Columns.size() ) + m->NumberOfNewEntries;
+}
+
+void LinearSystemWrapperCSR::CompressMatrix(unsigned int matrixIndex)
+{
+  MatrixRepresentation *m = ( *m_Matrices )[matrixIndex];
+
+  if( m->NumberOfNewEntries == 0 )
+    {
+    return;
+    }
+
+  const unsigned int        numberOfRows = static_cast<unsigned int>( m->NewEntries.size() );
+  std::vector<unsigned int> rowStart(numberOfRows + 1);
+  std::vector<unsigned int> columns;
+  std::vector<Float>        values;
+  columns.reserve(m->Columns.size() + m->NumberOfNewEntries);
+  values.reserve(m->Columns.size() + m->NumberOfNewEntries);
+  for( unsigned int i = 0; i < numberOfRows; i++ )
+    {
+    rowStart[i] = static_cast<unsigned int>( columns.size() );
+    unsigned int                 c = m->RowStart[i];
+    EntryRowType::const_iterator e = m->NewEntries[i].begin();
+    while( c < m->RowStart[i + 1] || e != m->NewEntries[i].end() )
+      {
+      if( e == m->NewEntries[i].end() || ( c < m->RowStart[i + 1] && m->Columns[c] < e->first ) )
+        {
+        columns.push_back(m->Columns[c]);
+        values.push_back(m->Values[c]);
+        c++;
+        }
+      else
+        {
+        columns.push_back(e->first);
+        values.push_back(e->second);
+        e++;
+        }
+      }
+    EntryRowType().swap(m->NewEntries[i]);
+    }
+  rowStart[numberOfRows] = static_cast<unsigned int>( columns.size() );
+
+  m->RowStart.swap(rowStart);
+  m->Columns.swap(columns);
+  m->Values.swap(values);
+  m->NumberOfNewEntries = 0;
+}
+
+void LinearSystemWrapperCSR::MultiplyRows(const MatrixRepresentation *m, const Float *x, Float *result,
+                                          unsigned int first, unsigned int last)
+{
+  const unsigned int *columns = m->Columns.empty() ? 0 : &m->Columns[0];
+  const Float *       values = m->Values.empty() ? 0 : &m->Values[0];
+  for( unsigned int i = first; i < last; i++ )
+    {
+    Float sum = 0.0;
+    for( unsigned int c = m->RowStart[i]; c < m->RowStart[i + 1]; c++ )
+      {
+      sum += values[c] * x[columns[c]];
+      }
+    result[i] = sum;
+    }
+}
+
+void LinearSystemWrapperCSR::MultiplyCompressedMatrix(const MatrixRepresentation *m, const vnl_vector<Float> & x,
+                                                      vnl_vector<Float> & result) const
+{
+  if( this->GetSystemOrder() == 0 )
+    {
+    return;
+    }
+  MultiplyRows(m, x.data_block(), result.data_block(), 0, this->GetSystemOrder() );
+}
+
+bool LinearSystemWrapperCSR::FactorizeIncompleteCholesky(const MatrixRepresentation *m)
+{
+  const unsigned int order = this->GetSystemOrder();
+
+  // the factor has the structure of the lower part of the matrix, with the
+  // diagonal last in each row
+  m_FactorRowStart.resize(order + 1);
+  m_FactorColumns.clear();
+  m_FactorValues.clear();
+  std::vector<unsigned int> diagonal(order);
+  for( unsigned int i = 0; i < order; i++ )
+    {
+    m_FactorRowStart[i] = static_cast<unsigned int>( m_FactorColumns.size() );
+    Float diagonalValue = 0.0;
+    for( unsigned int c = m->RowStart[i]; c < m->RowStart[i + 1] && m->Columns[c] <= i; c++ )
+      {
+      if( m->Columns[c] == i )
+        {
+        diagonalValue = m->Values[c];
+        }
+      else
+        {
+        m_FactorColumns.push_back(m->Columns[c]);
+        m_FactorValues.push_back(m->Values[c]);
+        }
+      }
+
+    // L(i,k) = ( A(i,k) - sum over j<k of L(i,j) L(k,j) ) / L(k,k)
+    const unsigned int rowStart = m_FactorRowStart[i];
+    const unsigned int rowEnd = static_cast<unsigned int>( m_FactorColumns.size() );
+    for( unsigned int c = rowStart; c < rowEnd; c++ )
+      {
+      const unsigned int k = m_FactorColumns[c];
+      Float              sum = m_FactorValues[c];
+      unsigned int       a = rowStart;
+      unsigned int       b = m_FactorRowStart[k];
+      while( a < c && b < diagonal[k] )
+        {
+        if( m_FactorColumns[a] < m_FactorColumns[b] )
+          {
+          a++;
+          }
+        else if( m_FactorColumns[b] < m_FactorColumns[a] )
+          {
+          b++;
+          }
+        else
+          {
+          sum -= m_FactorValues[a++] * m_FactorValues[b++];
+          }
+        }
+      m_FactorValues[c] = sum / m_FactorValues[diagonal[k]];
+      diagonalValue -= m_FactorValues[c] * m_FactorValues[c];
+      }
+
+    if( !( diagonalValue > 0.0 ) )
+      {
+      m_FactorRowStart.clear();
+      m_FactorColumns.clear();
+      m_FactorValues.clear();
+      return false;
+      }
+    diagonal[i] = static_cast<unsigned int>( m_FactorColumns.size() );
+    m_FactorColumns.push_back(i);
+    m_FactorValues.push_back( vcl_sqrt(diagonalValue) );
+    }
+  m_FactorRowStart[order] = static_cast<unsigned int>( m_FactorColumns.size() );
+
+  return true;
+}
+
+void LinearSystemWrapperCSR::SolveIncompleteCholesky(const Float *r, Float *z) const
+{
+  const unsigned int order = this->GetSystemOrder();
+
+  // forward substitution with L, by rows
+  for( unsigned int i = 0; i < order; i++ )
+    {
+    Float              sum = r[i];
+    const unsigned int diagonal = m_FactorRowStart[i + 1] - 1;
+    for( unsigned int c = m_FactorRowStart[i]; c < diagonal; c++ )
+      {
+      sum -= m_FactorValues[c] * z[m_FactorColumns[c]];
+      }
+    z[i] = sum / m_FactorValues[diagonal];
+    }
+
+  // backward substitution with the transpose of L, by columns
+  for( unsigned int i = order; i-- > 0; )
+    {
+    const unsigned int diagonal = m_FactorRowStart[i + 1] - 1;
+    z[i] /= m_FactorValues[diagonal];
+    for( unsigned int c = m_FactorRowStart[i]; c < diagonal; c++ )
+      {
+      z[m_FactorColumns[c]] -= m_FactorValues[c] * z[i];
+      }
+    }
+}
+
+LinearSystemWrapperCSR::Float LinearSystemWrapperCSR::GetSolutionValue(unsigned int i,
+                                                                       unsigned int SolutionIndex) const
+{
+  if( m_Solutions == 0 )
+    {
+    return 0.0;
+    }
+  if( ( ( *m_Solutions )[SolutionIndex] )->size() <= i )
+    {
+    return 0.0;
+    }
+  else
+    {
+    return ( *( ( *m_Solutions )[SolutionIndex] ) )(i);
+    }
+}
+
+void LinearSystemWrapperCSR::Solve(void)
+{
+  if( m_Matrices == 0 || m_Vectors == 0 || m_Solutions == 0
+      || ( *m_Matrices )[0] == 0 || ( *m_Vectors )[0] == 0 || ( *m_Solutions )[0] == 0 )
+    {
+    itkGenericExceptionMacro(
+      << "LinearSystemWrapperCSR::Solve(): the matrix, the vector and the solution must be initialized.");
+    }
+
+  this->CompressMatrix(0);
+  MatrixRepresentation *m = ( *m_Matrices )[0];
+  const unsigned int    order = this->GetSystemOrder();
+
+  // compute the preconditioner again only if the matrix changed
+  if( m != m_PreconditionedMatrix || m->Modified || m_Preconditioner != m_PreconditionedType )
+    {
+    m_InverseDiagonal.set_size(order);
+    for( unsigned int i = 0; i < order; i++ )
+      {
+      const Float *diagonal = FindCompressedValue(m, i, i);
+      m_InverseDiagonal[i] = ( diagonal != 0 && *diagonal != 0.0 ) ? 1.0 / *diagonal : 1.0;
+      }
+    m_FactorRowStart.clear();
+    m_FactorColumns.clear();
+    m_FactorValues.clear();
+    if( m_Preconditioner == IncompleteCholeskyPreconditioner )
+      {
+      // fall back to the diagonal if the factorization breaks down
+      this->FactorizeIncompleteCholesky(m);
+      }
+    m_PreconditionedMatrix = m;
+    m_PreconditionedType = m_Preconditioner;
+    m->Modified = false;
+    }
+
+  vnl_vector<Float> r(order);
+  vnl_vector<Float> z(order);
+  vnl_vector<Float> p(order);
+  vnl_vector<Float> q(order);
+
+  SolveThreadStruct str;
+  str.Matrix = m;
+  str.Wrapper = this;
+  str.B = ( *m_Vectors )[0]->data_block();
+  str.X = ( *m_Solutions )[0]->data_block();
+  str.R = r.data_block();
+  str.Z = z.data_block();
+  str.P = p.data_block();
+  str.Q = q.data_block();
+  str.InverseDiagonal = m_InverseDiagonal.data_block();
+  str.UseIncompleteCholesky = !m_FactorValues.empty();
+  str.MaximumNumberOfIterations = m_MaximumNumberOfIterations > 0 ? m_MaximumNumberOfIterations : order;
+  str.Tolerance = m_Tolerance;
+  str.NumberOfIterations = 0;
+  str.Residual = 0.0;
+  str.Breakdown = false;
+
+  ThreadIdType numberOfThreads = std::max( std::min( m_NumberOfThreads, static_cast<ThreadIdType>( order ) ),
+                                           ThreadIdType(1) );
+  m_Threader->SetNumberOfThreads(numberOfThreads);
+  numberOfThreads = m_Threader->GetNumberOfThreads();
+
+  // give the threads rows with about the same number of entries
+  str.FirstRows.resize(numberOfThreads + 1);
+  str.FirstRows[0] = 0;
+  unsigned int row = 0;
+  for( ThreadIdType t = 1; t < numberOfThreads; t++ )
+    {
+    const double entries = static_cast<double>( m->Columns.size() ) * t / numberOfThreads;
+    while( row < order && m->RowStart[row] < entries )
+      {
+      row++;
+      }
+    str.FirstRows[t] = row;
+    }
+  str.FirstRows[numberOfThreads] = order;
+  str.PQ.resize(numberOfThreads);
+  str.RR.resize(numberOfThreads);
+  str.RZ.resize(numberOfThreads);
+  str.BB.resize(numberOfThreads);
+  str.SolveBarrier = Barrier::New();
+  str.SolveBarrier->Initialize(numberOfThreads);
+
+  m_Threader->SetSingleMethod(SolveThreaderCallback, &str);
+  m_Threader->SingleMethodExecute();
+
+  m_NumberOfIterations = str.NumberOfIterations;
+  m_Residual = str.Residual;
+  if( str.Breakdown )
+    {
+    throw FEMExceptionLinearSystem(__FILE__, __LINE__, "LinearSystemWrapperCSR::Solve",
+                                   "the matrix is not positive definite");
+    }
+}
+
+ITK_THREAD_RETURN_TYPE LinearSystemWrapperCSR::SolveThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info = static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  SolveThreadStruct *              str = static_cast<SolveThreadStruct *>( info->UserData );
+
+  const ThreadIdType numberOfThreads = info->NumberOfThreads;
+  const ThreadIdType threadId = info->ThreadID;
+  const unsigned int first = str->FirstRows[threadId];
+  const unsigned int last = str->FirstRows[threadId + 1];
+  const Float *      b = str->B;
+  Float *            x = str->X;
+  Float *            r = str->R;
+  Float *            z = str->Z;
+  Float *            p = str->P;
+  Float *            q = str->Q;
+  const Float *      inverseDiagonal = str->InverseDiagonal;
+
+  // r = b - A x, z = M^-1 r and p = z
+  MultiplyRows(str->Matrix, x, r, first, last);
+  Float bb = 0.0;
+  for( unsigned int i = first; i < last; i++ )
+    {
+    r[i] = b[i] - r[i];
+    z[i] = r[i] * inverseDiagonal[i];
+    bb += b[i] * b[i];
+    }
+  if( str->UseIncompleteCholesky )
+    {
+    str->SolveBarrier->Wait();
+    if( threadId == 0 )
+      {
+      str->Wrapper->SolveIncompleteCholesky(r, z);
+      }
+    str->SolveBarrier->Wait();
+    }
+  Float rr = 0.0;
+  Float rz = 0.0;
+  for( unsigned int i = first; i < last; i++ )
+    {
+    p[i] = z[i];
+    rr += r[i] * r[i];
+    rz += r[i] * z[i];
+    }
+  str->BB[threadId] = bb;
+  str->RR[threadId] = rr;
+  str->RZ[threadId] = rz;
+  str->SolveBarrier->Wait();
+
+  // every thread adds the partial sums in the same order, so they all
+  // take the same decisions
+  bb = 0.0;
+  rr = 0.0;
+  rz = 0.0;
+  for( ThreadIdType t = 0; t < numberOfThreads; t++ )
+    {
+    bb += str->BB[t];
+    rr += str->RR[t];
+    rz += str->RZ[t];
+    }
+  const Float normB = vcl_sqrt(bb);
+  if( normB == 0.0 )
+    {
+    for( unsigned int i = first; i < last; i++ )
+      {
+      x[i] = 0.0;
+      }
+    return ITK_THREAD_RETURN_VALUE;
+    }
+
+  Float        residual = vcl_sqrt(rr) / normB;
+  unsigned int iteration = 0;
+  bool         breakdown = false;
+  while( residual > str->Tolerance && iteration < str->MaximumNumberOfIterations )
+    {
+    // q = A p, alpha = r.z / p.q
+    MultiplyRows(str->Matrix, p, q, first, last);
+    Float pq = 0.0;
+    for( unsigned int i = first; i < last; i++ )
+      {
+      pq += p[i] * q[i];
+      }
+    str->PQ[threadId] = pq;
+    str->SolveBarrier->Wait();
+    pq = 0.0;
+    for( ThreadIdType t = 0; t < numberOfThreads; t++ )
+      {
+      pq += str->PQ[t];
+      }
+    if( !( pq > 0.0 ) )
+      {
+      breakdown = true;
+      break;
+      }
+    const Float alpha = rz / pq;
+
+    // x += alpha p, r -= alpha q
+    rr = 0.0;
+    Float rzNew = 0.0;
+    for( unsigned int i = first; i < last; i++ )
+      {
+      x[i] += alpha * p[i];
+      r[i] -= alpha * q[i];
+      z[i] = r[i] * inverseDiagonal[i];
+      rr += r[i] * r[i];
+      rzNew += r[i] * z[i];
+      }
+    str->RR[threadId] = rr;
+    str->RZ[threadId] = rzNew;
+    iteration++;
+    str->SolveBarrier->Wait();
+    rr = 0.0;
+    for( ThreadIdType t = 0; t < numberOfThreads; t++ )
+      {
+      rr += str->RR[t];
+      }
+    residual = vcl_sqrt(rr) / normB;
+    if( residual <= str->Tolerance )
+      {
+      break;
+      }
+
+    if( str->UseIncompleteCholesky )
+      {
+      if( threadId == 0 )
+        {
+        str->Wrapper->SolveIncompleteCholesky(r, z);
+        }
+      str->SolveBarrier->Wait();
+      rzNew = 0.0;
+      for( unsigned int i = first; i < last; i++ )
+        {
+        rzNew += r[i] * z[i];
+        }
+      str->RZ[threadId] = rzNew;
+      str->SolveBarrier->Wait();
+      }
+    rzNew = 0.0;
+    for( ThreadIdType t = 0; t < numberOfThreads; t++ )
+      {
+      rzNew += str->RZ[t];
+      }
+
+    // p = z + beta p
+    const Float beta = rzNew / rz;
+    rz = rzNew;
+    for( unsigned int i = first; i < last; i++ )
+      {
+      p[i] = z[i] + beta * p[i];
+      }
+    str->SolveBarrier->Wait();
+    }
+
+  if( threadId == 0 )
+    {
+    str->NumberOfIterations = iteration;
+    str->Residual = residual;
+    str->Breakdown = breakdown;
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+void LinearSystemWrapperCSR::SwapMatrices(unsigned int MatrixIndex1, unsigned int MatrixIndex2)
+{
+  std::swap( ( *m_Matrices )[MatrixIndex1], ( *m_Matrices )[MatrixIndex2] );
+}
+
+void LinearSystemWrapperCSR::CopyMatrix(unsigned int MatrixIndex1, unsigned int MatrixIndex2)
+{
+  this->CompressMatrix(MatrixIndex1);
+  if( ( *m_Matrices )[MatrixIndex2] == 0 )
+    {
+    ( *m_Matrices )[MatrixIndex2] = new MatrixRepresentation;
+    }
+  *( ( *m_Matrices )[MatrixIndex2] ) = *( ( *m_Matrices )[MatrixIndex1] );
+  ( *m_Matrices )[MatrixIndex2]->Modified = true;
+}
+
+void LinearSystemWrapperCSR::SwapVectors(unsigned int VectorIndex1, unsigned int VectorIndex2)
+{
+  std::swap( ( *m_Vectors )[VectorIndex1], ( *m_Vectors )[VectorIndex2] );
+}
+
+void LinearSystemWrapperCSR::SwapSolutions(unsigned int SolutionIndex1, unsigned int SolutionIndex2)
+{
+  std::swap( ( *m_Solutions )[SolutionIndex1], ( *m_Solutions )[SolutionIndex2] );
+}
+
+void LinearSystemWrapperCSR::CopySolution2Vector(unsigned int SolutionIndex, unsigned int VectorIndex)
+{
+  delete ( *m_Vectors )[VectorIndex];
+  ( *m_Vectors )[VectorIndex] = new vnl_vector<Float>( *( ( *m_Solutions )[SolutionIndex] ) );
+}
+
+void LinearSystemWrapperCSR::CopyVector2Solution(unsigned int VectorIndex, unsigned int SolutionIndex)
+{
+  delete ( *m_Solutions )[SolutionIndex];
+  ( *m_Solutions )[SolutionIndex] = new vnl_vector<Float>( *( ( *m_Vectors )[VectorIndex] ) );
+}
+
+void LinearSystemWrapperCSR::MultiplyMatrixMatrix(unsigned int ResultMatrixIndex,
+                                                  unsigned int LeftMatrixIndex,
+                                                  unsigned int RightMatrixIndex)
+{
+  this->CompressMatrix(LeftMatrixIndex);
+  this->CompressMatrix(RightMatrixIndex);
+  const MatrixRepresentation *left = ( *m_Matrices )[LeftMatrixIndex];
+  const MatrixRepresentation *right = ( *m_Matrices )[RightMatrixIndex];
+  const unsigned int          order = this->GetSystemOrder();
+
+  MatrixRepresentation *result = new MatrixRepresentation;
+  result->RowStart.resize(order + 1);
+  result->NewEntries.resize(order);
+  result->NumberOfNewEntries = 0;
+  result->Modified = true;
+
+  // accumulate each row of the product in a dense row
+  std::vector<Float>        row(order, 0.0);
+  std::vector<bool>         used(order, false);
+  std::vector<unsigned int> columns;
+  for( unsigned int i = 0; i < order; i++ )
+    {
+    result->RowStart[i] = static_cast<unsigned int>( result->Columns.size() );
+    columns.clear();
+    for( unsigned int a = left->RowStart[i]; a < left->RowStart[i + 1]; a++ )
+      {
+      const unsigned int k = left->Columns[a];
+      for( unsigned int b = right->RowStart[k]; b < right->RowStart[k + 1]; b++ )
+        {
+        const unsigned int j = right->Columns[b];
+        if( !used[j] )
+          {
+          used[j] = true;
+          columns.push_back(j);
+          }
+        row[j] += left->Values[a] * right->Values[b];
+        }
+      }
+    std::sort( columns.begin(), columns.end() );
+    for( std::vector<unsigned int>::const_iterator j = columns.begin(); j != columns.end(); ++j )
+      {
+      result->Columns.push_back(*j);
+      result->Values.push_back(row[*j]);
+      row[*j] = 0.0;
+      used[*j] = false;
+      }
+    }
+  result->RowStart[order] = static_cast<unsigned int>( result->Columns.size() );
+
+  this->DestroyMatrix(ResultMatrixIndex);
+  ( *m_Matrices )[ResultMatrixIndex] = result;
+}
+
+void LinearSystemWrapperCSR::MultiplyMatrixVector(unsigned int ResultVectorIndex,
+                                                  unsigned int MatrixIndex,
+                                                  unsigned int VectorIndex)
+{
+  this->CompressMatrix(MatrixIndex);
+  vnl_vector<Float> *result = new vnl_vector<Float>( this->GetSystemOrder() );
+  this->MultiplyCompressedMatrix( ( *m_Matrices )[MatrixIndex], *( ( *m_Vectors )[VectorIndex] ), *result );
+
+  delete ( *m_Vectors )[ResultVectorIndex];
+  ( *m_Vectors )[ResultVectorIndex] = result;
+}
+
+void LinearSystemWrapperCSR::MultiplyMatrixSolution(unsigned int ResultVectorIndex,
+                                                    unsigned int MatrixIndex,
+                                                    unsigned int SolutionIndex)
+{
+  this->CompressMatrix(MatrixIndex);
+  vnl_vector<Float> *result = new vnl_vector<Float>( this->GetSystemOrder() );
+  this->MultiplyCompressedMatrix( ( *m_Matrices )[MatrixIndex], *( ( *m_Solutions )[SolutionIndex] ), *result );
+
+  delete ( *m_Vectors )[ResultVectorIndex];
+  ( *m_Vectors )[ResultVectorIndex] = result;
+}
+
+void LinearSystemWrapperCSR::ScaleMatrix(Float scale, unsigned int matrixIndex)
+{
+  MatrixRepresentation *m = ( *m_Matrices )[matrixIndex];
+
+  for( std::vector<Float>::iterator v = m->Values.begin(); v != m->Values.end(); ++v )
+    {
+    *v *= scale;
+    }
+  for( std::vector<EntryRowType>::iterator row = m->NewEntries.begin(); row != m->NewEntries.end(); ++row )
+    {
+    for( EntryRowType::iterator e = row->begin(); e != row->end(); ++e )
+      {
+      e->second *= scale;
+      }
+    }
+  m->Modified = true;
+}
+
+LinearSystemWrapperCSR::~LinearSystemWrapperCSR()
+{
+  unsigned int i;
+  for( i = 0; i < m_NumberOfMatrices; i++ )
+    {
+    this->DestroyMatrix(i);
+    }
+  for( i = 0; i < m_NumberOfVectors; i++ )
+    {
+    this->DestroyVector(i);
+    }
+  for( i = 0; i < m_NumberOfSolutions; i++ )
+    {
+    this->DestroySolution(i);
+    }
+
+  delete m_Matrices;
+  delete m_Vectors;
+  delete m_Solutions;
+}
+
+}
+}  // end namespace itk::fem
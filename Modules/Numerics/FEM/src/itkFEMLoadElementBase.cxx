@@ -55,6 +55,15 @@ Element::ConstPointer LoadElement::GetElement(int i)
   return this->m_Element[i];
 }
 
+void LoadElement::ApplyLoads(const ElementPointersVectorType & elements, std::vector<Element::VectorType> & Fe)
+{
+  Fe.resize( elements.size() );
+  for( unsigned int i = 0; i < elements.size(); i++ )
+    {
+    this->ApplyLoad(elements[i], Fe[i]);
+    }
+}
+
 void LoadElement::PrintSelf(std::ostream& os, Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
@@ -0,0 +1,380 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkFEMSolver.h"
+#include "itkFEMSolverHyperbolic.h"
+#include "itkFEMLinearSystemWrapperCSR.h"
+#include "itkFEMElement3DC0LinearHexahedronStrain.h"
+#include "itkTimeProbe.h"
+
+namespace
+{
+typedef itk::fem::FEMObject<3>                  FEMObjectType;
+typedef itk::fem::LinearSystemWrapperCSR        CSRWrapperType;
+typedef itk::fem::LinearSystemWrapper::Float    Float;
+typedef std::vector< Float >                    SolutionType;
+
+// A block of nx x ny x nz hexahedral elements, clamped on the face x = 0
+// and pulled on the opposite one.
+FEMObjectType::Pointer CreateBlock(unsigned int nx, unsigned int ny, unsigned int nz)
+{
+  FEMObjectType::Pointer femObject = FEMObjectType::New();
+
+  unsigned int gn = 0;
+  for( unsigned int k = 0; k <= nz; k++ )
+    {
+    for( unsigned int j = 0; j <= ny; j++ )
+      {
+      for( unsigned int i = 0; i <= nx; i++ )
+        {
+        itk::fem::Element::VectorType pt(3);
+        pt[0] = i;
+        pt[1] = 0.8 * j;
+        pt[2] = 1.2 * k;
+        itk::fem::Element::Node::Pointer n = itk::fem::Element::Node::New();
+        n->SetCoordinates(pt);
+        n->SetGlobalNumber(gn++);
+        femObject->AddNextNode(n);
+        }
+      }
+    }
+
+  itk::fem::MaterialLinearElasticity::Pointer m = itk::fem::MaterialLinearElasticity::New();
+  m->SetGlobalNumber(0);
+  m->SetYoungsModulus(1000.0);
+  m->SetPoissonsRatio(0.3);
+  m->SetCrossSectionalArea(1.0);
+  m->SetMomentOfInertia(1.0);
+  femObject->AddNextMaterial(m);
+
+  const unsigned int corners[8][3] = { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 },
+                                       { 0, 0, 1 }, { 1, 0, 1 }, { 1, 1, 1 }, { 0, 1, 1 } };
+  gn = 0;
+  for( unsigned int k = 0; k < nz; k++ )
+    {
+    for( unsigned int j = 0; j < ny; j++ )
+      {
+      for( unsigned int i = 0; i < nx; i++ )
+        {
+        itk::fem::Element3DC0LinearHexahedronStrain::Pointer e =
+          itk::fem::Element3DC0LinearHexahedronStrain::New();
+        for( unsigned int c = 0; c < 8; c++ )
+          {
+          e->SetNode( c, femObject->GetNode( ( i + corners[c][0] )
+                                             + ( nx + 1 ) * ( ( j + corners[c][1] )
+                                                              + ( ny + 1 ) * ( k + corners[c][2] ) ) ) );
+          }
+        e->SetGlobalNumber(gn++);
+        e->SetMaterial( m.GetPointer() );
+        femObject->AddNextElement( e.GetPointer() );
+        }
+      }
+    }
+
+  // The nodes 0, 3, 4 and 7 of an element are on its face x = 0, and the
+  // nodes 1 and 6 on its face x = 1
+  const unsigned int clampedNodes[4] = { 0, 3, 4, 7 };
+  const unsigned int pulledNodes[2] = { 1, 6 };
+  gn = 0;
+  for( unsigned int e = 0; e < femObject->GetNumberOfElements(); e++ )
+    {
+    const unsigned int i = e % nx;
+    if( i == 0 )
+      {
+      for( unsigned int c = 0; c < 4; c++ )
+        {
+        for( unsigned int d = 0; d < 3; d++ )
+          {
+          itk::fem::LoadBC::Pointer l = itk::fem::LoadBC::New();
+          l->SetGlobalNumber(gn++);
+          l->SetElement( femObject->GetElement(e) );
+          l->SetDegreeOfFreedom( 3 * clampedNodes[c] + d );
+          l->SetValue( vnl_vector<double>(1, 0.0) );
+          femObject->AddNextLoad( l );
+          }
+        }
+      }
+    if( i == nx - 1 )
+      {
+      for( unsigned int c = 0; c < 2; c++ )
+        {
+        vnl_vector<double> force(3);
+        force[0] = 1.0;
+        force[1] = -0.5 - 0.1 * ( e / nx % ny );
+        force[2] = 0.2;
+        itk::fem::LoadNode::Pointer l = itk::fem::LoadNode::New();
+        l->SetGlobalNumber(gn++);
+        l->SetElement( femObject->GetElement(e) );
+        l->SetNode( pulledNodes[c] );
+        l->SetForce( force );
+        femObject->AddNextLoad( l );
+        }
+      }
+    }
+
+  femObject->FinalizeMesh();
+  return femObject;
+}
+
+template< class TSolver >
+SolutionType Solve(TSolver *solver, FEMObjectType *femObject, itk::fem::LinearSystemWrapper *wrapper,
+                   itk::ThreadIdType numberOfThreads, const char *name)
+{
+  solver->SetInput( femObject );
+  solver->SetNumberOfThreads( numberOfThreads );
+  solver->UseMultiThreadedAssemblyOn();
+  if( wrapper )
+    {
+    solver->SetLinearSystemWrapper( wrapper );
+    }
+
+  itk::TimeProbe time;
+  time.Start();
+  solver->Update();
+  time.Stop();
+
+  SolutionType solution( femObject->GetNumberOfDegreesOfFreedom() );
+  for( unsigned int i = 0; i < solution.size(); i++ )
+    {
+    solution[i] = solver->GetSolution(i);
+    }
+  std::cout << name << ", " << numberOfThreads << " threads: " << time.GetMean() << " s";
+  if( CSRWrapperType *csr = dynamic_cast< CSRWrapperType * >( wrapper ) )
+    {
+    std::cout << ", " << csr->GetNumberOfMatrixEntries() << " entries, "
+              << csr->GetNumberOfIterations() << " iterations, residual " << csr->GetResidual();
+    }
+  std::cout << std::endl;
+  return solution;
+}
+
+// The largest difference between two solutions, relative to the largest
+// displacement of the first one.
+double RelativeDifference(const SolutionType & a, const SolutionType & b)
+{
+  double maximum = 0.0;
+  double difference = 0.0;
+  for( unsigned int i = 0; i < a.size(); i++ )
+    {
+    maximum = vnl_math_max( maximum, vnl_math_abs( a[i] ) );
+    difference = vnl_math_max( difference, vnl_math_abs( a[i] - b[i] ) );
+    }
+  return difference / maximum;
+}
+
+bool SameMatrices(CSRWrapperType & a, CSRWrapperType & b, unsigned int matrixIndex)
+{
+  if( a.GetSystemOrder() != b.GetSystemOrder()
+      || a.GetNumberOfMatrixEntries(matrixIndex) != b.GetNumberOfMatrixEntries(matrixIndex) )
+    {
+    return false;
+    }
+  for( unsigned int i = 0; i < a.GetSystemOrder(); i++ )
+    {
+    itk::fem::LinearSystemWrapper::ColumnArray columnsA;
+    itk::fem::LinearSystemWrapper::ColumnArray columnsB;
+    a.GetColumnsOfNonZeroMatrixElementsInRow(i, columnsA, matrixIndex);
+    b.GetColumnsOfNonZeroMatrixElementsInRow(i, columnsB, matrixIndex);
+    if( columnsA != columnsB )
+      {
+      return false;
+      }
+    for( unsigned int c = 0; c < columnsA.size(); c++ )
+      {
+      if( a.GetMatrixValue(i, columnsA[c], matrixIndex) != b.GetMatrixValue(i, columnsA[c], matrixIndex) )
+        {
+        return false;
+        }
+      }
+    }
+  return true;
+}
+}
+
+int itkFEMLinearSystemWrapperCSRTest(int, char* [] )
+{
+  itk::FEMFactoryBase::GetFactory()->RegisterDefaultTypes();
+
+  // Entries are added on demand, and the structure is kept when the matrix
+  // is initialized again
+  CSRWrapperType small;
+  small.SetSystemOrder(4);
+  small.SetNumberOfMatrices(1);
+  small.InitializeMatrix(0);
+  small.SetMatrixValue(0, 0, 4.0, 0);
+  small.SetMatrixValue(1, 1, 0.0, 0);
+  small.AddMatrixValue(0, 2, 1.0, 0);
+  small.AddMatrixValue(2, 0, 1.0, 0);
+  small.AddMatrixValue(0, 2, 0.5, 0);
+  small.SetMatrixValue(3, 3, 2.0, 0);
+  if( small.GetNumberOfMatrixEntries() != 4 || small.GetMatrixValue(0, 2, 0) != 1.5
+      || small.GetMatrixValue(1, 1, 0) != 0.0 || small.GetMatrixValue(3, 1, 0) != 0.0 )
+    {
+    std::cerr << "Wrong entries in the matrix" << std::endl;
+    return EXIT_FAILURE;
+    }
+  small.InitializeMatrix(0);
+  if( small.GetNumberOfMatrixEntries() != 4 || small.GetMatrixValue(0, 0, 0) != 0.0 )
+    {
+    std::cerr << "The structure of the matrix was not kept" << std::endl;
+    return EXIT_FAILURE;
+    }
+  small.SetReuseMatrixStructure(false);
+  small.InitializeMatrix(0);
+  if( small.GetNumberOfMatrixEntries() != 0 )
+    {
+    std::cerr << "The structure of the matrix was kept" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // An indefinite matrix is reported, whatever the preconditioner
+  small.SetSystemOrder(2);
+  small.SetNumberOfVectors(1);
+  small.SetNumberOfSolutions(1);
+  for( unsigned int p = 0; p < 2; p++ )
+    {
+    small.SetPreconditioner( static_cast< CSRWrapperType::PreconditionerType >( p ) );
+    small.InitializeMatrix(0);
+    small.InitializeVector(0);
+    small.InitializeSolution(0);
+    small.SetMatrixValue(0, 0, 1.0, 0);
+    small.SetMatrixValue(1, 1, -1.0, 0);
+    small.SetVectorValue(0, 1.0, 0);
+    small.SetVectorValue(1, 1.0, 0);
+    try
+      {
+      small.Solve();
+      std::cerr << "No exception for an indefinite matrix" << std::endl;
+      return EXIT_FAILURE;
+      }
+    catch( itk::fem::FEMExceptionLinearSystem & err )
+      {
+      std::cout << "Indefinite matrix: " << err.GetDescription() << std::endl;
+      }
+    }
+
+  typedef itk::fem::Solver<3> SolverType;
+  FEMObjectType::Pointer femObject = CreateBlock(10, 6, 6);
+
+  // Reference solution with the default sparse VNL wrapper
+  SolverType::Pointer vnlSolver = SolverType::New();
+  const SolutionType reference = Solve( vnlSolver.GetPointer(), femObject, 0, 1, "VNL" );
+
+  // The element matrices are added in the same order whatever the number
+  // of threads, and the conjugate gradient gives the same solution for the
+  // same number of threads of the wrapper
+  CSRWrapperType serialWrapper;
+  serialWrapper.SetNumberOfThreads(1);
+  SolverType::Pointer serialSolver = SolverType::New();
+  const SolutionType serial = Solve( serialSolver.GetPointer(), femObject, &serialWrapper, 1, "CSR, Jacobi" );
+  const unsigned int jacobiIterations = serialWrapper.GetNumberOfIterations();
+
+  CSRWrapperType threadedWrapper;
+  threadedWrapper.SetNumberOfThreads(1);
+  SolverType::Pointer threadedSolver = SolverType::New();
+  const SolutionType threaded = Solve( threadedSolver.GetPointer(), femObject, &threadedWrapper, 3, "CSR, Jacobi" );
+  if( !SameMatrices( serialWrapper, threadedWrapper, 0 ) || threaded != serial )
+    {
+    std::cerr << "The assembly on three threads differs from the serial one" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const double referenceDifference = RelativeDifference( reference, serial );
+  std::cout << "Relative difference to VNL: " << referenceDifference << std::endl;
+  if( referenceDifference > 1.0e-4 )
+    {
+    std::cerr << "The conjugate gradient differs from VNL by " << referenceDifference << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The incomplete Cholesky preconditioner and several threads converge to
+  // the same solution in fewer iterations
+  CSRWrapperType choleskyWrapper;
+  choleskyWrapper.SetPreconditioner( CSRWrapperType::IncompleteCholeskyPreconditioner );
+  choleskyWrapper.SetNumberOfThreads(3);
+  SolverType::Pointer choleskySolver = SolverType::New();
+  const SolutionType cholesky = Solve( choleskySolver.GetPointer(), femObject, &choleskyWrapper, 3, "CSR, IC(0)" );
+  const double choleskyDifference = RelativeDifference( serial, cholesky );
+  std::cout << "Relative difference between the preconditioners: " << choleskyDifference << std::endl;
+  if( choleskyDifference > 1.0e-6 || choleskyWrapper.GetNumberOfIterations() >= jacobiIterations )
+    {
+    std::cerr << "IC(0) differs from Jacobi by " << choleskyDifference << " after "
+              << choleskyWrapper.GetNumberOfIterations() << " iterations" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A second solve with the same mesh keeps the structure of the matrix
+  const unsigned int numberOfEntries = choleskyWrapper.GetNumberOfMatrixEntries();
+  choleskySolver->Modified();
+  const SolutionType again = Solve( choleskySolver.GetPointer(), femObject, 0, 3, "CSR, IC(0), same mesh" );
+  if( choleskyWrapper.GetNumberOfMatrixEntries() != numberOfEntries || again != cholesky )
+    {
+    std::cerr << "The second solve differs from the first one" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The stiffness and mass matrices of the hyperbolic solver
+  typedef itk::fem::SolverHyperbolic<3> HyperbolicSolverType;
+  FEMObjectType::Pointer smallBlock = CreateBlock(5, 3, 3);
+  SolutionType hyperbolicSolutions[2];
+  CSRWrapperType hyperbolicWrappers[2];
+  for( unsigned int t = 0; t < 2; t++ )
+    {
+    HyperbolicSolverType::Pointer hyperbolicSolver = HyperbolicSolverType::New();
+    hyperbolicSolver->SetTimeStep(0.5);
+    hyperbolicSolver->SetNumberOfIterations(3);
+    hyperbolicWrappers[t].SetNumberOfThreads(1);
+    hyperbolicSolutions[t] = Solve( hyperbolicSolver.GetPointer(), smallBlock, &hyperbolicWrappers[t],
+                                    1 + 2 * t, "Hyperbolic, CSR" );
+    }
+  if( !SameMatrices( hyperbolicWrappers[0], hyperbolicWrappers[1], 1 )
+      || !SameMatrices( hyperbolicWrappers[0], hyperbolicWrappers[1], 2 )
+      || hyperbolicSolutions[0] != hyperbolicSolutions[1] )
+    {
+    std::cerr << "The hyperbolic solver on three threads differs from the serial one" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The first element that fails is reported, as with a single thread
+  femObject->GetNode( 5 + 11 * ( 3 + 7 * 3 ) )->ClearDegreesOfFreedom();
+  std::string descriptions[2];
+  for( unsigned int t = 0; t < 2; t++ )
+    {
+    CSRWrapperType wrapper;
+    SolverType::Pointer solver = SolverType::New();
+    try
+      {
+      Solve( solver.GetPointer(), femObject, &wrapper, 1 + 2 * t, "Missing degrees of freedom" );
+      std::cerr << "No exception with " << 1 + 2 * t << " threads" << std::endl;
+      return EXIT_FAILURE;
+      }
+    catch( itk::fem::FEMExceptionSolution & err )
+      {
+      descriptions[t] = std::string( err.GetLocation() ) + ": " + err.GetDescription();
+      }
+    }
+  std::cout << "Exception: " << descriptions[0] << std::endl;
+  if( descriptions[1] != descriptions[0] )
+    {
+    std::cerr << "Exception with three threads: " << descriptions[1] << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
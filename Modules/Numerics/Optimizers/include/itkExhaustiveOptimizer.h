@@ -76,6 +76,11 @@ namespace itk
  * the number of steps along each dimension, a side of the region is
  * stepLength*(2*numberOfSteps[d]+1)*scaling[d].
  *
+ * With several threads (see SetNumberOfThreads()), the cost function is
+ * evaluated at a few grid points at once, which requires a thread safe
+ * cost function. The IterationEvents are still invoked one grid point at
+ * a time, in the same order, and the results are the same.
+ *
  * \ingroup Numerics Optimizers
  * \ingroup ITKOptimizers
  */
@@ -129,6 +134,13 @@ protected:
 
   void IncrementIndex(ParametersType & param);
 
+  /** Move an index to the next grid point. Returns false when the index
+   * wraps around to the first grid point. */
+  bool NextIndex(ParametersType & index) const;
+
+  /** Compute the position of the grid point of an index. */
+  void ComputePosition(const ParametersType & index, ParametersType & position) const;
+
 protected:
   MeasureType m_CurrentValue;
 
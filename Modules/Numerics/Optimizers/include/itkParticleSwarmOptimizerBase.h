@@ -47,6 +47,10 @@ namespace itk
  * The actual optimization procedure, updating the swarm, is performed in the
  * subclasses, required to implement the UpdateSwarm() method.
  *
+ * The particles are evaluated together (see EvaluateSwarm()), on
+ * NumberOfThreads threads when the cost function is thread safe, with the
+ * same results whatever the number of threads.
+ *
  * NOTE: This implementation only performs minimization.
  *
  * \ingroup Numerics Optimizers
@@ -205,6 +209,11 @@ protected:
    * Implement your update rule in this function.*/
   virtual void UpdateSwarm() = 0;
 
+  /**
+   * Evaluate the cost function at the current parameters of all the
+   * particles, on NumberOfThreads threads. */
+  void EvaluateSwarm();
+
   ParticleSwarmOptimizerBase( const Self& ); //purposely not implemented
   void operator=( const Self& );//purposely not implemented
 
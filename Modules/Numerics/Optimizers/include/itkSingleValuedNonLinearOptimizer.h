@@ -20,6 +20,7 @@
 
 #include "itkNonLinearOptimizer.h"
 #include "itkSingleValuedCostFunction.h"
+#include "itkMultiThreader.h"
 
 namespace itk
 {
@@ -27,6 +28,14 @@ namespace itk
  * \brief This class is a base for the Optimization methods that
  * optimize a single valued function.
  *
+ * The optimizers that evaluate the cost function at several independent
+ * positions at once (the grid points of ExhaustiveOptimizer, the particles
+ * of ParticleSwarmOptimizerBase) do it through GetValues(), which splits
+ * the positions among NumberOfThreads threads. There is a single thread by
+ * default: with more, the GetValue() method of the cost function is called
+ * concurrently, so it must be thread safe. The values do not depend on the
+ * number of threads.
+ *
  * \ingroup Numerics Optimizers
  *
  * \ingroup ITKOptimizers
@@ -73,6 +82,21 @@ public:
   /** Get the cost function value at the given parameters. */
   MeasureType GetValue(const ParametersType & parameters) const;
 
+  /** Lists of positions and of the cost function values at them. */
+  typedef std::vector< ParametersType > ParametersListType;
+  typedef std::vector< MeasureType >    MeasureListType;
+
+  /** Get the cost function values at several positions, evaluated on
+   * NumberOfThreads threads. If the cost function throws an exception,
+   * the exception of the first position that fails is rethrown on the
+   * calling thread, as an ExceptionObject when it is not one. */
+  void GetValues(const ParametersListType & positions, MeasureListType & values) const;
+
+  /** Set/Get the number of threads GetValues() evaluates the cost
+   * function on. The default is one. */
+  itkSetClampMacro(NumberOfThreads, ThreadIdType, 1, ITK_MAX_THREADS);
+  itkGetConstMacro(NumberOfThreads, ThreadIdType);
+
 protected:
   SingleValuedNonLinearOptimizer();
   virtual ~SingleValuedNonLinearOptimizer() {}
@@ -82,6 +106,24 @@ protected:
 private:
   SingleValuedNonLinearOptimizer(const Self &); //purposely not implemented
   void operator=(const Self &);                 //purposely not implemented
+
+  /** The positions to evaluate and, for each chunk of them, the first
+   * position whose evaluation failed with its exception. */
+  struct GetValuesThreadStruct
+  {
+    const Self *                   Optimizer;
+    const ParametersListType *     Positions;
+    MeasureListType *              Values;
+    std::vector< SizeValueType >   FailedPositions;
+    std::vector< ExceptionObject > Exceptions;
+  };
+
+  /** Evaluate the chunks of positions of a thread. Chunk c holds one
+   * position every NumberOfThreads, starting at position c. */
+  static ITK_THREAD_RETURN_TYPE GetValuesThreaderCallback(void *arg);
+
+  ThreadIdType           m_NumberOfThreads;
+  MultiThreader::Pointer m_Threader;
 };
 } // end namespace itk
 
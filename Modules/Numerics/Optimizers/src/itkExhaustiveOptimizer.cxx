@@ -112,42 +112,52 @@ ExhaustiveOptimizer
   itkDebugMacro("ResumeWalk");
   m_Stop = false;
 
+  // With several threads, the cost function is evaluated at a few grid
+  // points at once, which are then walked one at a time as before
+  const SizeValueType batchSize =
+    this->GetNumberOfThreads() > 1 ? 4 * this->GetNumberOfThreads() : 1;
+  ParametersListType  positions;
+  MeasureListType     values;
+
   while ( !m_Stop )
     {
-    ParametersType currentPosition = this->GetCurrentPosition();
-
-    if ( m_Stop )
+    positions.clear();
+    positions.push_back( this->GetCurrentPosition() );
+    ParametersType index = m_CurrentIndex;
+    while ( positions.size() < batchSize && this->NextIndex(index) )
       {
-      StopWalking();
-      break;
+      ParametersType position;
+      this->ComputePosition(index, position);
+      positions.push_back(position);
       }
 
-    m_CurrentValue = this->GetValue(currentPosition);
+    this->GetValues(positions, values);
 
-    if ( m_CurrentValue > m_MaximumMetricValue )
-      {
-      m_MaximumMetricValue = m_CurrentValue;
-      m_MaximumMetricValuePosition = currentPosition;
-      }
-    if ( m_CurrentValue < m_MinimumMetricValue )
+    for ( SizeValueType i = 0; i < positions.size() && !m_Stop; i++ )
       {
-      m_MinimumMetricValue = m_CurrentValue;
-      m_MinimumMetricValuePosition = currentPosition;
-      }
-
-    if ( m_Stop )
-      {
-      this->StopWalking();
-      break;
+      const ParametersType & currentPosition = positions[i];
+
+      m_CurrentValue = values[i];
+
+      if ( m_CurrentValue > m_MaximumMetricValue )
+        {
+        m_MaximumMetricValue = m_CurrentValue;
+        m_MaximumMetricValuePosition = currentPosition;
+        }
+      if ( m_CurrentValue < m_MinimumMetricValue )
+        {
+        m_MinimumMetricValue = m_CurrentValue;
+        m_MinimumMetricValuePosition = currentPosition;
+        }
+
+      m_StopConditionDescription.str("");
+      m_StopConditionDescription << this->GetNameOfClass() << ": Running. ";
+      m_StopConditionDescription << "@ index " << this->GetCurrentIndex() << " value is " << this->GetCurrentValue();
+
+      this->InvokeEvent( IterationEvent() );
+      this->AdvanceOneStep();
+      m_CurrentIteration++;
       }
-
-    m_StopConditionDescription.str("");
-    m_StopConditionDescription << this->GetNameOfClass() << ": Running. ";
-    m_StopConditionDescription << "@ index " << this->GetCurrentIndex() << " value is " << this->GetCurrentValue();
-
-    this->InvokeEvent( IterationEvent() );
-    this->AdvanceOneStep();
-    m_CurrentIteration++;
     }
 }
 
@@ -180,17 +190,33 @@ ExhaustiveOptimizer
 void
 ExhaustiveOptimizer
 ::IncrementIndex(ParametersType & newPosition)
+{
+  if ( !this->NextIndex(m_CurrentIndex) )
+    {
+    m_Stop = true;
+    m_StopConditionDescription.str("");
+    m_StopConditionDescription << this->GetNameOfClass() << ": ";
+    m_StopConditionDescription << "Completed sampling of parametric space of size "
+                               << m_CostFunction->GetNumberOfParameters();
+    }
+
+  this->ComputePosition(m_CurrentIndex, newPosition);
+}
+
+bool
+ExhaustiveOptimizer
+::NextIndex(ParametersType & index) const
 {
   unsigned int       idx = 0;
   const unsigned int spaceDimension = m_CostFunction->GetNumberOfParameters();
 
   while ( idx < spaceDimension )
     {
-    m_CurrentIndex[idx]++;
+    index[idx]++;
 
-    if ( m_CurrentIndex[idx] > ( 2 * m_NumberOfSteps[idx] ) )
+    if ( index[idx] > ( 2 * m_NumberOfSteps[idx] ) )
       {
-      m_CurrentIndex[idx] = 0;
+      index[idx] = 0;
       idx++;
       }
     else
@@ -199,19 +225,21 @@ ExhaustiveOptimizer
       }
     }
 
-  if ( idx == spaceDimension )
-    {
-    m_Stop = true;
-    m_StopConditionDescription.str("");
-    m_StopConditionDescription << this->GetNameOfClass() << ": ";
-    m_StopConditionDescription << "Completed sampling of parametric space of size " << spaceDimension;
-    }
+  return idx < spaceDimension;
+}
+
+void
+ExhaustiveOptimizer
+::ComputePosition(const ParametersType & index, ParametersType & position) const
+{
+  const unsigned int spaceDimension = m_CostFunction->GetNumberOfParameters();
 
+  position.SetSize(spaceDimension);
   for ( unsigned int i = 0; i < spaceDimension; i++ )
     {
-    newPosition[i] = ( m_CurrentIndex[i] - m_NumberOfSteps[i] )
-                     * m_StepLength * this->GetScales()[i]
-                     + this->GetInitialPosition()[i];
+    position[i] = ( index[i] - m_NumberOfSteps[i] )
+                  * m_StepLength * this->GetScales()[i]
+                  + this->GetInitialPosition()[i];
     }
 }
 
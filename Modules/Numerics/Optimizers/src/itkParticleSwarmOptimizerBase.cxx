@@ -528,12 +528,29 @@ ParticleSwarmOptimizerBase
       }
     }
             //initial function evaluations
+  this->EvaluateSwarm();
   for( i=0; i<this->m_NumberOfParticles; i++ )
     {
-    this->m_Particles[i].m_CurrentValue =
-      this->m_CostFunction->GetValue( m_Particles[i].m_CurrentParameters );
     this->m_Particles[i].m_BestValue = m_Particles[i].m_CurrentValue;
     }
 }
 
+
+void
+ParticleSwarmOptimizerBase
+::EvaluateSwarm()
+{
+  ParametersListType positions( this->m_NumberOfParticles );
+  for( unsigned int i=0; i<this->m_NumberOfParticles; i++ )
+    {
+    positions[i] = this->m_Particles[i].m_CurrentParameters;
+    }
+  MeasureListType values;
+  this->GetValues( positions, values );
+  for( unsigned int i=0; i<this->m_NumberOfParticles; i++ )
+    {
+    this->m_Particles[i].m_CurrentValue = values[i];
+    }
+}
+
 }
@@ -26,6 +26,8 @@ SingleValuedNonLinearOptimizer
 ::SingleValuedNonLinearOptimizer()
 {
   m_CostFunction = 0;
+  m_NumberOfThreads = 1;
+  m_Threader = MultiThreader::New();
 }
 
 /**
@@ -78,6 +80,114 @@ SingleValuedNonLinearOptimizer
   return this->GetCostFunction()->GetValue(parameters);
 }
 
+/**
+ * Get the cost function values at several positions
+ */
+void
+SingleValuedNonLinearOptimizer
+::GetValues(const ParametersListType & positions, MeasureListType & values) const
+{
+  values.resize( positions.size() );
+
+  ThreadIdType numberOfThreads = m_NumberOfThreads;
+  if ( positions.size() < numberOfThreads )
+    {
+    numberOfThreads = static_cast< ThreadIdType >( positions.size() );
+    }
+  if ( numberOfThreads <= 1 )
+    {
+    for ( SizeValueType i = 0; i < positions.size(); i++ )
+      {
+      values[i] = this->GetValue(positions[i]);
+      }
+    return;
+    }
+
+  if ( !m_CostFunction )
+    {
+    ExceptionObject ex;
+    ex.SetLocation(__FILE__);
+    ex.SetDescription("The costfunction must be set prior to calling GetValue");
+    throw ex;
+    }
+
+  GetValuesThreadStruct str;
+  str.Optimizer = this;
+  str.Positions = &positions;
+  str.Values = &values;
+  str.FailedPositions.resize( numberOfThreads, positions.size() );
+  str.Exceptions.resize(numberOfThreads);
+
+  m_Threader->SetNumberOfThreads(numberOfThreads);
+  m_Threader->SetSingleMethod(GetValuesThreaderCallback, &str);
+  m_Threader->SingleMethodExecute();
+
+  // Each chunk stops at its first failure: the first position that
+  // failed is the first of these
+  ThreadIdType failedChunk = 0;
+  for ( ThreadIdType chunk = 1; chunk < numberOfThreads; chunk++ )
+    {
+    if ( str.FailedPositions[chunk] < str.FailedPositions[failedChunk] )
+      {
+      failedChunk = chunk;
+      }
+    }
+  if ( str.FailedPositions[failedChunk] < positions.size() )
+    {
+    throw str.Exceptions[failedChunk];
+    }
+}
+
+ITK_THREAD_RETURN_TYPE
+SingleValuedNonLinearOptimizer
+::GetValuesThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info =
+    static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  GetValuesThreadStruct *str = static_cast< GetValuesThreadStruct * >( info->UserData );
+
+  const CostFunctionType *costFunction = str->Optimizer->GetCostFunction();
+  const SizeValueType     numberOfChunks = str->FailedPositions.size();
+
+  // the threader may run fewer threads than chunks
+  for ( SizeValueType chunk = info->ThreadID; chunk < numberOfChunks;
+        chunk += info->NumberOfThreads )
+    {
+    for ( SizeValueType i = chunk; i < str->Positions->size(); i += numberOfChunks )
+      {
+      try
+        {
+        ( *str->Values )[i] = costFunction->GetValue( ( *str->Positions )[i] );
+        }
+      catch ( ExceptionObject & err )
+        {
+        str->FailedPositions[chunk] = i;
+        str->Exceptions[chunk] = err;
+        break;
+        }
+      catch ( std::exception & err )
+        {
+        // Nothing may escape the thread: the exception is rethrown by
+        // GetValues() on the calling thread
+        str->FailedPositions[chunk] = i;
+        str->Exceptions[chunk] =
+          ExceptionObject(__FILE__, __LINE__, err.what(), ITK_LOCATION);
+        break;
+        }
+      catch ( ... )
+        {
+        str->FailedPositions[chunk] = i;
+        str->Exceptions[chunk] =
+          ExceptionObject(__FILE__, __LINE__,
+                          "Unknown exception thrown by the cost function", ITK_LOCATION);
+        break;
+        }
+      }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
 void
 SingleValuedNonLinearOptimizer
 ::PrintSelf(std::ostream & os, Indent indent) const
@@ -87,6 +197,7 @@ SingleValuedNonLinearOptimizer
     {
     os << indent << "Cost Function: " << m_CostFunction.GetPointer() << std::endl;
     }
+  os << indent << "NumberOfThreads: " << m_NumberOfThreads << std::endl;
 }
 } // namespace itk
 
@@ -0,0 +1,282 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkCommand.h"
+#include "itkExhaustiveOptimizer.h"
+#include "itkParticleSwarmOptimizer.h"
+#include "itkTimeProbe.h"
+
+namespace
+{
+/**
+ * The mean squared distance between a set of points rotated and
+ * translated in the plane and the same points rotated by 0.3 radians and
+ * translated by (2, -1): a small rigid alignment problem. The cost
+ * function has no state, so it can be evaluated on several threads. It
+ * throws when the angle is larger than a limit.
+ */
+class RigidAlignmentCostFunction : public itk::SingleValuedCostFunction
+{
+public:
+
+  typedef RigidAlignmentCostFunction    Self;
+  typedef itk::SingleValuedCostFunction Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+  itkNewMacro( Self );
+
+  typedef Superclass::ParametersType ParametersType;
+  typedef Superclass::DerivativeType DerivativeType;
+  typedef Superclass::MeasureType    MeasureType;
+
+  itkSetMacro( MaximumAngle, double );
+
+  MeasureType GetValue( const ParametersType & parameters ) const
+  {
+    if( parameters[0] > m_MaximumAngle )
+      {
+      itkExceptionMacro( << "Angle " << parameters[0] << " is out of range" );
+      }
+    const double c = vcl_cos( parameters[0] );
+    const double s = vcl_sin( parameters[0] );
+    const double fixedC = vcl_cos( 0.3 );
+    const double fixedS = vcl_sin( 0.3 );
+    double sum = 0.0;
+    for( unsigned int i = 0; i < 2000; ++i )
+      {
+      const double x = vcl_cos( 0.01 * i ) * ( 1.0 + 0.001 * i );
+      const double y = vcl_sin( 0.013 * i ) * ( 2.0 - 0.0005 * i );
+      const double dx = c * x - s * y + parameters[1] - ( fixedC * x - fixedS * y + 2.0 );
+      const double dy = s * x + c * y + parameters[2] - ( fixedS * x + fixedC * y - 1.0 );
+      sum += dx * dx + dy * dy;
+      }
+    return sum / 2000.0;
+  }
+
+  void GetDerivative( const ParametersType & itkNotUsed(parameters),
+                      DerivativeType & itkNotUsed(derivative) ) const
+  {
+    itkExceptionMacro( << "no derivative available" );
+  }
+
+  unsigned int GetNumberOfParameters(void) const
+  {
+    return 3;
+  }
+
+protected:
+  RigidAlignmentCostFunction() : m_MaximumAngle( 10.0 ) {}
+
+private:
+  double m_MaximumAngle;
+};
+
+/** Record the values of the iterations, and stop after some of them. */
+class IterationRecorder : public itk::Command
+{
+public:
+  typedef IterationRecorder       Self;
+  typedef itk::Command            Superclass;
+  typedef itk::SmartPointer<Self> Pointer;
+  itkNewMacro( Self );
+
+  std::vector< double > m_Values;
+  std::vector< double > m_Indices;
+  unsigned int          m_StopIteration;
+
+  void Execute( itk::Object *caller, const itk::EventObject & event )
+  {
+    itk::ExhaustiveOptimizer *optimizer = static_cast< itk::ExhaustiveOptimizer * >( caller );
+    if( itk::IterationEvent().CheckEvent( &event ) )
+      {
+      m_Values.push_back( optimizer->GetCurrentValue() );
+      m_Indices.push_back( optimizer->GetCurrentIndex()[0] + 100.0 * optimizer->GetCurrentIndex()[1]
+                           + 10000.0 * optimizer->GetCurrentIndex()[2] );
+      if( m_Values.size() == m_StopIteration )
+        {
+        optimizer->StopWalking();
+        }
+      }
+  }
+
+  void Execute( const itk::Object *, const itk::EventObject & )
+  {
+  }
+
+protected:
+  IterationRecorder() : m_StopIteration( 0 ) {}
+};
+
+itk::ExhaustiveOptimizer::Pointer Walk( RigidAlignmentCostFunction *costFunction,
+                                        itk::ThreadIdType numberOfThreads,
+                                        IterationRecorder *recorder )
+{
+  itk::ExhaustiveOptimizer::Pointer optimizer = itk::ExhaustiveOptimizer::New();
+  optimizer->SetCostFunction( costFunction );
+  optimizer->SetNumberOfThreads( numberOfThreads );
+
+  itk::ExhaustiveOptimizer::ParametersType initialPosition( 3 );
+  initialPosition[0] = 0.0;
+  initialPosition[1] = 1.0;
+  initialPosition[2] = 0.0;
+  optimizer->SetInitialPosition( initialPosition );
+  itk::ExhaustiveOptimizer::ScalesType scales( 3 );
+  scales[0] = 0.05;
+  scales[1] = 0.5;
+  scales[2] = 0.5;
+  optimizer->SetScales( scales );
+  itk::ExhaustiveOptimizer::StepsType steps( 3 );
+  steps[0] = 10;
+  steps[1] = 6;
+  steps[2] = 6;
+  optimizer->SetNumberOfSteps( steps );
+  optimizer->SetStepLength( 1.0 );
+  optimizer->AddObserver( itk::IterationEvent(), recorder );
+
+  itk::TimeProbe time;
+  time.Start();
+  optimizer->StartOptimization();
+  time.Stop();
+  std::cout << "ExhaustiveOptimizer, " << numberOfThreads << " threads: " << time.GetMean()
+            << " s, " << recorder->m_Values.size() << " iterations, minimum "
+            << optimizer->GetMinimumMetricValue() << " at "
+            << optimizer->GetMinimumMetricValuePosition() << std::endl;
+  return optimizer;
+}
+
+itk::ParticleSwarmOptimizer::Pointer Swarm( RigidAlignmentCostFunction *costFunction,
+                                            itk::ThreadIdType numberOfThreads )
+{
+  itk::ParticleSwarmOptimizer::Pointer optimizer = itk::ParticleSwarmOptimizer::New();
+  optimizer->UseSeedOn();
+  optimizer->SetSeed( 1234567 );
+  optimizer->SetNumberOfThreads( numberOfThreads );
+
+  itk::ParticleSwarmOptimizer::ParameterBoundsType bounds;
+  bounds.push_back( std::make_pair( -1.0, 1.0 ) );
+  bounds.push_back( std::make_pair( -5.0, 5.0 ) );
+  bounds.push_back( std::make_pair( -5.0, 5.0 ) );
+  optimizer->SetParameterBounds( bounds );
+  optimizer->SetNumberOfParticles( 30 );
+  optimizer->SetMaximalNumberOfIterations( 60 );
+  optimizer->SetParametersConvergenceTolerance( 1.0e-4, 3 );
+  optimizer->SetFunctionConvergenceTolerance( 1.0e-8 );
+  optimizer->SetCostFunction( costFunction );
+  itk::ParticleSwarmOptimizer::ParametersType initialPosition( 3 );
+  initialPosition.Fill( 0.0 );
+  optimizer->SetInitialPosition( initialPosition );
+
+  itk::TimeProbe time;
+  time.Start();
+  optimizer->StartOptimization();
+  time.Stop();
+  std::cout << "ParticleSwarmOptimizer, " << numberOfThreads << " threads: " << time.GetMean()
+            << " s, value " << optimizer->GetValue() << " at "
+            << optimizer->GetCurrentPosition() << std::endl;
+  return optimizer;
+}
+}
+
+int itkOptimizersThreadsTest(int, char* [] )
+{
+  RigidAlignmentCostFunction::Pointer costFunction = RigidAlignmentCostFunction::New();
+
+  // The grid points are walked in the same order whatever the number of
+  // threads, including when an observer stops the walk
+  const itk::ThreadIdType numbersOfThreads[] = { 1, 3, 8 };
+  const unsigned int      stopIterations[] = { 0, 1, 77 };
+  for( unsigned int s = 0; s < 3; ++s )
+    {
+    IterationRecorder::Pointer serialRecorder = IterationRecorder::New();
+    serialRecorder->m_StopIteration = stopIterations[s];
+    itk::ExhaustiveOptimizer::Pointer serial = Walk( costFunction, 1, serialRecorder );
+    for( unsigned int t = 1; t < 3; ++t )
+      {
+      IterationRecorder::Pointer recorder = IterationRecorder::New();
+      recorder->m_StopIteration = stopIterations[s];
+      itk::ExhaustiveOptimizer::Pointer threaded = Walk( costFunction, numbersOfThreads[t], recorder );
+      if( recorder->m_Values != serialRecorder->m_Values
+          || recorder->m_Indices != serialRecorder->m_Indices
+          || threaded->GetMinimumMetricValue() != serial->GetMinimumMetricValue()
+          || threaded->GetMaximumMetricValue() != serial->GetMaximumMetricValue()
+          || threaded->GetMinimumMetricValuePosition() != serial->GetMinimumMetricValuePosition()
+          || threaded->GetMaximumMetricValuePosition() != serial->GetMaximumMetricValuePosition()
+          || threaded->GetCurrentIndex() != serial->GetCurrentIndex()
+          || threaded->GetStopConditionDescription() != serial->GetStopConditionDescription() )
+        {
+        std::cerr << "The walk on " << numbersOfThreads[t] << " threads, stopped at iteration "
+                  << stopIterations[s] << ", differs from the serial one" << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    if( stopIterations[s] == 0 && serialRecorder->m_Values.size() != serial->GetMaximumNumberOfIterations() )
+      {
+      std::cerr << serialRecorder->m_Values.size() << " iterations instead of "
+                << serial->GetMaximumNumberOfIterations() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // The first grid point that fails is reported, as with a single thread
+  costFunction->SetMaximumAngle( 0.31 );
+  std::string descriptions[3];
+  for( unsigned int t = 0; t < 3; ++t )
+    {
+    IterationRecorder::Pointer recorder = IterationRecorder::New();
+    try
+      {
+      Walk( costFunction, numbersOfThreads[t], recorder );
+      std::cerr << "No exception with " << numbersOfThreads[t] << " threads" << std::endl;
+      return EXIT_FAILURE;
+      }
+    catch( itk::ExceptionObject & err )
+      {
+      descriptions[t] = err.GetDescription();
+      }
+    if( t > 0 && descriptions[t] != descriptions[0] )
+      {
+      std::cerr << "Exception with " << numbersOfThreads[t] << " threads: " << descriptions[t]
+                << std::endl << "with one: " << descriptions[0] << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  std::cout << "Exception: " << descriptions[0] << std::endl;
+  costFunction->SetMaximumAngle( 10.0 );
+
+  // The particles move the same way whatever the number of threads
+  itk::ParticleSwarmOptimizer::Pointer serialSwarm = Swarm( costFunction, 1 );
+  itk::ParticleSwarmOptimizer::Pointer threadedSwarm = Swarm( costFunction, 4 );
+  if( threadedSwarm->GetValue() != serialSwarm->GetValue()
+      || threadedSwarm->GetCurrentPosition() != serialSwarm->GetCurrentPosition() )
+    {
+    std::cerr << "The particle swarm on four threads differs from the serial one" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if( vnl_math_abs( serialSwarm->GetCurrentPosition()[0] - 0.3 ) > 1.0e-2
+      || vnl_math_abs( serialSwarm->GetCurrentPosition()[1] - 2.0 ) > 1.0e-2
+      || vnl_math_abs( serialSwarm->GetCurrentPosition()[2] + 1.0 ) > 1.0e-2 )
+    {
+    std::cerr << "The particle swarm did not find the alignment" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  threadedSwarm->Print( std::cout );
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -144,14 +144,9 @@ CovarianceSampleFilter< TSample >
 
   double totalFrequency = 0.0;
 
-  typename TSample::ConstIterator iter = input->Begin();
-  typename TSample::ConstIterator end = input->End();
-
   MeasurementVectorRealType diff;
-  MeasurementVectorType measurements;
 
   NumericTraits<MeasurementVectorRealType>::SetLength(diff, measurementVectorSize);
-  NumericTraits<MeasurementVectorType>::SetLength(measurements, measurementVectorSize);
 
   typedef MeanSampleFilter< TSample > MeanFilterType;
   typename MeanFilterType::Pointer meanFilter = MeanFilterType::New();
@@ -164,29 +159,69 @@ CovarianceSampleFilter< TSample >
 
   decoratedMeanOutput->Set( mean );
 
-  iter = input->Begin();
-
-  // fills the lower triangle and the diagonal cells in the covariance matrix
-  while ( iter != end )
+  const MeasurementType *buffer = input->GetMeasurementBuffer();
+  if ( buffer )
     {
-    const double frequency = iter.GetFrequency();
-    totalFrequency += frequency;
-    measurements = iter.GetMeasurementVector();
-
-    for ( unsigned int i = 0; i < measurementVectorSize; ++i )
+    // The measurements are contiguous, with a frequency of one each: the
+    // lower triangle is accumulated in a plain array
+    std::vector< double > lower( measurementVectorSize * ( measurementVectorSize + 1 ) / 2, 0.0 );
+    const typename TSample::InstanceIdentifier size = input->Size();
+    for ( typename TSample::InstanceIdentifier id = 0; id < size; ++id )
       {
-      diff[i] = static_cast< MeasurementRealType >( measurements[i] ) - mean[i];
+      for ( unsigned int i = 0; i < measurementVectorSize; ++i )
+        {
+        diff[i] = static_cast< MeasurementRealType >( buffer[i] ) - mean[i];
+        }
+
+      double *cell = &lower[0];
+      for ( unsigned int row = 0; row < measurementVectorSize; row++ )
+        {
+        const double rowDiff = diff[row];
+        for ( unsigned int col = 0; col < row + 1; col++ )
+          {
+          *cell++ += rowDiff * diff[col];
+          }
+        }
+      buffer += measurementVectorSize;
       }
+    totalFrequency = static_cast< double >( size );
 
-    // updates the covariance matrix
+    const double *cell = &lower[0];
     for ( unsigned int row = 0; row < measurementVectorSize; row++ )
       {
       for ( unsigned int col = 0; col < row + 1; col++ )
         {
-        output(row, col) += frequency * diff[row] * diff[col];
+        output(row, col) = *cell++;
+        }
+      }
+    }
+  else
+    {
+    typename TSample::ConstIterator iter = input->Begin();
+    typename TSample::ConstIterator end = input->End();
+
+    // fills the lower triangle and the diagonal cells in the covariance matrix
+    while ( iter != end )
+      {
+      const double frequency = iter.GetFrequency();
+      totalFrequency += frequency;
+      const MeasurementVectorType & measurements = iter.GetMeasurementVector();
+
+      for ( unsigned int i = 0; i < measurementVectorSize; ++i )
+        {
+        diff[i] = static_cast< MeasurementRealType >( measurements[i] ) - mean[i];
+        }
+
+      // updates the covariance matrix
+      for ( unsigned int row = 0; row < measurementVectorSize; row++ )
+        {
+        for ( unsigned int col = 0; col < row + 1; col++ )
+          {
+          output(row, col) += frequency * diff[row] * diff[col];
+          }
         }
+      ++iter;
       }
-    ++iter;
     }
 
   // fills the upper triangle using the lower triangle
@@ -21,6 +21,7 @@
 #include "itkMixtureModelComponentBase.h"
 #include "itkGaussianMembershipFunction.h"
 #include "itkSimpleDataObjectDecorator.h"
+#include "itkMultiThreader.h"
 
 namespace itk
 {
@@ -42,6 +43,13 @@ namespace Statistics
  * required. The EM procedure terminates when the current iteration
  * reaches the maximum iteration or the model parameters converge.
  *
+ * The memberships of the measurement vectors, the proportions and the
+ * parameters of the components can be computed on several threads
+ * (SetNumberOfThreads), each one on a chunk of the sample. The default is
+ * one thread, because the samples that return their measurement vectors
+ * through an internal buffer, such as ImageToListSampleAdaptor and
+ * Histogram, cannot be read by several threads at the same time.
+ *
  * <b>Recent API changes:</b>
  * The static const macro to get the length of a measurement vector,
  * \c MeasurementVectorSize  has been removed to allow the length of a measurement
@@ -138,6 +146,11 @@ public:
 
   int GetMaximumIteration() const;
 
+  /** Set/Get the number of threads. The components are updated with the
+   * same number of threads. */
+  itkSetClampMacro(NumberOfThreads, ThreadIdType, 1, ITK_MAX_THREADS);
+  itkGetConstMacro(NumberOfThreads, ThreadIdType);
+
   /** Gets the current iteration. */
   int GetCurrentIteration()
   {
@@ -180,10 +193,32 @@ protected:
 
   bool UpdateProportions();
 
+  /** Computes the memberships of the measurement vectors of a chunk of
+   * the sample. */
+  void ThreadedCalculateDensities(ThreadIdType chunk, ThreadIdType numberOfChunks);
+
+  /** Sums the memberships of the measurement vectors of a chunk of the
+   * sample to each component. The sums of the chunks follow each other in
+   * proportionSums. */
+  void ThreadedUpdateProportions(ThreadIdType chunk, ThreadIdType numberOfChunks,
+                                 std::vector< double > & proportionSums) const;
+
   /** Starts the estimation process */
   void GenerateData();
 
 private:
+  /** Data shared by the threads */
+  struct ThreadStruct {
+    Self *Estimator;
+    ThreadIdType NumberOfChunks;
+    std::vector< double > ProportionSums;
+  };
+
+  /** Static functions used as "callbacks" by the MultiThreader. */
+  static ITK_THREAD_RETURN_TYPE CalculateDensitiesThreaderCallback(void *arg);
+
+  static ITK_THREAD_RETURN_TYPE UpdateProportionsThreaderCallback(void *arg);
+
   /** Target data sample pointer*/
   const TSample *m_Sample;
 
@@ -197,6 +232,9 @@ private:
 
   MembershipFunctionVectorObjectPointer  m_MembershipFunctionsObject;
   MembershipFunctionsWeightsArrayPointer m_MembershipFunctionsWeightArrayObject;
+
+  ThreadIdType           m_NumberOfThreads;
+  MultiThreader::Pointer m_Threader;
 };  // end of class
 } // end of namespace Statistics
 } // end of namespace itk
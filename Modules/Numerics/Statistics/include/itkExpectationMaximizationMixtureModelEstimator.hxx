@@ -36,6 +36,8 @@ ExpectationMaximizationMixtureModelEstimator< TSample >
     MembershipFunctionsWeightsArrayObjectType::New();
   m_Sample = 0;
   m_MaxIteration = 100;
+  m_NumberOfThreads = 1;
+  m_Threader = MultiThreader::New();
 }
 
 template< class TSample >
@@ -62,6 +64,7 @@ ExpectationMaximizationMixtureModelEstimator< TSample >
   os << indent << "Proportions: "
      << this->GetProportions() << std::endl;
   os << indent << "Calculated Expectation: " << this->CalculateExpectation() << std::endl;
+  os << indent << "Number Of Threads: " << m_NumberOfThreads << std::endl;
 }
 
 template< class TSample >
@@ -174,13 +177,32 @@ ExpectationMaximizationMixtureModelEstimator< TSample >
     return false;
     }
 
+  if ( m_NumberOfThreads > 1 )
+    {
+    ThreadStruct str;
+    str.Estimator = this;
+    str.NumberOfChunks = m_NumberOfThreads;
+    m_Threader->SetNumberOfThreads(m_NumberOfThreads);
+    m_Threader->SetSingleMethod(Self::CalculateDensitiesThreaderCallback, &str);
+    m_Threader->SingleMethodExecute();
+    }
+  else
+    {
+    this->ThreadedCalculateDensities(0, 1);
+    }
+
+  return true;
+}
+
+template< class TSample >
+void
+ExpectationMaximizationMixtureModelEstimator< TSample >
+::ThreadedCalculateDensities(ThreadIdType chunk, ThreadIdType numberOfChunks)
+{
   double                temp;
   size_t                numberOfComponents = m_ComponentVector.size();
   std::vector< double > tempWeights(numberOfComponents, 0. );
 
-  typename TSample::ConstIterator iter = m_Sample->Begin();
-  typename TSample::ConstIterator last = m_Sample->End();
-
   size_t componentIndex;
 
   typedef typename TSample::AbsoluteFrequencyType FrequencyType;
@@ -191,9 +213,21 @@ ExpectationMaximizationMixtureModelEstimator< TSample >
   double densitySum;
   double minDouble = NumericTraits<double>::epsilon();
 
-  SizeValueType measurementVectorIndex = 0;
+  // the chunk is a range of consecutive measurement vectors, which only
+  // the iterators of the sample reach in order
+  const SizeValueType size = m_Sample->Size();
+  const SizeValueType first = size * chunk / numberOfChunks;
+  const SizeValueType last = size * ( chunk + 1 ) / numberOfChunks;
+
+  typename TSample::ConstIterator iter = m_Sample->Begin();
+  SizeValueType                   measurementVectorIndex = 0;
+  while ( measurementVectorIndex < first )
+    {
+    ++iter;
+    ++measurementVectorIndex;
+    }
 
-  while ( iter != last )
+  while ( measurementVectorIndex < last )
     {
     mvector = iter.GetMeasurementVector();
     frequency = iter.GetFrequency();
@@ -238,7 +272,25 @@ ExpectationMaximizationMixtureModelEstimator< TSample >
     ++measurementVectorIndex;
     }
 
-  return true;
+}
+
+template< class TSample >
+ITK_THREAD_RETURN_TYPE
+ExpectationMaximizationMixtureModelEstimator< TSample >
+::CalculateDensitiesThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info =
+    static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  ThreadStruct *str = static_cast< ThreadStruct * >( info->UserData );
+
+  // the threader may run fewer threads than chunks
+  for ( ThreadIdType chunk = info->ThreadID; chunk < str->NumberOfChunks;
+        chunk += info->NumberOfThreads )
+    {
+    str->Estimator->ThreadedCalculateDensities(chunk, str->NumberOfChunks);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
 }
 
 template< class TSample >
@@ -319,22 +371,40 @@ ExpectationMaximizationMixtureModelEstimator< TSample >
 ::UpdateProportions()
 {
   size_t numberOfComponents = m_ComponentVector.size();
-  size_t sampleSize = m_Sample->Size();
   double totalFrequency = static_cast< double >( m_Sample->GetTotalFrequency() );
-  size_t   i, j;
+  size_t   i;
+  ThreadIdType chunk;
   double tempSum;
   bool   updated = false;
 
+  // the sums of the memberships of the chunks, component by component
+  ThreadStruct str;
+  str.Estimator = this;
+  str.NumberOfChunks = m_NumberOfThreads;
+  str.ProportionSums.assign(m_NumberOfThreads * numberOfComponents, 0.);
+  if( totalFrequency > NumericTraits<double>::epsilon() )
+    {
+    if ( m_NumberOfThreads > 1 )
+      {
+      m_Threader->SetNumberOfThreads(m_NumberOfThreads);
+      m_Threader->SetSingleMethod(Self::UpdateProportionsThreaderCallback, &str);
+      m_Threader->SingleMethodExecute();
+      }
+    else
+      {
+      this->ThreadedUpdateProportions(0, 1, str.ProportionSums);
+      }
+    }
+
   for ( i = 0; i < numberOfComponents; ++i )
     {
     tempSum = 0.;
 
     if( totalFrequency > NumericTraits<double>::epsilon() )
       {
-      for ( j = 0; j < sampleSize; ++j )
+      for ( chunk = 0; chunk < str.NumberOfChunks; ++chunk )
         {
-        tempSum += ( m_ComponentVector[i]->GetWeight(j)
-                     * m_Sample->GetFrequency(j) );
+        tempSum += str.ProportionSums[chunk * numberOfComponents + i];
         }
 
       tempSum /= totalFrequency;
@@ -350,6 +420,48 @@ ExpectationMaximizationMixtureModelEstimator< TSample >
   return updated;
 }
 
+template< class TSample >
+void
+ExpectationMaximizationMixtureModelEstimator< TSample >
+::ThreadedUpdateProportions(ThreadIdType chunk, ThreadIdType numberOfChunks,
+                            std::vector< double > & proportionSums) const
+{
+  const size_t        numberOfComponents = m_ComponentVector.size();
+  const SizeValueType size = m_Sample->Size();
+  const SizeValueType first = size * chunk / numberOfChunks;
+  const SizeValueType last = size * ( chunk + 1 ) / numberOfChunks;
+
+  for ( size_t i = 0; i < numberOfComponents; ++i )
+    {
+    double tempSum = 0.;
+    for ( SizeValueType j = first; j < last; ++j )
+      {
+      tempSum += ( m_ComponentVector[i]->GetWeight(j)
+                   * m_Sample->GetFrequency(j) );
+      }
+    proportionSums[chunk * numberOfComponents + i] = tempSum;
+    }
+}
+
+template< class TSample >
+ITK_THREAD_RETURN_TYPE
+ExpectationMaximizationMixtureModelEstimator< TSample >
+::UpdateProportionsThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info =
+    static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  ThreadStruct *str = static_cast< ThreadStruct * >( info->UserData );
+
+  // the threader may run fewer threads than chunks
+  for ( ThreadIdType chunk = info->ThreadID; chunk < str->NumberOfChunks;
+        chunk += info->NumberOfThreads )
+    {
+    str->Estimator->ThreadedUpdateProportions(chunk, str->NumberOfChunks, str->ProportionSums);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
 template< class TSample >
 void
 ExpectationMaximizationMixtureModelEstimator< TSample >
@@ -357,6 +469,12 @@ ExpectationMaximizationMixtureModelEstimator< TSample >
 {
   m_Proportions = m_InitialProportions;
 
+  for ( size_t componentIndex = 0; componentIndex < m_ComponentVector.size();
+        ++componentIndex )
+    {
+    m_ComponentVector[componentIndex]->SetNumberOfThreads(m_NumberOfThreads);
+    }
+
   int iteration = 0;
   m_CurrentIteration = 0;
   while ( iteration < m_MaxIteration )
@@ -161,18 +161,22 @@ GaussianMembershipFunction< TMeasurementVector >
   const MeasurementVectorSizeType measurementVectorSize =
     this->GetMeasurementVectorSize();
 
-  // Compute ( y - mean )
-  vnl_vector< double > tempVector( measurementVectorSize );
-
+  // temp = ( y - mean )^t * InverseCovariance * ( y - mean ), one row
+  // of the inverse covariance at a time, without allocating temporary
+  // vectors
+  const vnl_matrix< double > & inverseCovariance = m_InverseCovariance.GetVnlMatrix();
+  double temp = 0.0;
   for ( MeasurementVectorSizeType i = 0; i < measurementVectorSize; ++i )
     {
-    tempVector[i] = measurement[i] - m_Mean[i];
+    const double *inverseCovarianceRow = inverseCovariance[i];
+    double        product = 0.0;
+    for ( MeasurementVectorSizeType j = 0; j < measurementVectorSize; ++j )
+      {
+      product += inverseCovarianceRow[j] * ( measurement[j] - m_Mean[j] );
+      }
+    temp += ( measurement[i] - m_Mean[i] ) * product;
     }
 
-  // temp = ( y - mean )^t * InverseCovariance * ( y - mean )
-  double temp = dot_product( tempVector,
-                             m_InverseCovariance.GetVnlMatrix() * tempVector );
-
   temp = vcl_exp(-0.5 * temp);
 
   return m_PreFactor * temp;
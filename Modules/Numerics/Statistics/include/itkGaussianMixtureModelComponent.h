@@ -35,6 +35,11 @@ namespace Statistics
  * On every iteration of EM estimation, this class's GenerateData
  * method is called to compute the new distribution parameters.
  *
+ * The weighted mean and covariance are computed from sums over chunks of
+ * the sample, one chunk per thread, which are added in the order of the
+ * chunks. With one thread (the default), they are the results of
+ * WeightedMeanSampleFilter and WeightedCovarianceSampleFilter.
+ *
  * <b>Recent API changes:</b>
  * The static const macro to get the length of a measurement vector,
  * \c MeasurementVectorSize  has been removed to allow the length of a measurement
@@ -83,6 +88,10 @@ public:
   /** Type of the covariance matrix */
   typedef typename CovarianceEstimatorType::OutputType CovarianceMatrixType;
 
+  typedef typename CovarianceEstimatorType::MeasurementRealType       MeasurementRealType;
+  typedef typename CovarianceEstimatorType::MeasurementVectorRealType MeasurementVectorRealType;
+  typedef typename CovarianceEstimatorType::MatrixType                MatrixType;
+
   /** Sets the input sample */
   void SetSample(const TSample *sample);
 
@@ -101,16 +110,44 @@ protected:
   /** Computes the new distribution parameters */
   void GenerateData();
 
+  /** Computes the weighted mean and covariance of the sample, into
+   * m_MeanEstimate and m_CovarianceEstimate. */
+  void ComputeMeanAndCovariance(const WeightArrayType & weights);
+
+  /** The sufficient statistics of each chunk of the sample */
+  struct ThreadStruct {
+    Self *Component;
+    const WeightArrayType *Weights;
+    ThreadIdType NumberOfChunks;
+    bool ComputeCovariance;
+    MeasurementVectorRealType Mean;
+    std::vector< double > TotalWeights;
+    std::vector< double > SumSquaredWeights;
+    std::vector< Array< typename NumericTraits< MeasurementRealType >::AccumulateType > > Sums;
+    std::vector< MatrixType > Covariances;
+  };
+
+  /** Adds the measurements of a chunk of the sample to its sufficient
+   * statistics: the weights and the weighted measurements on the first
+   * pass, the weighted products of the deviations from the mean on the
+   * second one. */
+  void ThreadedComputeSums(ThreadIdType chunk, ThreadStruct & str);
+
 private:
+  /** Static function used as a "callback" by the MultiThreader. */
+  static ITK_THREAD_RETURN_TYPE ComputeSumsThreaderCallback(void *arg);
+
   typename NativeMembershipFunctionType::Pointer m_GaussianMembershipFunction;
 
   typename MeanEstimatorType::MeasurementVectorType m_Mean;
 
-  typename CovarianceEstimatorType::MatrixType m_Covariance;
+  MatrixType m_Covariance;
+
+  MeasurementVectorRealType m_MeanEstimate;
 
-  typename MeanEstimatorType::Pointer m_MeanEstimator;
+  MatrixType m_CovarianceEstimate;
 
-  typename CovarianceEstimatorType::Pointer m_CovarianceEstimator;
+  MultiThreader::Pointer m_Threader;
 };  // end of class
 } // end of namespace Statistics
 } // end of namespace itk
@@ -30,8 +30,7 @@ template< class TSample >
 GaussianMixtureModelComponent< TSample >
 ::GaussianMixtureModelComponent()
 {
-  m_MeanEstimator = MeanEstimatorType::New();
-  m_CovarianceEstimator = CovarianceEstimatorType::New();
+  m_Threader = MultiThreader::New();
   m_GaussianMembershipFunction = NativeMembershipFunctionType::New();
   this->SetMembershipFunction( (MembershipFunctionType *)
                                m_GaussianMembershipFunction.GetPointer() );
@@ -48,8 +47,8 @@ GaussianMixtureModelComponent< TSample >
 
   os << indent << "Mean: " << m_Mean << std::endl;
   os << indent << "Covariance: " << m_Covariance << std::endl;
-  os << indent << "Mean Estimator: " << m_MeanEstimator << std::endl;
-  os << indent << "Covariance Estimator: " << m_CovarianceEstimator << std::endl;
+  os << indent << "Mean Estimate: " << m_MeanEstimate << std::endl;
+  os << indent << "Covariance Estimate: " << m_CovarianceEstimate << std::endl;
   os << indent << "GaussianMembershipFunction: " << m_GaussianMembershipFunction << std::endl;
 }
 
@@ -60,9 +59,6 @@ GaussianMixtureModelComponent< TSample >
 {
   Superclass::SetSample(sample);
 
-  m_MeanEstimator->SetInput(sample);
-  m_CovarianceEstimator->SetInput(sample);
-
   const MeasurementVectorSizeType measurementVectorLength =
     sample->GetMeasurementVectorSize();
   m_GaussianMembershipFunction->SetMeasurementVectorSize(measurementVectorLength);
@@ -70,6 +66,9 @@ GaussianMixtureModelComponent< TSample >
   NumericTraits<MeasurementVectorType>::SetLength(m_Mean, measurementVectorLength);
   m_Covariance.SetSize(measurementVectorLength, measurementVectorLength);
 
+  NumericTraits<MeasurementVectorRealType>::SetLength(m_MeanEstimate, measurementVectorLength);
+  m_CovarianceEstimate.SetSize(measurementVectorLength, measurementVectorLength);
+
   m_Mean.Fill(NumericTraits< double >::Zero);
 
   m_Covariance.Fill(NumericTraits< double >::Zero);
@@ -150,11 +149,8 @@ GaussianMixtureModelComponent< TSample >
 {
   unsigned int i, j;
 
-  typename MeanVectorType::MeasurementVectorType meanEstimate =
-    m_MeanEstimator->GetMean();
-
-  CovarianceMatrixType covEstimateDecoratedObject = m_CovarianceEstimator->GetOutput();
-  typename CovarianceMatrixType::MeasurementVectorType covEstimate =  covEstimateDecoratedObject->et();
+  const MeasurementVectorRealType & meanEstimate = m_MeanEstimate;
+  const MatrixType &                covEstimate = m_CovarianceEstimate;
 
   double                    temp;
   double                    changes = 0.0;
@@ -193,20 +189,7 @@ GaussianMixtureModelComponent< TSample >
 
   const WeightArrayType & weights = this->GetWeights();
 
-  typename TSample::ConstIterator iter = this->GetSample()->Begin();
-  typename TSample::ConstIterator end =  this->GetSample()->End();
-
-  typename TSample::MeasurementVectorType measurements;
-
-  // why these lines???
-  while ( iter != end )
-    {
-    measurements = iter.GetMeasurementVector();
-    ++iter;
-    }
-
-  m_MeanEstimator->SetWeights(weights);
-  m_MeanEstimator->Update();
+  this->ComputeMeanAndCovariance(weights);
 
   MeasurementVectorSizeType   i, j;
   double         temp;
@@ -215,7 +198,7 @@ GaussianMixtureModelComponent< TSample >
   ParametersType parameters = this->GetFullParameters();
   MeasurementVectorSizeType            paramIndex  = 0;
 
-  typename MeanEstimatorType::MeasurementVectorType meanEstimate = m_MeanEstimator->GetMean();
+  typename MeanEstimatorType::MeasurementVectorType meanEstimate = m_MeanEstimate;
   for ( i = 0; i < measurementVectorSize; i++ )
     {
     changes = vnl_math_abs( m_Mean[i] - meanEstimate[i] );
@@ -241,10 +224,7 @@ GaussianMixtureModelComponent< TSample >
     paramIndex = measurementVectorSize;
     }
 
-  m_CovarianceEstimator->SetWeights(weights);
-  m_CovarianceEstimator->Update();
-  typename CovarianceEstimatorType::MatrixType covEstimate =
-    m_CovarianceEstimator->GetCovarianceMatrix();
+  const MatrixType & covEstimate = m_CovarianceEstimate;
 
   changed = false;
   for ( i = 0; i < measurementVectorSize; i++ )
@@ -309,6 +289,209 @@ GaussianMixtureModelComponent< TSample >
 
   Superclass::SetParameters(parameters);
 }
+
+template< class TSample >
+void
+GaussianMixtureModelComponent< TSample >
+::ComputeMeanAndCovariance(const WeightArrayType & weights)
+{
+  typedef typename NumericTraits< MeasurementRealType >::AccumulateType MeasurementRealAccumulateType;
+
+  const MeasurementVectorSizeType measurementVectorSize =
+    this->GetSample()->GetMeasurementVectorSize();
+
+  ThreadStruct str;
+  str.Component = this;
+  str.Weights = &weights;
+  str.NumberOfChunks = this->GetNumberOfThreads();
+  str.ComputeCovariance = false;
+  str.TotalWeights.assign(str.NumberOfChunks, 0.0);
+  str.SumSquaredWeights.assign(str.NumberOfChunks, 0.0);
+  str.Sums.resize(str.NumberOfChunks);
+  str.Covariances.resize(str.NumberOfChunks);
+  for ( ThreadIdType chunk = 0; chunk < str.NumberOfChunks; chunk++ )
+    {
+    str.Sums[chunk].SetSize(measurementVectorSize);
+    str.Sums[chunk].Fill(NumericTraits< MeasurementRealAccumulateType >::Zero);
+    str.Covariances[chunk].SetSize(measurementVectorSize, measurementVectorSize);
+    str.Covariances[chunk].Fill(0.0);
+    }
+
+  if ( str.NumberOfChunks > 1 )
+    {
+    m_Threader->SetNumberOfThreads(str.NumberOfChunks);
+    m_Threader->SetSingleMethod(Self::ComputeSumsThreaderCallback, &str);
+    }
+
+  // weighted mean
+  if ( str.NumberOfChunks > 1 )
+    {
+    m_Threader->SingleMethodExecute();
+    }
+  else
+    {
+    this->ThreadedComputeSums(0, str);
+    }
+
+  double                                 totalWeight = 0.0;
+  Array< MeasurementRealAccumulateType > sum(measurementVectorSize);
+  sum.Fill(NumericTraits< MeasurementRealAccumulateType >::Zero);
+  for ( ThreadIdType chunk = 0; chunk < str.NumberOfChunks; chunk++ )
+    {
+    totalWeight += str.TotalWeights[chunk];
+    for ( unsigned int dim = 0; dim < measurementVectorSize; dim++ )
+      {
+      sum[dim] += str.Sums[chunk][dim];
+      }
+    }
+
+  if ( totalWeight > vnl_math::eps )
+    {
+    for ( unsigned int dim = 0; dim < measurementVectorSize; dim++ )
+      {
+      m_MeanEstimate[dim] = static_cast< MeasurementRealType >( sum[dim] / totalWeight );
+      }
+    }
+  else
+    {
+    itkExceptionMacro("Total weight was too close to zero. Value = " << totalWeight);
+    }
+
+  // weighted covariance, around the mean
+  str.ComputeCovariance = true;
+  str.Mean = m_MeanEstimate;
+  str.TotalWeights.assign(str.NumberOfChunks, 0.0);
+  if ( str.NumberOfChunks > 1 )
+    {
+    m_Threader->SingleMethodExecute();
+    }
+  else
+    {
+    this->ThreadedComputeSums(0, str);
+    }
+
+  totalWeight = 0.0;
+  double sumSquaredWeight = 0.0;
+  m_CovarianceEstimate.Fill(0.0);
+  for ( ThreadIdType chunk = 0; chunk < str.NumberOfChunks; chunk++ )
+    {
+    totalWeight += str.TotalWeights[chunk];
+    sumSquaredWeight += str.SumSquaredWeights[chunk];
+    for ( unsigned int row = 0; row < measurementVectorSize; row++ )
+      {
+      for ( unsigned int col = 0; col < row + 1; col++ )
+        {
+        m_CovarianceEstimate(row, col) += str.Covariances[chunk](row, col);
+        }
+      }
+    }
+
+  // fills the upper triangle using the lower triangle
+  for ( unsigned int row = 1; row < measurementVectorSize; row++ )
+    {
+    for ( unsigned int col = 0; col < row; col++ )
+      {
+      m_CovarianceEstimate(col, row) = m_CovarianceEstimate(row, col);
+      }
+    }
+
+  const double normalizationFactor = ( totalWeight - ( sumSquaredWeight / totalWeight ) );
+
+  if ( normalizationFactor > vnl_math::eps )
+    {
+    m_CovarianceEstimate /= normalizationFactor;
+    }
+  else
+    {
+    itkExceptionMacro("Normalization factor was too close to zero. Value = " << normalizationFactor);
+    }
+}
+
+template< class TSample >
+void
+GaussianMixtureModelComponent< TSample >
+::ThreadedComputeSums(ThreadIdType chunk, ThreadStruct & str)
+{
+  typedef typename NumericTraits< MeasurementRealType >::AccumulateType MeasurementRealAccumulateType;
+
+  const TSample *                 sample = this->GetSample();
+  const MeasurementVectorSizeType measurementVectorSize =
+    sample->GetMeasurementVectorSize();
+
+  // the chunk is a range of consecutive measurement vectors, which only
+  // the iterators of the sample reach in order
+  const SizeValueType size = sample->Size();
+  const SizeValueType first = size * chunk / str.NumberOfChunks;
+  const SizeValueType last = size * ( chunk + 1 ) / str.NumberOfChunks;
+
+  typename TSample::ConstIterator iter = sample->Begin();
+  for ( SizeValueType measurementVectorIndex = 0; measurementVectorIndex < first; ++measurementVectorIndex )
+    {
+    ++iter;
+    }
+
+  const WeightArrayType &   weights = *str.Weights;
+  MeasurementVectorRealType diff;
+  NumericTraits<MeasurementVectorRealType>::SetLength(diff, measurementVectorSize);
+
+  double totalWeight = 0.0;
+  double sumSquaredWeight = 0.0;
+  for ( SizeValueType measurementVectorIndex = first; measurementVectorIndex < last;
+        ++measurementVectorIndex, ++iter )
+    {
+    const MeasurementVectorType & measurements = iter.GetMeasurementVector();
+    const double                  weight = iter.GetFrequency() * weights[measurementVectorIndex];
+    totalWeight += weight;
+
+    if ( !str.ComputeCovariance )
+      {
+      for ( unsigned int dim = 0; dim < measurementVectorSize; dim++ )
+        {
+        const MeasurementRealType component = static_cast< MeasurementRealType >( measurements[dim] );
+        str.Sums[chunk][dim] += static_cast< MeasurementRealAccumulateType >( component * weight );
+        }
+      }
+    else
+      {
+      sumSquaredWeight += weight * weight;
+      for ( unsigned int i = 0; i < measurementVectorSize; ++i )
+        {
+        diff[i] = static_cast< MeasurementRealType >( measurements[i] ) - str.Mean[i];
+        }
+
+      // fills the lower triangle and the diagonal cells
+      for ( unsigned int row = 0; row < measurementVectorSize; row++ )
+        {
+        for ( unsigned int col = 0; col < row + 1; col++ )
+          {
+          str.Covariances[chunk](row, col) += weight * diff[row] * diff[col];
+          }
+        }
+      }
+    }
+
+  str.TotalWeights[chunk] = totalWeight;
+  str.SumSquaredWeights[chunk] = sumSquaredWeight;
+}
+
+template< class TSample >
+ITK_THREAD_RETURN_TYPE
+GaussianMixtureModelComponent< TSample >
+::ComputeSumsThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info =
+    static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  ThreadStruct *str = static_cast< ThreadStruct * >( info->UserData );
+
+  // the threader may run fewer threads than chunks
+  for ( ThreadIdType chunk = info->ThreadID; chunk < str->NumberOfChunks;
+        chunk += info->NumberOfThreads )
+    {
+    str->Component->ThreadedComputeSums(chunk, *str);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
 } // end of namespace Statistics
 } // end of namespace itk
 
@@ -62,6 +62,11 @@ struct GetHistogramDimension {
  * for regularly spaced bins to defined.  To define irregularly sized
  * bins, use the SetBinMin()/SetBinMax() methods.
  *
+ * When the bins are regularly spaced, GetIndex() computes the index of a
+ * measurement from its distance to the lower bound, instead of searching
+ * the bins.  Changing the bins with SetBinMin()/SetBinMax() turns this
+ * back to a binary search along the modified dimension.
+ *
  * If you do not know the length of the measurement vector at compile time, you
  * should use the VariableDimensionHistogram class, instead of the Histogram
  * class.
@@ -155,7 +160,8 @@ public:
 
   /** Get the index of histogram corresponding to the specified
    *  measurement value. Returns true if index is valid and false if
-   *  the measurement is outside the histogram */
+   *  the measurement is outside the histogram.  Along the dimensions
+   *  with regularly spaced bins, this takes a constant time. */
   bool GetIndex(const MeasurementVectorType & measurement,
                 IndexType & index) const;
 
@@ -513,6 +519,19 @@ private:
   // upper bound of each bin
   std::vector< std::vector< MeasurementType > > m_Max;
 
+  // Check along each dimension whether the bins are contiguous and
+  // increasing, so that GetIndex() can guess the bin from the lower bound
+  // and the mean bin width.
+  void ComputeUniformBins();
+
+  // true along the dimensions where GetIndex() guesses the bin
+  std::vector< bool > m_UniformBins;
+
+  // lower bound of the first bin, and number of bins per unit of
+  // measurement, along each dimension
+  std::vector< double > m_UniformBinsOrigin;
+  std::vector< double > m_UniformBinsScale;
+
   mutable MeasurementVectorType m_TempMeasurementVector;
   mutable IndexType             m_TempIndex;
 
@@ -100,6 +100,7 @@ Histogram< TMeasurement, TFrequencyContainer >
             MeasurementType min)
 {
   m_Min[dimension][nbin] = min;
+  m_UniformBins[dimension] = false;
 }
 
 template< class TMeasurement, class TFrequencyContainer >
@@ -109,6 +110,7 @@ Histogram< TMeasurement, TFrequencyContainer >
             MeasurementType max)
 {
   m_Max[dimension][nbin] = max;
+  m_UniformBins[dimension] = false;
 }
 
 template< class TMeasurement, class TFrequencyContainer >
@@ -215,6 +217,11 @@ Histogram< TMeasurement, TFrequencyContainer >
     m_Max[dim].resize(m_Size[dim]);
     }
 
+  // the bins are not set yet
+  m_UniformBins.assign(this->GetMeasurementVectorSize(), false);
+  m_UniformBinsOrigin.assign(this->GetMeasurementVectorSize(), 0.0);
+  m_UniformBinsScale.assign(this->GetMeasurementVectorSize(), 0.0);
+
   // initialize auxiliary variables
   this->m_TempIndex.SetSize( this->GetMeasurementVectorSize() );
   this->m_TempMeasurementVector.SetSize( this->GetMeasurementVectorSize() );
@@ -263,6 +270,39 @@ Histogram< TMeasurement, TFrequencyContainer >
                        (MeasurementType)( upperBound[i] ) );
       }
     }
+
+  this->ComputeUniformBins();
+}
+
+template< class TMeasurement, class TFrequencyContainer >
+void
+Histogram< TMeasurement, TFrequencyContainer >
+::ComputeUniformBins()
+{
+  for ( unsigned int dim = 0; dim < this->GetMeasurementVectorSize(); dim++ )
+    {
+    const std::vector< MeasurementType > & mins = m_Min[dim];
+    const std::vector< MeasurementType > & maxs = m_Max[dim];
+    const SizeValueType                    size = m_Size[dim];
+
+    // The guess is only corrected by walking to the neighbor bins, which
+    // finds the bin of the binary search when each bin starts where the
+    // previous one ends and no bin is empty.  Integer measurements with
+    // more bins than values, in particular, have empty bins.
+    bool uniform = ( size > 0 );
+    for ( SizeValueType j = 0; uniform && j < size; j++ )
+      {
+      uniform = ( mins[j] < maxs[j] ) && ( j == 0 || mins[j] == maxs[j - 1] );
+      }
+
+    m_UniformBins[dim] = uniform;
+    if ( uniform )
+      {
+      m_UniformBinsOrigin[dim] = static_cast< double >( mins[0] );
+      m_UniformBinsScale[dim] = static_cast< double >( size )
+                                / ( static_cast< double >( maxs[size - 1] ) - static_cast< double >( mins[0] ) );
+      }
+    }
 }
 
 template< class TMeasurement, class TFrequencyContainer >
@@ -333,6 +373,35 @@ bool Histogram< TMeasurement, TFrequencyContainer >
         }
       }
 
+    // With regularly spaced bins, guess the bin from the distance to the
+    // lower bound, and correct the rounding errors of the bin bounds by
+    // looking at the neighbor bins.  The measurement is in
+    // [m_Min[dim][0], m_Max[dim][end]), so the walk stops in the range.
+    // A NaN, which is in no bin, is left to the binary search.
+    if ( m_UniformBins[dim] && tempMeasurement == tempMeasurement )
+      {
+      mid = static_cast< int >( ( static_cast< double >( tempMeasurement ) - m_UniformBinsOrigin[dim] )
+                                * m_UniformBinsScale[dim] );
+      if ( mid > end )
+        {
+        mid = end;
+        }
+      else if ( mid < 0 )
+        {
+        mid = 0;
+        }
+      while ( tempMeasurement < m_Min[dim][mid] )
+        {
+        --mid;
+        }
+      while ( tempMeasurement >= m_Max[dim][mid] )
+        {
+        ++mid;
+        }
+      index[dim] = mid;
+      continue;
+      }
+
     // Binary search for the bin where this measurement could be
     mid = ( end + 1 ) / 2;
     median = m_Min[dim][mid];
@@ -577,10 +646,14 @@ inline bool
 Histogram< TMeasurement, TFrequencyContainer >
 ::IncreaseFrequencyOfMeasurement(const MeasurementVectorType & measurement, const AbsoluteFrequencyType value)
 {
-  IndexType index;
-
-  this->GetIndex(measurement, index);
-  return this->IncreaseFrequency(this->GetInstanceIdentifier(index), value);
+  // Reuse the temporary index, which saves an allocation per measurement.
+  // A measurement outside the histogram has an index that may alias a
+  // valid bin in more than one dimension.
+  if ( !this->GetIndex(measurement, m_TempIndex) )
+    {
+    return false;
+    }
+  return this->IncreaseFrequency(this->GetInstanceIdentifier(m_TempIndex), value);
 }
 
 template< class TMeasurement, class TFrequencyContainer >
@@ -742,6 +815,12 @@ Histogram< TMeasurement, TFrequencyContainer >
   os << std::endl;
   os << indent << "ClipBinsAtEnds: "
      << itk::NumericTraits< bool >::PrintType( this->GetClipBinsAtEnds() ) << std::endl;
+  os << indent << "UniformBins: ";
+  for ( unsigned int i = 0; i < m_UniformBins.size(); i++ )
+    {
+    os << m_UniformBins[i] << "  ";
+    }
+  os << std::endl;
   os << indent << "OffsetTable: ";
   for ( unsigned int i = 0; i < this->m_OffsetTable.size(); i++ )
     {
@@ -769,6 +848,9 @@ Histogram< TMeasurement, TFrequencyContainer >
     this->m_NumberOfInstances     = that->m_NumberOfInstances;
     this->m_Min                   = that->m_Min;
     this->m_Max                   = that->m_Max;
+    this->m_UniformBins           = that->m_UniformBins;
+    this->m_UniformBinsOrigin     = that->m_UniformBinsOrigin;
+    this->m_UniformBinsScale      = that->m_UniformBinsScale;
     this->m_TempMeasurementVector = that->m_TempMeasurementVector;
     this->m_TempIndex             = that->m_TempIndex;
     this->m_ClipBinsAtEnds        = that->m_ClipBinsAtEnds;
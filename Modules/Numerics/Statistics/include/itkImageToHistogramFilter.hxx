@@ -234,18 +234,18 @@ void
 ImageToHistogramFilter< TImage >
 ::AfterThreadedGenerateData()
 {
-  // group the results in the output histogram
+  // group the results in the output histogram.  All the histograms have
+  // the same bins, so the bins are matched by instance identifier.
   HistogramType * hist = m_Histograms[0];
   for( unsigned int i=1; i<m_Histograms.size(); i++ )
     {
     typedef typename HistogramType::ConstIterator         HistogramIterator;
-    typedef typename HistogramType::AbsoluteFrequencyType AbsoluteFrequencyType;
 
     HistogramIterator hit = m_Histograms[i]->Begin();
     HistogramIterator end = m_Histograms[i]->End();
     while ( hit != end )
       {
-      hist->IncreaseFrequencyOfMeasurement( hit.GetMeasurementVector(), hit.GetFrequency() );
+      hist->IncreaseFrequency( hit.GetInstanceIdentifier(), hit.GetFrequency() );
       ++hit;
       }
     }
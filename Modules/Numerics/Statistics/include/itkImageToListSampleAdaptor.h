@@ -111,6 +111,12 @@ public:
   /** method to return measurement vector for a specified id */
   virtual const MeasurementVectorType & GetMeasurementVector(InstanceIdentifier id) const;
 
+  /** Get the pixel buffer of the image, which holds the measurement
+   * vectors without copying them when the pixels have a fixed number of
+   * components of the measurement type. Returns a null pointer
+   * otherwise, as for a VectorImage. */
+  virtual const MeasurementType * GetMeasurementBuffer() const;
+
   virtual MeasurementVectorSizeType GetMeasurementVectorSize() const
   {
     // some filter are expected that this method returns something even if the
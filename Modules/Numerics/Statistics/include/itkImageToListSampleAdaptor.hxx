@@ -46,6 +46,27 @@ ImageToListSampleAdaptor< TImage >
   return m_MeasurementVectorInternal;
 }
 
+template< class TImage >
+const typename ImageToListSampleAdaptor< TImage >::MeasurementType *
+ImageToListSampleAdaptor< TImage >
+::GetMeasurementBuffer() const
+{
+  if ( m_Image.IsNull() )
+    {
+    itkExceptionMacro("Image has not been set yet");
+    }
+
+  // The pixel of instance id is at offset id in the pixel buffer
+  MeasurementVectorType m;
+  if ( MeasurementVectorTraits::IsResizable(m)
+       || sizeof( PixelType ) !=
+          this->GetMeasurementVectorSize() * sizeof( MeasurementType ) )
+    {
+    return 0;
+    }
+  return reinterpret_cast< const MeasurementType * >( m_Image->GetBufferPointer() );
+}
+
 /** returns the number of measurement vectors in this container*/
 template< class TImage >
 typename ImageToListSampleAdaptor< TImage >::InstanceIdentifier
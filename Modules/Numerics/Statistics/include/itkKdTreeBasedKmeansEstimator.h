@@ -26,6 +26,7 @@
 #include "itkDistanceToCentroidMembershipFunction.h"
 #include "itkSimpleDataObjectDecorator.h"
 #include "itkNumericTraitsArrayPixel.h"
+#include "itkMultiThreader.h"
 
 namespace itk
 {
@@ -54,6 +55,17 @@ namespace Statistics
  * WeightedCentroidKdTreeGenerator. It will save the tree construction
  * time and memory usage.
  *
+ * The filtering of each iteration can be run on several threads
+ * (SetNumberOfThreads). The top of the tree is filtered first, then the
+ * subtrees a few levels below the root are shared among the threads, each
+ * one adding the measurement vectors of its subtrees to its own copy of the
+ * candidates. The sums of the subtrees are added in the order of the
+ * subtrees, so the means only depend on the number of threads by rounding.
+ * The default is one thread, because the samples that return their
+ * measurement vectors through an internal buffer, such as the image
+ * adaptors, cannot be read by several threads at the same time. The
+ * cluster labels are always computed on one thread.
+ *
  * Note: There is a second implementation of k-means algorithm in ITK under the
  * While the Kd tree based implementation is more time efficient, the  GLA/LBG
  * based algorithm is more memory efficient.
@@ -156,6 +168,10 @@ public:
 
   itkSetMacro(UseClusterLabels, bool);
   itkGetConstMacro(UseClusterLabels, bool);
+
+  /** Set/Get the number of threads used to filter the tree. */
+  itkSetClampMacro(NumberOfThreads, ThreadIdType, 1, ITK_MAX_THREADS);
+  itkGetConstMacro(NumberOfThreads, ThreadIdType);
 protected:
   KdTreeBasedKmeansEstimator();
   virtual ~KdTreeBasedKmeansEstimator() {}
@@ -171,7 +187,7 @@ protected:
   class CandidateVector
   {
 public:
-    CandidateVector() {}
+    CandidateVector() : m_MeasurementVectorSize(0) {}
 
     struct Candidate {
       CentroidType Centroid;
@@ -251,6 +267,18 @@ private:
     MeasurementVectorSizeType m_MeasurementVectorSize;
   };  // end of class
 
+  /** A subtree to filter on a thread: its root, the surviving candidates
+   * and the cell of the root, the candidates to which its measurement
+   * vectors are added, and the vertex used by IsFarther. */
+  struct FilterTask {
+    KdTreeNodeType *Node;
+    std::vector< int > ValidIndexes;
+    MeasurementVectorType LowerBound;
+    MeasurementVectorType UpperBound;
+    CandidateVector Candidates;
+    ParameterType Vertex;
+  };
+
   /** gets the sum of squared difference between the previous position
    * and current postion of all centroid. This is the primary termination
    * condition for this algorithm. If the return value is less than
@@ -270,6 +298,14 @@ private:
                  MeasurementVectorType & lowerBound,
                  MeasurementVectorType & upperBound);
 
+  /** returns true if the pointA is farther than pointB to the boundary,
+   * computing the vertex of the cell in vertex */
+  bool IsFarther(ParameterType & pointA,
+                 ParameterType & pointB,
+                 MeasurementVectorType & lowerBound,
+                 MeasurementVectorType & upperBound,
+                 ParameterType & vertex) const;
+
   /** recursive pruning algorithm. the validIndexes vector contains
    * only the indexes of the surviving candidates for the node */
   void Filter(KdTreeNodeType *node,
@@ -277,6 +313,26 @@ private:
               MeasurementVectorType & lowerBound,
               MeasurementVectorType & upperBound);
 
+  /** recursive pruning algorithm, which adds the measurement vectors to
+   * candidates and uses vertex for IsFarther. When tasks is not null,
+   * the subtrees depth levels below node are not filtered but appended
+   * to tasks. */
+  void Filter(KdTreeNodeType *node,
+              std::vector< int > validIndexes,
+              MeasurementVectorType & lowerBound,
+              MeasurementVectorType & upperBound,
+              CandidateVector & candidates,
+              ParameterType & vertex,
+              std::vector< FilterTask > *tasks,
+              unsigned int depth);
+
+  /** Filter on several threads, then adds the candidates of the subtrees
+   * to m_CandidateVector */
+  void ThreadedFilter(KdTreeNodeType *node,
+                      std::vector< int > & validIndexes,
+                      MeasurementVectorType & lowerBound,
+                      MeasurementVectorType & upperBound);
+
   /** copies the source parameters (k-means) to the target */
   void CopyParameters(InternalParametersType & source, InternalParametersType & target);
 
@@ -292,6 +348,15 @@ private:
   void PrintPoint(ParameterType & point);
 
 private:
+  /** Data shared by the threads */
+  struct FilterThreadStruct {
+    Self *Estimator;
+    std::vector< FilterTask > Tasks;
+  };
+
+  /** Static function used as a "callback" by the MultiThreader. */
+  static ITK_THREAD_RETURN_TYPE FilterThreaderCallback(void *arg);
+
   /** current number of iteration */
   int m_CurrentIteration;
   /** maximum number of iteration. termination criterion */
@@ -318,6 +383,8 @@ private:
   ClusterLabelsType                     m_ClusterLabels;
   MeasurementVectorSizeType             m_MeasurementVectorSize;
   MembershipFunctionVectorObjectPointer m_MembershipFunctionsObject;
+  ThreadIdType                          m_NumberOfThreads;
+  MultiThreader::Pointer                m_Threader;
 };  // end of class
 } // end of namespace Statistics
 } // end of namespace itk
@@ -41,6 +41,8 @@ KdTreeBasedKmeansEstimator< TKdTree >
   m_TempVertex.Fill(0.0);
   m_CurrentIteration = 0;
   m_MeasurementVectorSize = 0;
+  m_NumberOfThreads = 1;
+  m_Threader = MultiThreader::New();
 }
 
 template< class TKdTree >
@@ -73,6 +75,7 @@ KdTreeBasedKmeansEstimator< TKdTree >
   os << indent << "Parameters: " << this->GetParameters() << std::endl;
   os << indent << "MeasurementVectorSize: " << this->GetMeasurementVectorSize() << std::endl;
   os << indent << "UseClusterLabels: " << this->GetUseClusterLabels() << std::endl;
+  os << indent << "NumberOfThreads: " << m_NumberOfThreads << std::endl;
 }
 
 template< class TKdTree >
@@ -126,6 +129,18 @@ KdTreeBasedKmeansEstimator< TKdTree >
             ParameterType & pointB,
             MeasurementVectorType & lowerBound,
             MeasurementVectorType & upperBound)
+{
+  return this->IsFarther(pointA, pointB, lowerBound, upperBound, m_TempVertex);
+}
+
+template< class TKdTree >
+inline bool
+KdTreeBasedKmeansEstimator< TKdTree >
+::IsFarther(ParameterType & pointA,
+            ParameterType & pointB,
+            MeasurementVectorType & lowerBound,
+            MeasurementVectorType & upperBound,
+            ParameterType & vertex) const
 {
   // calculates the vertex of the Cell bounded by the lowerBound
   // and the upperBound
@@ -133,16 +148,16 @@ KdTreeBasedKmeansEstimator< TKdTree >
     {
     if ( ( pointA[i] - pointB[i] ) < 0.0 )
       {
-      m_TempVertex[i] = lowerBound[i];
+      vertex[i] = lowerBound[i];
       }
     else
       {
-      m_TempVertex[i] = upperBound[i];
+      vertex[i] = upperBound[i];
       }
     }
 
-  if ( m_DistanceMetric->Evaluate(pointA, m_TempVertex) >=
-       m_DistanceMetric->Evaluate(pointB, m_TempVertex) )
+  if ( m_DistanceMetric->Evaluate(pointA, vertex) >=
+       m_DistanceMetric->Evaluate(pointB, vertex) )
     {
     return true;
     }
@@ -157,9 +172,37 @@ KdTreeBasedKmeansEstimator< TKdTree >
          std::vector< int > validIndexes,
          MeasurementVectorType & lowerBound,
          MeasurementVectorType & upperBound)
+{
+  this->Filter(node, validIndexes, lowerBound, upperBound,
+               m_CandidateVector, m_TempVertex, 0, 0);
+}
+
+template< class TKdTree >
+void
+KdTreeBasedKmeansEstimator< TKdTree >
+::Filter(KdTreeNodeType *node,
+         std::vector< int > validIndexes,
+         MeasurementVectorType & lowerBound,
+         MeasurementVectorType & upperBound,
+         CandidateVector & candidates,
+         ParameterType & vertex,
+         std::vector< FilterTask > *tasks,
+         unsigned int depth)
 {
   unsigned int i, j;
 
+  if ( tasks != 0 && depth == 0 )
+    {
+    // leave the subtree to a thread
+    FilterTask task;
+    task.Node = node;
+    task.ValidIndexes = validIndexes;
+    task.LowerBound = lowerBound;
+    task.UpperBound = upperBound;
+    tasks->push_back(task);
+    return;
+    }
+
   typename TKdTree::InstanceIdentifier tempId;
   int           closest;
   ParameterType individualPoint;
@@ -184,10 +227,10 @@ KdTreeBasedKmeansEstimator< TKdTree >
         this->GetClosestCandidate(individualPoint, validIndexes);
       for ( j = 0; j < m_MeasurementVectorSize; j++ )
         {
-        m_CandidateVector[closest].WeightedCentroid[j] +=
+        candidates[closest].WeightedCentroid[j] +=
           individualPoint[j];
         }
-      m_CandidateVector[closest].Size += 1;
+      candidates[closest].Size += 1;
       if ( m_GenerateClusterLabels )
         {
         m_ClusterLabels[tempId] = closest;
@@ -212,7 +255,7 @@ KdTreeBasedKmeansEstimator< TKdTree >
       if ( *iter != closest
            && this->IsFarther(m_CandidateVector[*iter].Centroid,
                               closestPosition,
-                              lowerBound, upperBound) )
+                              lowerBound, upperBound, vertex) )
         {
         iter = validIndexes.erase(iter);
         continue;
@@ -228,10 +271,10 @@ KdTreeBasedKmeansEstimator< TKdTree >
       {
       for ( j = 0; j < m_MeasurementVectorSize; j++ )
         {
-        m_CandidateVector[closest].WeightedCentroid[j] +=
+        candidates[closest].WeightedCentroid[j] +=
           weightedCentroid[j];
         }
-      m_CandidateVector[closest].Size += node->Size();
+      candidates[closest].Size += node->Size();
       if ( m_GenerateClusterLabels )
         {
         this->FillClusterLabels(node, closest);
@@ -243,22 +286,98 @@ KdTreeBasedKmeansEstimator< TKdTree >
       MeasurementType partitionValue;
       MeasurementType tempValue;
       node->GetParameters(partitionDimension, partitionValue);
+      const unsigned int childDepth = ( depth > 0 ) ? depth - 1 : 0;
 
       tempValue = upperBound[partitionDimension];
       upperBound[partitionDimension] = partitionValue;
       this->Filter(node->Left(), validIndexes,
-                   lowerBound, upperBound);
+                   lowerBound, upperBound,
+                   candidates, vertex, tasks, childDepth);
       upperBound[partitionDimension] = tempValue;
 
       tempValue = lowerBound[partitionDimension];
       lowerBound[partitionDimension] = partitionValue;
       this->Filter(node->Right(), validIndexes,
-                   lowerBound, upperBound);
+                   lowerBound, upperBound,
+                   candidates, vertex, tasks, childDepth);
       lowerBound[partitionDimension] = tempValue;
       }
     }
 }
 
+template< class TKdTree >
+void
+KdTreeBasedKmeansEstimator< TKdTree >
+::ThreadedFilter(KdTreeNodeType *node,
+                 std::vector< int > & validIndexes,
+                 MeasurementVectorType & lowerBound,
+                 MeasurementVectorType & upperBound)
+{
+  // filter the top of the tree, down to a depth that leaves a few
+  // subtrees to each thread, since the pruning makes them uneven
+  unsigned int depth = 0;
+  while ( ( 1u << depth ) < 4 * m_NumberOfThreads )
+    {
+    ++depth;
+    }
+
+  FilterThreadStruct str;
+  str.Estimator = this;
+  this->Filter(node, validIndexes, lowerBound, upperBound,
+               m_CandidateVector, m_TempVertex, &str.Tasks, depth);
+  if ( str.Tasks.empty() )
+    {
+    return;
+    }
+
+  InternalParametersType centroids;
+  m_CandidateVector.GetCentroids(centroids);
+  for ( unsigned int t = 0; t < str.Tasks.size(); t++ )
+    {
+    str.Tasks[t].Candidates.SetCentroids(centroids);
+    NumericTraits<ParameterType>::SetLength(str.Tasks[t].Vertex, m_MeasurementVectorSize);
+    }
+
+  m_Threader->SetNumberOfThreads(m_NumberOfThreads);
+  m_Threader->SetSingleMethod(Self::FilterThreaderCallback, &str);
+  m_Threader->SingleMethodExecute();
+
+  // add the sums of the subtrees in their order
+  for ( unsigned int t = 0; t < str.Tasks.size(); t++ )
+    {
+    CandidateVector & candidates = str.Tasks[t].Candidates;
+    for ( int i = 0; i < m_CandidateVector.Size(); i++ )
+      {
+      for ( unsigned int j = 0; j < m_MeasurementVectorSize; j++ )
+        {
+        m_CandidateVector[i].WeightedCentroid[j] +=
+          candidates[i].WeightedCentroid[j];
+        }
+      m_CandidateVector[i].Size += candidates[i].Size;
+      }
+    }
+}
+
+template< class TKdTree >
+ITK_THREAD_RETURN_TYPE
+KdTreeBasedKmeansEstimator< TKdTree >
+::FilterThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info =
+    static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  FilterThreadStruct *str = static_cast< FilterThreadStruct * >( info->UserData );
+
+  for ( unsigned int t = info->ThreadID; t < str->Tasks.size(); t += info->NumberOfThreads )
+    {
+    FilterTask & task = str->Tasks[t];
+    str->Estimator->Filter(task.Node, task.ValidIndexes,
+                           task.LowerBound, task.UpperBound,
+                           task.Candidates, task.Vertex, 0, 0);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
 template< class TKdTree >
 void
 KdTreeBasedKmeansEstimator< TKdTree >
@@ -387,8 +506,16 @@ KdTreeBasedKmeansEstimator< TKdTree >
     {
     this->CopyParameters(currentPosition, previousPosition);
     m_CandidateVector.SetCentroids(currentPosition);
-    this->Filter(m_KdTree->GetRoot(), validIndexes,
-                 lowerBound, upperBound);
+    if ( m_NumberOfThreads > 1 )
+      {
+      this->ThreadedFilter(m_KdTree->GetRoot(), validIndexes,
+                           lowerBound, upperBound);
+      }
+    else
+      {
+      this->Filter(m_KdTree->GetRoot(), validIndexes,
+                   lowerBound, upperBound);
+      }
     m_CandidateVector.UpdateCentroids();
     m_CandidateVector.GetCentroids(currentPosition);
 
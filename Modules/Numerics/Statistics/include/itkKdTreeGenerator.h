@@ -22,6 +22,7 @@
 
 #include "itkKdTree.h"
 #include "itkStatisticsAlgorithm.h"
+#include "itkMultiThreader.h"
 
 namespace itk
 {
@@ -50,6 +51,14 @@ namespace Statistics
  * (SetBucketSize method) and the input sample (SetSample method). The
  * Update method will run this generator. To get the resulting KdTree
  * object, call the GetOutput method.
+ *
+ * The subtrees of the nodes that hold a large part of the sample can be
+ * generated on several threads (SetNumberOfThreads): both sides of such a
+ * node are generated at the same time, on disjoint ranges of the internal
+ * Subsample, so that the tree does not depend on the number of threads.
+ * The default is one thread, because the samples that return their
+ * measurement vectors through an internal buffer, such as the image
+ * adaptors, cannot be read by several threads at the same time.
 
  * <b>Recent API changes:</b>
  * The static const macro to get the length of a measurement vector,
@@ -128,6 +137,10 @@ public:
   /** Get macro to get the length of the measurement vectors that are being
    * held in the 'sample' that is passed to this class */
   itkGetConstMacro(MeasurementVectorSize, unsigned int);
+
+  /** Set/Get the number of threads used to generate the tree. */
+  itkSetClampMacro(NumberOfThreads, ThreadIdType, 1, ITK_MAX_THREADS);
+  itkGetConstMacro(NumberOfThreads, ThreadIdType);
 protected:
   /** Constructor */
   KdTreeGenerator();
@@ -158,10 +171,38 @@ protected:
                                     MeasurementVectorType & upperBound,
                                     unsigned int level);
 
+  /** Generates the subtrees on both sides of the median of a nonterminal
+   * node, which partitionValue splits along partitionDimension. They are
+   * generated on two threads when the node holds more than its share of
+   * the sample. */
+  void GenerateSubtrees(unsigned int beginIndex, unsigned int medianIndex,
+                        unsigned int endIndex,
+                        MeasurementVectorType & lowerBound,
+                        MeasurementVectorType & upperBound,
+                        unsigned int partitionDimension,
+                        MeasurementType partitionValue,
+                        unsigned int level,
+                        KdTreeNodeType * & left,
+                        KdTreeNodeType * & right);
+
 private:
   KdTreeGenerator(const Self &); //purposely not implemented
   void operator=(const Self &);  //purposely not implemented
 
+  /** The subtrees generated by each thread */
+  struct SubtreeThreadStruct {
+    Self *Generator;
+    unsigned int BeginIndex[2];
+    unsigned int EndIndex[2];
+    MeasurementVectorType LowerBound[2];
+    MeasurementVectorType UpperBound[2];
+    unsigned int Level;
+    KdTreeNodeType *Node[2];
+  };
+
+  /** Static function used as a "callback" by the MultiThreader. */
+  static ITK_THREAD_RETURN_TYPE GenerateSubtreeThreaderCallback(void *arg);
+
   /** Pointer to the input (source) sample */
   TSample *m_SourceSample;
 
@@ -177,17 +218,10 @@ private:
   /** Pointer to the resulting k-d tree. */
   OutputPointer m_Tree;
 
-  /** Temporary lower bound for the TreeGenerationLoop */
-  MeasurementVectorType m_TempLowerBound;
-
-  /** Temporary upper bound for the TreeGenerationLoop */
-  MeasurementVectorType m_TempUpperBound;
-
-  /** Temporary mean for the TreeGenerationLoop */
-  MeasurementVectorType m_TempMean;
-
   /** Length of a measurement vector */
   MeasurementVectorSizeType m_MeasurementVectorSize;
+
+  ThreadIdType m_NumberOfThreads;
 };  // end of class
 } // end of namespace Statistics
 } // end of namespace itk
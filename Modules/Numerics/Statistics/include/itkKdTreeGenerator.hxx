@@ -32,6 +32,7 @@ KdTreeGenerator< TSample >
   m_BucketSize = 16;
   m_Subsample = SubsampleType::New();
   m_MeasurementVectorSize = 0;
+  m_NumberOfThreads = 1;
 }
 
 template< class TSample >
@@ -54,6 +55,7 @@ KdTreeGenerator< TSample >
   os << indent << "Bucket Size: " << m_BucketSize << std::endl;
   os << indent << "MeasurementVectorSize: "
      << m_MeasurementVectorSize << std::endl;
+  os << indent << "NumberOfThreads: " << m_NumberOfThreads << std::endl;
 }
 
 template< class TSample >
@@ -65,9 +67,6 @@ KdTreeGenerator< TSample >
   m_Subsample->SetSample(sample);
   m_Subsample->InitializeWithAllInstances();
   m_MeasurementVectorSize = sample->GetMeasurementVectorSize();
-  NumericTraits<MeasurementVectorType>::SetLength(m_TempLowerBound, m_MeasurementVectorSize);
-  NumericTraits<MeasurementVectorType>::SetLength(m_TempUpperBound, m_MeasurementVectorSize);
-  NumericTraits<MeasurementVectorType>::SetLength(m_TempMean, m_MeasurementVectorSize);
 }
 
 template< class TSample >
@@ -130,8 +129,6 @@ KdTreeGenerator< TSample >
                           unsigned int level)
 {
   typedef typename KdTreeType::KdTreeNodeType NodeType;
-  MeasurementType dimensionLowerBound;
-  MeasurementType dimensionUpperBound;
   MeasurementType partitionValue;
   unsigned int    partitionDimension = 0;
   unsigned int    i;
@@ -142,15 +139,21 @@ KdTreeGenerator< TSample >
   SubsamplePointer subsample = this->GetSubsample();
 
   // find most widely spread dimension
+  MeasurementVectorType tempLowerBound;
+  NumericTraits<MeasurementVectorType>::SetLength(tempLowerBound, m_MeasurementVectorSize);
+  MeasurementVectorType tempUpperBound;
+  NumericTraits<MeasurementVectorType>::SetLength(tempUpperBound, m_MeasurementVectorSize);
+  MeasurementVectorType tempMean;
+  NumericTraits<MeasurementVectorType>::SetLength(tempMean, m_MeasurementVectorSize);
   Algorithm::FindSampleBoundAndMean< SubsampleType >(subsample,
                                                      beginIndex, endIndex,
-                                                     m_TempLowerBound, m_TempUpperBound,
-                                                     m_TempMean);
+                                                     tempLowerBound, tempUpperBound,
+                                                     tempMean);
 
   maxSpread = NumericTraits< MeasurementType >::NonpositiveMin();
   for ( i = 0; i < m_MeasurementVectorSize; i++ )
     {
-    spread = m_TempUpperBound[i] - m_TempLowerBound[i];
+    spread = tempUpperBound[i] - tempLowerBound[i];
     if ( spread >= maxSpread )
       {
       maxSpread = spread;
@@ -172,21 +175,10 @@ KdTreeGenerator< TSample >
 
   medianIndex += beginIndex;
 
-  // save bounds for cutting dimension
-  dimensionLowerBound = lowerBound[partitionDimension];
-  dimensionUpperBound = upperBound[partitionDimension];
-
-  upperBound[partitionDimension] = partitionValue;
-  const unsigned int beginLeftIndex = beginIndex;
-  const unsigned int endLeftIndex   = medianIndex;
-  NodeType *         left = GenerateTreeLoop(beginLeftIndex, endLeftIndex, lowerBound, upperBound, level + 1);
-  upperBound[partitionDimension] = dimensionUpperBound;
-
-  lowerBound[partitionDimension] = partitionValue;
-  const unsigned int beginRightIndex = medianIndex + 1;
-  const unsigned int endRightIndex   = endIndex;
-  NodeType *         right = GenerateTreeLoop(beginRightIndex, endRightIndex, lowerBound, upperBound, level + 1);
-  lowerBound[partitionDimension] = dimensionLowerBound;
+  NodeType *left;
+  NodeType *right;
+  this->GenerateSubtrees(beginIndex, medianIndex, endIndex, lowerBound, upperBound,
+                         partitionDimension, partitionValue, level, left, right);
 
   typedef KdTreeNonterminalNode< TSample > KdTreeNonterminalNodeType;
 
@@ -240,6 +232,84 @@ KdTreeGenerator< TSample >
                                          lowerBound, upperBound, level + 1);
     }
 }
+
+template< class TSample >
+void
+KdTreeGenerator< TSample >
+::GenerateSubtrees(unsigned int beginIndex,
+                   unsigned int medianIndex,
+                   unsigned int endIndex,
+                   MeasurementVectorType & lowerBound,
+                   MeasurementVectorType & upperBound,
+                   unsigned int partitionDimension,
+                   MeasurementType partitionValue,
+                   unsigned int level,
+                   KdTreeNodeType * & left,
+                   KdTreeNodeType * & right)
+{
+  if ( m_NumberOfThreads < 2
+       || endIndex - beginIndex <= m_Subsample->Size() / m_NumberOfThreads )
+    {
+    // save bounds for cutting dimension
+    const MeasurementType dimensionLowerBound = lowerBound[partitionDimension];
+    const MeasurementType dimensionUpperBound = upperBound[partitionDimension];
+
+    upperBound[partitionDimension] = partitionValue;
+    left = this->GenerateTreeLoop(beginIndex, medianIndex, lowerBound, upperBound, level + 1);
+    upperBound[partitionDimension] = dimensionUpperBound;
+
+    lowerBound[partitionDimension] = partitionValue;
+    right = this->GenerateTreeLoop(medianIndex + 1, endIndex, lowerBound, upperBound, level + 1);
+    lowerBound[partitionDimension] = dimensionLowerBound;
+    return;
+    }
+
+  // both sides are disjoint ranges of the subsample, each one with its
+  // own copy of the bounds
+  SubtreeThreadStruct str;
+  str.Generator = this;
+  str.BeginIndex[0] = beginIndex;
+  str.EndIndex[0] = medianIndex;
+  str.BeginIndex[1] = medianIndex + 1;
+  str.EndIndex[1] = endIndex;
+  for ( unsigned int side = 0; side < 2; side++ )
+    {
+    str.LowerBound[side] = lowerBound;
+    str.UpperBound[side] = upperBound;
+    str.Node[side] = 0;
+    }
+  str.UpperBound[0][partitionDimension] = partitionValue;
+  str.LowerBound[1][partitionDimension] = partitionValue;
+  str.Level = level + 1;
+
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads(2);
+  threader->SetSingleMethod(Self::GenerateSubtreeThreaderCallback, &str);
+  threader->SingleMethodExecute();
+
+  left = str.Node[0];
+  right = str.Node[1];
+}
+
+template< class TSample >
+ITK_THREAD_RETURN_TYPE
+KdTreeGenerator< TSample >
+::GenerateSubtreeThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info =
+    static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  SubtreeThreadStruct *str = static_cast< SubtreeThreadStruct * >( info->UserData );
+
+  // the threader may run a single thread
+  for ( unsigned int side = info->ThreadID; side < 2; side += info->NumberOfThreads )
+    {
+    str->Node[side] = str->Generator->GenerateTreeLoop(str->BeginIndex[side], str->EndIndex[side],
+                                                       str->LowerBound[side], str->UpperBound[side],
+                                                       str->Level);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
 } // end of namespace Statistics
 } // end of namespace itk
 
@@ -117,6 +117,12 @@ public:
    * the size of the sample. */
   TotalAbsoluteFrequencyType GetTotalFrequency() const;
 
+  /** Get the measurements of all the measurement vectors, which are
+   * contiguous when the measurement vectors have a fixed length (a
+   * FixedArray or a Vector, for instance). Returns a null pointer for
+   * resizable measurement vectors, and for an empty sample. */
+  const MeasurementType * GetMeasurementBuffer() const;
+
   /** Method to graft another sample */
   virtual void Graft(const DataObject *thatObject);
 
@@ -129,6 +129,24 @@ ListSample< TMeasurementVector >
     }
 }
 
+template< class TMeasurementVector >
+const typename ListSample< TMeasurementVector >::MeasurementType *
+ListSample< TMeasurementVector >
+::GetMeasurementBuffer() const
+{
+  // The measurement vectors are stored one after the other, but only
+  // fixed length vectors hold their measurements themselves
+  MeasurementVectorType m;
+  if ( m_InternalContainer.empty()
+       || MeasurementVectorTraits::IsResizable(m)
+       || sizeof( MeasurementVectorType ) !=
+          this->GetMeasurementVectorSize() * sizeof( MeasurementType ) )
+    {
+    return 0;
+    }
+  return reinterpret_cast< const MeasurementType * >( &m_InternalContainer[0] );
+}
+
 template< class TMeasurementVector >
 void
 ListSample< TMeasurementVector >
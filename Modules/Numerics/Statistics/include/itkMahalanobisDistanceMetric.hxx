@@ -157,26 +157,23 @@ double
 MahalanobisDistanceMetric< TVector >
 ::Evaluate(const MeasurementVectorType & measurement) const
 {
-  vnl_matrix< double > tempVec;
-  vnl_matrix< double > tempMat;
+  const MeasurementVectorSizeType measurementVectorSize = this->GetMeasurementVectorSize();
+  const MeanVectorType &          origin = this->GetOrigin();
 
-  tempVec.set_size( 1, this->GetMeasurementVectorSize() );
-  tempMat.set_size( 1, this->GetMeasurementVectorSize() );
-
-  // Compute |y - mean |
-  for ( unsigned int i = 0; i < this->GetMeasurementVectorSize(); i++ )
+  // Compute |y - mean | * inverse(cov) * |y - mean|^T one column of the
+  // inverse covariance at a time, without allocating temporary vectors
+  double temp = 0.0;
+  for ( unsigned int col = 0; col < measurementVectorSize; col++ )
     {
-    tempVec[0][i] = measurement[i] - this->GetOrigin()[i];
+    double product = 0.0;
+    for ( unsigned int row = 0; row < measurementVectorSize; row++ )
+      {
+      product += ( measurement[row] - origin[row] ) * m_InverseCovariance(row, col);
+      }
+    temp += product * ( measurement[col] - origin[col] );
     }
 
-  // Compute |y - mean | * inverse(cov)
-  tempMat = tempVec * m_InverseCovariance;
-
-  // Compute |y - mean | * inverse(cov) * |y - mean|^T
-  double temp;
-  temp = vcl_sqrt( dot_product( tempMat.as_ref(), tempVec.as_ref() ) );
-
-  return temp;
+  return vcl_sqrt(temp);
 }
 
 template< class TVector >
@@ -191,26 +188,22 @@ MahalanobisDistanceMetric< TVector >
                       << " the measurement vector set in the distance metric.");
     }
 
-  vnl_matrix< double > tempVec;
-  vnl_matrix< double > tempMat;
+  const MeasurementVectorSizeType measurementVectorSize = this->GetMeasurementVectorSize();
 
-  tempVec.set_size( 1, this->GetMeasurementVectorSize() );
-  tempMat.set_size( 1, this->GetMeasurementVectorSize() );
-
-  // Compute |x1 - x2 |
-  for ( unsigned int i = 0; i < this->GetMeasurementVectorSize(); i++ )
+  // Compute |x1 - x2 | * inverse(cov) * |x1 - x2|^T one column of the
+  // inverse covariance at a time
+  double temp = 0.0;
+  for ( unsigned int col = 0; col < measurementVectorSize; col++ )
     {
-    tempVec[0][i] = x1[i] - x2[i];
+    double product = 0.0;
+    for ( unsigned int row = 0; row < measurementVectorSize; row++ )
+      {
+      product += static_cast< double >( x1[row] - x2[row] ) * m_InverseCovariance(row, col);
+      }
+    temp += product * static_cast< double >( x1[col] - x2[col] );
     }
 
-  // Compute |x1 - x2 | * inverse(cov)
-  tempMat = tempVec * m_InverseCovariance;
-
-  // Compute |x1 - x2 | * inverse(cov) * |x1 - x2|^T
-  double temp;
-  temp = vcl_sqrt( dot_product( tempMat.as_ref(), tempVec.as_ref() ) );
-
-  return temp;
+  return vcl_sqrt(temp);
 }
 
 template< class TVector >
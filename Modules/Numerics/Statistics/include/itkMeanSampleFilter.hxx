@@ -141,8 +141,6 @@ MeanSampleFilter< TSample >
 
   NumericTraits<MeasurementVectorRealType>::SetLength( output, this->GetMeasurementVectorSize() );
 
-  typename TSample::ConstIterator iter = input->Begin();
-  typename TSample::ConstIterator end =  input->End();
   double totalFrequency = 0.0;
 
   typedef typename NumericTraits<
@@ -151,22 +149,44 @@ MeanSampleFilter< TSample >
   Array< MeasurementRealAccumulateType > sum( measurementVectorSize );
   sum.Fill( NumericTraits< MeasurementRealAccumulateType >::Zero );
 
-  while ( iter != end )
+  const MeasurementType *buffer = input->GetMeasurementBuffer();
+  if ( buffer )
     {
-    double frequency = iter.GetFrequency();
-    totalFrequency += frequency;
-
-    const MeasurementVectorType & measurement = iter.GetMeasurementVector();
+    // The measurements are contiguous, with a frequency of one each
+    const typename TSample::InstanceIdentifier size = input->Size();
+    for ( typename TSample::InstanceIdentifier id = 0; id < size; ++id )
+      {
+      for ( unsigned int dim = 0; dim < measurementVectorSize; dim++ )
+        {
+        sum[dim] += static_cast< MeasurementRealAccumulateType >(
+          static_cast< MeasurementRealType >( buffer[dim] ) );
+        }
+      buffer += measurementVectorSize;
+      }
+    totalFrequency = static_cast< double >( size );
+    }
+  else
+    {
+    typename TSample::ConstIterator iter = input->Begin();
+    typename TSample::ConstIterator end =  input->End();
 
-    for ( unsigned int dim = 0; dim < measurementVectorSize; dim++ )
+    while ( iter != end )
       {
-      const MeasurementRealType component =
-        static_cast< MeasurementRealType >( measurement[dim] );
+      double frequency = iter.GetFrequency();
+      totalFrequency += frequency;
 
-      sum[dim] += static_cast< MeasurementRealAccumulateType >( component * frequency );
-      }
+      const MeasurementVectorType & measurement = iter.GetMeasurementVector();
+
+      for ( unsigned int dim = 0; dim < measurementVectorSize; dim++ )
+        {
+        const MeasurementRealType component =
+          static_cast< MeasurementRealType >( measurement[dim] );
 
-    ++iter;
+        sum[dim] += static_cast< MeasurementRealAccumulateType >( component * frequency );
+        }
+
+      ++iter;
+      }
     }
 
   // compute the mean if the total frequency is different from zero
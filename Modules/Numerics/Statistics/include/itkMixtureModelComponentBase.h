@@ -24,6 +24,7 @@
 #include "itkArray.h"
 #include "itkObject.h"
 #include "itkMembershipFunctionBase.h"
+#include "itkMultiThreader.h"
 
 namespace itk
 {
@@ -48,6 +49,12 @@ namespace Statistics
  * MembershipFunctionBase object. By doing that, users can get pointers
  * to membership functions from different distributional model
  *
+ * Subclasses may update the parameters on several threads
+ * (SetNumberOfThreads). The default is one thread, because the samples
+ * that return their measurement vectors through an internal buffer, such
+ * as the image adaptors and the histograms, cannot be read by several
+ * threads at the same time.
+ *
  * \sa ExpectationMaximizationMixtureModelEstimator
  * \ingroup ITKStatistics
  */
@@ -126,6 +133,10 @@ public:
   /** returns the pointer to the weights array */
   itkGetConstReferenceMacro(Weights, WeightArrayType);
 
+  /** Set/Get the number of threads used to update the parameters. */
+  itkSetClampMacro(NumberOfThreads, ThreadIdType, 1, ITK_MAX_THREADS);
+  itkGetConstMacro(NumberOfThreads, ThreadIdType);
+
   virtual void Update();
 
 protected:
@@ -156,6 +167,8 @@ private:
 
   /** indicative flag of membership function's parameter changes */
   bool m_ParametersModified;
+
+  ThreadIdType m_NumberOfThreads;
 };  // end of class
 } // end of namespace Statistics
 } // end of namespace itk
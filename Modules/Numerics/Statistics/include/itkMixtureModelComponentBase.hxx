@@ -32,6 +32,7 @@ MixtureModelComponentBase< TSample >
   m_MembershipFunction = 0;
   m_MinimalParametersChange = 1.0e-06;
   m_ParametersModified = true;
+  m_NumberOfThreads = 1;
 }
 
 template< class TSample >
@@ -71,6 +72,7 @@ MixtureModelComponentBase< TSample >
 
   os << indent << "Parameters are modified: " << m_ParametersModified
      << std::endl;
+  os << indent << "Number of threads: " << m_NumberOfThreads << std::endl;
 }
 
 template< class TSample >
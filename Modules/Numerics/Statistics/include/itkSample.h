@@ -106,6 +106,19 @@ public:
   /** Get the total frequency of the sample. */
   virtual TotalAbsoluteFrequencyType GetTotalFrequency() const = 0;
 
+  /** Get the measurements of all the instances when the sample stores
+   * them contiguously, with a frequency of one each: the measurement
+   * vector of instance id is then made of the GetMeasurementVectorSize()
+   * measurements starting at id * GetMeasurementVectorSize(). Filters
+   * can run through this buffer instead of calling
+   * GetMeasurementVector() for every instance. The default
+   * implementation returns a null pointer, for samples that do not
+   * store their measurements that way. */
+  virtual const MeasurementType * GetMeasurementBuffer() const
+  {
+    return 0;
+  }
+
   /** Set method for the length of the measurement vector */
   virtual void SetMeasurementVectorSize(MeasurementVectorSizeType s)
   {
@@ -62,6 +62,10 @@ namespace Statistics
  * offset falls outside of the requested region at a particular point, that
  * co-occurrence pair will not be added to the matrix.
  *
+ * The requested region is split in as many pieces as there are threads.  Each
+ * thread adds the co-occurrence pairs of its piece to its own histogram, and
+ * the histograms are summed in the output.
+ *
  * The number of histogram bins on each axis can be set (defaults to 256). Also,
  * by default the histogram min and max corresponds to the largest and smallest
  * possible pixel value of that pixel type. To customize the histogram bounds
@@ -176,6 +180,12 @@ protected:
 
   virtual void FillHistogramWithMask(RadiusType radius, RegionType region, const ImageType *maskImage);
 
+  /** Adds the co-occurrence pairs of the pixels of "region" to "histogram".
+   * The mask image is ignored when it is NULL.  This is called by each
+   * thread on its piece of the region. */
+  virtual void ThreadedFillHistogram(RadiusType radius, RegionType region,
+                                     const ImageType *maskImage, HistogramType *histogram);
+
   /** Standard itk::ProcessObject subclass method. */
   typedef DataObject::Pointer DataObjectPointer;
 
@@ -195,6 +205,23 @@ private:
 
   void NormalizeHistogram(void);
 
+  /** Splits the region over the threads, and sums the histograms of the
+   * threads in the output. */
+  void ThreadedFillOutput(RadiusType radius, RegionType region, const ImageType *maskImage);
+
+  /** Structure for passing information into static callback methods. */
+  struct FillHistogramThreadStruct {
+    Self *Filter;
+    RadiusType Radius;
+    RegionType Region;
+    const ImageType *MaskImage;
+    std::vector< HistogramPointer > Histograms;
+  };
+
+  /** Calls ThreadedFillHistogram on the piece of the region of the calling
+   * thread. */
+  static ITK_THREAD_RETURN_TYPE FillHistogramThreaderCallback(void *arg);
+
   OffsetVectorConstPointer m_Offsets;
   PixelType                m_Min;
   PixelType                m_Max;
@@ -21,6 +21,7 @@
 #include "itkScalarImageToCooccurrenceMatrixFilter.h"
 
 #include "itkConstNeighborhoodIterator.h"
+#include "itkImageRegionSplitter.h"
 #include "vnl/vnl_math.h"
 
 namespace itk
@@ -206,86 +207,161 @@ ScalarImageToCooccurrenceMatrixFilter< TImageType,
                                        THistogramFrequencyContainer >::FillHistogram(RadiusType radius,
                                                                                      RegionType region)
 {
-  // Iterate over all of those pixels and offsets, adding each
-  // co-occurrence pair to the histogram
+  this->ThreadedFillOutput(radius, region, NULL);
+}
 
-  const ImageType *input = this->GetInput();
+template< class TImageType, class THistogramFrequencyContainer >
+void
+ScalarImageToCooccurrenceMatrixFilter< TImageType,
+                                       THistogramFrequencyContainer >::FillHistogramWithMask(RadiusType radius,
+                                                                                             RegionType region,
+                                                                                             const ImageType *maskImage)
+{
+  this->ThreadedFillOutput(radius, region, maskImage);
+}
 
+template< class TImageType, class THistogramFrequencyContainer >
+void
+ScalarImageToCooccurrenceMatrixFilter< TImageType,
+                                       THistogramFrequencyContainer >::ThreadedFillOutput(RadiusType radius,
+                                                                                          RegionType region,
+                                                                                          const ImageType *maskImage)
+{
   HistogramType *output =
     static_cast< HistogramType * >( this->ProcessObject::GetOutput(0) );
 
-  typedef ConstNeighborhoodIterator< ImageType > NeighborhoodIteratorType;
-  NeighborhoodIteratorType neighborIt;
-  neighborIt = NeighborhoodIteratorType(radius, input, region);
+  typedef ImageRegionSplitter< ImageType::ImageDimension > SplitterType;
+  typename SplitterType::Pointer splitter = SplitterType::New();
+  const unsigned int numberOfPieces =
+    splitter->GetNumberOfSplits( region, this->GetNumberOfThreads() );
+
+  // Each thread fills a histogram with the same bins as the output.  The
+  // first thread fills the output.
+  FillHistogramThreadStruct str;
+  str.Filter = this;
+  str.Radius = radius;
+  str.Region = region;
+  str.MaskImage = maskImage;
+  str.Histograms.resize(numberOfPieces);
+  str.Histograms[0] = output;
+  for ( unsigned int i = 1; i < numberOfPieces; i++ )
+    {
+    str.Histograms[i] = HistogramType::New();
+    str.Histograms[i]->SetMeasurementVectorSize( output->GetMeasurementVectorSize() );
+    str.Histograms[i]->Initialize(output->GetSize(), m_LowerBound, m_UpperBound);
+    }
 
-  MeasurementVectorType cooccur( output->GetMeasurementVectorSize() );
+  this->GetMultiThreader()->SetNumberOfThreads(numberOfPieces);
+  this->GetMultiThreader()->SetSingleMethod(this->FillHistogramThreaderCallback, &str);
+  this->GetMultiThreader()->SingleMethodExecute();
 
-  for ( neighborIt.GoToBegin(); !neighborIt.IsAtEnd(); ++neighborIt )
+  for ( unsigned int i = 1; i < numberOfPieces; i++ )
     {
-    const PixelType centerPixelIntensity = neighborIt.GetCenterPixel();
-    if ( centerPixelIntensity < m_Min
-         || centerPixelIntensity > m_Max )
+    typename HistogramType::ConstIterator hit = str.Histograms[i]->Begin();
+    typename HistogramType::ConstIterator end = str.Histograms[i]->End();
+    for (; hit != end; ++hit )
       {
-      continue; // don't put a pixel in the histogram if the value
-                // is out-of-bounds.
-      }
-
-    typename OffsetVector::ConstIterator offsets;
-    for ( offsets = m_Offsets->Begin(); offsets != m_Offsets->End(); offsets++ )
-      {
-      bool            pixelInBounds;
-      const PixelType pixelIntensity =
-        neighborIt.GetPixel(offsets.Value(), pixelInBounds);
-
-      if ( !pixelInBounds )
-        {
-        continue; // don't put a pixel in the histogram if it's out-of-bounds.
-        }
-
-      if ( pixelIntensity < m_Min
-           || pixelIntensity > m_Max )
+      if ( hit.GetFrequency() != NumericTraits< typename HistogramType::AbsoluteFrequencyType >::Zero )
         {
-        continue; // don't put a pixel in the histogram if the value
-                  // is out-of-bounds.
+        output->IncreaseFrequency( hit.GetInstanceIdentifier(), hit.GetFrequency() );
         }
+      }
+    }
+}
 
-      // Now make both possible co-occurrence combinations and increment the
-      // histogram with them.
+template< class TImageType, class THistogramFrequencyContainer >
+ITK_THREAD_RETURN_TYPE
+ScalarImageToCooccurrenceMatrixFilter< TImageType,
+                                       THistogramFrequencyContainer >::FillHistogramThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info = static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  FillHistogramThreadStruct *      str = static_cast< FillHistogramThreadStruct * >( info->UserData );
 
-      cooccur[0] = centerPixelIntensity;
-      cooccur[1] = pixelIntensity;
-      output->IncreaseFrequencyOfMeasurement(cooccur, 1);
+  typedef ImageRegionSplitter< ImageType::ImageDimension > SplitterType;
+  typename SplitterType::Pointer splitter = SplitterType::New();
+  const unsigned int numberOfPieces = static_cast< unsigned int >( str->Histograms.size() );
 
-      cooccur[1] = centerPixelIntensity;
-      cooccur[0] = pixelIntensity;
-      output->IncreaseFrequencyOfMeasurement(cooccur, 1);
-      }
+  // The multithreader may run fewer threads than there are pieces
+  for ( unsigned int i = info->ThreadID; i < numberOfPieces; i += info->NumberOfThreads )
+    {
+    str->Filter->ThreadedFillHistogram( str->Radius,
+                                        splitter->GetSplit(i, numberOfPieces, str->Region),
+                                        str->MaskImage,
+                                        str->Histograms[i] );
     }
+
+  return ITK_THREAD_RETURN_VALUE;
 }
 
 template< class TImageType, class THistogramFrequencyContainer >
 void
 ScalarImageToCooccurrenceMatrixFilter< TImageType,
-                                       THistogramFrequencyContainer >::FillHistogramWithMask(RadiusType radius,
+                                       THistogramFrequencyContainer >::ThreadedFillHistogram(RadiusType radius,
                                                                                              RegionType region,
-                                                                                             const ImageType *maskImage)
+                                                                                             const ImageType *maskImage,
+                                                                                             HistogramType *histogram)
 {
   // Iterate over all of those pixels and offsets, adding each
-  // co-occurrence pair to the histogram
+  // co-occurrence pair to the histogram.  The neighbors are checked
+  // against the buffered region of the image, so a piece of the region
+  // sees the pixels of its neighbor pieces.
 
   const ImageType *input = this->GetInput();
 
-  HistogramType *output =
-    static_cast< HistogramType * >( this->ProcessObject::GetOutput(0) );
-
-  // Iterate over all of those pixels and offsets, adding each
-  // co-occurrence pair to the histogram
   typedef ConstNeighborhoodIterator< ImageType > NeighborhoodIteratorType;
-  NeighborhoodIteratorType neighborIt, maskNeighborIt;
+  NeighborhoodIteratorType neighborIt;
   neighborIt = NeighborhoodIteratorType(radius, input, region);
-  maskNeighborIt = NeighborhoodIteratorType(radius, maskImage, region);
 
-  MeasurementVectorType cooccur( output->GetMeasurementVectorSize() );
+  MeasurementVectorType cooccur( histogram->GetMeasurementVectorSize() );
+
+  if ( maskImage == NULL )
+    {
+    for ( neighborIt.GoToBegin(); !neighborIt.IsAtEnd(); ++neighborIt )
+      {
+      const PixelType centerPixelIntensity = neighborIt.GetCenterPixel();
+      if ( centerPixelIntensity < m_Min
+           || centerPixelIntensity > m_Max )
+        {
+        continue; // don't put a pixel in the histogram if the value
+                  // is out-of-bounds.
+        }
+
+      typename OffsetVector::ConstIterator offsets;
+      for ( offsets = m_Offsets->Begin(); offsets != m_Offsets->End(); offsets++ )
+        {
+        bool            pixelInBounds;
+        const PixelType pixelIntensity =
+          neighborIt.GetPixel(offsets.Value(), pixelInBounds);
+
+        if ( !pixelInBounds )
+          {
+          continue; // don't put a pixel in the histogram if it's out-of-bounds.
+          }
+
+        if ( pixelIntensity < m_Min
+             || pixelIntensity > m_Max )
+          {
+          continue; // don't put a pixel in the histogram if the value
+                    // is out-of-bounds.
+          }
+
+        // Now make both possible co-occurrence combinations and increment the
+        // histogram with them.
+
+        cooccur[0] = centerPixelIntensity;
+        cooccur[1] = pixelIntensity;
+        histogram->IncreaseFrequencyOfMeasurement(cooccur, 1);
+
+        cooccur[1] = centerPixelIntensity;
+        cooccur[0] = pixelIntensity;
+        histogram->IncreaseFrequencyOfMeasurement(cooccur, 1);
+        }
+      }
+    return;
+    }
+
+  NeighborhoodIteratorType maskNeighborIt;
+  maskNeighborIt = NeighborhoodIteratorType(radius, maskImage, region);
 
   for ( neighborIt.GoToBegin(), maskNeighborIt.GoToBegin();
         !neighborIt.IsAtEnd(); ++neighborIt, ++maskNeighborIt )
@@ -297,15 +373,15 @@ ScalarImageToCooccurrenceMatrixFilter< TImageType,
 
     const PixelType centerPixelIntensity = neighborIt.GetCenterPixel();
 
-    if ( centerPixelIntensity < this->GetMin()
-         || centerPixelIntensity > this->GetMax() )
+    if ( centerPixelIntensity < m_Min
+         || centerPixelIntensity > m_Max )
       {
       continue; // don't put a pixel in the histogram if the value
                 // is out-of-bounds.
       }
 
     typename OffsetVector::ConstIterator offsets;
-    for ( offsets = this->GetOffsets()->Begin(); offsets != this->GetOffsets()->End(); offsets++ )
+    for ( offsets = m_Offsets->Begin(); offsets != m_Offsets->End(); offsets++ )
       {
       if ( maskNeighborIt.GetPixel( offsets.Value() ) != m_InsidePixelValue )
         {
@@ -321,8 +397,8 @@ ScalarImageToCooccurrenceMatrixFilter< TImageType,
         continue; // don't put a pixel in the histogram if it's out-of-bounds.
         }
 
-      if ( pixelIntensity < this->GetMin()
-           || pixelIntensity > this->GetMax() )
+      if ( pixelIntensity < m_Min
+           || pixelIntensity > m_Max )
         {
         continue; // don't put a pixel in the histogram if the value
                   // is out-of-bounds.
@@ -333,11 +409,11 @@ ScalarImageToCooccurrenceMatrixFilter< TImageType,
 
       cooccur[0] = centerPixelIntensity;
       cooccur[1] = pixelIntensity;
-      output->IncreaseFrequencyOfMeasurement(cooccur, 1);
+      histogram->IncreaseFrequencyOfMeasurement(cooccur, 1);
 
       cooccur[1] = centerPixelIntensity;
       cooccur[0] = pixelIntensity;
-      output->IncreaseFrequencyOfMeasurement(cooccur, 1);
+      histogram->IncreaseFrequencyOfMeasurement(cooccur, 1);
       }
     }
 }
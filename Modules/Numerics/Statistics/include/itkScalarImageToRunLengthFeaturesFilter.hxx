@@ -106,6 +106,10 @@ void
 ScalarImageToRunLengthFeaturesFilter<TImage, THistogramFrequencyContainer>
 ::GenerateData(void)
 {
+  // The run length matrices are computed with the threads of this filter
+  this->m_RunLengthMatrixGenerator->SetNumberOfThreads(
+    this->GetNumberOfThreads() );
+
   if ( this->m_FastCalculations )
     {
     this->FastCompute();
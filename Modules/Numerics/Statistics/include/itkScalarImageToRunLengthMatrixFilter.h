@@ -73,6 +73,11 @@ namespace Statistics
  * at a particular point, that distance/intensity pair will not be added to
  * the matrix.
  *
+ * For each offset, the runs are followed along the lines of pixels that the
+ * offset goes through, which are shared among the threads.  Each thread adds
+ * the runs of its lines to its own histogram, and the histograms are summed
+ * in the output.
+ *
  * The number of histogram bins on each axis can be set (defaults to 256). Also,
  * by default the histogram min and max corresponds to the largest and smallest
  * possible pixel value of that pixel type. To customize the histogram bounds
@@ -254,8 +259,38 @@ protected:
    * */
   void NormalizeOffsetDirection(OffsetType &offset);
 
+  /**
+   * Adds to "histogram" the runs of the lines of pixels going along
+   * "offset", whose first pixels are in "lineStarts".  The lines are shared
+   * among the threads: the thread "threadId" follows one line out of
+   * "numberOfThreads".
+   */
+  virtual void ThreadedFillHistogram( const OffsetType & offset,
+    const std::vector<RegionType> & lineStarts, ThreadIdType threadId,
+    ThreadIdType numberOfThreads, HistogramType *histogram );
+
 private:
 
+  /**
+   * Computes the regions that hold the first pixel of each line of pixels
+   * going along "offset" in "region", i.e. the pixels whose predecessor
+   * along the offset is outside of the region.
+   */
+  void ComputeLineStarts( const OffsetType & offset, const RegionType & region,
+    std::vector<RegionType> & lineStarts ) const;
+
+  /** Structure for passing information into static callback methods. */
+  struct FillHistogramThreadStruct
+    {
+    Self                                   *Filter;
+    std::vector<OffsetType>                 Offsets;
+    std::vector< std::vector<RegionType> >  LineStarts;
+    std::vector<HistogramPointer>           Histograms;
+    };
+
+  /** Calls ThreadedFillHistogram for each offset. */
+  static ITK_THREAD_RETURN_TYPE FillHistogramThreaderCallback( void *arg );
+
   unsigned int             m_NumberOfBinsPerAxis;
   PixelType                m_Min;
   PixelType                m_Max;
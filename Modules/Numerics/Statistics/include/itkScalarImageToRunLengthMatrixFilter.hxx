@@ -20,8 +20,7 @@
 
 #include "itkScalarImageToRunLengthMatrixFilter.h"
 
-#include "itkConstNeighborhoodIterator.h"
-#include "itkNeighborhood.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "vnl/vnl_math.h"
 #include "itkMacro.h"
 
@@ -150,137 +149,244 @@ ScalarImageToRunLengthMatrixFilter<TImageType, THistogramFrequencyContainer>
   this->m_UpperBound[1] = this->m_MaxDistance;
   output->Initialize( size, this->m_LowerBound, this->m_UpperBound );
 
-  MeasurementVectorType run( output->GetMeasurementVectorSize() );
+  // Find the first pixel of each line of pixels going along each offset.
+  // A run never leaves its line, and the runs of a line only depend on the
+  // pixels of the line, so the lines can be followed in any order.
+  const RegionType & region = this->GetInput()->GetRequestedRegion();
 
-  // Iterate over all of those pixels and offsets, adding each
-  // distance/intensity pair to the histogram
-
-  typedef ConstNeighborhoodIterator<ImageType> NeighborhoodIteratorType;
-  typename NeighborhoodIteratorType::RadiusType radius;
-  radius.Fill( 1 );
-  NeighborhoodIteratorType neighborIt( radius,
-    this->GetInput(), this->GetInput()->GetRequestedRegion() );
-
-
-  // this temp image has the same dimension for each offset
-  // moving the allocation out of loop of offsets
-  // while keeping FillBuffer with boolean false in each loop
-  typedef Image<bool, ImageDimension> BoolImageType;
-  typename BoolImageType::Pointer alreadyVisitedImage = BoolImageType::New();
-  alreadyVisitedImage->CopyInformation( this->GetInput() );
-  alreadyVisitedImage->SetRegions( this->GetInput()->GetRequestedRegion() );
-  alreadyVisitedImage->Allocate();
+  FillHistogramThreadStruct str;
+  str.Filter = this;
 
   typename OffsetVector::ConstIterator offsets;
   for( offsets = this->GetOffsets()->Begin();
     offsets != this->GetOffsets()->End(); offsets++ )
     {
-
-    alreadyVisitedImage->FillBuffer( false );
-
-    neighborIt.GoToBegin();
     OffsetType offset = offsets.Value();
 
     this->NormalizeOffsetDirection(offset);
 
+    str.Offsets.push_back( offset );
+    str.LineStarts.push_back( std::vector<RegionType>() );
+    this->ComputeLineStarts( offset, region, str.LineStarts.back() );
+    }
+
+  // Each thread fills a histogram with the same bins as the output.  The
+  // first thread fills the output.
+  const ThreadIdType numberOfThreads = this->GetNumberOfThreads();
+  str.Histograms.resize( numberOfThreads );
+  str.Histograms[0] = output;
+  for( ThreadIdType i = 1; i < numberOfThreads; i++ )
+    {
+    str.Histograms[i] = HistogramType::New();
+    str.Histograms[i]->SetMeasurementVectorSize(
+      output->GetMeasurementVectorSize() );
+    str.Histograms[i]->Initialize( size, this->m_LowerBound,
+      this->m_UpperBound );
+    }
+
+  this->GetMultiThreader()->SetNumberOfThreads( numberOfThreads );
+  this->GetMultiThreader()->SetSingleMethod(
+    this->FillHistogramThreaderCallback, &str );
+  this->GetMultiThreader()->SingleMethodExecute();
 
-    for( neighborIt.GoToBegin(); !neighborIt.IsAtEnd(); ++neighborIt )
+  for( ThreadIdType i = 1; i < numberOfThreads; i++ )
+    {
+    typename HistogramType::ConstIterator hit = str.Histograms[i]->Begin();
+    typename HistogramType::ConstIterator end = str.Histograms[i]->End();
+    for( ; hit != end; ++hit )
       {
-      const PixelType centerPixelIntensity = neighborIt.GetCenterPixel();
-      IndexType centerIndex = neighborIt.GetIndex();
-      if( centerPixelIntensity < this->m_Min ||
-        centerPixelIntensity > this->m_Max ||
-        alreadyVisitedImage->GetPixel( centerIndex ) || ( this->GetMaskImage() &&
-        this->GetMaskImage()->GetPixel( centerIndex ) !=
-        this->m_InsidePixelValue ) )
+      if( hit.GetFrequency() !=
+        NumericTraits<typename HistogramType::AbsoluteFrequencyType>::Zero )
         {
-        continue; // don't put a pixel in the histogram if the value
-                  // is out-of-bounds or is outside the mask.
+        output->IncreaseFrequency( hit.GetInstanceIdentifier(),
+          hit.GetFrequency() );
         }
+      }
+    }
+}
 
-      itkDebugMacro("===> offset = " << offset << std::endl);
-
-      MeasurementType centerBinMin = this->GetOutput()->
-        GetBinMinFromValue( 0, centerPixelIntensity );
-      MeasurementType centerBinMax = this->GetOutput()->
-        GetBinMaxFromValue( 0, centerPixelIntensity );
-      MeasurementType lastBinMax = this->GetOutput()->
-              GetDimensionMaxs( 0 )[ this->GetOutput()->GetSize( 0 ) - 1 ];
-
-      PixelType pixelIntensity( NumericTraits<PixelType>::Zero );
-      IndexType index;
+template<class TImageType, class THistogramFrequencyContainer>
+ITK_THREAD_RETURN_TYPE
+ScalarImageToRunLengthMatrixFilter<TImageType, THistogramFrequencyContainer>
+::FillHistogramThreaderCallback( void *arg )
+{
+  MultiThreader::ThreadInfoStruct *info =
+    static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  FillHistogramThreadStruct *str =
+    static_cast<FillHistogramThreadStruct *>( info->UserData );
+
+  // The multithreader may run fewer threads than there are histograms
+  const ThreadIdType numberOfHistograms =
+    static_cast<ThreadIdType>( str->Histograms.size() );
+  for( ThreadIdType i = info->ThreadID; i < numberOfHistograms;
+    i += info->NumberOfThreads )
+    {
+    for( unsigned int o = 0; o < str->Offsets.size(); o++ )
+      {
+      str->Filter->ThreadedFillHistogram( str->Offsets[o],
+        str->LineStarts[o], i, numberOfHistograms, str->Histograms[i] );
+      }
+    }
 
-      index = centerIndex + offset;
-      IndexType lastGoodIndex = centerIndex;
-      bool runLengthSegmentAlreadyVisited = false;
+  return ITK_THREAD_RETURN_VALUE;
+}
 
-      // Scan from the current pixel at index, following
-      // the direction of offset. Run length is computed as the
-      // length of continuous pixels whose pixel values are
-      // in the same bin.
+template<class TImageType, class THistogramFrequencyContainer>
+void
+ScalarImageToRunLengthMatrixFilter<TImageType, THistogramFrequencyContainer>
+::ComputeLineStarts( const OffsetType & offset, const RegionType & region,
+  std::vector<RegionType> & lineStarts ) const
+{
+  // A pixel starts a line when its predecessor along the offset is outside
+  // of the region along at least one dimension.  The pixels whose
+  // predecessor first leaves the region along dimension d make one box.
+  lineStarts.clear();
+  for( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    if( offset[d] == 0 )
+      {
+      continue;
+      }
 
-      while ( this->GetInput()->GetRequestedRegion().IsInside(index) )
+    RegionType start = region;
+    bool isEmpty = false;
+    for( unsigned int i = 0; i < ImageDimension; i++ )
+      {
+      OffsetValueType first = region.GetIndex( i );
+      OffsetValueType last = first +
+        static_cast<OffsetValueType>( region.GetSize( i ) ) - 1;
+      if( i < d )
         {
-        // For the same offset, each run length segment can
-        // only be visited once
-        if (alreadyVisitedImage->GetPixel( index ) )
+        // The predecessor is inside of the region along i
+        if( offset[i] > 0 )
           {
-          runLengthSegmentAlreadyVisited = true;
-          break;
+          first += offset[i];
           }
-
-        pixelIntensity = this->GetInput()->GetPixel( index );
-
-        // Special attention paid to boundaries of bins.
-        // For the last bin,
-        // it is left close and right close (following the previous
-        // gerrit patch).
-        // For all
-        // other bins,
-        // the bin is left close and right open.
-
-        if ( pixelIntensity >= centerBinMin
-            && ( pixelIntensity < centerBinMax || ( pixelIntensity == centerBinMax && centerBinMax == lastBinMax ) ) )
+        else
+          {
+          last += offset[i];
+          }
+        }
+      else if( i == d )
+        {
+        // The predecessor is outside of the region along d
+        if( offset[i] > 0 )
           {
-          alreadyVisitedImage->SetPixel( index, true );
-          lastGoodIndex = index;
-          index += offset;
+          last = vnl_math_min( last, first + offset[i] - 1 );
           }
         else
           {
-          break;
+          first = vnl_math_max( first, last + offset[i] + 1 );
           }
         }
+      if( first > last )
+        {
+        isEmpty = true;
+        break;
+        }
+      start.SetIndex( i, first );
+      start.SetSize( i, static_cast<SizeValueType>( last - first + 1 ) );
+      }
+    if( !isEmpty )
+      {
+      lineStarts.push_back( start );
+      }
+    }
+}
+
+template<class TImageType, class THistogramFrequencyContainer>
+void
+ScalarImageToRunLengthMatrixFilter<TImageType, THistogramFrequencyContainer>
+::ThreadedFillHistogram( const OffsetType & offset,
+  const std::vector<RegionType> & lineStarts, ThreadIdType threadId,
+  ThreadIdType numberOfThreads, HistogramType *histogram )
+{
+  const ImageType *input = this->GetInput();
+  const ImageType *maskImage = this->GetMaskImage();
+  const RegionType & region = input->GetRequestedRegion();
+
+  const MeasurementType lastBinMax =
+    histogram->GetDimensionMaxs( 0 )[ histogram->GetSize( 0 ) - 1 ];
 
-      if ( runLengthSegmentAlreadyVisited )
+  MeasurementVectorType run( histogram->GetMeasurementVectorSize() );
+
+  SizeValueType lineNumber = 0;
+  for( unsigned int s = 0; s < lineStarts.size(); s++ )
+    {
+    ImageRegionConstIteratorWithIndex<ImageType> lineIt( input, lineStarts[s] );
+    for( lineIt.GoToBegin(); !lineIt.IsAtEnd(); ++lineIt, ++lineNumber )
+      {
+      if( lineNumber % numberOfThreads != threadId )
         {
         continue;
         }
 
-      PointType centerPoint;
-      this->GetInput()->TransformIndexToPhysicalPoint(
-        centerIndex, centerPoint );
-      PointType point;
-      this->GetInput()->TransformIndexToPhysicalPoint( lastGoodIndex, point );
+      // Follow the line: each run starts at the first pixel after the
+      // previous run, so that each run length segment is only visited once.
+      IndexType centerIndex = lineIt.GetIndex();
+      while( region.IsInside( centerIndex ) )
+        {
+        const PixelType centerPixelIntensity = input->GetPixel( centerIndex );
+        if( centerPixelIntensity < this->m_Min ||
+          centerPixelIntensity > this->m_Max || ( maskImage &&
+          maskImage->GetPixel( centerIndex ) != this->m_InsidePixelValue ) )
+          {
+          centerIndex += offset;
+          continue; // don't put a pixel in the histogram if the value
+                    // is out-of-bounds or is outside the mask.
+          }
 
-      run[0] = centerPixelIntensity;
-      run[1] = centerPoint.EuclideanDistanceTo( point );
+        MeasurementType centerBinMin =
+          histogram->GetBinMinFromValue( 0, centerPixelIntensity );
+        MeasurementType centerBinMax =
+          histogram->GetBinMaxFromValue( 0, centerPixelIntensity );
 
-      if( run[1] >= this->m_MinDistance && run[1] <= this->m_MaxDistance )
-        {
-        output->IncreaseFrequencyOfMeasurement( run, 1 );
-
-        itkDebugMacro( "centerIndex<->index: "
-            << (int) centerPixelIntensity
-            << "@"<< centerIndex
-                << "<->" << (int) pixelIntensity << "@" << index
-                <<", Bin# " << output->GetIndex(run)
-                << ", Measurement: (" << run[0] << ", " << run[1] << ")"
-                << ", Center bin [" << this->GetOutput()->GetBinMinFromValue( 0, run[0] )
-                << "," << this->GetOutput()->GetBinMaxFromValue( 0, run[0] ) << "]"
-                << "~[" << this->GetOutput()->GetBinMinFromValue( 1, run[1] )
-                << "," << this->GetOutput()->GetBinMaxFromValue( 1, run[1] ) << "]"
-                << std::endl );
+        IndexType index = centerIndex + offset;
+        IndexType lastGoodIndex = centerIndex;
+
+        // Scan from the current pixel at index, following
+        // the direction of offset. Run length is computed as the
+        // length of continuous pixels whose pixel values are
+        // in the same bin.
+
+        while( region.IsInside( index ) )
+          {
+          const PixelType pixelIntensity = input->GetPixel( index );
+
+          // Special attention paid to boundaries of bins.
+          // For the last bin,
+          // it is left close and right close (following the previous
+          // gerrit patch).
+          // For all
+          // other bins,
+          // the bin is left close and right open.
+
+          if ( pixelIntensity >= centerBinMin
+              && ( pixelIntensity < centerBinMax || ( pixelIntensity == centerBinMax && centerBinMax == lastBinMax ) ) )
+            {
+            lastGoodIndex = index;
+            index += offset;
+            }
+          else
+            {
+            break;
+            }
+          }
+
+        PointType centerPoint;
+        input->TransformIndexToPhysicalPoint( centerIndex, centerPoint );
+        PointType point;
+        input->TransformIndexToPhysicalPoint( lastGoodIndex, point );
+
+        run[0] = centerPixelIntensity;
+        run[1] = centerPoint.EuclideanDistanceTo( point );
+
+        if( run[1] >= this->m_MinDistance && run[1] <= this->m_MaxDistance )
+          {
+          histogram->IncreaseFrequencyOfMeasurement( run, 1 );
+          }
+
+        centerIndex = index;
         }
       }
     }
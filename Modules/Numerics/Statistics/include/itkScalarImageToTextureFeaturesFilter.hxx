@@ -89,6 +89,9 @@ template< class TImage, class THistogramFrequencyContainer >
 void
 ScalarImageToTextureFeaturesFilter< TImage, THistogramFrequencyContainer >::GenerateData(void)
 {
+  // The co-occurrence matrices are computed with the threads of this filter
+  m_GLCMGenerator->SetNumberOfThreads( this->GetNumberOfThreads() );
+
   if ( m_FastCalculations )
     {
     this->FastCompute();
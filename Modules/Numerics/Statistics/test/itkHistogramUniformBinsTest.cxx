@@ -0,0 +1,191 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkHistogram.h"
+#include "itkImageToHistogramFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkTimeProbe.h"
+
+namespace
+{
+typedef itk::Statistics::MersenneTwisterRandomVariateGenerator GeneratorType;
+
+// Compare the indices computed with regularly spaced bins to the ones of
+// the binary search, on random measurements and on the bounds of the bins.
+template< class TMeasurement >
+bool CompareToBinarySearch(GeneratorType *generator, unsigned int bins,
+                           double lower, double upper, bool clip, const char *name)
+{
+  typedef itk::Statistics::Histogram< TMeasurement > HistogramType;
+
+  typename HistogramType::SizeType size(2);
+  size[0] = bins;
+  size[1] = 3;
+  typename HistogramType::MeasurementVectorType lowerBound(2);
+  typename HistogramType::MeasurementVectorType upperBound(2);
+  lowerBound[0] = static_cast< TMeasurement >( lower );
+  upperBound[0] = static_cast< TMeasurement >( upper );
+  lowerBound[1] = 0;
+  upperBound[1] = 3;
+
+  typename HistogramType::Pointer uniform = HistogramType::New();
+  uniform->SetMeasurementVectorSize(2);
+  uniform->Initialize( size, lowerBound, upperBound );
+  uniform->SetClipBinsAtEnds( clip );
+
+  // Setting a bin to its own value keeps the bins, but turns back to the
+  // binary search
+  typename HistogramType::Pointer searched = HistogramType::New();
+  searched->SetMeasurementVectorSize(2);
+  searched->Initialize( size, lowerBound, upperBound );
+  searched->SetClipBinsAtEnds( clip );
+  searched->SetBinMin( 0, 0, searched->GetBinMin( 0, 0 ) );
+
+  std::vector< double > values;
+  for( unsigned int i = 0; i < 20000; ++i )
+    {
+    values.push_back( lower - 1.0 + ( upper - lower + 2.0 ) * generator->GetVariate() );
+    }
+  for( unsigned int i = 0; i < bins; ++i )
+    {
+    values.push_back( uniform->GetBinMin( 0, i ) );
+    values.push_back( uniform->GetBinMax( 0, i ) );
+    }
+
+  typename HistogramType::MeasurementVectorType measurement(2);
+  typename HistogramType::IndexType uniformIndex;
+  typename HistogramType::IndexType searchedIndex;
+  for( unsigned int i = 0; i < values.size(); ++i )
+    {
+    measurement[0] = static_cast< TMeasurement >( values[i] );
+    measurement[1] = 1;
+    const bool uniformInside = uniform->GetIndex( measurement, uniformIndex );
+    const bool searchedInside = searched->GetIndex( measurement, searchedIndex );
+    if( uniformInside != searchedInside || uniformIndex[0] != searchedIndex[0] )
+      {
+      std::cerr << name << ": measurement " << measurement[0] << " is in bin "
+                << uniformIndex[0] << " (" << uniformInside << ") with regularly spaced bins, in bin "
+                << searchedIndex[0] << " (" << searchedInside << ") with the binary search"
+                << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+}
+
+int itkHistogramUniformBinsTest(int, char* [] )
+{
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize( 3579 );
+
+  // Bounds whose bin widths cannot be represented exactly, and integer
+  // measurements with fewer bins than values, or more (which have empty
+  // bins)
+  if( !CompareToBinarySearch< float >( generator, 256, -1024.3, 3071.7, true, "float" )
+      || !CompareToBinarySearch< float >( generator, 7, 0.1, 0.2, false, "float, not clipped" )
+      || !CompareToBinarySearch< double >( generator, 1000, -3.0, 1.0e5 / 3.0, true, "double" )
+      || !CompareToBinarySearch< int >( generator, 50, -100, 1000, true, "int" )
+      || !CompareToBinarySearch< int >( generator, 50, 0, 20, false, "int, empty bins" ) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  // A measurement outside the histogram along one dimension is not counted
+  typedef itk::Statistics::Histogram< float > HistogramType;
+  HistogramType::Pointer histogram = HistogramType::New();
+  HistogramType::SizeType size(2);
+  size.Fill( 4 );
+  HistogramType::MeasurementVectorType lowerBound(2);
+  HistogramType::MeasurementVectorType upperBound(2);
+  lowerBound.Fill( 0 );
+  upperBound.Fill( 4 );
+  histogram->SetMeasurementVectorSize(2);
+  histogram->Initialize( size, lowerBound, upperBound );
+  HistogramType::MeasurementVectorType measurement(2);
+  measurement[0] = 5.0;
+  measurement[1] = 1.5;
+  if( histogram->IncreaseFrequencyOfMeasurement( measurement, 1 )
+      || histogram->GetTotalFrequency() != 0 )
+    {
+    std::cerr << "A measurement outside the histogram was counted" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Histogram of a 16 bit image, with one and several threads
+  typedef itk::Image< short, 3 > ImageType;
+  ImageType::Pointer image = ImageType::New();
+  ImageType::SizeType imageSize;
+  imageSize[0] = 128;
+  imageSize[1] = 128;
+  imageSize[2] = 64;
+  image->SetRegions( imageSize );
+  image->Allocate();
+  itk::ImageRegionIterator< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for( ; !it.IsAtEnd(); ++it )
+    {
+    it.Set( static_cast< short >( -1000.0 + 4000.0 * generator->GetVariate() ) );
+    }
+
+  typedef itk::Statistics::ImageToHistogramFilter< ImageType > FilterType;
+  FilterType::HistogramSizeType histogramSize(1);
+  histogramSize[0] = 1000;
+
+  FilterType::Pointer serial = FilterType::New();
+  serial->SetInput( image );
+  serial->SetHistogramSize( histogramSize );
+  serial->SetNumberOfThreads( 1 );
+  itk::TimeProbe serialTime;
+  serialTime.Start();
+  serial->Update();
+  serialTime.Stop();
+
+  FilterType::Pointer threaded = FilterType::New();
+  threaded->SetInput( image );
+  threaded->SetHistogramSize( histogramSize );
+  threaded->SetNumberOfThreads( 3 );
+  itk::TimeProbe threadedTime;
+  threadedTime.Start();
+  threaded->Update();
+  threadedTime.Stop();
+  std::cout << "ImageToHistogramFilter: one thread " << serialTime.GetMean()
+            << " s, three threads " << threadedTime.GetMean() << " s" << std::endl;
+
+  const FilterType::HistogramType *serialHistogram = serial->GetOutput();
+  const FilterType::HistogramType *threadedHistogram = threaded->GetOutput();
+  if( serialHistogram->GetTotalFrequency() != image->GetLargestPossibleRegion().GetNumberOfPixels()
+      || threadedHistogram->GetTotalFrequency() != serialHistogram->GetTotalFrequency() )
+    {
+    std::cerr << "Total frequencies: " << serialHistogram->GetTotalFrequency() << " with one thread, "
+              << threadedHistogram->GetTotalFrequency() << " with three" << std::endl;
+    return EXIT_FAILURE;
+    }
+  for( unsigned int i = 0; i < serialHistogram->Size(); ++i )
+    {
+    if( serialHistogram->GetFrequency( i ) != threadedHistogram->GetFrequency( i ) )
+      {
+      std::cerr << "Bin " << i << ": " << serialHistogram->GetFrequency( i ) << " with one thread, "
+                << threadedHistogram->GetFrequency( i ) << " with three" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
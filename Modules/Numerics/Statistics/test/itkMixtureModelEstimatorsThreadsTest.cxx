@@ -0,0 +1,239 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkListSample.h"
+#include "itkExpectationMaximizationMixtureModelEstimator.h"
+#include "itkGaussianMixtureModelComponent.h"
+#include "itkWeightedCentroidKdTreeGenerator.h"
+#include "itkKdTreeBasedKmeansEstimator.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkTimeProbe.h"
+
+namespace
+{
+typedef itk::Vector< double, 2 >                                MeasurementVectorType;
+typedef itk::Statistics::ListSample< MeasurementVectorType >    SampleType;
+typedef itk::Statistics::GaussianMixtureModelComponent< SampleType >                ComponentType;
+typedef itk::Statistics::ExpectationMaximizationMixtureModelEstimator< SampleType > EstimatorType;
+typedef itk::Statistics::WeightedCentroidKdTreeGenerator< SampleType >              GeneratorType;
+typedef GeneratorType::KdTreeType                                                   TreeType;
+typedef itk::Statistics::KdTreeBasedKmeansEstimator< TreeType >                     KmeansType;
+
+const unsigned int NumberOfClasses = 3;
+
+bool Close(double a, double b)
+{
+  return vnl_math_abs( a - b ) <= 1.0e-9 * ( 1.0 + vnl_math_abs( a ) );
+}
+
+// Estimate the mixture of three Gaussian distributions, starting from the
+// same parameters whatever the number of threads.
+EstimatorType::Pointer EstimateMixture(const SampleType *sample, itk::ThreadIdType numberOfThreads,
+                                       std::vector< ComponentType::Pointer > & components)
+{
+  EstimatorType::Pointer estimator = EstimatorType::New();
+  estimator->SetSample( sample );
+  estimator->SetMaximumIteration( 50 );
+  estimator->SetNumberOfThreads( numberOfThreads );
+
+  EstimatorType::ProportionVectorType proportions( NumberOfClasses );
+  proportions.Fill( 1.0 / NumberOfClasses );
+  estimator->SetInitialProportions( proportions );
+
+  components.clear();
+  for( unsigned int i = 0; i < NumberOfClasses; ++i )
+    {
+    ComponentType::ParametersType parameters( 6 );
+    parameters[0] = 40.0 + 70.0 * i;
+    parameters[1] = 110.0 - 30.0 * i;
+    parameters[2] = 400.0;
+    parameters[3] = 0.0;
+    parameters[4] = 0.0;
+    parameters[5] = 400.0;
+
+    components.push_back( ComponentType::New() );
+    components[i]->SetSample( sample );
+    components[i]->SetParameters( parameters );
+    estimator->AddComponent( components[i].GetPointer() );
+    }
+
+  itk::TimeProbe time;
+  time.Start();
+  estimator->Update();
+  time.Stop();
+  std::cout << "Expectation maximization, " << numberOfThreads << " threads: "
+            << time.GetMean() << " s, " << estimator->GetCurrentIteration()
+            << " iterations" << std::endl;
+  return estimator;
+}
+
+// Check that two k-d trees have the same nodes.
+bool SameTrees(const TreeType::KdTreeNodeType *a, const TreeType::KdTreeNodeType *b)
+{
+  TreeType::KdTreeNodeType *left = const_cast< TreeType::KdTreeNodeType * >( a );
+  TreeType::KdTreeNodeType *right = const_cast< TreeType::KdTreeNodeType * >( b );
+  if( left->IsTerminal() != right->IsTerminal() || left->Size() != right->Size() )
+    {
+    return false;
+    }
+  if( left->IsTerminal() )
+    {
+    for( unsigned int i = 0; i < left->Size(); ++i )
+      {
+      if( left->GetInstanceIdentifier( i ) != right->GetInstanceIdentifier( i ) )
+        {
+        return false;
+        }
+      }
+    return true;
+    }
+
+  unsigned int leftDimension;
+  unsigned int rightDimension;
+  TreeType::MeasurementType leftValue;
+  TreeType::MeasurementType rightValue;
+  left->GetParameters( leftDimension, leftValue );
+  right->GetParameters( rightDimension, rightValue );
+  return leftDimension == rightDimension && leftValue == rightValue
+         && left->GetInstanceIdentifier( 0 ) == right->GetInstanceIdentifier( 0 )
+         && SameTrees( left->Left(), right->Left() )
+         && SameTrees( left->Right(), right->Right() );
+}
+}
+
+int itkMixtureModelEstimatorsThreadsTest(int, char* [] )
+{
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomType;
+  RandomType::Pointer random = RandomType::New();
+  random->Initialize( 8642 );
+
+  // Three clusters of different sizes and spreads
+  const double centers[NumberOfClasses][2] = { { 30.0, 100.0 }, { 120.0, 90.0 }, { 170.0, 40.0 } };
+  const double variances[NumberOfClasses] = { 100.0, 225.0, 64.0 };
+  const unsigned int sizes[NumberOfClasses] = { 12000, 9000, 6001 };
+
+  SampleType::Pointer sample = SampleType::New();
+  sample->SetMeasurementVectorSize( 2 );
+  for( unsigned int c = 0; c < NumberOfClasses; ++c )
+    {
+    for( unsigned int i = 0; i < sizes[c]; ++i )
+      {
+      MeasurementVectorType mv;
+      mv[0] = random->GetNormalVariate( centers[c][0], variances[c] );
+      mv[1] = random->GetNormalVariate( centers[c][1], variances[c] );
+      sample->PushBack( mv );
+      }
+    }
+
+  // The sums of the chunks only differ from the serial sums by rounding
+  std::vector< ComponentType::Pointer > serialComponents;
+  EstimatorType::Pointer serial = EstimateMixture( sample, 1, serialComponents );
+  const itk::ThreadIdType numbersOfThreads[] = { 3, 8 };
+  for( unsigned int t = 0; t < 2; ++t )
+    {
+    std::vector< ComponentType::Pointer > components;
+    EstimatorType::Pointer threaded = EstimateMixture( sample, numbersOfThreads[t], components );
+    for( unsigned int i = 0; i < NumberOfClasses; ++i )
+      {
+      const ComponentType::ParametersType serialParameters = serialComponents[i]->GetFullParameters();
+      const ComponentType::ParametersType parameters = components[i]->GetFullParameters();
+      for( unsigned int j = 0; j < parameters.Size(); ++j )
+        {
+        if( !Close( serialParameters[j], parameters[j] ) )
+          {
+          std::cerr << "Component " << i << ": parameter " << j << " is " << parameters[j]
+                    << " with " << numbersOfThreads[t] << " threads, " << serialParameters[j]
+                    << " with one" << std::endl;
+          return EXIT_FAILURE;
+          }
+        }
+      if( !Close( serial->GetProportions()[i], threaded->GetProportions()[i] ) )
+        {
+        std::cerr << "Proportion " << i << " is " << threaded->GetProportions()[i] << " with "
+                  << numbersOfThreads[t] << " threads, " << serial->GetProportions()[i]
+                  << " with one" << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+  for( unsigned int i = 0; i < NumberOfClasses; ++i )
+    {
+    std::cout << "Component " << i << ": " << serialComponents[i]->GetFullParameters()
+              << ", proportion " << serial->GetProportions()[i] << std::endl;
+    }
+
+  // The subtrees generated on several threads are the same as the serial
+  // ones, and so are the k-means on them, up to rounding
+  GeneratorType::Pointer generators[3];
+  KmeansType::Pointer    kmeans[3];
+  const itk::ThreadIdType kdTreeThreads[] = { 1, 3, 16 };
+  for( unsigned int t = 0; t < 3; ++t )
+    {
+    generators[t] = GeneratorType::New();
+    generators[t]->SetSample( sample );
+    generators[t]->SetBucketSize( 8 );
+    generators[t]->SetNumberOfThreads( kdTreeThreads[t] );
+    itk::TimeProbe treeTime;
+    treeTime.Start();
+    generators[t]->Update();
+    treeTime.Stop();
+
+    KmeansType::ParametersType initialMeans( 2 * NumberOfClasses );
+    for( unsigned int c = 0; c < NumberOfClasses; ++c )
+      {
+      initialMeans[2 * c] = 40.0 + 70.0 * c;
+      initialMeans[2 * c + 1] = 110.0 - 30.0 * c;
+      }
+    kmeans[t] = KmeansType::New();
+    kmeans[t]->SetParameters( initialMeans );
+    kmeans[t]->SetKdTree( generators[t]->GetOutput() );
+    kmeans[t]->SetMaximumIteration( 100 );
+    kmeans[t]->SetCentroidPositionChangesThreshold( 0.0 );
+    kmeans[t]->SetNumberOfThreads( kdTreeThreads[t] );
+    itk::TimeProbe kmeansTime;
+    kmeansTime.Start();
+    kmeans[t]->StartOptimization();
+    kmeansTime.Stop();
+    std::cout << kdTreeThreads[t] << " threads: k-d tree " << treeTime.GetMean()
+              << " s, k-means " << kmeansTime.GetMean() << " s, "
+              << kmeans[t]->GetCurrentIteration() << " iterations" << std::endl;
+
+    if( !SameTrees( generators[0]->GetOutput()->GetRoot(), generators[t]->GetOutput()->GetRoot() ) )
+      {
+      std::cerr << "The k-d tree generated with " << kdTreeThreads[t]
+                << " threads differs from the serial one" << std::endl;
+      return EXIT_FAILURE;
+      }
+    for( unsigned int i = 0; i < 2 * NumberOfClasses; ++i )
+      {
+      if( !Close( kmeans[0]->GetParameters()[i], kmeans[t]->GetParameters()[i] ) )
+        {
+        std::cerr << "Mean " << i << " is " << kmeans[t]->GetParameters()[i] << " with "
+                  << kdTreeThreads[t] << " threads, " << kmeans[0]->GetParameters()[i]
+                  << " with one" << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+  std::cout << "k-means: " << kmeans[0]->GetParameters() << std::endl;
+
+  kmeans[2]->Print( std::cout );
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,249 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkListSample.h"
+#include "itkImageToListSampleAdaptor.h"
+#include "itkVectorImage.h"
+#include "itkCovarianceSampleFilter.h"
+#include "itkMahalanobisDistanceMetric.h"
+#include "itkGaussianMembershipFunction.h"
+#include "itkImageRegionIterator.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkTimeProbe.h"
+
+namespace
+{
+const unsigned int Dimension = 3;
+
+typedef itk::Vector< float, Dimension >                             FixedVectorType;
+typedef itk::Array< float >                                         ResizableVectorType;
+typedef itk::Statistics::ListSample< FixedVectorType >              FixedSampleType;
+typedef itk::Statistics::ListSample< ResizableVectorType >          ResizableSampleType;
+typedef itk::Image< FixedVectorType, 3 >                            ImageType;
+typedef itk::Statistics::ImageToListSampleAdaptor< ImageType >      AdaptorType;
+
+// Compute the mean and the covariance of a sample, and check them against
+// the ones computed from its measurement vectors one at a time.
+template< class TSample >
+bool SameMoments(const TSample *sample, const ResizableSampleType *reference, const char *name)
+{
+  typedef itk::Statistics::CovarianceSampleFilter< TSample >             FilterType;
+  typedef itk::Statistics::CovarianceSampleFilter< ResizableSampleType > ReferenceFilterType;
+
+  typename FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( sample );
+  itk::TimeProbe time;
+  time.Start();
+  filter->Update();
+  time.Stop();
+
+  typename ReferenceFilterType::Pointer referenceFilter = ReferenceFilterType::New();
+  referenceFilter->SetInput( reference );
+  itk::TimeProbe referenceTime;
+  referenceTime.Start();
+  referenceFilter->Update();
+  referenceTime.Stop();
+  std::cout << name << ": mean and covariance " << time.GetMean() << " s, one vector at a time "
+            << referenceTime.GetMean() << " s" << std::endl;
+
+  for( unsigned int i = 0; i < Dimension; ++i )
+    {
+    if( filter->GetMean()[i] != referenceFilter->GetMean()[i] )
+      {
+      std::cerr << name << ": mean " << i << " is " << filter->GetMean()[i] << " instead of "
+                << referenceFilter->GetMean()[i] << std::endl;
+      return false;
+      }
+    for( unsigned int j = 0; j < Dimension; ++j )
+      {
+      if( filter->GetCovarianceMatrix()(i, j) != referenceFilter->GetCovarianceMatrix()(i, j) )
+        {
+        std::cerr << name << ": covariance (" << i << ", " << j << ") is "
+                  << filter->GetCovarianceMatrix()(i, j) << " instead of "
+                  << referenceFilter->GetCovarianceMatrix()(i, j) << std::endl;
+        return false;
+        }
+      }
+    }
+  return true;
+}
+}
+
+int itkSampleMeasurementBufferTest(int, char* [] )
+{
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator GeneratorType;
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize( 1357 );
+
+  // The same measurements in an image, in a list of fixed length vectors,
+  // and in a list of resizable ones
+  ImageType::SizeType size;
+  size[0] = 61;
+  size[1] = 47;
+  size[2] = 35;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+
+  FixedSampleType::Pointer fixedSample = FixedSampleType::New();
+  ResizableSampleType::Pointer resizableSample = ResizableSampleType::New();
+  resizableSample->SetMeasurementVectorSize( Dimension );
+  itk::ImageRegionIterator< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for( ; !it.IsAtEnd(); ++it )
+    {
+    FixedVectorType mv;
+    mv[0] = static_cast< float >( generator->GetNormalVariate( 10.0, 4.0 ) );
+    mv[1] = static_cast< float >( generator->GetNormalVariate( -3.0, 1.0 ) + 0.5 * mv[0] );
+    mv[2] = static_cast< float >( 1000.0 * generator->GetVariate() );
+    it.Set( mv );
+    fixedSample->PushBack( mv );
+    ResizableVectorType rv( Dimension );
+    for( unsigned int i = 0; i < Dimension; ++i )
+      {
+      rv[i] = mv[i];
+      }
+    resizableSample->PushBack( rv );
+    }
+
+  AdaptorType::Pointer adaptor = AdaptorType::New();
+  adaptor->SetImage( image );
+
+  // Only the fixed length vectors and the image pixels are contiguous
+  const float *imageBuffer = image->GetBufferPointer()->GetDataPointer();
+  if( adaptor->GetMeasurementBuffer() != imageBuffer
+      || fixedSample->GetMeasurementBuffer() != fixedSample->GetMeasurementVector( 0 ).GetDataPointer()
+      || resizableSample->GetMeasurementBuffer() != 0
+      || FixedSampleType::New()->GetMeasurementBuffer() != 0 )
+    {
+    std::cerr << "Wrong measurement buffers" << std::endl;
+    return EXIT_FAILURE;
+    }
+  for( unsigned int id = 0; id < fixedSample->Size(); id += 997 )
+    {
+    for( unsigned int i = 0; i < Dimension; ++i )
+      {
+      if( adaptor->GetMeasurementBuffer()[id * Dimension + i] != adaptor->GetMeasurementVector( id )[i]
+          || fixedSample->GetMeasurementBuffer()[id * Dimension + i] != fixedSample->GetMeasurementVector( id )[i] )
+        {
+        std::cerr << "Measurement " << i << " of instance " << id << " is not in the buffer" << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  typedef itk::Image< short, 2 >                                 ScalarImageType;
+  typedef itk::VectorImage< float, 2 >                           VectorImageType;
+  ScalarImageType::Pointer scalarImage = ScalarImageType::New();
+  ScalarImageType::SizeType scalarSize;
+  scalarSize.Fill( 8 );
+  scalarImage->SetRegions( scalarSize );
+  scalarImage->Allocate();
+  VectorImageType::Pointer vectorImage = VectorImageType::New();
+  vectorImage->SetRegions( scalarSize );
+  vectorImage->SetVectorLength( 2 );
+  vectorImage->Allocate();
+  itk::Statistics::ImageToListSampleAdaptor< ScalarImageType >::Pointer scalarAdaptor =
+    itk::Statistics::ImageToListSampleAdaptor< ScalarImageType >::New();
+  scalarAdaptor->SetImage( scalarImage );
+  itk::Statistics::ImageToListSampleAdaptor< VectorImageType >::Pointer vectorAdaptor =
+    itk::Statistics::ImageToListSampleAdaptor< VectorImageType >::New();
+  vectorAdaptor->SetImage( vectorImage );
+  if( scalarAdaptor->GetMeasurementBuffer() != scalarImage->GetBufferPointer()
+      || vectorAdaptor->GetMeasurementBuffer() != 0 )
+    {
+    std::cerr << "Wrong measurement buffers of the scalar or vector image adaptors" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Running through the buffers sums the same values in the same order
+  if( !SameMoments< FixedSampleType >( fixedSample, resizableSample, "ListSample" )
+      || !SameMoments< AdaptorType >( adaptor, resizableSample, "ImageToListSampleAdaptor" ) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Distances and densities against the products of vnl
+  typedef itk::Statistics::CovarianceSampleFilter< FixedSampleType > CovarianceFilterType;
+  CovarianceFilterType::Pointer covarianceFilter = CovarianceFilterType::New();
+  covarianceFilter->SetInput( fixedSample );
+  covarianceFilter->Update();
+
+  typedef itk::Statistics::MahalanobisDistanceMetric< FixedVectorType >  DistanceType;
+  typedef itk::Statistics::GaussianMembershipFunction< FixedVectorType > MembershipType;
+  DistanceType::Pointer distance = DistanceType::New();
+  DistanceType::MeanVectorType mean( Dimension );
+  for( unsigned int i = 0; i < Dimension; ++i )
+    {
+    mean[i] = covarianceFilter->GetMean()[i];
+    }
+  distance->SetMean( mean );
+  distance->SetCovariance( covarianceFilter->GetCovarianceMatrix().GetVnlMatrix() );
+  MembershipType::Pointer membership = MembershipType::New();
+  membership->SetMean( covarianceFilter->GetMean() );
+  membership->SetCovariance( covarianceFilter->GetCovarianceMatrix() );
+
+  const vnl_matrix< double > & inverse = distance->GetInverseCovariance();
+  const double preFactor = 1.0 / ( vcl_pow( 2.0 * vnl_math::pi, 0.5 * Dimension )
+                                   * vcl_sqrt( vnl_determinant( distance->GetCovariance() ) ) );
+  const FixedVectorType origin = fixedSample->GetMeasurementVector( 17 );
+  double distanceSum = 0.0;
+  double densitySum = 0.0;
+  itk::TimeProbe time;
+  time.Start();
+  for( unsigned int id = 0; id < fixedSample->Size(); ++id )
+    {
+    distanceSum += distance->Evaluate( fixedSample->GetMeasurementVector( id ) );
+    densitySum += membership->Evaluate( fixedSample->GetMeasurementVector( id ) );
+    }
+  time.Stop();
+  std::cout << "Mahalanobis distance and Gaussian density of " << fixedSample->Size()
+            << " measurements: " << time.GetMean() << " s, sums " << distanceSum
+            << " and " << densitySum << std::endl;
+
+  for( unsigned int id = 0; id < fixedSample->Size(); id += 101 )
+    {
+    const FixedVectorType & mv = fixedSample->GetMeasurementVector( id );
+    vnl_vector< double > diff( Dimension );
+    vnl_vector< double > pairDiff( Dimension );
+    for( unsigned int i = 0; i < Dimension; ++i )
+      {
+      diff[i] = mv[i] - mean[i];
+      pairDiff[i] = mv[i] - origin[i];
+      }
+    const double squaredDistance = dot_product( diff, inverse * diff );
+    const double expectedDistance = vcl_sqrt( squaredDistance );
+    const double expectedPairDistance = vcl_sqrt( dot_product( pairDiff, inverse * pairDiff ) );
+    const double expectedDensity = preFactor * vcl_exp( -0.5 * squaredDistance );
+    if( vnl_math_abs( distance->Evaluate( mv ) - expectedDistance ) > 1.0e-9 * ( 1.0 + expectedDistance )
+        || vnl_math_abs( distance->Evaluate( mv, origin ) - expectedPairDistance )
+           > 1.0e-9 * ( 1.0 + expectedPairDistance )
+        || vnl_math_abs( membership->Evaluate( mv ) - expectedDensity ) > 1.0e-9 * expectedDensity )
+      {
+      std::cerr << "Instance " << id << ": distance " << distance->Evaluate( mv ) << " instead of "
+                << expectedDistance << ", distance to instance 17 " << distance->Evaluate( mv, origin )
+                << " instead of " << expectedPairDistance << ", density " << membership->Evaluate( mv )
+                << " instead of " << expectedDensity << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  adaptor->Print( std::cout );
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,232 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkScalarImageToCooccurrenceMatrixFilter.h"
+#include "itkScalarImageToRunLengthMatrixFilter.h"
+#include "itkScalarImageToRunLengthFeaturesFilter.h"
+#include "itkScalarImageToTextureFeaturesFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkTimeProbe.h"
+
+namespace
+{
+typedef itk::Image< short, 3 >                                 ImageType;
+typedef itk::Statistics::MersenneTwisterRandomVariateGenerator GeneratorType;
+
+template< class THistogram >
+bool SameHistograms(const THistogram *a, const THistogram *b, const char *name)
+{
+  if( a->Size() != b->Size() || a->GetTotalFrequency() != b->GetTotalFrequency() )
+    {
+    std::cerr << name << ": total frequencies " << a->GetTotalFrequency()
+              << " with one thread, " << b->GetTotalFrequency() << " with several" << std::endl;
+    return false;
+    }
+  for( unsigned int i = 0; i < a->Size(); ++i )
+    {
+    if( a->GetFrequency( i ) != b->GetFrequency( i ) )
+      {
+      std::cerr << name << ": bin " << i << " is " << a->GetFrequency( i )
+                << " with one thread, " << b->GetFrequency( i ) << " with several" << std::endl;
+      return false;
+      }
+    }
+  std::cout << name << ": total frequency " << a->GetTotalFrequency() << std::endl;
+  return true;
+}
+
+template< class TFilter >
+bool SameFeatures(const TFilter *a, const TFilter *b, const char *name)
+{
+  for( unsigned int i = 0; i < a->GetFeatureMeans()->size(); ++i )
+    {
+    if( a->GetFeatureMeans()->ElementAt( i ) != b->GetFeatureMeans()->ElementAt( i )
+        || a->GetFeatureStandardDeviations()->ElementAt( i ) !=
+           b->GetFeatureStandardDeviations()->ElementAt( i ) )
+      {
+      std::cerr << name << ": feature " << i << " is " << a->GetFeatureMeans()->ElementAt( i )
+                << " with one thread, " << b->GetFeatureMeans()->ElementAt( i )
+                << " with several" << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+}
+
+int itkScalarImageToTextureMatricesThreadsTest(int, char* [] )
+{
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize( 9753 );
+
+  // Blocks of a few gray levels with some noise, so that there are runs of
+  // many lengths, and a mask made of slabs
+  ImageType::SizeType size;
+  size[0] = 45;
+  size[1] = 38;
+  size[2] = 21;
+  ImageType::IndexType start;
+  start[0] = -3;
+  start[1] = 4;
+  start[2] = 1;
+  ImageType::RegionType region( start, size );
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( region );
+  image->Allocate();
+  ImageType::Pointer mask = ImageType::New();
+  mask->SetRegions( region );
+  mask->Allocate();
+
+  itk::ImageRegionIterator< ImageType > it( image, region );
+  itk::ImageRegionIterator< ImageType > mit( mask, region );
+  for( ; !it.IsAtEnd(); ++it, ++mit )
+    {
+    const ImageType::IndexType idx = it.GetIndex();
+    const short level = static_cast< short >( ( ( idx[0] + 3 ) / 5 + idx[1] / 3 + idx[2] / 4 ) % 8 );
+    it.Set( generator->GetVariate() < 0.1 ? static_cast< short >( generator->GetIntegerVariate( 7 ) ) : level );
+    mit.Set( ( idx[0] + idx[1] ) % 7 < 5 ? 1 : 0 );
+    }
+
+  // The offsets of the previous neighbors, with their signs reversed for
+  // some, and a longer one
+  typedef itk::Statistics::ScalarImageToCooccurrenceMatrixFilter< ImageType > CooccurrenceType;
+  typedef itk::Statistics::ScalarImageToRunLengthMatrixFilter< ImageType >    RunLengthType;
+  RunLengthType::OffsetVectorPointer offsets = RunLengthType::OffsetVector::New();
+  itk::Neighborhood< short, 3 > hood;
+  hood.SetRadius( 1 );
+  for( unsigned int d = 0; d < hood.GetCenterNeighborhoodIndex(); ++d )
+    {
+    ImageType::OffsetType offset = hood.GetOffset( d );
+    if( d % 3 == 0 )
+      {
+      for( unsigned int i = 0; i < 3; ++i )
+        {
+        offset[i] = -offset[i];
+        }
+      }
+    offsets->push_back( offset );
+    }
+  ImageType::OffsetType longOffset;
+  longOffset[0] = 2;
+  longOffset[1] = -1;
+  longOffset[2] = 3;
+  offsets->push_back( longOffset );
+
+  for( unsigned int masked = 0; masked < 2; ++masked )
+    {
+    const itk::ThreadIdType numbersOfThreads[] = { 1, 3, 7 };
+    CooccurrenceType::Pointer cooccurrences[3];
+    RunLengthType::Pointer    runLengths[3];
+    for( unsigned int t = 0; t < 3; ++t )
+      {
+      cooccurrences[t] = CooccurrenceType::New();
+      cooccurrences[t]->SetInput( image );
+      cooccurrences[t]->SetOffsets( offsets.GetPointer() );
+      cooccurrences[t]->SetNumberOfBinsPerAxis( 8 );
+      cooccurrences[t]->SetPixelValueMinMax( 0, 7 );
+      cooccurrences[t]->SetNumberOfThreads( numbersOfThreads[t] );
+
+      runLengths[t] = RunLengthType::New();
+      runLengths[t]->SetInput( image );
+      runLengths[t]->SetOffsets( offsets );
+      runLengths[t]->SetNumberOfBinsPerAxis( 8 );
+      runLengths[t]->SetPixelValueMinMax( 0, 7 );
+      runLengths[t]->SetDistanceValueMinMax( 0, 12 );
+      runLengths[t]->SetNumberOfThreads( numbersOfThreads[t] );
+      if( masked )
+        {
+        cooccurrences[t]->SetMaskImage( mask );
+        runLengths[t]->SetMaskImage( mask );
+        }
+
+      itk::TimeProbe cooccurrenceTime;
+      cooccurrenceTime.Start();
+      cooccurrences[t]->Update();
+      cooccurrenceTime.Stop();
+      itk::TimeProbe runLengthTime;
+      runLengthTime.Start();
+      runLengths[t]->Update();
+      runLengthTime.Stop();
+      std::cout << "Masked " << masked << ", " << numbersOfThreads[t] << " threads: co-occurrence "
+                << cooccurrenceTime.GetMean() << " s, run length " << runLengthTime.GetMean()
+                << " s" << std::endl;
+      }
+
+    for( unsigned int t = 1; t < 3; ++t )
+      {
+      if( !SameHistograms( cooccurrences[0]->GetOutput(), cooccurrences[t]->GetOutput(), "co-occurrence" )
+          || !SameHistograms( runLengths[0]->GetOutput(), runLengths[t]->GetOutput(), "run length" ) )
+        {
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  // Each run of a line is counted once: without a mask nor bounds on the
+  // distances, the runs along (1, 0, 0) with a single bin are the rows
+  RunLengthType::Pointer rows = RunLengthType::New();
+  rows->SetInput( image );
+  rows->SetOffset( hood.GetOffset( hood.GetCenterNeighborhoodIndex() + 1 ) );
+  rows->SetNumberOfBinsPerAxis( 1 );
+  rows->SetPixelValueMinMax( 0, 8 );
+  rows->SetDistanceValueMinMax( 0, 1000 );
+  rows->SetNumberOfThreads( 3 );
+  rows->Update();
+  if( rows->GetOutput()->GetTotalFrequency() != size[1] * size[2] )
+    {
+    std::cerr << rows->GetOutput()->GetTotalFrequency() << " runs along the rows instead of "
+              << size[1] * size[2] << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The features filters compute their matrices with their own threads
+  typedef itk::Statistics::ScalarImageToRunLengthFeaturesFilter< ImageType > RunLengthFeaturesType;
+  typedef itk::Statistics::ScalarImageToTextureFeaturesFilter< ImageType >   TextureFeaturesType;
+  RunLengthFeaturesType::Pointer runLengthFeatures[2];
+  TextureFeaturesType::Pointer   textureFeatures[2];
+  for( unsigned int t = 0; t < 2; ++t )
+    {
+    runLengthFeatures[t] = RunLengthFeaturesType::New();
+    runLengthFeatures[t]->SetInput( image );
+    runLengthFeatures[t]->SetMaskImage( mask );
+    runLengthFeatures[t]->SetNumberOfBinsPerAxis( 8 );
+    runLengthFeatures[t]->SetPixelValueMinMax( 0, 7 );
+    runLengthFeatures[t]->SetDistanceValueMinMax( 0, 12 );
+    runLengthFeatures[t]->SetNumberOfThreads( t == 0 ? 1 : 4 );
+    runLengthFeatures[t]->Update();
+
+    textureFeatures[t] = TextureFeaturesType::New();
+    textureFeatures[t]->SetInput( image );
+    textureFeatures[t]->SetNumberOfBinsPerAxis( 8 );
+    textureFeatures[t]->SetPixelValueMinMax( 0, 7 );
+    textureFeatures[t]->SetNumberOfThreads( t == 0 ? 1 : 4 );
+    textureFeatures[t]->Update();
+    }
+  if( !SameFeatures< RunLengthFeaturesType >( runLengthFeatures[0], runLengthFeatures[1], "run length features" )
+      || !SameFeatures< TextureFeaturesType >( textureFeatures[0], textureFeatures[1], "texture features" ) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  rows->Print( std::cout );
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
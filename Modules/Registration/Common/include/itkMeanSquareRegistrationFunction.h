@@ -128,12 +128,13 @@ public:
   {
     GlobalDataStruct *global = new GlobalDataStruct();
 
+    global->m_Energy = 0.0;
     return global;
   }
 
-  /** Release memory for global data structure. */
-  virtual void ReleaseGlobalDataPointer(void *GlobalData) const
-  { delete (GlobalDataStruct *)GlobalData;  }
+  /** Add the energy of the global data structure to the energy of the
+   * function and release its memory. */
+  virtual void ReleaseGlobalDataPointer(void *GlobalData) const;
 
   /** Set the object's state before each iteration. */
   virtual void InitializeIteration();
@@ -153,9 +154,11 @@ protected:
   typedef ConstNeighborhoodIterator< FixedImageType > FixedImageNeighborhoodIteratorType;
 
   /** A global data type for this class of equation. Used to store
-   * iterators for the fixed image. */
+   * iterators for the fixed image and the energy of the pixels of a
+   * thread. */
   struct GlobalDataStruct {
     FixedImageNeighborhoodIteratorType m_FixedImageIterator;
+    double m_Energy;
   };
 private:
   MeanSquareRegistrationFunction(const Self &); //purposely not implemented
@@ -178,6 +181,9 @@ private:
 
   /** Threshold below which two intensity value are assumed to match. */
   double m_IntensityDifferenceThreshold;
+
+  /** Mutex lock to protect modification to the energy. */
+  mutable SimpleFastMutexLock m_EnergyCalculationLock;
 };
 } // end namespace itk
 
@@ -108,7 +108,7 @@ template< class TFixedImage, class TMovingImage, class TDisplacementField >
 typename MeanSquareRegistrationFunction< TFixedImage, TMovingImage, TDisplacementField >
 ::PixelType
 MeanSquareRegistrationFunction< TFixedImage, TMovingImage, TDisplacementField >
-::ComputeUpdate( const NeighborhoodType & it, void *itkNotUsed(globalData),
+::ComputeUpdate( const NeighborhoodType & it, void *gd,
                  const FloatOffsetType & itkNotUsed(offset) )
 {
   // Get fixed image related information
@@ -140,7 +140,15 @@ MeanSquareRegistrationFunction< TFixedImage, TMovingImage, TDisplacementField >
 
   // Compute update
   const double speedValue = fixedValue - movingValue;
-  this->m_Energy += speedValue * speedValue;
+  GlobalDataStruct *globalData = (GlobalDataStruct *)gd;
+  if ( globalData )
+    {
+    globalData->m_Energy += speedValue * speedValue;
+    }
+  else
+    {
+    this->m_Energy += speedValue * speedValue;
+    }
 
   const bool normalizemetric = this->GetNormalizeGradient();
   double     denominator = 1.0;
@@ -168,6 +176,23 @@ MeanSquareRegistrationFunction< TFixedImage, TMovingImage, TDisplacementField >
     }
   return update;
 }
+
+/**
+ * Update the energy and release the per-thread-global data.
+ */
+template< class TFixedImage, class TMovingImage, class TDisplacementField >
+void
+MeanSquareRegistrationFunction< TFixedImage, TMovingImage, TDisplacementField >
+::ReleaseGlobalDataPointer(void *gd) const
+{
+  GlobalDataStruct *globalData = (GlobalDataStruct *)gd;
+
+  m_EnergyCalculationLock.Lock();
+  this->m_Energy += globalData->m_Energy;
+  m_EnergyCalculationLock.Unlock();
+
+  delete globalData;
+}
 } // end namespace itk
 
 #endif
@@ -31,6 +31,7 @@
 #include "itkDerivativeOperator.h"
 #include "itkForwardDifferenceOperator.h"
 #include "itkLinearInterpolateImageFunction.h"
+#include "itkMultiThreader.h"
 #include "vnl/vnl_math.h"
 
 #include "itkDemonsRegistrationFunction.h"
@@ -61,6 +62,17 @@ namespace fem
  * This region size may be set by the user by calling SetMetricRadius.
  * As the metric derivative computation evolves, performance should improve
  * and more functionality will be available (such as scale selection).
+ *
+ * ApplyLoads() computes the loads of the elements on NumberOfThreads
+ * threads. The elements are split into chunks of a fixed size, and each
+ * chunk walks the field with its own neighborhood iterator and adds the
+ * energy of the metric to its own global data structure (see
+ * FiniteDifferenceFunction::GetGlobalDataPointer()). The global data of the
+ * chunks are released in the order of the elements, so the loads and the
+ * energy do not depend on the number of threads. The random samples of the
+ * mutual information metric are drawn from a generator per chunk, seeded
+ * from a number drawn once per call from the global generator (see
+ * MIRegistrationFunction::SetGlobalDataChunkIndex()).
  * \ingroup ITKFEMRegistration
  */
 template <class TMoving, class TFixed>
@@ -329,10 +341,53 @@ public:
 
   virtual void ApplyLoad(Element::ConstPointer element, Element::VectorType & Fe);
 
+  /** Compute the loads of the elements on several threads. */
+  virtual void ApplyLoads(const ElementPointersVectorType & elements, std::vector<Element::VectorType> & F);
+
+  /** Set/Get the number of threads ApplyLoads() runs on. The default is the
+   * global default number of threads of MultiThreader. */
+  void SetNumberOfThreads(ThreadIdType numberOfThreads)
+  {
+    m_NumberOfThreads = std::min( std::max( numberOfThreads, ThreadIdType(1) ), ThreadIdType(ITK_MAX_THREADS) );
+  }
+
+  ThreadIdType GetNumberOfThreads() const
+  {
+    return m_NumberOfThreads;
+  }
+
 protected:
 private:
   FiniteDifferenceFunctionLoad(); // cannot be private until we always use smart pointers
 
+  /** Initialize the metric if it is not set yet. Return false if the
+   * images or the field are not set. */
+  bool InitializeLoad();
+
+  /** Compute the load at the point Gpos. The neighborhood iterator nD
+   * walks the field, and the metric adds its energy to globalData. */
+  void ComputeForce(const FEMVectorType & Gpos, FieldIteratorType & nD, void *globalData,
+                    FEMVectorType & force) const;
+
+  /** Integrate the loads over the integration points of an element. */
+  void ComputeElementForce(const Element *element, FieldIteratorType & nD, void *globalData,
+                           Element::VectorType & F) const;
+
+  /** The elements of ApplyLoads(), split into chunks of ElementsPerChunk
+   * elements, and the global data of the metric of each chunk. */
+  struct ApplyLoadsThreadStruct
+  {
+    const Self *                       Load;
+    const ElementPointersVectorType *  Elements;
+    std::vector<Element::VectorType> * Forces;
+    unsigned int                       ElementsPerChunk;
+    std::vector<void *>                GlobalData;
+    std::vector<unsigned int>          FailedElements;
+  };
+
+  /** Compute the loads of the chunks of elements of a thread. */
+  static ITK_THREAD_RETURN_TYPE ApplyLoadsThreaderCallback(void *arg);
+
   MovingPointer    m_MovingImage;
   FixedPointer     m_FixedImage;
   MovingRadiusType m_MetricRadius;                                   /** used by the metric to set region size for fixed
@@ -351,6 +406,9 @@ private:
 
   typename DisplacementFieldType::Pointer             m_DisplacementField;
 
+  ThreadIdType           m_NumberOfThreads;
+  MultiThreader::Pointer m_Threader;
+
 };
 
 }
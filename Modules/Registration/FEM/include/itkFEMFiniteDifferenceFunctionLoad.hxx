@@ -47,6 +47,7 @@ FiniteDifferenceFunctionLoad<TMoving, TFixed>::CreateAnother(void) const
   copyPtr->m_WhichMetric = this->m_WhichMetric;
   copyPtr->m_DifferenceFunction = this->m_DifferenceFunction;
   copyPtr->m_DisplacementField = this->m_DisplacementField;
+  copyPtr->m_NumberOfThreads = this->m_NumberOfThreads;
 
   smartPtr = static_cast<Pointer>(copyPtr);
 
@@ -67,6 +68,8 @@ FiniteDifferenceFunctionLoad<TMoving, TFixed>::FiniteDifferenceFunctionLoad()
   m_DifferenceFunction = NULL;
   m_DisplacementField = NULL;
 
+  m_NumberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
+  m_Threader = MultiThreader::New();
 }
 
 template <class TMoving, class TFixed>
@@ -213,9 +216,47 @@ FiniteDifferenceFunctionLoad<TMoving, TFixed>::EvaluateMetricGivenSolution( Elem
 }
 
 
+template <class TMoving, class TFixed>
+bool
+FiniteDifferenceFunctionLoad<TMoving, TFixed>::InitializeLoad()
+{
+  if( !m_DifferenceFunction || !m_DisplacementField || !m_FixedImage || !m_MovingImage )
+    {
+    this->InitializeIteration();
+    if( !m_DisplacementField || !m_FixedImage || !m_MovingImage )
+      {
+      //std::cout << " input data {field,fixed/moving image} are not set " << std::endl;
+      return false;
+      }
+    //std::cout << " sizes " << m_DisplacementField->GetLargestPossibleRegion().GetSize() << std::endl;
+    //std::cout << "  image " << m_FixedImage->GetLargestPossibleRegion().GetSize() << std::endl;
+    }
+  return true;
+}
+
 template <class TMoving, class TFixed>
 typename FiniteDifferenceFunctionLoad<TMoving, TFixed>::FEMVectorType
 FiniteDifferenceFunctionLoad<TMoving, TFixed>::Fe( FEMVectorType  Gpos )
+{
+  FEMVectorType femVec;
+
+  femVec.set_size(ImageDimension);
+  femVec.fill(0.0);
+
+  if( !this->InitializeLoad() )
+    {
+    return femVec;
+    }
+
+  FieldIteratorType nD(m_MetricRadius, m_DisplacementField, m_DisplacementField->GetLargestPossibleRegion() );
+  this->ComputeForce(Gpos, nD, NULL, femVec);
+  return femVec;
+}
+
+template <class TMoving, class TFixed>
+void
+FiniteDifferenceFunctionLoad<TMoving, TFixed>::ComputeForce
+  ( const FEMVectorType & Gpos, FieldIteratorType & nD, void *globalData, FEMVectorType & femVec) const
 {
 
   // We assume the vector input is of size 2*ImageDimension.
@@ -228,24 +269,11 @@ FiniteDifferenceFunctionLoad<TMoving, TFixed>::Fe( FEMVectorType  Gpos )
   // the translation parameters as provided by the vector field at p.
   // ------------------------------------------------------------
 
-  VectorType    OutVec;
-  FEMVectorType femVec;
+  VectorType OutVec;
 
   femVec.set_size(ImageDimension);
   femVec.fill(0.0);
 
-  if( !m_DifferenceFunction || !m_DisplacementField || !m_FixedImage || !m_MovingImage )
-    {
-    this->InitializeIteration();
-    if( !m_DisplacementField || !m_FixedImage || !m_MovingImage )
-      {
-      //std::cout << " input data {field,fixed/moving image} are not set " << std::endl;
-      return femVec;
-      }
-    //std::cout << " sizes " << m_DisplacementField->GetLargestPossibleRegion().GetSize() << std::endl;
-    //std::cout << "  image " << m_FixedImage->GetLargestPossibleRegion().GetSize() << std::endl;
-    }
-
   typedef typename TMoving::IndexType::IndexValueType OIndexValueType;
   typename TMoving::IndexType oindex;
   typename TMoving::PointType physicalPoint;
@@ -256,7 +284,7 @@ FiniteDifferenceFunctionLoad<TMoving, TFixed>::Fe( FEMVectorType  Gpos )
     {
     if( vnl_math_isnan(Gpos[k])  || vnl_math_isinf(Gpos[k]) || vcl_fabs(Gpos[k]) > 1.e33 )
       {
-      return femVec;
+      return;
       }
 
       physicalPoint[k] = Gpos[k];
@@ -274,13 +302,11 @@ FiniteDifferenceFunctionLoad<TMoving, TFixed>::Fe( FEMVectorType  Gpos )
 
   if( !inimage )
     {
-    return femVec;
+    return;
     }
 
-  FieldIteratorType nD(m_MetricRadius, m_DisplacementField, m_DisplacementField->GetLargestPossibleRegion() );
   nD.SetLocation(oindex);
 
-  void* globalData = NULL;
   OutVec = m_DifferenceFunction->ComputeUpdate(nD, globalData);
   for( k = 0; k < ImageDimension; k++ )
     {
@@ -293,18 +319,33 @@ FiniteDifferenceFunctionLoad<TMoving, TFixed>::Fe( FEMVectorType  Gpos )
       femVec[k] = OutVec[k] * m_Sign;
       }
     }
-  return femVec;
 }
 
 template <class TMoving, class TFixed>
 void
 FiniteDifferenceFunctionLoad<TMoving, TFixed>::ApplyLoad
   ( Element::ConstPointer element, Element::VectorType & F)
+{
+  if( !this->InitializeLoad() )
+    {
+    F.set_size(element->GetNumberOfDegreesOfFreedom() );
+    F.fill(0.0);
+    return;
+    }
+
+  FieldIteratorType nD(m_MetricRadius, m_DisplacementField, m_DisplacementField->GetLargestPossibleRegion() );
+  this->ComputeElementForce(element.GetPointer(), nD, NULL, F);
+}
+
+template <class TMoving, class TFixed>
+void
+FiniteDifferenceFunctionLoad<TMoving, TFixed>::ComputeElementForce
+  ( const Element *element, FieldIteratorType & nD, void *globalData, Element::VectorType & F) const
 {
   // Order of integration
   // FIXME: Allow changing the order of integration by setting a
   //        static member within an element base class.
-  unsigned int order = GetNumberOfIntegrationPoints();
+  unsigned int order = m_NumberOfIntegrationPoints;
 
   const unsigned int NumIntegrationPoints = element->GetNumberOfIntegrationPoints(order);
   const unsigned int NumDegreesOfFreedom = element->GetNumberOfDegreesOfFreedomPerNode();
@@ -338,9 +379,7 @@ FiniteDifferenceFunctionLoad<TMoving, TFixed>::ApplyLoad
     // that it is equal to the number of DOFs per node. If the Fg returned
     // a vector with less dimensions, we add zero elements. If the Fg
     // returned a vector with more dimensions, we remove the extra dimensions.
-    force.fill(0.0);
-
-    force = this->Fe(gip);
+    this->ComputeForce(gip, nD, globalData, force);
     // Calculate the equivalent nodal loads
     for( unsigned int n = 0; n < NumNodes; n++ )
       {
@@ -353,6 +392,125 @@ FiniteDifferenceFunctionLoad<TMoving, TFixed>::ApplyLoad
     }
 }
 
+template <class TMoving, class TFixed>
+void
+FiniteDifferenceFunctionLoad<TMoving, TFixed>::ApplyLoads
+  ( const ElementPointersVectorType & elements, std::vector<Element::VectorType> & F)
+{
+  const unsigned int numberOfElements = static_cast<unsigned int>( elements.size() );
+
+  F.resize(numberOfElements);
+  if( numberOfElements == 0 )
+    {
+    return;
+    }
+  if( !this->InitializeLoad() )
+    {
+    for( unsigned int i = 0; i < numberOfElements; i++ )
+      {
+      F[i].set_size(elements[i]->GetNumberOfDegreesOfFreedom() );
+      F[i].fill(0.0);
+      }
+    return;
+    }
+
+  // The chunks do not depend on the number of threads, so that the energy
+  // is added in the same order on any number of threads.
+  const unsigned int elementsPerChunk = 64;
+  const unsigned int numberOfChunks = ( numberOfElements + elementsPerChunk - 1 ) / elementsPerChunk;
+
+  ApplyLoadsThreadStruct str;
+  str.Load = this;
+  str.Elements = &elements;
+  str.Forces = &F;
+  str.ElementsPerChunk = elementsPerChunk;
+  str.GlobalData.resize(numberOfChunks);
+  str.FailedElements.resize(numberOfChunks, numberOfElements);
+  // The mutual information draws its random samples from a generator per
+  // chunk, seeded from the index of the chunk and a base seed drawn once per
+  // call from the global generator.
+  const MIRegistrationFunctionType *miFunction =
+    dynamic_cast<const MIRegistrationFunctionType *>( m_DifferenceFunction.GetPointer() );
+  typedef typename MIRegistrationFunctionType::RandomGeneratorType RandomGeneratorType;
+  typename RandomGeneratorType::IntegerType baseSeed = 0;
+  if( miFunction )
+    {
+    baseSeed = RandomGeneratorType::GetInstance()->GetIntegerVariate();
+    }
+  for( unsigned int chunk = 0; chunk < numberOfChunks; chunk++ )
+    {
+    str.GlobalData[chunk] = m_DifferenceFunction->GetGlobalDataPointer();
+    if( miFunction )
+      {
+      miFunction->SetGlobalDataChunkIndex(str.GlobalData[chunk], chunk, baseSeed);
+      }
+    }
+
+  m_Threader->SetNumberOfThreads( std::min( m_NumberOfThreads, static_cast<ThreadIdType>( numberOfChunks ) ) );
+  m_Threader->SetSingleMethod(ApplyLoadsThreaderCallback, &str);
+  m_Threader->SingleMethodExecute();
+
+  // The metric adds the energy of the chunks in the order of the elements
+  unsigned int failedElement = numberOfElements;
+  for( unsigned int chunk = 0; chunk < numberOfChunks; chunk++ )
+    {
+    m_DifferenceFunction->ReleaseGlobalDataPointer(str.GlobalData[chunk]);
+    if( failedElement == numberOfElements )
+      {
+      failedElement = str.FailedElements[chunk];
+      }
+    }
+
+  if( failedElement < numberOfElements )
+    {
+    // Compute the load of the element again, which throws the same
+    // exception
+    this->ApplyLoad(elements[failedElement], F[failedElement]);
+    throw FEMExceptionSolution(__FILE__, __LINE__, "FiniteDifferenceFunctionLoad::ApplyLoads()",
+                               "Element load could not be computed!");
+    }
+}
+
+template <class TMoving, class TFixed>
+ITK_THREAD_RETURN_TYPE
+FiniteDifferenceFunctionLoad<TMoving, TFixed>::ApplyLoadsThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info =
+    static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  ApplyLoadsThreadStruct *str =
+    static_cast<ApplyLoadsThreadStruct *>( info->UserData );
+
+  const Self *       load = str->Load;
+  const unsigned int numberOfChunks = static_cast<unsigned int>( str->GlobalData.size() );
+  const unsigned int numberOfElements = static_cast<unsigned int>( str->Elements->size() );
+
+  // The iterator is moved to each integration point of the thread
+  FieldIteratorType nD(load->m_MetricRadius, load->m_DisplacementField,
+                       load->m_DisplacementField->GetLargestPossibleRegion() );
+
+  // the threader may run fewer threads than chunks
+  for( unsigned int chunk = info->ThreadID; chunk < numberOfChunks;
+       chunk += info->NumberOfThreads )
+    {
+    const unsigned int first = chunk * str->ElementsPerChunk;
+    const unsigned int end = std::min(first + str->ElementsPerChunk, numberOfElements);
+    for( unsigned int i = first; i < end; i++ )
+      {
+      try
+        {
+        load->ComputeElementForce( ( *str->Elements )[i], nD, str->GlobalData[chunk], ( *str->Forces )[i]);
+        }
+      catch( ... )
+        {
+        str->FailedElements[chunk] = i;
+        break;
+        }
+      }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
 } // end namespace fem
 } // end namespace itk
 
@@ -373,6 +373,7 @@ void FEMRegistrationFilter<TMovingImage, TFixedImage, TFemObject>
     }
   m_Load->SetMetricRadius(r);
   m_Load->SetNumberOfIntegrationPoints(m_NumberOfIntegrationPoints[m_CurrentLevel]);
+  m_Load->SetNumberOfThreads(this->GetNumberOfThreads() );
   m_Load->SetGlobalNumber(m_FEMObject->GetNumberOfLoads() + 1);
   if (m_DescentDirection == positive)
   {
@@ -1165,6 +1166,10 @@ void FEMRegistrationFilter<TMovingImage, TFixedImage, TFemObject>::MultiResSolve
       SSS->SetTimeStep(m_TimeStep);
       SSS->SetRho(m_Rho[m_CurrentLevel]);
       SSS->SetAlpha(m_Alpha);
+      // SolverCrankNicolson computes its element matrices with
+      // ComputeElementMatrixEntries(), so they can be computed concurrently
+      SSS->SetNumberOfThreads(this->GetNumberOfThreads());
+      SSS->UseMultiThreadedAssemblyOn();
 
       if ( m_CreateMeshFromImage )
         {
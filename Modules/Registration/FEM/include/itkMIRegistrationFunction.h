@@ -22,6 +22,7 @@
 #include "itkPoint.h"
 #include "itkLinearInterpolateImageFunction.h"
 #include "itkCentralDifferenceImageFunction.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
 
 namespace itk
 {
@@ -110,6 +111,10 @@ public:
   typedef CentralDifferenceImageFunction< FixedImageType > GradientCalculatorType;
   typedef typename GradientCalculatorType::Pointer         GradientCalculatorPointer;
 
+  /** Random generator type. */
+  typedef Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
+  typedef RandomGeneratorType::Pointer                      RandomGeneratorPointer;
+
   /** Set the moving image interpolator. */
   void SetMovingImageInterpolator(InterpolatorType *ptr)
   { m_MovingImageInterpolator = ptr; }
@@ -128,12 +133,26 @@ public:
   {
     GlobalDataStruct *global = new GlobalDataStruct();
 
+    global->m_MetricTotal = 0.0;
+    global->m_Energy = 0.0;
+    global->m_ChunkIndex = 0;
+    global->m_RandomGenerator = RandomGeneratorType::New();
+    global->m_RandomGenerator->Initialize(0);
     return global;
   }
 
-  /** Release memory for global data structure. */
-  virtual void ReleaseGlobalDataPointer(void *GlobalData) const
-  { delete (GlobalDataStruct *)GlobalData;  }
+  /** Set the index of the chunk of pixels that is evaluated with the global
+   * data structure, and seed its random generator with the sum of
+   * \a baseSeed and this index. A solver that evaluates the function on
+   * fixed chunks of pixels draws \a baseSeed once per pass and calls this
+   * method for each chunk, so that the random samples of a chunk do not
+   * depend on the thread that evaluates it, but vary between the passes. */
+  void SetGlobalDataChunkIndex(void *GlobalData, unsigned int chunkIndex,
+                               RandomGeneratorType::IntegerType baseSeed) const;
+
+  /** Add the metric and the energy of the global data structure to the
+   * ones of the function and release its memory. */
+  virtual void ReleaseGlobalDataPointer(void *GlobalData) const;
 
   /** Set the object's state before each iteration. */
   virtual void InitializeIteration();
@@ -156,9 +175,14 @@ protected:
   typedef ConstNeighborhoodIterator< FixedImageType > FixedImageNeighborhoodIteratorType;
 
   /** A global data type for this class of equation. Used to store
-   * iterators for the fixed image. */
+   * iterators for the fixed image, the metric and energy of the pixels
+   * of a chunk, and the generator of the random samples of the chunk. */
   struct GlobalDataStruct {
     FixedImageNeighborhoodIteratorType m_FixedImageIterator;
+    double m_MetricTotal;
+    double m_Energy;
+    unsigned int m_ChunkIndex;
+    RandomGeneratorPointer m_RandomGenerator;
   };
 
   /** The global timestep. */
@@ -188,6 +212,9 @@ private:
 
   mutable double m_MetricTotal;
 
+  /** Mutex lock to protect modification to the metric and the energy. */
+  mutable SimpleFastMutexLock m_MetricCalculationLock;
+
   unsigned int m_NumberOfSamples;
   unsigned int m_NumberOfBins;
   float        m_Minnorm;
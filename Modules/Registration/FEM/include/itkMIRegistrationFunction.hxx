@@ -19,7 +19,6 @@
 #define __itkMIRegistrationFunction_hxx
 
 #include "itkMIRegistrationFunction.h"
-#include "itkImageRandomIteratorWithIndex.h"
 #include "itkMacro.h"
 #include "vnl/vnl_math.h"
 #include "itkNeighborhoodIterator.h"
@@ -127,7 +126,7 @@ template< class TFixedImage, class TMovingImage, class TDisplacementField >
 typename MIRegistrationFunction< TFixedImage, TMovingImage, TDisplacementField >
 ::PixelType
 MIRegistrationFunction< TFixedImage, TMovingImage, TDisplacementField >
-::ComputeUpdate( const NeighborhoodType & it, void *itkNotUsed(globalData),
+::ComputeUpdate( const NeighborhoodType & it, void *gd,
                  const FloatOffsetType & itkNotUsed(offset) )
 {
   // we compute the derivative of MI w.r.t. the infinitesimal
@@ -277,17 +276,29 @@ MIRegistrationFunction< TFixedImage, TMovingImage, TDisplacementField >
     {
     typename FixedImageType::RegionType region = img->GetLargestPossibleRegion();
 
-    ImageRandomIteratorWithIndex< FixedImageType > randasamit(img, region);
-    unsigned int                                   numberOfSamples = 20;
-    randasamit.SetNumberOfSamples(numberOfSamples);
+    // The samples are drawn from the generator of the chunk, which no other
+    // thread uses. Without global data, the function is evaluated on one
+    // thread, which draws from the global generator.
+    GlobalDataStruct *     globalData = (GlobalDataStruct *)gd;
+    RandomGeneratorPointer generator = globalData ?
+                                       globalData->m_RandomGenerator :
+                                       RandomGeneratorType::GetInstance();
+    unsigned int numberOfSamples = 20;
 //  numberOfSamples=100;
 
-    indct = 0;
+    std::vector< IndexType > randomIndices(numberOfSamples);
+    for ( indct = 0; indct < numberOfSamples; indct++ )
+      {
+      for ( unsigned int dd = 0; dd < ImageDimension; dd++ )
+        {
+        randomIndices[indct][dd] = region.GetIndex()[dd]
+                                   + generator->GetIntegerVariate(region.GetSize()[dd] - 1);
+        }
+      }
 
-    randasamit.GoToBegin();
-    while ( !randasamit.IsAtEnd() &&  indct < numberOfSamples )
+    for ( unsigned int sample = 0; sample < numberOfSamples; sample++ )
       {
-      IndexType index = randasamit.GetIndex();
+      const IndexType index = randomIndices[sample];
       inimage = true;
 
       float d = 0.0;
@@ -342,10 +353,8 @@ MIRegistrationFunction< TFixedImage, TMovingImage, TDisplacementField >
           fixedGradientsA.insert(fixedGradientsA.begin(), fixedGradient);
           movingSamplesA.insert(movingSamplesA.begin(), (double)movingValue);
           sampct++;
-          indct++;
           }
         }
-      ++randasamit;
       }
     }
   // END RANDOM A SAMPLES
@@ -532,8 +541,17 @@ MIRegistrationFunction< TFixedImage, TMovingImage, TDisplacementField >
   value /= nsamp;
   value += vcl_log(nsamp);
 
-  m_MetricTotal += value;
-  this->m_Energy += value;
+  GlobalDataStruct *globalData = (GlobalDataStruct *)gd;
+  if ( globalData )
+    {
+    globalData->m_MetricTotal += value;
+    globalData->m_Energy += value;
+    }
+  else
+    {
+    m_MetricTotal += value;
+    this->m_Energy += value;
+    }
 
   derivative /= nsamp;
   derivative /= vnl_math_sqr(m_FixedImageStandardDeviation);
@@ -552,6 +570,40 @@ MIRegistrationFunction< TFixedImage, TMovingImage, TDisplacementField >
 
   return derivative * this->GetGradientStep();
 }
+
+/**
+ * Seed the random generator of a chunk from the base seed and its index.
+ */
+template< class TFixedImage, class TMovingImage, class TDisplacementField >
+void
+MIRegistrationFunction< TFixedImage, TMovingImage, TDisplacementField >
+::SetGlobalDataChunkIndex(void *gd, unsigned int chunkIndex,
+                          RandomGeneratorType::IntegerType baseSeed) const
+{
+  GlobalDataStruct *globalData = (GlobalDataStruct *)gd;
+
+  globalData->m_ChunkIndex = chunkIndex;
+  globalData->m_RandomGenerator->Initialize(
+    baseSeed + static_cast< RandomGeneratorType::IntegerType >( chunkIndex ) );
+}
+
+/**
+ * Update the metric and the energy and release the per-thread-global data.
+ */
+template< class TFixedImage, class TMovingImage, class TDisplacementField >
+void
+MIRegistrationFunction< TFixedImage, TMovingImage, TDisplacementField >
+::ReleaseGlobalDataPointer(void *gd) const
+{
+  GlobalDataStruct *globalData = (GlobalDataStruct *)gd;
+
+  m_MetricCalculationLock.Lock();
+  m_MetricTotal += globalData->m_MetricTotal;
+  this->m_Energy += globalData->m_Energy;
+  m_MetricCalculationLock.Unlock();
+
+  delete globalData;
+}
 } // end namespace itk
 
 #endif
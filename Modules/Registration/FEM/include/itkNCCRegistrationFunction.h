@@ -130,12 +130,14 @@ public:
   {
     GlobalDataStruct *global = new GlobalDataStruct();
 
+    global->m_MetricTotal = 0.0;
+    global->m_Energy = 0.0;
     return global;
   }
 
-  /** Release memory for global data structure. */
-  virtual void ReleaseGlobalDataPointer(void *GlobalData) const
-  { delete (GlobalDataStruct *)GlobalData;  }
+  /** Add the metric and the energy of the global data structure to the
+   * ones of the function and release its memory. */
+  virtual void ReleaseGlobalDataPointer(void *GlobalData) const;
 
   /** Set the object's state before each iteration. */
   virtual void InitializeIteration();
@@ -155,9 +157,12 @@ protected:
   typedef ConstNeighborhoodIterator< FixedImageType > FixedImageNeighborhoodIteratorType;
 
   /** A global data type for this class of equation. Used to store
-   * iterators for the fixed image. */
+   * iterators for the fixed image and the metric and energy of the pixels
+   * of a thread. */
   struct GlobalDataStruct {
     FixedImageNeighborhoodIteratorType m_FixedImageIterator;
+    double m_MetricTotal;
+    double m_Energy;
   };
 private:
   NCCRegistrationFunction(const Self &); //purposely not implemented
@@ -182,6 +187,9 @@ private:
   double m_IntensityDifferenceThreshold;
 
   mutable double m_MetricTotal;
+
+  /** Mutex lock to protect modification to the metric and the energy. */
+  mutable SimpleFastMutexLock m_MetricCalculationLock;
 };
 } // end namespace itk
 
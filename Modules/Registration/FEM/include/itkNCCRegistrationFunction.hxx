@@ -113,7 +113,7 @@ template< class TFixedImage, class TMovingImage, class TDisplacementField >
 typename NCCRegistrationFunction< TFixedImage, TMovingImage, TDisplacementField >
 ::PixelType
 NCCRegistrationFunction< TFixedImage, TMovingImage, TDisplacementField >
-::ComputeUpdate( const NeighborhoodType & it, void *itkNotUsed(globalData),
+::ComputeUpdate( const NeighborhoodType & it, void *gd,
                  const FloatOffsetType & itkNotUsed(offset) )
 {
   const IndexType oindex = it.GetIndex();
@@ -201,8 +201,17 @@ NCCRegistrationFunction< TFixedImage, TMovingImage, TDisplacementField >
       updatenorm += ( update[i] * update[i] );
       }
     updatenorm = vcl_sqrt(updatenorm);
-    m_MetricTotal += sfm * factor;
-    this->m_Energy += sfm * factor;
+    GlobalDataStruct *globalData = (GlobalDataStruct *)gd;
+    if ( globalData )
+      {
+      globalData->m_MetricTotal += sfm * factor;
+      globalData->m_Energy += sfm * factor;
+      }
+    else
+      {
+      m_MetricTotal += sfm * factor;
+      this->m_Energy += sfm * factor;
+      }
     }
   else
     {
@@ -216,6 +225,24 @@ NCCRegistrationFunction< TFixedImage, TMovingImage, TDisplacementField >
     }
   return update * this->m_GradientStep;
 }
+
+/**
+ * Update the metric and the energy and release the per-thread-global data.
+ */
+template< class TFixedImage, class TMovingImage, class TDisplacementField >
+void
+NCCRegistrationFunction< TFixedImage, TMovingImage, TDisplacementField >
+::ReleaseGlobalDataPointer(void *gd) const
+{
+  GlobalDataStruct *globalData = (GlobalDataStruct *)gd;
+
+  m_MetricCalculationLock.Lock();
+  m_MetricTotal += globalData->m_MetricTotal;
+  this->m_Energy += globalData->m_Energy;
+  m_MetricCalculationLock.Unlock();
+
+  delete globalData;
+}
 } // end namespace itk
 
 #endif
@@ -23,6 +23,8 @@
 #include "itkFEMFiniteDifferenceFunctionLoad.h"
 #include "itkImageToRectilinearFEMObjectFilter.h"
 #include "itkFEMSolver.h"
+#include "itkTimeProbe.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
 
 #include "itkImageFileWriter.h"
 
@@ -243,10 +245,16 @@ int RunTest(testImageType* fixed, testImageType* moving, FieldType* initField,
   load->SetSolution(solver->GetLinearSystemWrapper());
   Element2DType::VectorType force;
   force.set_size(ImageDimension);
+  ImageMetricLoadType::ElementPointersVectorType elements;
+  std::vector<Element2DType::VectorType>         elementForces;
+  itk::TimeProbe                                 applyLoadProbe;
+  applyLoadProbe.Start();
   for (unsigned int i = 0; i < femObject->GetNumberOfElements(); i++)
     {
     itk::fem::Element* element = femObject->GetElement(i);
     load->ApplyLoad(element, force);
+    elements.push_back(element);
+    elementForces.push_back(force);
     for (unsigned int n = 0; n < element->GetNumberOfNodes(); n++)
       {
       // Accumulate to corresponding pixel in displacement field
@@ -267,6 +275,8 @@ int RunTest(testImageType* fixed, testImageType* moving, FieldType* initField,
 
       } // end of for (each node in an element)
     } // end of for(each element)
+  applyLoadProbe.Stop();
+  std::cout << "ApplyLoad() of the elements: " << applyLoadProbe.GetTotal() << " s" << std::endl;
 
   // Write to vector image
   std::ostringstream vectorOutFilenameStream;
@@ -279,6 +289,58 @@ int RunTest(testImageType* fixed, testImageType* moving, FieldType* initField,
   forceFieldWriter->SetInput(outField);
   forceFieldWriter->Update();
 
+  // --------------------------------------------------------
+  // Test ApplyLoads() function on one and several threads. The mutual
+  // information draws its random samples from a generator per chunk of
+  // elements, seeded from the global generator, so its loads must not depend
+  // on the number of threads either once the global generator is reseeded.
+  // They are not compared with the ones of ApplyLoad(), which draws from
+  // the global generator.
+  double                                 energy[2];
+  std::vector<Element2DType::VectorType> forces[2];
+  for (unsigned int t = 0; t < 2; t++)
+    {
+    const itk::ThreadIdType numberOfThreads = (t == 0) ? 1 : 4;
+    load->SetNumberOfThreads(numberOfThreads);
+    load->SetCurrentEnergy(0.0);
+    itk::Statistics::MersenneTwisterRandomVariateGenerator::GetInstance()->SetSeed(1234);
+
+    itk::TimeProbe applyLoadsProbe;
+    applyLoadsProbe.Start();
+    load->ApplyLoads(elements, forces[t]);
+    applyLoadsProbe.Stop();
+    energy[t] = load->GetCurrentEnergy();
+    std::cout << "ApplyLoads() on " << numberOfThreads << " threads: "
+              << applyLoadsProbe.GetTotal() << " s, energy " << energy[t] << std::endl;
+
+    if (forces[t].size() != elements.size())
+      {
+      std::cerr << "ApplyLoads() returned " << forces[t].size() << " loads for "
+                << elements.size() << " elements" << std::endl;
+      return EXIT_FAILURE;
+      }
+    for (unsigned int i = 0; i < elements.size(); i++)
+      {
+      if (forces[t][i] != forces[0][i])
+        {
+        std::cerr << "ApplyLoads() on " << numberOfThreads << " threads differs from ApplyLoads() on one thread "
+                  << "for element " << i << ": " << forces[t][i] << " != " << forces[0][i] << std::endl;
+        return EXIT_FAILURE;
+        }
+      if (metricType != 2 && forces[t][i] != elementForces[i])
+        {
+        std::cerr << "ApplyLoads() on " << numberOfThreads << " threads differs from ApplyLoad() for element "
+                  << i << ": " << forces[t][i] << " != " << elementForces[i] << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+  if (energy[0] != energy[1])
+    {
+    std::cerr << "The energy depends on the number of threads: " << energy[0] << " != " << energy[1] << std::endl;
+    return EXIT_FAILURE;
+    }
+
   return EXIT_SUCCESS;
 }
 
@@ -20,6 +20,7 @@
 
 #include "itkDenseFiniteDifferenceImageFilter.h"
 #include "itkPDEDeformableRegistrationFunction.h"
+#include "itkRecursiveGaussianImageFilter.h"
 
 namespace itk
 {
@@ -54,6 +55,15 @@ namespace itk
  * of smoothing is governed by a set of user defined standard deviations
  * (one for each dimension).
  *
+ * By default the fields are smoothed with a truncated Gaussian kernel
+ * (see GaussianOperator), whose cost grows with the standard deviations.
+ * With UseRecursiveGaussianSmoothing on, they are smoothed instead with
+ * a recursive approximation of the Gaussian (see
+ * RecursiveGaussianImageFilter), in place and on several threads, at a
+ * cost that does not depend on the standard deviations. The result
+ * differs by a few percent from the one of a kernel with a small
+ * MaximumError.
+ *
  * In terms of memory, this filter keeps two internal buffers: one for storing
  * the intermediate updates to the field and one for double-buffering when
  * smoothing the displacement field. Both buffers are the same type and size as the
@@ -232,6 +242,15 @@ public:
    * \sa GaussianOperator. */
   itkSetMacro(MaximumKernelWidth, unsigned int);
   itkGetConstMacro(MaximumKernelWidth, unsigned int);
+
+  /** Set/Get whether the displacement and update fields are smoothed
+   * with a recursive Gaussian filter, in place, instead of a Gaussian
+   * kernel. MaximumError and MaximumKernelWidth are then unused. Each
+   * buffered dimension of the fields must be at least four pixels long.
+   * Off by default. \sa RecursiveGaussianImageFilter */
+  itkSetMacro(UseRecursiveGaussianSmoothing, bool);
+  itkGetConstMacro(UseRecursiveGaussianSmoothing, bool);
+  itkBooleanMacro(UseRecursiveGaussianSmoothing);
 protected:
   PDEDeformableRegistrationFilter();
   ~PDEDeformableRegistrationFilter() {}
@@ -293,6 +312,11 @@ protected:
    * set to be the same as that of the output requested region. */
   virtual void GenerateInputRequestedRegion();
 
+  /** Smooth a field in place with the recursive Gaussian filter, one
+   * dimension after the other. The standard deviations are in pixels. */
+  void SmoothFieldRecursively(DisplacementFieldType *field,
+                              const StandardDeviationsType & standardDeviations);
+
 private:
   PDEDeformableRegistrationFilter(const Self &); //purposely not implemented
   void operator=(const Self &);                  //purposely not implemented
@@ -308,6 +332,15 @@ private:
   /** Temporary displacement field use for smoothing the
    * the displacement field. */
   DisplacementFieldPointer m_TempField;
+
+  /** Recursive Gaussian filter run in place on a field, and the image
+   * through which it shares the buffer of that field. Both are kept
+   * across iterations. */
+  typedef RecursiveGaussianImageFilter< DisplacementFieldType,
+                                        DisplacementFieldType > RecursiveGaussianFilterType;
+  typename RecursiveGaussianFilterType::Pointer m_RecursiveGaussianFilter;
+  DisplacementFieldPointer                      m_RecursiveGaussianField;
+  bool                                          m_UseRecursiveGaussianSmoothing;
 private:
   /** Maximum error for Gaussian operator approximation. */
   double m_MaximumError;
@@ -56,6 +56,11 @@ PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDisplacementField >
 
   m_SmoothDisplacementField = true;
   m_SmoothUpdateField = false;
+
+  m_RecursiveGaussianFilter = RecursiveGaussianFilterType::New();
+  m_RecursiveGaussianFilter->InPlaceOn();
+  m_RecursiveGaussianField = DisplacementFieldType::New();
+  m_UseRecursiveGaussianSmoothing = false;
 }
 
 /*
@@ -219,6 +224,8 @@ PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDisplacementField >
   os << m_MaximumError << std::endl;
   os << indent << "MaximumKernelWidth: ";
   os << m_MaximumKernelWidth << std::endl;
+  os << indent << "UseRecursiveGaussianSmoothing: ";
+  os << m_UseRecursiveGaussianSmoothing << std::endl;
 }
 
 /*
@@ -388,6 +395,12 @@ PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDisplacementField >
 {
   DisplacementFieldPointer field = this->GetOutput();
 
+  if ( m_UseRecursiveGaussianSmoothing )
+    {
+    this->SmoothFieldRecursively(field, m_StandardDeviations);
+    return;
+    }
+
   // copy field to TempField
   m_TempField->SetOrigin( field->GetOrigin() );
   m_TempField->SetSpacing( field->GetSpacing() );
@@ -459,6 +472,12 @@ PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDisplacementField >
   // The update buffer will be overwritten with new data.
   DisplacementFieldPointer field = this->GetUpdateBuffer();
 
+  if ( m_UseRecursiveGaussianSmoothing )
+    {
+    this->SmoothFieldRecursively( field, this->GetUpdateFieldStandardDeviations() );
+    return;
+    }
+
   typedef typename DisplacementFieldType::PixelType       VectorType;
   typedef typename VectorType::ValueType                  ScalarType;
   typedef GaussianOperator< ScalarType, ImageDimension >  OperatorType;
@@ -506,6 +525,49 @@ PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDisplacementField >
                                    ->GetLargestPossibleRegion() );
   field->CopyInformation( smoothers[ImageDimension - 1]->GetOutput() );
 }
+
+/*
+ * Smooth a field in place using recursive Gaussian filters
+ */
+template< class TFixedImage, class TMovingImage, class TDisplacementField >
+void
+PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDisplacementField >
+::SmoothFieldRecursively(DisplacementFieldType *field,
+                         const StandardDeviationsType & standardDeviations)
+{
+  // The filter sees the buffer of the field through an image with a unit
+  // spacing, so that the standard deviations are in pixels and only the
+  // buffered region is smoothed.
+  typename DisplacementFieldType::SpacingType unitSpacing;
+  unitSpacing.Fill(1.0);
+
+  m_RecursiveGaussianFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
+
+  for ( unsigned int j = 0; j < ImageDimension; j++ )
+    {
+    if ( standardDeviations[j] <= 0.0 )
+      {
+      continue;
+      }
+
+    // The filter releases its input after running in place, so the image
+    // is set up again before each dimension.
+    m_RecursiveGaussianField->SetRegions( field->GetBufferedRegion() );
+    m_RecursiveGaussianField->SetSpacing(unitSpacing);
+    m_RecursiveGaussianField->SetPixelContainer( field->GetPixelContainer() );
+
+    m_RecursiveGaussianFilter->SetInput(m_RecursiveGaussianField);
+    m_RecursiveGaussianFilter->SetDirection(j);
+    m_RecursiveGaussianFilter->SetSigma(standardDeviations[j]);
+    m_RecursiveGaussianFilter->GetOutput()
+    ->SetRequestedRegion( field->GetBufferedRegion() );
+    m_RecursiveGaussianFilter->Modified();
+    m_RecursiveGaussianFilter->Update();
+    }
+
+  // do not keep a reference to the buffer of the field
+  m_RecursiveGaussianFilter->GetOutput()->ReleaseData();
+}
 } // end namespace itk
 
 #endif
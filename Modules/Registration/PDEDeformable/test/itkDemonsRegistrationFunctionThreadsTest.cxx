@@ -0,0 +1,168 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkDemonsRegistrationFilter.h"
+#include "itkSymmetricForcesDemonsRegistrationFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkTimeProbe.h"
+
+namespace
+{
+const unsigned int Dimension = 3;
+
+typedef itk::Image< float, Dimension >      ImageType;
+typedef itk::Vector< float, Dimension >     VectorType;
+typedef itk::Image< VectorType, Dimension > FieldType;
+
+bool Close(double a, double b)
+{
+  return vnl_math_abs( a - b ) <= 1.0e-9 * ( 1.0 + vnl_math_abs( a ) );
+}
+
+// Register the images and return the metric and the rms change of the
+// last iteration.
+template< class TRegistration >
+void Register( const ImageType *fixed, const ImageType *moving, itk::ThreadIdType numberOfThreads,
+               const char *name, double & metric, double & rmsChange )
+{
+  typename TRegistration::Pointer registration = TRegistration::New();
+  registration->SetFixedImage( fixed );
+  registration->SetMovingImage( moving );
+  registration->SetNumberOfIterations( 10 );
+  registration->SetStandardDeviations( 1.0 );
+  registration->SetNumberOfThreads( numberOfThreads );
+
+  itk::TimeProbe time;
+  time.Start();
+  registration->Update();
+  time.Stop();
+  metric = registration->GetMetric();
+  rmsChange = registration->GetRMSChange();
+  std::cout << name << ", " << numberOfThreads << " threads: " << time.GetMean()
+            << " s, metric " << metric << ", rms change " << rmsChange << std::endl;
+}
+
+template< class TRegistration >
+bool SameStatistics( const ImageType *fixed, const ImageType *moving, const char *name )
+{
+  double serialMetric;
+  double serialRMSChange;
+  Register< TRegistration >( fixed, moving, 1, name, serialMetric, serialRMSChange );
+  if( serialMetric <= 0.0 || serialRMSChange <= 0.0 )
+    {
+    std::cerr << name << ": the metric or the rms change was not computed" << std::endl;
+    return false;
+    }
+
+  // The sums of the threads are added in the same order on every run
+  const itk::ThreadIdType numbersOfThreads[] = { 3, 8, 8 };
+  double metrics[3];
+  double rmsChanges[3];
+  for( unsigned int t = 0; t < 3; ++t )
+    {
+    Register< TRegistration >( fixed, moving, numbersOfThreads[t], name, metrics[t], rmsChanges[t] );
+    if( !Close( serialMetric, metrics[t] ) || !Close( serialRMSChange, rmsChanges[t] ) )
+      {
+      std::cerr << name << ": metric " << metrics[t] << ", rms change " << rmsChanges[t]
+                << " with " << numbersOfThreads[t] << " threads, " << serialMetric << " and "
+                << serialRMSChange << " with one" << std::endl;
+      return false;
+      }
+    }
+  if( metrics[1] != metrics[2] || rmsChanges[1] != rmsChanges[2] )
+    {
+    std::cerr << name << ": two runs on eight threads differ" << std::endl;
+    return false;
+    }
+  return true;
+}
+}
+
+int itkDemonsRegistrationFunctionThreadsTest(int, char* [] )
+{
+  // A sphere and a shifted ellipsoid
+  ImageType::SizeType size;
+  size[0] = 64;
+  size[1] = 56;
+  size[2] = 40;
+  ImageType::Pointer fixed = ImageType::New();
+  ImageType::Pointer moving = ImageType::New();
+  fixed->SetRegions( size );
+  fixed->Allocate();
+  moving->SetRegions( size );
+  moving->Allocate();
+  itk::ImageRegionIterator< ImageType > fit( fixed, fixed->GetBufferedRegion() );
+  itk::ImageRegionIterator< ImageType > mit( moving, moving->GetBufferedRegion() );
+  for( ; !fit.IsAtEnd(); ++fit, ++mit )
+    {
+    const ImageType::IndexType idx = fit.GetIndex();
+    const double x = idx[0] - 32.0;
+    const double y = idx[1] - 28.0;
+    const double z = idx[2] - 20.0;
+    fit.Set( x * x + y * y + z * z < 196.0 ? 200.0f : 20.0f );
+    mit.Set( ( x - 2.0 ) * ( x - 2.0 ) / 1.44 + y * y + ( z + 1.0 ) * ( z + 1.0 ) < 196.0 ? 200.0f : 20.0f );
+    }
+
+  typedef itk::DemonsRegistrationFilter< ImageType, ImageType, FieldType >               DemonsType;
+  typedef itk::SymmetricForcesDemonsRegistrationFilter< ImageType, ImageType, FieldType > SymmetricType;
+  if( !SameStatistics< DemonsType >( fixed, moving, "Demons" )
+      || !SameStatistics< SymmetricType >( fixed, moving, "Symmetric forces demons" ) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Solvers that do not give the threads their own global data still
+  // update the metric
+  typedef itk::DemonsRegistrationFunction< ImageType, ImageType, FieldType > FunctionType;
+  FunctionType::Pointer function = FunctionType::New();
+  FieldType::Pointer field = FieldType::New();
+  field->SetRegions( size );
+  field->Allocate();
+  VectorType zero;
+  zero.Fill( 0.0f );
+  field->FillBuffer( zero );
+  function->SetFixedImage( fixed );
+  function->SetMovingImage( moving );
+  function->SetDisplacementField( field );
+  function->InitializeIteration();
+  FunctionType::NeighborhoodType neighborhood( function->GetRadius(), field, field->GetBufferedRegion() );
+  double sumOfSquaredDifference = 0.0;
+  unsigned int numberOfPixels = 0;
+  void *globalData = function->GetGlobalDataPointer();
+  for( neighborhood.GoToBegin(); !neighborhood.IsAtEnd(); ++neighborhood )
+    {
+    function->ComputeUpdate( neighborhood, globalData );
+    const double difference = fixed->GetPixel( neighborhood.GetIndex() )
+                              - moving->GetPixel( neighborhood.GetIndex() );
+    sumOfSquaredDifference += difference * difference;
+    ++numberOfPixels;
+    }
+  function->ReleaseGlobalDataPointer( globalData );
+  function->ReduceGlobalData();
+  if( !Close( function->GetMetric(), sumOfSquaredDifference / numberOfPixels ) )
+    {
+    std::cerr << "Metric " << function->GetMetric() << " instead of "
+              << sumOfSquaredDifference / numberOfPixels << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  function->Print( std::cout );
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,245 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkDemonsRegistrationFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkTimeProbe.h"
+
+namespace
+{
+const unsigned int Dimension = 3;
+
+typedef itk::Image< float, Dimension >                     ImageType;
+typedef itk::Vector< float, Dimension >                    VectorType;
+typedef itk::Image< VectorType, Dimension >                FieldType;
+typedef itk::Statistics::MersenneTwisterRandomVariateGenerator GeneratorType;
+
+/** Only smooth the initial field, and tell whether the output buffer
+ * was kept. */
+class SmoothingRegistrationFilter :
+  public itk::DemonsRegistrationFilter< ImageType, ImageType, FieldType >
+{
+public:
+  typedef SmoothingRegistrationFilter                                      Self;
+  typedef itk::DemonsRegistrationFilter< ImageType, ImageType, FieldType > Superclass;
+  typedef itk::SmartPointer< Self >                                        Pointer;
+  itkNewMacro( Self );
+
+  bool m_SmoothedInPlace;
+
+protected:
+  SmoothingRegistrationFilter() : m_SmoothedInPlace( false ) {}
+
+  void GenerateData()
+  {
+    this->AllocateOutputs();
+    this->CopyInputToOutput();
+    const VectorType *buffer = this->GetOutput()->GetBufferPointer();
+    this->SmoothDisplacementField();
+    m_SmoothedInPlace = ( this->GetOutput()->GetBufferPointer() == buffer );
+  }
+};
+
+// Smooth a field with the filter, on images of the same size.
+FieldType::Pointer Smooth( const FieldType *field, SmoothingRegistrationFilter *filter,
+                           const char *name )
+{
+  ImageType::Pointer image = ImageType::New();
+  image->CopyInformation( field );
+  image->SetRegions( field->GetBufferedRegion() );
+  image->Allocate();
+  image->FillBuffer( 0.0f );
+  filter->SetFixedImage( image );
+  filter->SetMovingImage( image );
+  filter->SetInitialDisplacementField( const_cast< FieldType * >( field ) );
+
+  itk::TimeProbe time;
+  time.Start();
+  filter->Update();
+  time.Stop();
+  std::cout << "Smoothing, " << name << ", " << filter->GetNumberOfThreads() << " threads: "
+            << time.GetMean() << " s" << std::endl;
+  return filter->GetOutput();
+}
+
+// The largest difference between the components of two fields, relative
+// to the largest component of the first one.
+double RelativeDifference( const FieldType *a, const FieldType *b )
+{
+  double maximum = 0.0;
+  double difference = 0.0;
+  const itk::SizeValueType numberOfPixels = a->GetBufferedRegion().GetNumberOfPixels();
+  for( itk::SizeValueType i = 0; i < numberOfPixels; ++i )
+    {
+    for( unsigned int j = 0; j < Dimension; ++j )
+      {
+      const double value = a->GetBufferPointer()[i][j];
+      maximum = vnl_math_max( maximum, vnl_math_abs( value ) );
+      difference = vnl_math_max( difference, vnl_math_abs( value - b->GetBufferPointer()[i][j] ) );
+      }
+    }
+  return difference / maximum;
+}
+
+FieldType::Pointer Register( const ImageType *fixed, const ImageType *moving,
+                             bool recursive, itk::ThreadIdType numberOfThreads )
+{
+  typedef itk::DemonsRegistrationFilter< ImageType, ImageType, FieldType > RegistrationType;
+  RegistrationType::Pointer registration = RegistrationType::New();
+  registration->SetFixedImage( fixed );
+  registration->SetMovingImage( moving );
+  registration->SetNumberOfIterations( 20 );
+  registration->SetStandardDeviations( 2.0 );
+  registration->SmoothUpdateFieldOn();
+  registration->SetUpdateFieldStandardDeviations( 1.5 );
+  registration->SetUseRecursiveGaussianSmoothing( recursive );
+  registration->SetNumberOfThreads( numberOfThreads );
+  registration->SetMaximumError( 0.001 );
+
+  itk::TimeProbe time;
+  time.Start();
+  registration->Update();
+  time.Stop();
+  std::cout << "Demons registration, " << ( recursive ? "recursive" : "kernel" ) << " smoothing, "
+            << numberOfThreads << " threads: " << time.GetMean() << " s, metric "
+            << registration->GetMetric() << std::endl;
+  return registration->GetOutput();
+}
+}
+
+int itkPDEDeformableRegistrationFilterSmoothingTest(int, char* [] )
+{
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize( 2468 );
+
+  // A random field, with a spacing that is not one and a region that does
+  // not start at the origin
+  FieldType::SizeType size;
+  size[0] = 48;
+  size[1] = 40;
+  size[2] = 32;
+  FieldType::IndexType start;
+  start[0] = -5;
+  start[1] = 3;
+  start[2] = 0;
+  FieldType::SpacingType spacing;
+  spacing[0] = 1.5;
+  spacing[1] = 0.8;
+  spacing[2] = 2.0;
+  FieldType::Pointer field = FieldType::New();
+  field->SetRegions( FieldType::RegionType( start, size ) );
+  field->SetSpacing( spacing );
+  field->Allocate();
+  itk::ImageRegionIterator< FieldType > it( field, field->GetBufferedRegion() );
+  for( ; !it.IsAtEnd(); ++it )
+    {
+    VectorType v;
+    for( unsigned int j = 0; j < Dimension; ++j )
+      {
+      v[j] = static_cast< float >( generator->GetNormalVariate( 0.0, 1.0 ) );
+      }
+    it.Set( v );
+    }
+
+  SmoothingRegistrationFilter::StandardDeviationsType standardDeviations;
+  standardDeviations[0] = 2.0;
+  standardDeviations[1] = 3.0;
+  standardDeviations[2] = 2.5;
+
+  // Smoothing with the Gaussian kernel, truncated far enough to be
+  // compared to the recursive Gaussian, and with the recursive Gaussian,
+  // which runs in place and gives the same field whatever the number of
+  // threads
+  SmoothingRegistrationFilter::Pointer kernelFilter = SmoothingRegistrationFilter::New();
+  kernelFilter->SetStandardDeviations( standardDeviations );
+  kernelFilter->SetMaximumError( 0.001 );
+  kernelFilter->SetNumberOfThreads( 1 );
+  FieldType::Pointer kernelField = Smooth( field, kernelFilter, "kernel" );
+
+  const itk::ThreadIdType numbersOfThreads[] = { 1, 3 };
+  FieldType::Pointer recursiveFields[2];
+  for( unsigned int t = 0; t < 2; ++t )
+    {
+    SmoothingRegistrationFilter::Pointer recursiveFilter = SmoothingRegistrationFilter::New();
+    recursiveFilter->SetStandardDeviations( standardDeviations );
+    recursiveFilter->UseRecursiveGaussianSmoothingOn();
+    recursiveFilter->SetNumberOfThreads( numbersOfThreads[t] );
+    recursiveFields[t] = Smooth( field, recursiveFilter, "recursive" );
+    if( !recursiveFilter->m_SmoothedInPlace )
+      {
+      std::cerr << "The recursive smoothing did not run in place" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  if( RelativeDifference( recursiveFields[0], recursiveFields[1] ) != 0.0 )
+    {
+    std::cerr << "The recursive smoothing on three threads differs from the serial one" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const double smoothingDifference = RelativeDifference( kernelField, recursiveFields[0] );
+  std::cout << "Smoothing, relative difference: " << smoothingDifference << std::endl;
+  if( smoothingDifference > 0.05 )
+    {
+    std::cerr << "The recursive smoothing differs from the kernel one by "
+              << smoothingDifference << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Registration of a sphere onto a shifted ellipsoid
+  ImageType::Pointer fixed = ImageType::New();
+  ImageType::Pointer moving = ImageType::New();
+  fixed->SetRegions( size );
+  fixed->Allocate();
+  moving->SetRegions( size );
+  moving->Allocate();
+  itk::ImageRegionIterator< ImageType > fit( fixed, fixed->GetBufferedRegion() );
+  itk::ImageRegionIterator< ImageType > mit( moving, moving->GetBufferedRegion() );
+  for( ; !fit.IsAtEnd(); ++fit, ++mit )
+    {
+    const ImageType::IndexType idx = fit.GetIndex();
+    const double x = idx[0] - 24.0;
+    const double y = idx[1] - 20.0;
+    const double z = idx[2] - 16.0;
+    fit.Set( x * x + y * y + z * z < 100.0 ? 200.0f : 20.0f );
+    mit.Set( ( x - 2.0 ) * ( x - 2.0 ) / 1.44 + y * y + ( z + 1.0 ) * ( z + 1.0 ) < 100.0 ? 200.0f : 20.0f );
+    }
+
+  FieldType::Pointer kernelRegistration = Register( fixed, moving, false, 1 );
+  FieldType::Pointer recursiveRegistration = Register( fixed, moving, true, 1 );
+  FieldType::Pointer threadedRegistration = Register( fixed, moving, true, 3 );
+  if( RelativeDifference( recursiveRegistration, threadedRegistration ) > 1.0e-5 )
+    {
+    std::cerr << "The registration on three threads differs from the serial one" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const double registrationDifference = RelativeDifference( kernelRegistration, recursiveRegistration );
+  std::cout << "Registration, relative difference: " << registrationDifference << std::endl;
+  if( registrationDifference > 0.05 )
+    {
+    std::cerr << "The registration with the recursive smoothing differs from the one with the kernel by "
+              << registrationDifference << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  kernelFilter->UseRecursiveGaussianSmoothingOn();
+  kernelFilter->Print( std::cout );
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
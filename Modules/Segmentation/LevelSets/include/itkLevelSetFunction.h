@@ -219,6 +219,23 @@ public:
   virtual void ReleaseGlobalDataPointer(void *GlobalData) const
   { delete (GlobalDataStruct *)GlobalData; }
 
+  /** Returns a new global data structure for the thread \a threadId of the
+   * solver, and remembers it until it is released, so that
+   * ReduceGlobalData() can combine the structures of the threads. */
+  virtual void * GetThreadGlobalDataPointer(ThreadIdType threadId) const;
+
+  /** Forgets the structure of the thread \a threadId and releases it. */
+  virtual void ReleaseThreadGlobalDataPointer(void *GlobalData, ThreadIdType threadId) const;
+
+  /** Keeps in the global data structure of thread 0 the largest advection,
+   * propagation and curvature changes of the structures of the threads
+   * that are not released yet. */
+  virtual void ReduceGlobalData() const;
+
+  /** The level set functions compute their updates from the neighborhood
+   * and their global data only, so they can run on several threads. */
+  virtual bool IsThreadSafe() const { return true; }
+
   /**  */
   virtual ScalarValueType ComputeCurvatureTerm(const NeighborhoodType &,
                                                const FloatOffsetType &,
@@ -297,6 +314,7 @@ protected:
                           m_CurvatureWeight = m_LaplacianSmoothingWeight =
                                                 NumericTraits< ScalarValueType >::Zero;
     m_UseMinimalCurvature = false;
+    m_ThreadGlobalData.resize(ITK_MAX_THREADS, 0);
   }
 
   virtual ~LevelSetFunction() {}
@@ -338,6 +356,9 @@ protected:
 
   /** Laplacean smoothing term */
   ScalarValueType m_LaplacianSmoothingWeight;
+
+  /** Global data structures of the threads of the solver. */
+  mutable std::vector< GlobalDataStruct * > m_ThreadGlobalData;
 private:
   LevelSetFunction(const Self &); //purposely not implemented
   void operator=(const Self &);   //purposely not implemented
@@ -269,6 +269,49 @@ LevelSetFunction< TImageType >
   return dt;
 }
 
+template< class TImageType >
+void *
+LevelSetFunction< TImageType >
+::GetThreadGlobalDataPointer(ThreadIdType threadId) const
+{
+  GlobalDataStruct *gd = (GlobalDataStruct *)this->GetGlobalDataPointer();
+
+  m_ThreadGlobalData[threadId] = gd;
+  return gd;
+}
+
+template< class TImageType >
+void
+LevelSetFunction< TImageType >
+::ReleaseThreadGlobalDataPointer(void *GlobalData, ThreadIdType threadId) const
+{
+  m_ThreadGlobalData[threadId] = 0;
+  this->ReleaseGlobalDataPointer(GlobalData);
+}
+
+template< class TImageType >
+void
+LevelSetFunction< TImageType >
+::ReduceGlobalData() const
+{
+  GlobalDataStruct *d = m_ThreadGlobalData[0];
+
+  if ( !d )
+    {
+    return;
+    }
+  for ( unsigned int i = 1; i < m_ThreadGlobalData.size(); i++ )
+    {
+    const GlobalDataStruct *o = m_ThreadGlobalData[i];
+    if ( o )
+      {
+      d->m_MaxAdvectionChange   = vnl_math_max(d->m_MaxAdvectionChange, o->m_MaxAdvectionChange);
+      d->m_MaxPropagationChange = vnl_math_max(d->m_MaxPropagationChange, o->m_MaxPropagationChange);
+      d->m_MaxCurvatureChange   = vnl_math_max(d->m_MaxCurvatureChange, o->m_MaxCurvatureChange);
+      }
+    }
+}
+
 template< class TImageType >
 void
 LevelSetFunction< TImageType >
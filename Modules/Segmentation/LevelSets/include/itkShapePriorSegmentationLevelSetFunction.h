@@ -135,6 +135,9 @@ public:
   /** Release the global data structure. */
   virtual void ReleaseGlobalDataPointer(void *GlobalData) const
   { delete (ShapePriorGlobalDataStruct *)GlobalData; }
+
+  /** The shape function is not safe to evaluate on several threads. */
+  virtual bool IsThreadSafe() const { return false; }
 protected:
   ShapePriorSegmentationLevelSetFunction();
   virtual ~ShapePriorSegmentationLevelSetFunction() {}
@@ -141,6 +141,7 @@ ShapePriorSegmentationLevelSetFunction< TImageType, TFeatureImageType >
 
   return dt;
 }
+
 } // end namespace itk
 
 #endif
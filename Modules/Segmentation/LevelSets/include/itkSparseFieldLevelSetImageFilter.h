@@ -366,9 +366,24 @@ protected:
   void ApplyUpdate(const TimeStepType& dt);
 
   /** Traverses the active layer list and calculates the change at these
-   *  indicies to be applied in the current iteration. */
+   *  indicies to be applied in the current iteration.  The active layer is
+   *  split in contiguous chunks that are processed on several threads when
+   *  the difference function is thread safe (see
+   *  FiniteDifferenceFunction::IsThreadSafe()), and on one thread otherwise.
+   *  Each thread writes the changes of its chunk in its own slice of the update
+   *  buffer, so the buffer is in the order of the active layer whatever the
+   *  number of threads. */
   TimeStepType CalculateChange();
 
+  /** Calculates the changes at the nodes of the active layer in
+   *  [first, last), and stores them in the update buffer starting at
+   *  position "bufferPosition".  The maximum changes of this chunk are
+   *  collected in "globalData". */
+  void ThreadedCalculateChange(typename LayerType::ConstIterator first,
+                               typename LayerType::ConstIterator last,
+                               SizeValueType bufferPosition,
+                               void *globalData);
+
   /** Initializes a layer of the sparse field using a previously initialized
    * layer. Builds the list of nodes in m_Layer[to] using m_Layer[from].
    * Marks values in the m_StatusImage. */
@@ -496,6 +511,20 @@ private:
   /** This flag is true when methods need to check boundary conditions and
       false when methods do not need to check for boundary conditions. */
   bool m_BoundsCheckingActive;
+
+  /** Structure for passing information into static callback methods.  The
+   *  chunk of thread i starts at Begin[i] and at BufferPosition[i] in the
+   *  update buffer, and ends at Begin[i + 1].  Its changes are collected in
+   *  GlobalData[i]. */
+  struct CalculateChangeThreadStruct {
+    Self *Filter;
+    std::vector< typename LayerType::ConstIterator > Begin;
+    std::vector< SizeValueType > BufferPosition;
+    std::vector< void * > GlobalData;
+  };
+
+  /** Calls ThreadedCalculateChange on the chunk of the calling thread. */
+  static ITK_THREAD_RETURN_TYPE CalculateChangeThreaderCallback(void *arg);
 };
 } // end namespace itk
 
@@ -900,6 +900,114 @@ typename
 SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >::TimeStepType
 SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
 ::CalculateChange()
+{
+  const SizeValueType numberOfNodes = m_Layers[0]->Size();
+
+  const typename Superclass::FiniteDifferenceFunctionType::Pointer df =
+    this->GetDifferenceFunction();
+
+  // Split the active layer in contiguous chunks of about the same number of
+  // nodes, one per thread.  The time step must be the one of the whole
+  // active layer, so several threads are only used when the difference
+  // function is thread safe and combines the global data of the threads.
+  ThreadIdType numberOfThreads = this->GetNumberOfThreads();
+  if ( !df->IsThreadSafe() )
+    {
+    numberOfThreads = 1;
+    }
+  if ( numberOfThreads > numberOfNodes )
+    {
+    numberOfThreads = static_cast< ThreadIdType >( numberOfNodes );
+    }
+  if ( numberOfThreads < 1 )
+    {
+    numberOfThreads = 1;
+    }
+
+  // Each chunk has its own global data, so that the threads do not share
+  // the maximum changes.
+  std::vector< void * > globalData(numberOfThreads);
+  for ( ThreadIdType i = 0; i < numberOfThreads; ++i )
+    {
+    globalData[i] = df->GetThreadGlobalDataPointer(i);
+    }
+
+  CalculateChangeThreadStruct str;
+  str.Filter = this;
+  str.Begin.resize(numberOfThreads + 1);
+  str.BufferPosition.resize(numberOfThreads + 1);
+  str.GlobalData = globalData;
+
+  typename LayerType::ConstIterator layerIt = m_Layers[0]->Begin();
+  SizeValueType                     position = 0;
+  for ( ThreadIdType i = 0; i < numberOfThreads; ++i )
+    {
+    const SizeValueType chunkEnd = ( numberOfNodes * ( i + 1 ) ) / numberOfThreads;
+    str.Begin[i] = layerIt;
+    str.BufferPosition[i] = position;
+    for (; position < chunkEnd; ++position )
+      {
+      ++layerIt;
+      }
+    }
+  str.Begin[numberOfThreads] = m_Layers[0]->End();
+  str.BufferPosition[numberOfThreads] = numberOfNodes;
+
+  // The threads write the changes at their own positions in the buffer.
+  m_UpdateBuffer.clear();
+  m_UpdateBuffer.resize(numberOfNodes);
+
+  this->GetMultiThreader()->SetNumberOfThreads(numberOfThreads);
+  this->GetMultiThreader()->SetSingleMethod(this->CalculateChangeThreaderCallback, &str);
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  // The maximum changes of the whole active layer are the largest maximum
+  // changes of the chunks, so the time step does not depend on the number
+  // of threads.  Ask the finite difference function to combine the global
+  // data of the chunks into the one of the first chunk and to compute the
+  // time step from it, then free the global data memory.
+  df->ReduceGlobalData();
+  const TimeStepType timeStep = df->ComputeGlobalTimeStep(globalData[0]);
+  for ( ThreadIdType i = 0; i < numberOfThreads; ++i )
+    {
+    df->ReleaseThreadGlobalDataPointer(globalData[i], i);
+    }
+
+  return timeStep;
+}
+
+template< class TInputImage, class TOutputImage >
+ITK_THREAD_RETURN_TYPE
+SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
+::CalculateChangeThreaderCallback(void *arg)
+{
+  const ThreadIdType threadId =
+    ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+  CalculateChangeThreadStruct *str =
+    (CalculateChangeThreadStruct *)( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  // The multithreader may run fewer threads than chunks.
+  const ThreadIdType threadCount =
+    ( (MultiThreader::ThreadInfoStruct *)( arg ) )->NumberOfThreads;
+  const ThreadIdType numberOfChunks = static_cast< ThreadIdType >( str->GlobalData.size() );
+  for ( ThreadIdType i = threadId; i < numberOfChunks; i += threadCount )
+    {
+    str->Filter->ThreadedCalculateChange(str->Begin[i],
+                                         str->Begin[i + 1],
+                                         str->BufferPosition[i],
+                                         str->GlobalData[i]);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TInputImage, class TOutputImage >
+void
+SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
+::ThreadedCalculateChange(typename LayerType::ConstIterator first,
+                          typename LayerType::ConstIterator last,
+                          SizeValueType bufferPosition,
+                          void *globalData)
 {
   const typename Superclass::FiniteDifferenceFunctionType::Pointer df =
     this->GetDifferenceFunction();
@@ -918,26 +1026,21 @@ SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
     MIN_NORM *= minSpacing;
     }
 
-  void *globalData = df->GetGlobalDataPointer();
-
   typename LayerType::ConstIterator layerIt;
   NeighborhoodIterator< OutputImageType > outputIt( df->GetRadius(),
                                                     this->GetOutput(), this->GetOutput()->GetRequestedRegion() );
-  TimeStepType timeStep;
 
   if ( m_BoundsCheckingActive == false )
     {
     outputIt.NeedToUseBoundaryConditionOff();
     }
 
-  m_UpdateBuffer.clear();
-  m_UpdateBuffer.reserve( m_Layers[0]->Size() );
-
   // Calculates the update values for the active layer indicies in this
-  // iteration.  Iterates through the active layer index list, applying
+  // chunk.  Iterates through the active layer index list, applying
   // the level set function to the output image (level set image) at each
   // index.  Update values are stored in the update buffer.
-  for ( layerIt = m_Layers[0]->Begin(); layerIt != m_Layers[0]->End(); ++layerIt )
+  typename UpdateBufferType::iterator updateIt = m_UpdateBuffer.begin() + bufferPosition;
+  for ( layerIt = first; layerIt != last; ++layerIt, ++updateIt )
     {
     outputIt.SetLocation(layerIt->m_Value);
 
@@ -992,22 +1095,13 @@ SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
         offset[i] = ( offset[i] * centerValue ) / ( norm_grad_phi_squared + MIN_NORM );
         }
 
-      m_UpdateBuffer.push_back( df->ComputeUpdate(outputIt, globalData, offset) );
+      *updateIt = df->ComputeUpdate(outputIt, globalData, offset);
       }
     else // Don't do interpolation
       {
-      m_UpdateBuffer.push_back( df->ComputeUpdate(outputIt, globalData) );
+      *updateIt = df->ComputeUpdate(outputIt, globalData);
       }
     }
-
-  // Ask the finite difference function to compute the time step for
-  // this iteration.  We give it the global data pointer to use, then
-  // ask it to free the global data memory.
-  timeStep = df->ComputeGlobalTimeStep(globalData);
-
-  df->ReleaseGlobalDataPointer(globalData);
-
-  return timeStep;
 }
 
 template< class TInputImage, class TOutputImage >
@@ -0,0 +1,155 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkThresholdSegmentationLevelSetImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkTimeProbe.h"
+
+namespace
+{
+typedef itk::Image< float, 3 >                                                ImageType;
+typedef itk::ThresholdSegmentationLevelSetImageFilter< ImageType, ImageType > FilterType;
+
+FilterType::Pointer Segment(const ImageType *seed, const ImageType *feature,
+                            double curvatureScaling, itk::ThreadIdType numberOfThreads)
+{
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( seed );
+  filter->SetFeatureImage( feature );
+  filter->SetLowerThreshold( 50 );
+  filter->SetUpperThreshold( 63 );
+  filter->ReverseExpansionDirectionOn();
+  filter->SetIsoSurfaceValue( 0.5 );
+  filter->SetCurvatureScaling( curvatureScaling );
+  filter->SetMaximumRMSError( 0.0 );
+  filter->SetNumberOfIterations( 15 );
+  filter->SetNumberOfThreads( numberOfThreads );
+
+  itk::TimeProbe time;
+  time.Start();
+  filter->Update();
+  time.Stop();
+  std::cout << "CurvatureScaling " << curvatureScaling << ", " << numberOfThreads
+            << " threads: " << time.GetMean() << " s, RMS change "
+            << filter->GetRMSChange() << std::endl;
+  return filter;
+}
+
+// Count the pixels that are not on the same side of the surface in both
+// level sets, and the largest difference of the level sets.
+unsigned int CountDifferences(const ImageType *a, const ImageType *b, double & maximumDifference)
+{
+  unsigned int differences = 0;
+  maximumDifference = 0.0;
+  itk::ImageRegionConstIterator< ImageType > ait( a, a->GetBufferedRegion() );
+  itk::ImageRegionConstIterator< ImageType > bit( b, a->GetBufferedRegion() );
+  for( ; !ait.IsAtEnd(); ++ait, ++bit )
+    {
+    if( ( ait.Get() < 0 ) != ( bit.Get() < 0 ) )
+      {
+      ++differences;
+      }
+    maximumDifference = vnl_math_max( maximumDifference,
+                                      static_cast< double >( vnl_math_abs( ait.Get() - bit.Get() ) ) );
+    }
+  return differences;
+}
+}
+
+int itkSparseFieldLevelSetImageFilterThreadsTest(int, char* [] )
+{
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator GeneratorType;
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize( 4321 );
+
+  // A sphere grows toward a noisy diamond
+  ImageType::SizeType size;
+  size[0] = 64;
+  size[1] = 64;
+  size[2] = 64;
+  ImageType::IndexType start;
+  start.Fill( 0 );
+  ImageType::RegionType region( start, size );
+
+  ImageType::Pointer seed = ImageType::New();
+  seed->SetRegions( region );
+  seed->Allocate();
+  ImageType::Pointer point = ImageType::New();
+  point->SetRegions( region );
+  point->Allocate();
+  point->FillBuffer( 0 );
+  ImageType::Pointer feature = ImageType::New();
+  feature->SetRegions( region );
+  feature->Allocate();
+
+  itk::ImageRegionIterator< ImageType > sit( seed, region );
+  itk::ImageRegionIterator< ImageType > fit( feature, region );
+  for( ; !sit.IsAtEnd(); ++sit, ++fit )
+    {
+    const ImageType::IndexType idx = sit.GetIndex();
+    double sphere = 0.0;
+    double diamond = 0.0;
+    for( unsigned int i = 0; i < 3; ++i )
+      {
+      sphere += ( idx[i] - 32.0 ) * ( idx[i] - 32.0 ) / ( 12.8 * 12.8 );
+      diamond += idx[i] < 32 ? idx[i] : 64 - idx[i];
+      }
+    sit.Set( sphere <= 1.0 ? 1 : 0 );
+    fit.Set( diamond + 4.0 * generator->GetVariate() );
+    }
+  start.Fill( 32 );
+  point->SetPixel( start, 1 );
+
+  // The time step is computed from the largest changes of the whole active
+  // layer, so the results do not depend on the number of threads, with or
+  // without curvature.  A single point has fewer active nodes than threads.
+  const ImageType *      seeds[] = { seed, point };
+  const double           curvatureScalings[] = { 0.0, 1.0 };
+  const itk::ThreadIdType numbersOfThreads[] = { 2, 3, 16 };
+  FilterType::Pointer threaded;
+  for( unsigned int c = 0; c < 2; ++c )
+    {
+    for( unsigned int s = 0; s < 2; ++s )
+      {
+      FilterType::Pointer serial = Segment( seeds[s], feature, curvatureScalings[c], 1 );
+      for( unsigned int t = 0; t < 3; ++t )
+        {
+        threaded = Segment( seeds[s], feature, curvatureScalings[c], numbersOfThreads[t] );
+        double maximumDifference;
+        const unsigned int differences =
+          CountDifferences( serial->GetOutput(), threaded->GetOutput(), maximumDifference );
+        if( maximumDifference != 0.0
+            || threaded->GetRMSChange() != serial->GetRMSChange()
+            || threaded->GetElapsedIterations() != serial->GetElapsedIterations() )
+          {
+          std::cerr << "CurvatureScaling " << curvatureScalings[c] << ", "
+                    << numbersOfThreads[t] << " threads: " << differences
+                    << " pixels differ, largest difference " << maximumDifference << std::endl;
+          return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+
+  threaded->Print( std::cout );
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -26,6 +26,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 namespace itk
 {
@@ -118,6 +119,22 @@ public:
   LevelSetOutputRealType Evaluate( const LevelSetInputIndexType& iP,
                                    const LevelSetDataType& iData );
 
+  /** Largest magnitude of each term, in the order of the terms */
+  typedef std::vector< LevelSetOutputRealType > TermContributionArrayType;
+
+  /** Evaluate the terms at a given pixel location, accumulating the CFL
+   *  contribution of each term in ioContribution rather than in the
+   *  container. Several threads can call this method at the same time, each
+   *  with its own ioContribution, as long as the terms do not modify their
+   *  state while being evaluated. The contributions are then added with
+   *  MergeTermContribution(). */
+  LevelSetOutputRealType Evaluate( const LevelSetInputIndexType& iP,
+                                   const LevelSetDataType& iData,
+                                   TermContributionArrayType& ioContribution );
+
+  /** Merge the CFL contributions gathered by Evaluate( iP, iData, ioContribution ) */
+  void MergeTermContribution( const TermContributionArrayType& iContribution );
+
   /** Update the term parameters at end of iteration */
   void Update();
 
@@ -330,6 +330,61 @@ LevelSetEquationTermContainerBase< TInputImage, TLevelSetContainer >
   return oValue;
 }
 
+// ----------------------------------------------------------------------------
+template< class TInputImage, class TLevelSetContainer >
+typename LevelSetEquationTermContainerBase< TInputImage, TLevelSetContainer >::LevelSetOutputRealType
+LevelSetEquationTermContainerBase< TInputImage, TLevelSetContainer >
+::Evaluate( const LevelSetInputIndexType& iP, const LevelSetDataType& iData,
+            TermContributionArrayType& ioContribution )
+{
+  if( ioContribution.size() != m_Container.size() )
+    {
+    ioContribution.assign( m_Container.size(), NumericTraits< LevelSetOutputRealType >::Zero );
+    }
+
+  MapTermContainerIteratorType term_it  = m_Container.begin();
+  MapTermContainerIteratorType term_end = m_Container.end();
+
+  typename TermContributionArrayType::iterator cfl_it = ioContribution.begin();
+
+  LevelSetOutputRealType oValue = NumericTraits< LevelSetOutputRealType >::Zero;
+
+  while( term_it != term_end )
+    {
+    LevelSetOutputRealType temp_val = ( term_it->second )->Evaluate( iP, iData );
+
+    *cfl_it = vnl_math_max( vnl_math_abs( temp_val ), *cfl_it );
+
+    oValue += temp_val;
+    ++term_it;
+    ++cfl_it;
+    }
+
+  return oValue;
+}
+
+// ----------------------------------------------------------------------------
+template< class TInputImage, class TLevelSetContainer >
+void
+LevelSetEquationTermContainerBase< TInputImage, TLevelSetContainer >
+::MergeTermContribution( const TermContributionArrayType& iContribution )
+{
+  if( iContribution.size() != m_TermContribution.size() )
+    {
+    return;
+    }
+
+  MapCFLContainerIterator cfl_it = m_TermContribution.begin();
+  typename TermContributionArrayType::const_iterator it = iContribution.begin();
+
+  while( cfl_it != m_TermContribution.end() )
+    {
+    cfl_it->second = vnl_math_max( *it, cfl_it->second );
+    ++cfl_it;
+    ++it;
+    }
+}
+
 // ----------------------------------------------------------------------------
 template< class TInputImage, class TLevelSetContainer >
 void
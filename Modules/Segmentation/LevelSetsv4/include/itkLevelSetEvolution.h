@@ -134,9 +134,22 @@ protected:
    *  the stopping criterion is satisfied */
   virtual void RunOneIteration();
 
+  typedef typename TermContainerType::TermContributionArrayType TermContributionArrayType;
+
+  /** Per-thread CFL contributions, see ThreadedComputeIteration() */
+  std::vector< TermContributionArrayType > m_ThreadTermContribution;
+
   /** Computer the update at each pixel and store in the update buffer */
   void ComputeIteration();
 
+  /** Compute the update of the pixels of iRegion when a single level set
+   *  covers the input image */
+  void ThreadedComputeIteration( const InputImageRegionType& iRegion,
+                                 TermContributionArrayType& ioContribution );
+
+  /** Split the requested region of the input image between the threads */
+  static ITK_THREAD_RETURN_TYPE ComputeIterationThreaderCallback( void* arg );
+
   /** Compute the time-step for the next iteration */
   void ComputeTimeStepForNextIteration();
 
@@ -233,6 +246,17 @@ protected:
   // For sparse case, the update buffer needs to be the size of the active layer
   std::map< IdentifierType, LevelSetLayerType* >  m_UpdateBuffer;
 
+  typedef typename TermContainerType::TermContributionArrayType TermContributionArrayType;
+
+  /** The active layer of the level set being evaluated, flattened in the
+   *  order of the layer so that it can be split between threads, and the
+   *  updates computed for each of its nodes. Both are kept between
+   *  iterations to reuse their storage. */
+  std::vector< LevelSetInputType >          m_ActiveNodes;
+  std::vector< LevelSetOutputType >         m_ActiveNodeUpdates;
+  std::vector< TermContributionArrayType >  m_ThreadTermContribution;
+  TermContainerPointer                      m_CurrentTermContainer;
+
   /** Initialize the update buffers for all level sets to hold the updates of
    *  equations in each iteration */
   void AllocateUpdateBuffer();
@@ -244,6 +268,13 @@ protected:
   /** Compute the update at each pixel and store in the update buffer */
   void ComputeIteration();
 
+  /** Compute the updates of the nodes [iBegin, iEnd) of m_ActiveNodes */
+  void ThreadedComputeIteration( const SizeValueType& iBegin, const SizeValueType& iEnd,
+                                 TermContributionArrayType& ioContribution );
+
+  /** Split m_ActiveNodes between the threads */
+  static ITK_THREAD_RETURN_TYPE ComputeIterationThreaderCallback( void* arg );
+
   /** Compute the time-step for the next iteration */
   void ComputeTimeStepForNextIteration();
 
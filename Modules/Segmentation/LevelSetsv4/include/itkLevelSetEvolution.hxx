@@ -21,6 +21,7 @@
 #define __itkLevelSetEvolution_hxx
 
 #include "itkLevelSetEvolution.h"
+#include "itkImageRegionSplitter.h"
 
 namespace itk
 {
@@ -130,24 +131,78 @@ LevelSetEvolution< TEquationContainer, LevelSetDenseImageBase< TImage > >
     }
   else // assume there is one level set that covers the RequestedRegion of the InputImage
     {
-    ImageRegionConstIteratorWithIndex< InputImageType > it( inputImage, inputImage->GetRequestedRegion() );
-    it.GoToBegin();
-    while( !it.IsAtEnd() )
+    this->m_Threader->SetNumberOfThreads( this->m_NumberOfThreads );
+    const ThreadIdType numberOfThreads = this->m_Threader->GetNumberOfThreads();
+
+    this->m_ThreadTermContribution.assign( numberOfThreads, TermContributionArrayType() );
+
+    if( numberOfThreads > 1 )
+      {
+      this->m_Threader->SetSingleMethod( this->ComputeIterationThreaderCallback, this );
+      this->m_Threader->SingleMethodExecute();
+      }
+    else
       {
-      LevelSetPointer levelSetUpdate = this->m_UpdateBuffer->GetLevelSet( 0 );
+      this->ThreadedComputeIteration( inputImage->GetRequestedRegion(), this->m_ThreadTermContribution[0] );
+      }
+
+    TermContainerPointer termContainer = this->m_EquationContainer->GetEquation( 0 );
+    for( ThreadIdType i = 0; i < numberOfThreads; i++ )
+      {
+      termContainer->MergeTermContribution( this->m_ThreadTermContribution[i] );
+      }
+    }
+}
 
-      LevelSetDataType characteristics;
+template< class TEquationContainer, class TImage >
+void
+LevelSetEvolution< TEquationContainer, LevelSetDenseImageBase< TImage > >
+::ThreadedComputeIteration( const InputImageRegionType& iRegion, TermContributionArrayType& ioContribution )
+{
+  InputImageConstPointer inputImage = this->m_EquationContainer->GetInput();
 
-      TermContainerPointer termContainer = this->m_EquationContainer->GetEquation( 0 );
-      termContainer->ComputeRequiredData( it.GetIndex(), characteristics );
+  TermContainerPointer termContainer = this->m_EquationContainer->GetEquation( 0 );
+  LevelSetImageType* levelSetImage = this->m_UpdateBuffer->GetLevelSet( 0 )->GetImage();
 
-      LevelSetOutputRealType temp_update = termContainer->Evaluate( it.GetIndex(), characteristics );
+  ImageRegionConstIteratorWithIndex< InputImageType > it( inputImage, iRegion );
+  it.GoToBegin();
+  while( !it.IsAtEnd() )
+    {
+    LevelSetDataType characteristics;
 
-      LevelSetImageType* levelSetImage = levelSetUpdate->GetImage();
-      levelSetImage->SetPixel( it.GetIndex(), temp_update );
-      ++it;
-      }
+    termContainer->ComputeRequiredData( it.GetIndex(), characteristics );
+
+    LevelSetOutputRealType temp_update = termContainer->Evaluate( it.GetIndex(), characteristics, ioContribution );
+
+    levelSetImage->SetPixel( it.GetIndex(), temp_update );
+    ++it;
+    }
+}
+
+template< class TEquationContainer, class TImage >
+ITK_THREAD_RETURN_TYPE
+LevelSetEvolution< TEquationContainer, LevelSetDenseImageBase< TImage > >
+::ComputeIterationThreaderCallback( void* arg )
+{
+  MultiThreader::ThreadInfoStruct* info = static_cast< MultiThreader::ThreadInfoStruct* >( arg );
+  Self* self = static_cast< Self* >( info->UserData );
+
+  const ThreadIdType threadId = info->ThreadID;
+
+  InputImageRegionType region = self->m_EquationContainer->GetInput()->GetRequestedRegion();
+
+  typedef ImageRegionSplitter< ImageDimension > SplitterType;
+  typename SplitterType::Pointer splitter = SplitterType::New();
+
+  const unsigned int numberOfPieces = splitter->GetNumberOfSplits( region, info->NumberOfThreads );
+
+  if( threadId < numberOfPieces )
+    {
+    region = splitter->GetSplit( threadId, numberOfPieces, region );
+    self->ThreadedComputeIteration( region, self->m_ThreadTermContribution[threadId] );
     }
+
+  return ITK_THREAD_RETURN_VALUE;
 }
 
 template< class TEquationContainer, class TImage >
@@ -363,31 +418,104 @@ LevelSetEvolution< TEquationContainer, WhitakerSparseLevelSetImage< TOutput, VDi
     LevelSetPointer levelSet = it->GetLevelSet();
 
     LevelSetIdentifierType levelSetId = it->GetIdentifier();
-    TermContainerPointer termContainer = this->m_EquationContainer->GetEquation( levelSetId );
+    this->m_CurrentTermContainer = this->m_EquationContainer->GetEquation( levelSetId );
+
+    // Flatten the active layer so that it can be split between threads
+    this->m_ActiveNodes.clear();
 
     LevelSetLayerIterator list_it = levelSet->GetLayer( 0 ).begin();
     LevelSetLayerIterator list_end = levelSet->GetLayer( 0 ).end();
 
     while( list_it != list_end )
       {
-      const LevelSetInputType idx = list_it->first;
+      this->m_ActiveNodes.push_back( list_it->first );
+      ++list_it;
+      }
 
-      LevelSetDataType characteristics;
+    const SizeValueType numberOfNodes = this->m_ActiveNodes.size();
+    this->m_ActiveNodeUpdates.resize( numberOfNodes );
 
-      termContainer->ComputeRequiredData( idx, characteristics );
+    ThreadIdType numberOfThreads = this->m_NumberOfThreads;
+    if( numberOfNodes < numberOfThreads )
+      {
+      numberOfThreads = ( numberOfNodes > 0 ) ? static_cast< ThreadIdType >( numberOfNodes ) : 1;
+      }
+    this->m_Threader->SetNumberOfThreads( numberOfThreads );
+    numberOfThreads = this->m_Threader->GetNumberOfThreads();
 
-      const LevelSetOutputType temp_update =
-          static_cast< LevelSetOutputType >( termContainer->Evaluate( idx, characteristics ) );
+    this->m_ThreadTermContribution.assign( numberOfThreads, TermContributionArrayType() );
 
-      this->m_UpdateBuffer[ levelSetId ]->insert(
-            NodePairType( idx, temp_update ) );
+    if( numberOfThreads > 1 )
+      {
+      this->m_Threader->SetSingleMethod( this->ComputeIterationThreaderCallback, this );
+      this->m_Threader->SingleMethodExecute();
+      }
+    else
+      {
+      this->ThreadedComputeIteration( 0, numberOfNodes, this->m_ThreadTermContribution[0] );
+      }
 
-      ++list_it;
+    for( ThreadIdType i = 0; i < numberOfThreads; i++ )
+      {
+      this->m_CurrentTermContainer->MergeTermContribution( this->m_ThreadTermContribution[i] );
       }
+
+    // The nodes are in the order of the layer: each insertion is done in
+    // constant time at the end of the update buffer
+    LevelSetLayerType* updateBuffer = this->m_UpdateBuffer[ levelSetId ];
+    for( SizeValueType i = 0; i < numberOfNodes; i++ )
+      {
+      updateBuffer->insert( updateBuffer->end(),
+                            NodePairType( this->m_ActiveNodes[i], this->m_ActiveNodeUpdates[i] ) );
+      }
+
+    this->m_CurrentTermContainer = NULL;
     ++it;
     }
 }
 
+template< class TEquationContainer, typename TOutput, unsigned int VDimension >
+void
+LevelSetEvolution< TEquationContainer, WhitakerSparseLevelSetImage< TOutput, VDimension > >
+::ThreadedComputeIteration( const SizeValueType& iBegin, const SizeValueType& iEnd,
+                            TermContributionArrayType& ioContribution )
+{
+  TermContainerType* termContainer = this->m_CurrentTermContainer;
+
+  for( SizeValueType i = iBegin; i < iEnd; i++ )
+    {
+    const LevelSetInputType& idx = this->m_ActiveNodes[i];
+
+    LevelSetDataType characteristics;
+
+    termContainer->ComputeRequiredData( idx, characteristics );
+
+    this->m_ActiveNodeUpdates[i] =
+        static_cast< LevelSetOutputType >( termContainer->Evaluate( idx, characteristics, ioContribution ) );
+    }
+}
+
+template< class TEquationContainer, typename TOutput, unsigned int VDimension >
+ITK_THREAD_RETURN_TYPE
+LevelSetEvolution< TEquationContainer, WhitakerSparseLevelSetImage< TOutput, VDimension > >
+::ComputeIterationThreaderCallback( void* arg )
+{
+  MultiThreader::ThreadInfoStruct* info = static_cast< MultiThreader::ThreadInfoStruct* >( arg );
+  Self* self = static_cast< Self* >( info->UserData );
+
+  const ThreadIdType threadId = info->ThreadID;
+  const ThreadIdType numberOfThreads = info->NumberOfThreads;
+  const SizeValueType numberOfNodes = self->m_ActiveNodes.size();
+
+  // Contiguous chunks keep the nodes of one thread close in the image
+  const SizeValueType begin = ( numberOfNodes * threadId ) / numberOfThreads;
+  const SizeValueType end = ( numberOfNodes * ( threadId + 1 ) ) / numberOfThreads;
+
+  self->ThreadedComputeIteration( begin, end, self->m_ThreadTermContribution[threadId] );
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
 template< class TEquationContainer, typename TOutput, unsigned int VDimension >
 void
 LevelSetEvolution< TEquationContainer, WhitakerSparseLevelSetImage< TOutput, VDimension > >
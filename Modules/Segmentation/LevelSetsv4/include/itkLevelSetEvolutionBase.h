@@ -28,6 +28,7 @@
 #include "itkBinaryThresholdImageFilter.h"
 #include "itkSignedMaurerDistanceMapImageFilter.h"
 #include "itkNumericTraits.h"
+#include "itkMultiThreader.h"
 #include "itkLevelSetEvolutionStoppingCriterionBase.h"
 
 namespace itk
@@ -120,6 +121,12 @@ public:
   itkSetMacro( NumberOfIterations, IdentifierType );
   itkGetConstMacro( NumberOfIterations, IdentifierType );
 
+  /** Set/Get the number of threads used to evaluate the equations at each
+   *  iteration. Defaults to the global default number of threads. The terms
+   *  of the equations must then not modify their state in Evaluate(). */
+  itkSetClampMacro( NumberOfThreads, ThreadIdType, 1, ITK_MAX_THREADS );
+  itkGetConstMacro( NumberOfThreads, ThreadIdType );
+
   /** Update the filter by computing the output level function
    * by calling RunOneIteration() once the instantiation of necessary variables
    * is verified */
@@ -141,6 +148,9 @@ protected:
   bool                        m_UserGloballyDefinedTimeStep;
   IdentifierType              m_NumberOfIterations;
 
+  ThreadIdType                m_NumberOfThreads;
+  MultiThreader::Pointer      m_Threader;
+
   void CheckSetUp();
 
   /** Run the iterative loops of calculating levelset function updates until
@@ -32,6 +32,9 @@ LevelSetEvolutionBase< TEquationContainer, TLevelSet >
   this->m_Dt = 1.;
   this->m_RMSChangeAccumulator = 0.;
   this->m_UserGloballyDefinedTimeStep = false;
+  this->m_NumberOfIterations = 0;
+  this->m_Threader = MultiThreader::New();
+  this->m_NumberOfThreads = this->m_Threader->GetNumberOfThreads();
 }
 
 template< class TEquationContainer, class TLevelSet >
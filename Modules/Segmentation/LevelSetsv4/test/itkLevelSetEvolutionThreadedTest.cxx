@@ -0,0 +1,239 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkLevelSetContainer.h"
+#include "itkLevelSetEquationChanAndVeseInternalTerm.h"
+#include "itkLevelSetEquationChanAndVeseExternalTerm.h"
+#include "itkLevelSetEquationCurvatureTerm.h"
+#include "itkLevelSetEquationTermContainerBase.h"
+#include "itkLevelSetEquationContainerBase.h"
+#include "itkSinRegularizedHeavisideStepFunction.h"
+#include "itkLevelSetEvolution.h"
+#include "itkBinaryImageToLevelSetImageAdaptor.h"
+#include "itkLevelSetEvolutionNumberOfIterationsStoppingCriterion.h"
+
+const unsigned int Dimension = 2;
+
+typedef unsigned short                                    InputPixelType;
+typedef itk::Image< InputPixelType, Dimension >           InputImageType;
+typedef itk::ImageRegionIteratorWithIndex< InputImageType > InputIteratorType;
+
+// Evolve a level set initialized with a square towards a disk, using the
+// given number of threads, and return the evolved level set.
+template< class TLevelSet >
+typename TLevelSet::Pointer
+itkLevelSetEvolutionThreadedTestEvolve( InputImageType* input,
+                                        InputImageType* binary,
+                                        itk::ThreadIdType numberOfThreads,
+                                        unsigned int numberOfIterations )
+{
+  typedef TLevelSet LevelSetType;
+
+  typedef itk::BinaryImageToLevelSetImageAdaptor< InputImageType, LevelSetType >
+                                                            BinaryToLevelSetAdaptorType;
+  typedef itk::LevelSetContainer< itk::IdentifierType, LevelSetType >
+                                                            LevelSetContainerType;
+  typedef itk::LevelSetEquationChanAndVeseInternalTerm< InputImageType, LevelSetContainerType >
+                                                            ChanAndVeseInternalTermType;
+  typedef itk::LevelSetEquationChanAndVeseExternalTerm< InputImageType, LevelSetContainerType >
+                                                            ChanAndVeseExternalTermType;
+  typedef itk::LevelSetEquationCurvatureTerm< InputImageType, LevelSetContainerType >
+                                                            CurvatureTermType;
+  typedef itk::LevelSetEquationTermContainerBase< InputImageType, LevelSetContainerType >
+                                                            TermContainerType;
+  typedef itk::LevelSetEquationContainerBase< TermContainerType >
+                                                            EquationContainerType;
+  typedef itk::LevelSetEvolution< EquationContainerType, LevelSetType >
+                                                            LevelSetEvolutionType;
+  typedef typename LevelSetType::OutputRealType             LevelSetOutputRealType;
+  typedef itk::SinRegularizedHeavisideStepFunction< LevelSetOutputRealType, LevelSetOutputRealType >
+                                                            HeavisideFunctionBaseType;
+  typedef itk::LevelSetEvolutionNumberOfIterationsStoppingCriterion< LevelSetContainerType >
+                                                            StoppingCriterionType;
+
+  typename BinaryToLevelSetAdaptorType::Pointer adaptor = BinaryToLevelSetAdaptorType::New();
+  adaptor->SetInputImage( binary );
+  adaptor->Initialize();
+
+  typename LevelSetType::Pointer levelSet = adaptor->GetLevelSet();
+
+  typename HeavisideFunctionBaseType::Pointer heaviside = HeavisideFunctionBaseType::New();
+  heaviside->SetEpsilon( 1.0 );
+
+  typename LevelSetContainerType::Pointer lscontainer = LevelSetContainerType::New();
+  lscontainer->SetHeaviside( heaviside );
+  lscontainer->AddLevelSet( 0, levelSet, false );
+
+  typename ChanAndVeseInternalTermType::Pointer cvInternalTerm = ChanAndVeseInternalTermType::New();
+  cvInternalTerm->SetInput( input );
+  cvInternalTerm->SetCoefficient( 1.0 );
+
+  typename ChanAndVeseExternalTermType::Pointer cvExternalTerm = ChanAndVeseExternalTermType::New();
+  cvExternalTerm->SetInput( input );
+  cvExternalTerm->SetCoefficient( 1.0 );
+
+  typename CurvatureTermType::Pointer curvatureTerm = CurvatureTermType::New();
+  curvatureTerm->SetInput( input );
+  curvatureTerm->SetCoefficient( 1.0 );
+
+  typename TermContainerType::Pointer termContainer = TermContainerType::New();
+  termContainer->SetInput( input );
+  termContainer->SetCurrentLevelSetId( 0 );
+  termContainer->SetLevelSetContainer( lscontainer );
+  termContainer->AddTerm( 0, cvInternalTerm );
+  termContainer->AddTerm( 1, cvExternalTerm );
+  termContainer->AddTerm( 2, curvatureTerm );
+
+  typename EquationContainerType::Pointer equationContainer = EquationContainerType::New();
+  equationContainer->SetLevelSetContainer( lscontainer );
+  equationContainer->AddEquation( 0, termContainer );
+
+  typename StoppingCriterionType::Pointer criterion = StoppingCriterionType::New();
+  criterion->SetNumberOfIterations( numberOfIterations );
+
+  typename LevelSetEvolutionType::Pointer evolution = LevelSetEvolutionType::New();
+  evolution->SetEquationContainer( equationContainer );
+  evolution->SetStoppingCriterion( criterion );
+  evolution->SetLevelSetContainer( lscontainer );
+  evolution->SetNumberOfThreads( numberOfThreads );
+  if( evolution->GetNumberOfThreads() != numberOfThreads )
+    {
+    std::cerr << "GetNumberOfThreads() returned " << evolution->GetNumberOfThreads()
+              << ", expected " << numberOfThreads << std::endl;
+    return NULL;
+    }
+
+  evolution->Update();
+
+  return levelSet;
+}
+
+// Evolve the level set with one and with several threads, and check that
+// the threaded evaluation of the equation gives the same level set.
+template< class TLevelSet >
+bool
+itkLevelSetEvolutionThreadedTestCompare( const char* name,
+                                         InputImageType* input,
+                                         InputImageType* binary )
+{
+  const unsigned int numberOfIterations = 10;
+
+  typename TLevelSet::Pointer reference;
+  typename TLevelSet::Pointer threaded;
+  try
+    {
+    reference = itkLevelSetEvolutionThreadedTestEvolve< TLevelSet >( input, binary, 1, numberOfIterations );
+    threaded = itkLevelSetEvolutionThreadedTestEvolve< TLevelSet >( input, binary, 4, numberOfIterations );
+    }
+  catch( itk::ExceptionObject & err )
+    {
+    std::cerr << name << ": " << err << std::endl;
+    return false;
+    }
+  if( reference.IsNull() || threaded.IsNull() )
+    {
+    return false;
+    }
+
+  unsigned int numberOfNegativeValues = 0;
+
+  InputIteratorType it( input, input->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const typename TLevelSet::OutputType expected = reference->Evaluate( it.GetIndex() );
+    const typename TLevelSet::OutputType value = threaded->Evaluate( it.GetIndex() );
+    if( value != expected )
+      {
+      std::cerr << name << ": level set is " << value << " at " << it.GetIndex()
+                << " with 4 threads, and " << expected << " with 1 thread" << std::endl;
+      return false;
+      }
+    if( value < 0 )
+      {
+      ++numberOfNegativeValues;
+      }
+    }
+
+  if( numberOfNegativeValues == 0 )
+    {
+    std::cerr << name << ": the level set has no inside" << std::endl;
+    return false;
+    }
+
+  std::cout << name << ": " << numberOfNegativeValues << " pixels inside" << std::endl;
+  return true;
+}
+
+int itkLevelSetEvolutionThreadedTest( int , char* [] )
+{
+  typedef float                                                     PixelType;
+  typedef itk::Image< PixelType, Dimension >                        LevelSetImageType;
+  typedef itk::LevelSetDenseImageBase< LevelSetImageType >          DenseLevelSetType;
+  typedef itk::WhitakerSparseLevelSetImage< PixelType, Dimension >  SparseLevelSetType;
+
+  InputImageType::SizeType size;
+  size.Fill( 64 );
+  InputImageType::RegionType region;
+  region.SetSize( size );
+
+  // Bright disk on a dark background
+  InputImageType::Pointer input = InputImageType::New();
+  input->SetRegions( region );
+  input->Allocate();
+
+  InputIteratorType iIt( input, region );
+  for( iIt.GoToBegin(); !iIt.IsAtEnd(); ++iIt )
+    {
+    const InputImageType::IndexType idx = iIt.GetIndex();
+    const double dx = idx[0] - 32.;
+    const double dy = idx[1] - 30.;
+    iIt.Set( dx * dx + dy * dy < 18. * 18. ? 200 : 20 );
+    }
+
+  // Initialize with a square inside the disk
+  InputImageType::Pointer binary = InputImageType::New();
+  binary->SetRegions( region );
+  binary->Allocate();
+  binary->FillBuffer( itk::NumericTraits< InputPixelType >::Zero );
+
+  InputImageType::IndexType index;
+  index.Fill( 24 );
+  InputImageType::SizeType squareSize;
+  squareSize.Fill( 16 );
+  InputImageType::RegionType square;
+  square.SetIndex( index );
+  square.SetSize( squareSize );
+
+  InputIteratorType bIt( binary, square );
+  for( bIt.GoToBegin(); !bIt.IsAtEnd(); ++bIt )
+    {
+    bIt.Set( itk::NumericTraits< InputPixelType >::One );
+    }
+
+  if( !itkLevelSetEvolutionThreadedTestCompare< DenseLevelSetType >( "Dense", input, binary ) )
+    {
+    return EXIT_FAILURE;
+    }
+  if( !itkLevelSetEvolutionThreadedTestCompare< SparseLevelSetType >( "Whitaker", input, binary ) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -185,7 +185,8 @@ public:
   /** Method for creation through the object factory. */
   itkNewMacro(Self);
 
-  /** Standard process object method.  This filter is not multithreaded. */
+  /** Standard process object method.  Only the initial segmentation is
+   * multithreaded, when NumberOfChunks is greater than one. */
   void GenerateData();
 
   /** Overloaded to link the input to this filter with the input of the
@@ -225,6 +226,15 @@ public:
 
   itkGetConstMacro(Level, double);
 
+  /** Set/Get the number of chunks into which the initial segmentation is
+   * split along the last dimension of the image.  The chunks are segmented
+   * on the threads of this filter and joined with the boundary resolution
+   * of streamed segmentations.  See watershed::Segmenter::SetNumberOfChunks.
+   * Default is 1. */
+  void SetNumberOfChunks(unsigned int);
+
+  itkGetConstMacro(NumberOfChunks, unsigned int);
+
   /** Get the basic segmentation from the Segmenter member filter. */
   typename watershed::Segmenter< InputImageType >::OutputImageType *
   GetBasicSegmentation()
@@ -279,6 +289,9 @@ private:
    *  level. */
   double m_Level;
 
+  /** The number of chunks of the initial segmentation. */
+  unsigned int m_NumberOfChunks;
+
   /** The component parts of the segmentation algorithm.  These objects
    * must save state between calls to GenerateData() so that the
    * computationally expensive execution of segment tree generation is
@@ -293,6 +306,7 @@ private:
 
   bool m_LevelChanged;
   bool m_ThresholdChanged;
+  bool m_NumberOfChunksChanged;
   bool m_InputChanged;
 
   TimeStamp m_GenerateDataMTime;
@@ -70,9 +70,29 @@ WatershedImageFilter< TInputImage >
     }
 }
 
+template< class TInputImage >
+void
+WatershedImageFilter< TInputImage >
+::SetNumberOfChunks(unsigned int val)
+{
+  if ( val < 1 )
+    {
+    val = 1;
+    }
+
+  if ( val != m_NumberOfChunks )
+    {
+    m_NumberOfChunks = val;
+    m_Segmenter->SetNumberOfChunks(m_NumberOfChunks);
+
+    m_NumberOfChunksChanged = true;
+    this->Modified();
+    }
+}
+
 template< class TInputImage >
 WatershedImageFilter< TInputImage >
-::WatershedImageFilter():m_Threshold(0.0), m_Level(0.0)
+::WatershedImageFilter():m_Threshold(0.0), m_Level(0.0), m_NumberOfChunks(1)
 {
   // Set up the mini-pipeline for the first execution.
   m_Segmenter    = watershed::Segmenter< InputImageType >::New();
@@ -82,6 +102,7 @@ WatershedImageFilter< TInputImage >
   m_Segmenter->SetDoBoundaryAnalysis(false);
   m_Segmenter->SetSortEdgeLists(true);
   m_Segmenter->SetThreshold( this->GetThreshold() );
+  m_Segmenter->SetNumberOfChunks( this->GetNumberOfChunks() );
 
   m_TreeGenerator->SetInputSegmentTable( m_Segmenter->GetSegmentTable() );
   m_TreeGenerator->SetMerge(false);
@@ -103,6 +124,7 @@ WatershedImageFilter< TInputImage >
   m_InputChanged = true;
   m_LevelChanged = true;
   m_ThresholdChanged = true;
+  m_NumberOfChunksChanged = true;
 }
 
 template< class TInputImage >
@@ -130,13 +152,14 @@ WatershedImageFilter< TInputImage >
   // to re-execute.  Plus, the HighestCalculatedFloodLevel must be reset
   // on the Tree Generator.
   //
-  // If the threshold changed, then Segmenter + Tree Generator +
-  // Relabeler need to re-execute.  Plus, the
+  // If the threshold or the number of chunks changed, then Segmenter +
+  // Tree Generator + Relabeler need to re-execute.  Plus, the
   // HighestCalculatedFloodLevel must be reset on the Tree Generator
   //
   if ( m_InputChanged
        || ( this->GetInput()->GetPipelineMTime() > m_GenerateDataMTime )
-       || m_ThresholdChanged )
+       || m_ThresholdChanged
+       || m_NumberOfChunksChanged )
     {
     m_Segmenter->PrepareOutputs();
     m_TreeGenerator->PrepareOutputs();
@@ -178,6 +201,9 @@ WatershedImageFilter< TInputImage >
   m_Segmenter->GetOutputImage()
   ->SetRequestedRegion( this->GetInput()->GetLargestPossibleRegion() );
 
+  // The chunks of the segmenter run on our threads
+  m_Segmenter->SetNumberOfThreads( this->GetNumberOfThreads() );
+
   // Setup the progress command
   WatershedMiniPipelineProgressCommand::Pointer c =
     dynamic_cast< WatershedMiniPipelineProgressCommand * >(
@@ -201,6 +227,7 @@ WatershedImageFilter< TInputImage >
   m_InputChanged = false;
   m_LevelChanged = false;
   m_ThresholdChanged = false;
+  m_NumberOfChunksChanged = false;
 }
 
 template< class TInputImage >
@@ -211,6 +238,7 @@ WatershedImageFilter< TInputImage >
   Superclass::PrintSelf(os, indent);
   os << indent << "Threshold: " << m_Threshold << std::endl;
   os << indent << "Level: " << m_Level << std::endl;
+  os << indent << "NumberOfChunks: " << m_NumberOfChunks << std::endl;
 }
 } // end namespace itk
 
@@ -231,6 +231,20 @@ public:
    * after all iterations have taken place. */
   itkGetConstMacro(SortEdgeLists, bool);
   itkSetMacro(SortEdgeLists, bool);
+
+  /** Gets/Sets the number of chunks into which the region is split along
+   * its last dimension.  The chunks are segmented on the threads of this
+   * filter, with boundary analysis, and are joined with a BoundaryResolver
+   * before their segment tables are merged.  Up to the numbering of the
+   * labels, the result is the one of the whole region, except where a flat
+   * region crosses a chunk face: each chunk then drains its part of the
+   * flat region on its own, so the segments around it differ from those
+   * of the whole region.  Such faces are common with integer pixel types,
+   * and with a Threshold greater than zero, which flattens the lowest
+   * values of the image.  Only used when DoBoundaryAnalysis is off.
+   * Default is 1. */
+  itkSetClampMacro(NumberOfChunks, unsigned int, 1, NumericTraits< unsigned int >::max());
+  itkGetConstMacro(NumberOfChunks, unsigned int);
 protected:
   /** Structure storing information about image flat regions.
    * Flat regions are connected pixels of the same value.  */
@@ -319,6 +333,11 @@ protected:
    * image.  */
   void UpdateSegmentTable(InputImageTypePointer, ImageRegionType);
 
+  /** Segments the region in numberOfChunks chunks on several threads
+   * and joins the results.  Used when NumberOfChunks is greater than
+   * one.   */
+  void ChunkedGenerateData(unsigned int numberOfChunks);
+
   /** Traverses each boundary and fills in the data needed for joining
    * streamed chunks of an image volume.  Only necessary for streaming
    * applications.   */
@@ -373,6 +392,49 @@ private:
   double          m_Threshold;
   double          m_MaximumFloodLevel;
   IdentifierType  m_CurrentLabel;
+  unsigned int    m_NumberOfChunks;
+
+  /** The range of the whole region, set on the segmenters of the chunks
+   * so that they all threshold the input at the same level. */
+  bool            m_UseRegionRange;
+  InputPixelType  m_RegionMinimum;
+  InputPixelType  m_RegionMaximum;
+
+  /** The segmenters of the chunks and the parts of the output they
+   * fill, shared by the threads. */
+  struct ChunkStruct {
+    Self                           *Filter;
+    bool                           Relabel;
+    std::vector< Pointer >         Segmenters;
+    std::vector< ImageRegionType > Regions;
+    EquivalencyTable::Pointer      Equivalencies;
+  };
+
+  static ITK_THREAD_RETURN_TYPE ChunkThreaderCallback(void *arg);
+
+  /** Segments a chunk and copies its labels in the output.  The
+   * boundary and the segment table of the chunk are kept for the
+   * join. */
+  void SegmentChunk(ChunkStruct & str, unsigned int chunk);
+
+  /** Replaces the labels of the part of the output filled by a chunk
+   * with the labels they are equivalent to. */
+  void RelabelChunk(ChunkStruct & str, unsigned int chunk);
+
+  /** The value of a pixel after thresholding at the given level. */
+  static InputPixelType ThresholdValue(InputPixelType value, InputPixelType level)
+  {
+    if ( value < level )
+      {
+      return level;
+      }
+    if ( NumericTraits< InputPixelType >::is_integer
+         && value == NumericTraits< InputPixelType >::max() )
+      {
+      return value - NumericTraits< InputPixelType >::One;
+      }
+    return value;
+  }
 };
 } // end namespace watershed
 } // end namespace itk
@@ -21,6 +21,8 @@
 #include "itkWatershedSegmenter.h"
 #include "itkNeighborhoodAlgorithm.h"
 #include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkWatershedBoundaryResolver.h"
 #include <stack>
 #include <list>
 
@@ -63,6 +65,21 @@ void Segmenter< TInputImage >::GenerateData()
   //
   unsigned int i;
 
+  // Split the region into chunks, as long as they are at least two
+  // pixels thick so that their faces do not overlap.
+  if ( m_DoBoundaryAnalysis == false && m_NumberOfChunks > 1 )
+    {
+    const SizeValueType length =
+      this->GetOutputImage()->GetRequestedRegion().GetSize()[ImageDimension - 1];
+    const unsigned int numberOfChunks = static_cast< unsigned int >(
+      vnl_math_min( static_cast< SizeValueType >( m_NumberOfChunks ), length / 2 ) );
+    if ( numberOfChunks > 1 )
+      {
+      this->ChunkedGenerateData(numberOfChunks);
+      return;
+      }
+    }
+
   this->UpdateProgress(0.0);
   if ( m_DoBoundaryAnalysis == false )
     {
@@ -184,7 +201,15 @@ void Segmenter< TInputImage >::GenerateData()
   //
   //
   InputPixelType minimum, maximum;
-  Self::MinMax(input, regionToProcess, minimum, maximum);
+  if ( m_UseRegionRange )
+    {
+    minimum = m_RegionMinimum;
+    maximum = m_RegionMaximum;
+    }
+  else
+    {
+    Self::MinMax(input, regionToProcess, minimum, maximum);
+    }
   // cap the maximum in the image so that we can always define a pixel
   // value that is one greater than the maximum value in the image.
   if ( NumericTraits< InputPixelType >::is_integer
@@ -192,6 +217,13 @@ void Segmenter< TInputImage >::GenerateData()
     {
     maximum -= NumericTraits< InputPixelType >::One;
     }
+  // The boundary flow analysis looks at the padding along the true data set
+  // boundary before the retaining wall is built, so it must already be
+  // higher than the image.
+  if ( m_DoBoundaryAnalysis == true )
+    {
+    thresholdImage->FillBuffer(maximum + NumericTraits< InputPixelType >::One);
+    }
   // threshold the image.
   Self::Threshold( thresholdImage, input, regionToProcess, regionToProcess,
                    static_cast< InputPixelType >( ( m_Threshold * ( maximum - minimum ) ) + minimum ) );
@@ -325,6 +357,325 @@ void Segmenter< TInputImage >::GenerateData()
   this->UpdateProgress(1.0);
 }
 
+template< class TInputImage >
+void Segmenter< TInputImage >
+::ChunkedGenerateData(unsigned int numberOfChunks)
+{
+  unsigned int i, c;
+
+  this->UpdateProgress(0.0);
+  this->GetSegmentTable()->Clear();
+
+  typename InputImageType::Pointer input   = this->GetInputImage();
+  typename OutputImageType::Pointer output = this->GetOutputImage();
+  typename SegmentTableType::Pointer segments = this->GetSegmentTable();
+  const unsigned int lastDimension = ImageDimension - 1;
+
+  //
+  // All the chunks threshold the input at the level computed from the
+  // dynamic range of the whole region.
+  //
+  const ImageRegionType regionToProcess = output->GetRequestedRegion();
+  InputPixelType        minimum, maximum;
+  Self::MinMax(input, regionToProcess, minimum, maximum);
+  if ( NumericTraits< InputPixelType >::is_integer
+       && maximum == NumericTraits< InputPixelType >::max() )
+    {
+    maximum -= NumericTraits< InputPixelType >::One;
+    }
+  const InputPixelType thresholdLevel =
+    static_cast< InputPixelType >( ( m_Threshold * ( maximum - minimum ) ) + minimum );
+
+  //
+  // As for a single chunk, the output is padded by one pixel on the
+  // faces that lie on the true data set boundary.
+  //
+  typename ImageRegionType::IndexType oidx = regionToProcess.GetIndex();
+  typename ImageRegionType::SizeType osz = regionToProcess.GetSize();
+  for ( i = 0; i < ImageDimension; ++i )
+    {
+    if ( regionToProcess.GetIndex()[i] == m_LargestPossibleRegion.GetIndex()[i] )
+      {
+      oidx[i] -= 1;
+      osz[i] += 1;
+      }
+    if ( regionToProcess.GetIndex()[i] + static_cast< OffsetValueType >( regionToProcess.GetSize()[i] )
+         == m_LargestPossibleRegion.GetIndex()[i]
+         + static_cast< OffsetValueType >( m_LargestPossibleRegion.GetSize()[i] ) )
+      {
+      osz[i] += 1;
+      }
+    }
+  ImageRegionType outputRegion(oidx, osz);
+  output->SetBufferedRegion(outputRegion);
+  output->Allocate();
+  Self::SetOutputImageValues(output, outputRegion, Self::NULL_LABEL);
+
+  //
+  // Set up a segmenter for each slab along the last dimension.  The
+  // slabs overlap by one pixel, like the chunks of a streamed data set,
+  // and the labels of different chunks do not overlap: a chunk has
+  // fewer segments than pixels.
+  //
+  ChunkStruct str;
+  str.Filter = this;
+  str.Relabel = false;
+  str.Segmenters.resize(numberOfChunks);
+  str.Regions.resize(numberOfChunks);
+
+  const OffsetValueType start = regionToProcess.GetIndex()[lastDimension];
+  const OffsetValueType length = regionToProcess.GetSize()[lastDimension];
+  IdentifierType        label = 1;
+  for ( c = 0; c < numberOfChunks; ++c )
+    {
+    const OffsetValueType begin = start + length * c / numberOfChunks;
+    const OffsetValueType end = start + length * ( c + 1 ) / numberOfChunks;
+
+    typename ImageRegionType::IndexType cidx = regionToProcess.GetIndex();
+    typename ImageRegionType::SizeType csz = regionToProcess.GetSize();
+    cidx[lastDimension] = ( c > 0 ) ? begin - 1 : begin;
+    csz[lastDimension] = ( ( c + 1 < numberOfChunks ) ? end + 1 : end ) - cidx[lastDimension];
+    const ImageRegionType chunkRegion(cidx, csz);
+
+    // The chunk only fills the part of the output it owns
+    cidx = outputRegion.GetIndex();
+    csz = outputRegion.GetSize();
+    if ( c > 0 )
+      {
+      cidx[lastDimension] = begin;
+      }
+    if ( c + 1 < numberOfChunks )
+      {
+      csz[lastDimension] = end - cidx[lastDimension];
+      }
+    else
+      {
+      csz[lastDimension] = oidx[lastDimension] + osz[lastDimension] - cidx[lastDimension];
+      }
+    str.Regions[c] = ImageRegionType(cidx, csz);
+
+    // Each chunk reads the input through its own image, so that
+    // releasing its input does not release the data of the others.
+    typename InputImageType::Pointer chunkInput = InputImageType::New();
+    chunkInput->Graft(input);
+
+    Pointer segmenter = Self::New();
+    segmenter->SetInputImage(chunkInput);
+    segmenter->SetLargestPossibleRegion(m_LargestPossibleRegion);
+    segmenter->GetOutputImage()->SetRequestedRegion(chunkRegion);
+    segmenter->SetThreshold(m_Threshold);
+    segmenter->SetDoBoundaryAnalysis(true);
+    segmenter->SetSortEdgeLists(false);
+    segmenter->SetCurrentLabel(label);
+    segmenter->m_UseRegionRange = true;
+    segmenter->m_RegionMinimum = minimum;
+    segmenter->m_RegionMaximum = maximum;
+    str.Segmenters[c] = segmenter;
+
+    label += chunkRegion.GetNumberOfPixels();
+    }
+
+  MultiThreader *threader = this->GetMultiThreader();
+  threader->SetNumberOfThreads( static_cast< ThreadIdType >(
+                                  vnl_math_min( static_cast< unsigned int >( this->GetNumberOfThreads() ),
+                                                numberOfChunks ) ) );
+  threader->SetSingleMethod(Self::ChunkThreaderCallback, &str);
+  threader->SingleMethodExecute();
+  this->UpdateProgress(0.6);
+
+  //
+  // Connect the labels that flow across the faces between the chunks.
+  //
+  typedef BoundaryResolver< InputPixelType, ImageDimension > BoundaryResolverType;
+  typename BoundaryResolverType::Pointer resolver = BoundaryResolverType::New();
+  resolver->SetFace(lastDimension);
+  for ( c = 0; c + 1 < numberOfChunks; ++c )
+    {
+    resolver->SetBoundaryA( str.Segmenters[c]->GetBoundary() );
+    resolver->SetBoundaryB( str.Segmenters[c + 1]->GetBoundary() );
+    resolver->GenerateData();
+    }
+  EquivalencyTable::Pointer equivalencies = resolver->GetEquivalencyTable();
+
+  //
+  // Merge the segment tables of the chunks, on the equivalent labels.
+  //
+  edge_table_hash_t edgeHash;
+  typename edge_table_t::iterator edge_ptr;
+  typedef typename edge_table_t::value_type EdgeValueType;
+  for ( c = 0; c < numberOfChunks; ++c )
+    {
+    typename SegmentTableType::Pointer chunkSegments = str.Segmenters[c]->GetSegmentTable();
+    for ( typename SegmentTableType::Iterator it = chunkSegments->Begin();
+          it != chunkSegments->End(); ++it )
+      {
+      const IdentifierType segment_label = equivalencies->Lookup( ( *it ).first );
+      typename SegmentTableType::segment_t *segment_ptr = segments->Lookup(segment_label);
+      if ( segment_ptr == 0 )
+        {
+        typename SegmentTableType::segment_t temp_segment;
+        temp_segment.min = ( *it ).second.min;
+        segments->Add(segment_label, temp_segment);
+        }
+      else if ( ( *it ).second.min < segment_ptr->min )
+        {
+        segment_ptr->min = ( *it ).second.min;
+        }
+
+      edge_table_t & edges = edgeHash[segment_label];
+      for ( typename SegmentTableType::edge_list_t::const_iterator e = ( *it ).second.edge_list.begin();
+            e != ( *it ).second.edge_list.end(); ++e )
+        {
+        const IdentifierType neighbor = equivalencies->Lookup( ( *e ).label );
+        if ( neighbor == segment_label ) { continue; }
+        edge_ptr = edges.find(neighbor);
+        if ( edge_ptr == edges.end() )
+          {
+          edges.insert( EdgeValueType(neighbor, ( *e ).height) );
+          }
+        else if ( ( *e ).height < ( *edge_ptr ).second )
+          {
+          ( *edge_ptr ).second = ( *e ).height;
+          }
+        }
+      }
+    chunkSegments->Clear();
+    }
+
+  //
+  // The chunks only know the adjacencies inside of them.  Add the ones
+  // across the faces between the chunks.
+  //
+  BoundaryIndexType high, low;
+  high.first = lastDimension;
+  high.second = 1;
+  low.first = lastDimension;
+  low.second = 0;
+  for ( c = 0; c + 1 < numberOfChunks; ++c )
+    {
+    const ImageRegionType regionA = str.Segmenters[c]->GetBoundary()->GetFace(high)->GetRequestedRegion();
+    const ImageRegionType regionB = str.Segmenters[c + 1]->GetBoundary()->GetFace(low)->GetRequestedRegion();
+    ImageRegionConstIterator< InputImageType >  valueA(input, regionA);
+    ImageRegionConstIterator< InputImageType >  valueB(input, regionB);
+    ImageRegionConstIterator< OutputImageType > labelA(output, regionA);
+    ImageRegionConstIterator< OutputImageType > labelB(output, regionB);
+    for ( ; !labelA.IsAtEnd(); ++valueA, ++valueB, ++labelA, ++labelB )
+      {
+      const IdentifierType a = equivalencies->Lookup( labelA.Get() );
+      const IdentifierType b = equivalencies->Lookup( labelB.Get() );
+      if ( a == b || a == NULL_LABEL || b == NULL_LABEL ) { continue; }
+
+      // The edge value is the maximum of the two adjacent pixels
+      const InputPixelType edgeA = Self::ThresholdValue(valueA.Get(), thresholdLevel);
+      const InputPixelType edgeB = Self::ThresholdValue(valueB.Get(), thresholdLevel);
+      const InputPixelType lowest_edge = ( edgeA < edgeB ) ? edgeB : edgeA;
+      for ( unsigned int side = 0; side < 2; ++side )
+        {
+        edge_table_t & edges = edgeHash[side == 0 ? a : b];
+        const IdentifierType neighbor = ( side == 0 ) ? b : a;
+        edge_ptr = edges.find(neighbor);
+        if ( edge_ptr == edges.end() )
+          {
+          edges.insert( EdgeValueType(neighbor, lowest_edge) );
+          }
+        else if ( lowest_edge < ( *edge_ptr ).second )
+          {
+          ( *edge_ptr ).second = lowest_edge;
+          }
+        }
+      }
+    }
+
+  // Copy the edge tables into the edge lists of the segment table.
+  for ( typename edge_table_hash_t::iterator edge_table_entry_ptr = edgeHash.begin();
+        edge_table_entry_ptr != edgeHash.end(); ++edge_table_entry_ptr )
+    {
+    typename SegmentTableType::segment_t *segment_ptr =
+      segments->Lookup( ( *edge_table_entry_ptr ).first );
+    segment_ptr->edge_list.clear();
+    for ( edge_ptr = ( *edge_table_entry_ptr ).second.begin();
+          edge_ptr != ( *edge_table_entry_ptr ).second.end(); ++edge_ptr )
+      {
+      segment_ptr->edge_list.push_back(
+        typename SegmentTableType::edge_pair_t( ( *edge_ptr ).first, ( *edge_ptr ).second ) );
+      }
+    }
+  edgeHash.clear();
+  this->UpdateProgress(0.8);
+
+  // Give the pixels the labels they are equivalent to.
+  str.Relabel = true;
+  str.Equivalencies = equivalencies;
+  threader->SingleMethodExecute();
+  this->UpdateProgress(0.9);
+
+  this->ReleaseInputs();
+  this->SetCurrentLabel(label);
+
+  if ( m_SortEdgeLists == true )
+          {  segments->SortEdgeLists(); }
+
+  segments->SetMaximumDepth(maximum - minimum);
+  this->UpdateProgress(1.0);
+}
+
+template< class TInputImage >
+ITK_THREAD_RETURN_TYPE
+Segmenter< TInputImage >
+::ChunkThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info = static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  ChunkStruct *str = static_cast< ChunkStruct * >( info->UserData );
+
+  for ( unsigned int c = info->ThreadID; c < str->Segmenters.size(); c += info->NumberOfThreads )
+    {
+    if ( str->Relabel )
+      {
+      str->Filter->RelabelChunk(*str, c);
+      }
+    else
+      {
+      str->Filter->SegmentChunk(*str, c);
+      }
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TInputImage >
+void Segmenter< TInputImage >
+::SegmentChunk(ChunkStruct & str, unsigned int chunk)
+{
+  Self *segmenter = str.Segmenters[chunk];
+
+  segmenter->GenerateData();
+
+  ImageRegionConstIterator< OutputImageType > it(segmenter->GetOutputImage(), str.Regions[chunk]);
+  ImageRegionIterator< OutputImageType >      ot(this->GetOutputImage(), str.Regions[chunk]);
+  for ( ; !it.IsAtEnd(); ++it, ++ot )
+    {
+    ot.Set( it.Get() );
+    }
+
+  // Only the boundary and the segment table are needed from now on
+  segmenter->GetOutputImage()->ReleaseData();
+  segmenter->SetInputImage(0);
+}
+
+template< class TInputImage >
+void Segmenter< TInputImage >
+::RelabelChunk(ChunkStruct & str, unsigned int chunk)
+{
+  // Like RelabelImage, without flattening the shared table
+  const EquivalencyTable *equivalencies = str.Equivalencies;
+
+  ImageRegionIterator< OutputImageType > it(this->GetOutputImage(), str.Regions[chunk]);
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    const IdentifierType temp = equivalencies->Lookup( it.Get() );
+    if ( temp != it.Get() )  { it.Set(temp); }
+    }
+}
+
 template< class TInputImage >
 void Segmenter< TInputImage >
 ::CollectBoundaryInformation(flat_region_table_t & flatRegions)
@@ -481,16 +832,18 @@ void Segmenter< TInputImage >
       searchIt.GoToBegin();
       labelIt.GoToBegin();
 
+      // The connectivity lists the negative directions from the last
+      // dimension to the first, then the positive directions from the
+      // first dimension to the last.
       if ( ( idx ).second == 0 )
         {
         // Low face
-        cPos = m_Connectivity.index[( idx ).first];
+        cPos = m_Connectivity.index[( ImageDimension - 1 ) - ( idx ).first];
         }
       else
         {
         // High face
-        cPos = m_Connectivity.index[( ImageDimension - 1 )
-                                    + ( ImageDimension - ( idx ).first )];
+        cPos = m_Connectivity.index[ImageDimension + ( idx ).first];
         }
 
       while ( !searchIt.IsAtEnd() )
@@ -1363,6 +1716,10 @@ Segmenter< TInputImage >
   m_CurrentLabel = 1;
   m_DoBoundaryAnalysis = false;
   m_SortEdgeLists = true;
+  m_NumberOfChunks = 1;
+  m_UseRegionRange = false;
+  m_RegionMinimum = NumericTraits< InputPixelType >::Zero;
+  m_RegionMaximum = NumericTraits< InputPixelType >::Zero;
   m_Connectivity.direction = 0;
   m_Connectivity.index = 0;
   typename OutputImageType::Pointer img =
@@ -1394,6 +1751,7 @@ Segmenter< TInputImage >
   os << indent << "Threshold: " << m_Threshold << std::endl;
   os << indent << "MaximumFloodLevel: " << m_MaximumFloodLevel << std::endl;
   os << indent << "CurrentLabel: " << m_CurrentLabel << std::endl;
+  os << indent << "NumberOfChunks: " << m_NumberOfChunks << std::endl;
 }
 } // end namespace watershed
 } // end namespace itk
@@ -0,0 +1,164 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkWatershedImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkTimeProbe.h"
+#include <map>
+
+namespace
+{
+typedef itk::Image< double, 3 >                ImageType;
+typedef itk::WatershedImageFilter< ImageType > WatershedType;
+typedef WatershedType::OutputImageType         LabelImageType;
+
+// Check that two label images define the same partition of the image,
+// whatever the numbering of the labels.
+bool SamePartitions(const LabelImageType *a, const LabelImageType *b,
+                    const ImageType::RegionType & region, const char *name)
+{
+  std::map< itk::IdentifierType, itk::IdentifierType > aToB;
+  std::map< itk::IdentifierType, itk::IdentifierType > bToA;
+
+  itk::ImageRegionConstIterator< LabelImageType > ait(a, region);
+  itk::ImageRegionConstIterator< LabelImageType > bit(b, region);
+  for( ; !ait.IsAtEnd(); ++ait, ++bit )
+    {
+    if( ait.Get() == 0 || bit.Get() == 0 )
+      {
+      std::cerr << name << ": pixel " << ait.GetIndex() << " is not labeled" << std::endl;
+      return false;
+      }
+    std::pair< std::map< itk::IdentifierType, itk::IdentifierType >::iterator, bool > ab =
+      aToB.insert( std::make_pair( ait.Get(), bit.Get() ) );
+    std::pair< std::map< itk::IdentifierType, itk::IdentifierType >::iterator, bool > ba =
+      bToA.insert( std::make_pair( bit.Get(), ait.Get() ) );
+    if( ab.first->second != bit.Get() || ba.first->second != ait.Get() )
+      {
+      std::cerr << name << ": pixel " << ait.GetIndex() << " is in segment "
+                << bit.Get() << " with chunks, in segment " << ait.Get()
+                << " without" << std::endl;
+      return false;
+      }
+    }
+  std::cout << name << ": " << aToB.size() << " segments" << std::endl;
+  return true;
+}
+}
+
+int itkWatershedImageFilterChunksTest(int, char* [] )
+{
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator GeneratorType;
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize( 2468 );
+
+  // Smooth hills with some noise, with no two equal neighbors so that no
+  // flat region crosses the chunk faces
+  ImageType::SizeType size;
+  size[0] = 47;
+  size[1] = 39;
+  size[2] = 33;
+  ImageType::IndexType start;
+  start[0] = -4;
+  start[1] = 2;
+  start[2] = 5;
+  ImageType::RegionType region( start, size );
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( region );
+  image->Allocate();
+  itk::ImageRegionIterator< ImageType > it( image, region );
+  for( ; !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType idx = it.GetIndex();
+    it.Set( vcl_sin( idx[0] / 4.0 ) * vcl_cos( idx[1] / 3.0 ) + vcl_sin( idx[2] / 5.0 )
+            + 0.3 * generator->GetVariate() );
+    }
+
+  // The segment tables only differ in the order of the edges of equal
+  // heights, which higher levels may merge in a different order
+  const double levels[] = { 0.0, 0.02 };
+  for( unsigned int l = 0; l < 2; ++l )
+    {
+    WatershedType::Pointer whole = WatershedType::New();
+    whole->SetInput( image );
+    whole->SetThreshold( 0.0 );
+    whole->SetLevel( levels[l] );
+    itk::TimeProbe wholeTime;
+    wholeTime.Start();
+    whole->Update();
+    wholeTime.Stop();
+    std::cout << "Level " << levels[l] << ": one chunk " << wholeTime.GetMean() << " s" << std::endl;
+
+    // More chunks than threads, and chunks only two pixels thick
+    const unsigned int numbersOfChunks[] = { 2, 5, 16 };
+    for( unsigned int c = 0; c < 3; ++c )
+      {
+      WatershedType::Pointer chunked = WatershedType::New();
+      chunked->SetInput( image );
+      chunked->SetThreshold( 0.0 );
+      chunked->SetLevel( levels[l] );
+      chunked->SetNumberOfChunks( numbersOfChunks[c] );
+      chunked->SetNumberOfThreads( 3 );
+      itk::TimeProbe chunkedTime;
+      chunkedTime.Start();
+      chunked->Update();
+      chunkedTime.Stop();
+      std::cout << "Level " << levels[l] << ": " << numbersOfChunks[c] << " chunks "
+                << chunkedTime.GetMean() << " s" << std::endl;
+
+      if( !SamePartitions( whole->GetOutput(), chunked->GetOutput(), region, "chunks" ) )
+        {
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  // With a threshold, flat regions cross the chunk faces: only check that
+  // the image is fully labeled, and that a new number of chunks reruns the
+  // segmentation.
+  WatershedType::Pointer thresholded = WatershedType::New();
+  thresholded->SetInput( image );
+  thresholded->SetThreshold( 0.3 );
+  thresholded->SetLevel( 0.05 );
+  const unsigned int thresholdedChunks[] = { 7, 1 };
+  for( unsigned int c = 0; c < 2; ++c )
+    {
+    thresholded->SetNumberOfChunks( thresholdedChunks[c] );
+    thresholded->Update();
+    std::map< itk::IdentifierType, bool > labels;
+    itk::ImageRegionConstIterator< LabelImageType > lit( thresholded->GetOutput(), region );
+    for( ; !lit.IsAtEnd(); ++lit )
+      {
+      if( lit.Get() == 0 )
+        {
+        std::cerr << "Pixel " << lit.GetIndex() << " is not labeled" << std::endl;
+        return EXIT_FAILURE;
+        }
+      labels[lit.Get()] = true;
+      }
+    std::cout << "Threshold 0.3, " << thresholdedChunks[c] << " chunks: "
+              << labels.size() << " segments" << std::endl;
+    }
+  thresholded->Print( std::cout );
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}